@@ -1,8 +1,9 @@
 // SPDX-License-Identifier: MIT
 /*
  * Combined and revised DMA loopback/throughput test for PolarFire SoC.
- * This version uses the UIO framework and implements a chained descriptor
- * throughput test with pre-flight configuration verification.
+ * This version uses the UIO framework, through the radiohound-dma library,
+ * and implements batched and chained descriptor throughput tests and a
+ * stream descriptor setup test.
  *
  */
 
@@ -14,65 +15,10 @@
 #include <sys/mman.h>
 #include <errno.h>
 #include <stdint.h>
-#include <time.h>       
-#include "mpu_driver.h" 
-
-/*
- * This struct accurately represents a single DMA descriptor block in hardware,
- * including padding, allowing for easy array-based access.
- * Each descriptor is 32 bytes.
- */
-typedef struct {
-    volatile uint32_t CONFIG_REG;         // Offset +0x00
-    volatile uint32_t BYTE_COUNT_REG;     // Offset +0x04
-    volatile uint32_t SOURCE_ADDR_REG;    // Offset +0x08
-    volatile uint32_t DEST_ADDR_REG;      // Offset +0x0C
-    volatile uint32_t NEXT_DESC_ADDR_REG; // Offset +0x10
-    uint8_t           _RESERVED[0x20 - 0x14]; // Pad to 32 bytes total
-} DmaDescriptorBlock_t;
-
-/*
- * This struct represents the register block for a single interrupt source.
- */
-typedef struct {
-    volatile const uint32_t STAT_REG;
-    volatile uint32_t       MASK_REG;
-    volatile uint32_t       CLEAR_REG;
-    volatile const uint32_t EXT_ADDR_REG;
-} DmaInterruptBlock_t;
-
-
-/*
- * This struct represents a single Stream Descriptor block in memory.
- * Each descriptor is 12 bytes, padded to 16 for alignment.
- */
-#define STREAM_DESC_SIZE 16
-typedef struct {
-    volatile uint32_t CONFIG_REG;         // Offset +0x00
-    volatile uint32_t BYTE_COUNT_REG;     // Offset +0x04
-    volatile uint32_t DEST_ADDR_REG;      // Offset +0x08
-    uint8_t           _RESERVED[STREAM_DESC_SIZE - 12];
-} StreamDescriptor_t;
-
-
-/*
- * This struct directly mirrors the register layout of the CoreAXI4DMAController
- * using the descriptor block structure defined above.
- */
-typedef struct {
-    volatile const uint32_t VERSION_REG;            // Offset +0x00
-    volatile uint32_t       START_OPERATION_REG;      // Offset +0x04
-    uint8_t                 _RESERVED1[0x10 - 0x08];
-    DmaInterruptBlock_t     INTERRUPT[4];             // Offset +0x10 (0x10 * 4 = 0x40 bytes)
-    uint8_t                 _RESERVED2[0x60 - 0x50];
-    DmaDescriptorBlock_t    DESCRIPTOR[4];            // Offset +0x60
-    uint8_t                 _RESERVED3[0x460 - (0x60 + sizeof(DmaDescriptorBlock_t) * 4)];
-    volatile uint32_t       STREAM_DESC_ADDR_REG[4];  // Offset +0x460
-} CoreAXI4DMAController_Regs_t;
-
-
-// Device tree names
-#define UIO_DMA_DEVNAME         "dma-controller@60010000"
+#include <time.h>       // For high-resolution timing
+#include <poll.h>
+#include "mpu_driver.h" // For MPU setup
+#include "radiohound_dma_api.h"
 
 // Memory addresses
 #define DDR_BUFFER_BASE         0xc8000000UL // Base for all test buffers
@@ -81,72 +27,27 @@ typedef struct {
 #define LOOPBACK_BUFFER_SIZE    4096
 
 // Throughput Test parameters
-#define NUM_CHAINED_DESCS           4
-#define SINGLE_DESC_TRANSFER_SIZE (1024 * 1024) // 1MB per descriptor
-#define TOTAL_CHAINED_TRANSFER_SIZE (NUM_CHAINED_DESCS * SINGLE_DESC_TRANSFER_SIZE)
+#define NUM_BATCHED_XFERS       4
+#define SINGLE_XFER_SIZE        (1024 * 1024) // 1MB per transfer
+#define TOTAL_BATCH_TRANSFER_SIZE (NUM_BATCHED_XFERS * SINGLE_XFER_SIZE)
 #define THROUGHPUT_SRC_BASE     DDR_BUFFER_BASE // Source data from DDR
-#define THROUGHPUT_DEST_BASE    (DDR_BUFFER_BASE + TOTAL_CHAINED_TRANSFER_SIZE) // Place destination after source to avoid overlap
-
-// DMA Configuration Bit Flags
-#define FLAG_CHAIN              (1U << 10)
-#define FLAG_IRQ_ON_PROCESS     (1U << 12)
-#define FLAG_SRC_RDY            (1U << 13)
-#define FLAG_DEST_RDY           (1U << 14)
-#define FLAG_VALID              (1U << 15)
-#define OP_INCR                 (0b01)
-
-// Stream Descriptor Configuration Bit Flags
-#define STREAM_FLAG_DEST_OP_INCR (0b01)
-#define STREAM_FLAG_DEST_RDY     (1U << 2)
-#define STREAM_FLAG_VALID        (1U << 3)
-
-// Base configuration for an incrementing transfer (without the VALID bit)
-#define BASE_CONF               ((OP_INCR << 2) | OP_INCR | FLAG_SRC_RDY | FLAG_DEST_RDY)
-
-// DMA Control values
-#define FDMA_START              (1U << 0) // Start with descriptor 0
-#define FDMA_IRQ_MASK           (1U << 0) // Unmask completion interrupt
-#define FDMA_IRQ_CLEAR          (1U << 0) // Clear completion interrupt
-
-// Helper constants
-#define SYSFS_PATH_LEN          (128)
-#define ID_STR_LEN              (32)
-#define UIO_DEVICE_PATH_LEN     (32)
-#define NUM_UIO_DEVICES         (32)
-#define MAP_SIZE                4096UL
+#define THROUGHPUT_DEST_BASE    (DDR_BUFFER_BASE + TOTAL_BATCH_TRANSFER_SIZE) // Place destination after source to avoid overlap
 
-/**
- * @brief Finds the UIO device number (e.g., 'X' in /dev/uioX) for a given device name.
- * @param id The name of the device from the device tree (e.g., "dma-controller@60010000").
- * @return The UIO device number on success, -1 on failure.
- */
-static int get_uio_device_number(const char *id) {
-    FILE *fp;
-    int i;
-    char file_id[ID_STR_LEN];
-    char sysfs_path[SYSFS_PATH_LEN];
-
-    for (i = 0; i < NUM_UIO_DEVICES; i++) {
-        snprintf(sysfs_path, SYSFS_PATH_LEN, "/sys/class/uio/uio%d/name", i);
-        fp = fopen(sysfs_path, "r");
-        if (fp == NULL) break;
-        fscanf(fp, "%31s", file_id);
-        fclose(fp);
-        if (strncmp(file_id, id, strlen(id)) == 0) return i;
-    }
-    return -1;
-}
+// Stream Test parameters
+#define DESC_PAGE_SIZE               4096
+#define STREAM_DESC_PHYS        (THROUGHPUT_DEST_BASE + TOTAL_BATCH_TRANSFER_SIZE) // Past the throughput buffers
+#define STREAM_DEST_PHYS        (STREAM_DESC_PHYS + DESC_PAGE_SIZE) // Place buffer on the next page
+#define STREAM_TRANSFER_SIZE    1024
 
 /**
  * @brief Runs a simple memory-to-memory loopback test within DDR.
  * This confirms basic DMA functionality and interrupt handling.
- * @param dma_regs Pointer to the mapped DMA controller registers.
- * @param dma_uio_fd File descriptor for the DMA's UIO device.
+ * @param dma Open DMA library handle.
  * @param mem_fd File descriptor for /dev/mem.
  */
-void run_loopback_test(CoreAXI4DMAController_Regs_t* dma_regs, int dma_uio_fd, int mem_fd) {
+void run_loopback_test(RhDma* dma, int mem_fd) {
     uint8_t *src_buf = NULL, *dest_buf = NULL;
-    
+
     printf("\n--- Running Memory-to-Memory Loopback Test ---\n");
 
     // Map source and destination buffers in the reserved DDR region
@@ -161,59 +62,126 @@ void run_loopback_test(CoreAXI4DMAController_Regs_t* dma_regs, int dma_uio_fd, i
     for (int i = 0; i < LOOPBACK_BUFFER_SIZE; i++) src_buf[i] = (uint8_t)(i % 256);
     memset(dest_buf, 0, LOOPBACK_BUFFER_SIZE);
 
-    // Configure Descriptor 0 for the loopback
-    dma_regs->DESCRIPTOR[0].SOURCE_ADDR_REG = DDR_BUFFER_BASE;
-    dma_regs->DESCRIPTOR[0].DEST_ADDR_REG = DDR_BUFFER_BASE + LOOPBACK_BUFFER_SIZE;
-    dma_regs->DESCRIPTOR[0].BYTE_COUNT_REG = LOOPBACK_BUFFER_SIZE;
-    dma_regs->DESCRIPTOR[0].NEXT_DESC_ADDR_REG = 0; // Not chained
-    
-    // Correct two-step write: 1. Configure, 2. Arm
-    dma_regs->DESCRIPTOR[0].CONFIG_REG = BASE_CONF | FLAG_IRQ_ON_PROCESS;
-    dma_regs->DESCRIPTOR[0].CONFIG_REG |= FLAG_VALID;
-    
-    // Enable and start DMA
-    dma_regs->INTERRUPT[0].MASK_REG = FDMA_IRQ_MASK; // Corrected register access
-    dma_regs->START_OPERATION_REG = FDMA_START;
+    RhDmaTransfer xfer = {
+        .kind = RH_DMA_MEM_TO_MEM,
+        .src_phys = DDR_BUFFER_BASE,
+        .dst_phys = DDR_BUFFER_BASE + LOOPBACK_BUFFER_SIZE,
+        .bytes = LOOPBACK_BUFFER_SIZE,
+    };
+    RhDmaCompletion done;
+    if (rh_dma_submit(dma, &xfer, 1) != 1) {
+        printf("***** Loopback Test FAILED *****\n");
+        goto out;
+    }
 
     printf("  Waiting for DMA completion interrupt...\n");
-    uint32_t irq_count;
-    read(dma_uio_fd, &irq_count, sizeof(irq_count));
-    printf("  Interrupt received!\n");
-    dma_regs->INTERRUPT[0].CLEAR_REG = FDMA_IRQ_CLEAR; // Corrected register access
+    if (rh_dma_reap(dma, &done, 1, 1000) != 1) {
+        printf("  ERROR: No completion within 1s.\n");
+        rh_dma_reset(dma);
+        printf("***** Loopback Test FAILED *****\n");
+        goto out;
+    }
+    printf("  Interrupt received! (event 0x%08X)\n", done.irq_status);
 
     // Verify data
-    if (memcmp(src_buf, dest_buf, LOOPBACK_BUFFER_SIZE) == 0) {
+    if (done.status == RH_DMA_STATUS_OK && memcmp(src_buf, dest_buf, LOOPBACK_BUFFER_SIZE) == 0) {
         printf("***** Loopback Test PASSED *****\n");
     } else {
         printf("***** Loopback Test FAILED *****\n");
     }
 
+out:
     munmap(src_buf, LOOPBACK_BUFFER_SIZE);
     munmap(dest_buf, LOOPBACK_BUFFER_SIZE);
 }
 
 /**
- * @brief Runs the chained descriptor throughput test from DDR to DDR.
- * @param dma_regs Pointer to the mapped DMA controller registers.
- * @param dma_uio_fd File descriptor for the DMA's UIO device.
- * @param mem_fd File descriptor for /dev/mem is not used here but passed for consistency.
+ * @brief Runs the batched DDR-to-DDR throughput test: four 1MB transfers submitted together,
+ * one per internal descriptor, then reaped as they complete.
+ * @param dma Open DMA library handle.
+ */
+void run_batched_throughput_test(RhDma* dma) {
+    printf("\n--- Running Batched DDR-to-DDR Throughput Test ---\n");
+
+    RhDmaTransfer xfers[NUM_BATCHED_XFERS];
+    RhDmaCompletion done[NUM_BATCHED_XFERS];
+    for (int i = 0; i < NUM_BATCHED_XFERS; i++) {
+        xfers[i].kind = RH_DMA_MEM_TO_MEM;
+        xfers[i].stream = 0;
+        xfers[i].src_phys = THROUGHPUT_SRC_BASE;
+        xfers[i].dst_phys = THROUGHPUT_DEST_BASE + (i * SINGLE_XFER_SIZE);
+        xfers[i].bytes = SINGLE_XFER_SIZE;
+        xfers[i].user_data = i;
+    }
+
+    printf("  Submitting %d transfers as one batch for %luMB...\n", NUM_BATCHED_XFERS,
+           (unsigned long)(TOTAL_BATCH_TRANSFER_SIZE / (1024 * 1024)));
+
+    struct timespec start_time, end_time;
+    clock_gettime(CLOCK_MONOTONIC, &start_time);
+
+    if (rh_dma_submit(dma, xfers, NUM_BATCHED_XFERS) != NUM_BATCHED_XFERS) {
+        printf("\nERROR: The batch was not accepted. Aborting test.\n");
+        return;
+    }
+    int completed = 0, failed = 0;
+    while (completed < NUM_BATCHED_XFERS) {
+        int got = rh_dma_reap(dma, done, NUM_BATCHED_XFERS, 1000);
+        if (got <= 0) break;
+        for (int i = 0; i < got; i++) {
+            if (done[i].status != RH_DMA_STATUS_OK) failed++;
+        }
+        completed += got;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &end_time);
+
+    if (completed < NUM_BATCHED_XFERS || failed) {
+        printf("\nERROR: %d of %d transfers completed, %d with errors.\n", completed, NUM_BATCHED_XFERS, failed);
+        rh_dma_reset(dma);
+        return;
+    }
+    printf("  All completions reaped (%llu interrupt events, %llu waits so far).\n",
+           (unsigned long long)dma->stats.events, (unsigned long long)dma->stats.waits);
+
+    // Calculate and print throughput
+    double elapsed_time = (end_time.tv_sec - start_time.tv_sec) + (end_time.tv_nsec - start_time.tv_nsec) / 1e9;
+    double throughput = (double)TOTAL_BATCH_TRANSFER_SIZE / elapsed_time / (1024.0 * 1024.0);
+
+    printf("\n***** Batched Throughput Test Complete *****\n");
+    printf("Transferred %lu MB in %.4f seconds.\n", (unsigned long)(TOTAL_BATCH_TRANSFER_SIZE / (1024*1024)), elapsed_time);
+    printf("Calculated Throughput: %.2f MB/s\n", throughput);
+    printf("******************************************\n");
+}
+
+/**
+ * @brief Runs the chained descriptor throughput test from DDR to DDR: descriptors 0->1->2->3
+ * linked with FLAG_CHAIN and started by one kick-off, interrupting only when the last finishes.
+ * The library has no chained transfers, so this programs the descriptors itself while the
+ * library is idle and consumes the interrupt on its behalf.
+ * @param dma Open DMA library handle.
  */
-void run_chained_throughput_test(CoreAXI4DMAController_Regs_t* dma_regs, int dma_uio_fd, int mem_fd) {
+void run_chained_throughput_test(RhDma* dma) {
+    CoreAXI4DMAController_Regs_t* regs = rh_dma_regs(dma);
+    DmaInterruptBlock_t* irq = &regs->INTERRUPT[0];
+    uint32_t intended_configs[NUM_BATCHED_XFERS];
+    uint32_t intended_next_desc[NUM_BATCHED_XFERS];
+
     printf("\n--- Running Chained DDR-to-DDR Throughput Test ---\n");
-    
-    uint32_t intended_configs[NUM_CHAINED_DESCS];
-    uint32_t intended_next_desc[NUM_CHAINED_DESCS];
+    if (rh_dma_outstanding(dma) > 0) {
+        printf("  ERROR: Library transfers are still outstanding. Aborting test.\n");
+        return;
+    }
 
     // --- Step 1: Configure all descriptors without setting the VALID bit ---
-    // This is the first part of the two-step "configure, then arm" process.
-    printf("  Configuring %d descriptors in a linear chain (0->1->2->3)...\n", NUM_CHAINED_DESCS);
-    for (int i = 0; i < NUM_CHAINED_DESCS; i++) {
-        dma_regs->DESCRIPTOR[i].SOURCE_ADDR_REG = THROUGHPUT_SRC_BASE;
-        dma_regs->DESCRIPTOR[i].DEST_ADDR_REG = THROUGHPUT_DEST_BASE + (i * SINGLE_DESC_TRANSFER_SIZE);
-        dma_regs->DESCRIPTOR[i].BYTE_COUNT_REG = SINGLE_DESC_TRANSFER_SIZE;
-        
+    printf("  Configuring %d descriptors in a linear chain (0->1->2->3)...\n", NUM_BATCHED_XFERS);
+    for (int i = 0; i < NUM_BATCHED_XFERS; i++) {
+        regs->DESCRIPTOR[i].SOURCE_ADDR_REG = THROUGHPUT_SRC_BASE;
+        regs->DESCRIPTOR[i].DEST_ADDR_REG = THROUGHPUT_DEST_BASE + (i * SINGLE_XFER_SIZE);
+        regs->DESCRIPTOR[i].BYTE_COUNT_REG = SINGLE_XFER_SIZE;
+
         uint32_t temp_config = BASE_CONF;
-        if (i < NUM_CHAINED_DESCS - 1) {
+        if (i < NUM_BATCHED_XFERS - 1) {
             // Point to the next descriptor in the chain
             temp_config |= FLAG_CHAIN;
             intended_next_desc[i] = i + 1;
@@ -222,147 +190,128 @@ void run_chained_throughput_test(CoreAXI4DMAController_Regs_t* dma_regs, int dma
             temp_config |= FLAG_IRQ_ON_PROCESS;
             intended_next_desc[i] = 0; // Next descriptor is ignored
         }
-        
-        // Store the final intended value for verification
         intended_configs[i] = temp_config | FLAG_VALID;
-        
-        // Write the configuration and next descriptor address to the hardware.
-        dma_regs->DESCRIPTOR[i].CONFIG_REG = temp_config; 
-        dma_regs->DESCRIPTOR[i].NEXT_DESC_ADDR_REG = intended_next_desc[i];
+        regs->DESCRIPTOR[i].CONFIG_REG = temp_config;
+        regs->DESCRIPTOR[i].NEXT_DESC_ADDR_REG = intended_next_desc[i];
     }
-    
+
     // --- Step 2: Arm all descriptors by setting the VALID bit ---
-    printf("  Arming descriptors by setting the VALID bit...\n");
-    for (int i = 0; i < NUM_CHAINED_DESCS; i++) {
-        dma_regs->DESCRIPTOR[i].CONFIG_REG |= FLAG_VALID;
+    for (int i = 0; i < NUM_BATCHED_XFERS; i++) {
+        regs->DESCRIPTOR[i].CONFIG_REG |= FLAG_VALID;
     }
-    
-    // Ensure writes are visible to hardware before proceeding
-    __sync_synchronize(); 
-
-    dma_regs->INTERRUPT[0].MASK_REG = FDMA_IRQ_MASK; // FIX: Corrected register access
-    
-    // --- Step 3: Optional - Read back and verify the configuration ---
-    int config_ok = 1;
-    for (int i = 0; i < NUM_CHAINED_DESCS; i++) {
-        uint32_t actual_config = dma_regs->DESCRIPTOR[i].CONFIG_REG;
-        uint32_t actual_next = dma_regs->DESCRIPTOR[i].NEXT_DESC_ADDR_REG;
-        
+    __sync_synchronize();
+
+    // --- Step 3: Read back and verify the configuration ---
+    for (int i = 0; i < NUM_BATCHED_XFERS; i++) {
+        uint32_t actual_config = regs->DESCRIPTOR[i].CONFIG_REG;
+        uint32_t actual_next = regs->DESCRIPTOR[i].NEXT_DESC_ADDR_REG;
         if (intended_configs[i] != actual_config || intended_next_desc[i] != actual_next) {
-            printf("  ERROR: Descriptor %d config mismatch!\n", i);
-            printf("     Expected Conf: 0x%08X, Got: 0x%08X\n", intended_configs[i], actual_config);
-            printf("     Expected Next: %d, Got: %d\n", intended_next_desc[i], actual_next);
-            config_ok = 0;
+            printf("  ERROR: Descriptor %d config mismatch (conf 0x%08X, next %u)! Aborting test.\n", i,
+                   actual_config, actual_next);
+            rh_dma_reset(dma);
+            return;
         }
     }
-
-    if (!config_ok) {
-        printf("\nERROR: Hardware configuration does not match intended values. Aborting test.\n");
-        return;
-    }
     printf("  Descriptor configuration verified successfully.\n");
-    
-    // --- Step 4: Run the transfer and time it ---
-    printf("\n  Performing single kick-off for %luMB transfer...\n", (unsigned long)(TOTAL_CHAINED_TRANSFER_SIZE / (1024 * 1024)));
-    
+
+    // --- Step 4: Run the chain and time it ---
+    printf("\n  Performing single kick-off for %luMB transfer...\n",
+           (unsigned long)(TOTAL_BATCH_TRANSFER_SIZE / (1024 * 1024)));
     struct timespec start_time, end_time;
     clock_gettime(CLOCK_MONOTONIC, &start_time);
 
-    dma_regs->START_OPERATION_REG = FDMA_START;
-    
-    uint32_t irq_count;
-    read(dma_uio_fd, &irq_count, sizeof(irq_count)); // Block until final interrupt
+    regs->START_OPERATION_REG = 1U << 0;
 
+    struct pollfd pfd = { .fd = rh_dma_fd(dma), .events = POLLIN };
+    uint32_t irq_count;
+    if (poll(&pfd, 1, 1000) != 1 || read(pfd.fd, &irq_count, sizeof(irq_count)) != sizeof(irq_count)) {
+        printf("  ERROR: No interrupt within 1s. Aborting test.\n");
+        rh_dma_reset(dma);
+        return;
+    }
     clock_gettime(CLOCK_MONOTONIC, &end_time);
-    
-    dma_regs->INTERRUPT[0].CLEAR_REG = FDMA_IRQ_CLEAR;
+
+    // Drain the event queue and re-enable the UIO interrupt, as the library would.
+    uint32_t stat, errors = 0;
+    while ((stat = irq->STAT_REG) & FDMA_IRQ_ALL) {
+        errors |= stat & FDMA_IRQ_ERRORS;
+        irq->CLEAR_REG = stat & FDMA_IRQ_ALL;
+    }
+    uint32_t irq_enable = 1;
+    if (write(pfd.fd, &irq_enable, sizeof(irq_enable)) != sizeof(irq_enable)) {
+        perror("Failed to re-enable the UIO interrupt");
+    }
+    if (errors) {
+        printf("  ERROR: The chain reported errors (0x%X).\n", errors);
+        return;
+    }
     printf("  Final interrupt received and cleared.\n");
 
-    // Calculate and print throughput
     double elapsed_time = (end_time.tv_sec - start_time.tv_sec) + (end_time.tv_nsec - start_time.tv_nsec) / 1e9;
-    double throughput = (double)TOTAL_CHAINED_TRANSFER_SIZE / elapsed_time / (1024.0 * 1024.0);
+    double throughput = (double)TOTAL_BATCH_TRANSFER_SIZE / elapsed_time / (1024.0 * 1024.0);
 
     printf("\n***** Chained Throughput Test Complete *****\n");
-    printf("Transferred %lu MB in %.4f seconds.\n", (unsigned long)(TOTAL_CHAINED_TRANSFER_SIZE / (1024*1024)), elapsed_time);
+    printf("Transferred %lu MB in %.4f seconds.\n", (unsigned long)(TOTAL_BATCH_TRANSFER_SIZE / (1024*1024)), elapsed_time);
     printf("Calculated Throughput: %.2f MB/s\n", throughput);
     printf("******************************************\n");
 }
 
 /**
- * @brief Sets up and verifies the configuration for a Stream Descriptor test.
- * @note This test only prepares the DMA controller. A real AXI4-Stream
- * initiator is required to assert TVALID and start the actual transfer.
- * @param dma_regs Pointer to the mapped DMA controller registers.
- * @param mem_fd File descriptor for /dev/mem.
+ * @brief Arms the stream descriptor for TDEST 0 through the library and checks that the
+ * controller's STREAM_DESC_ADDR_REG points at it.
+ * @param dma Open DMA library handle (opened with the stream descriptor page).
  */
-void run_stream_descriptor_test(CoreAXI4DMAController_Regs_t* dma_regs, int mem_fd) {
-    StreamDescriptor_t *stream_desc = NULL;
-    uint8_t *dest_buf = NULL;
-    
-    // Define page size for mmap alignment
-    const uint32_t PAGE_SIZE = 4096;
-
-    // Ensure all physical addresses are page-aligned for mmap
-    uint32_t stream_desc_phys_addr = DDR_BUFFER_BASE; 
-    uint32_t dest_buf_phys_addr = stream_desc_phys_addr + PAGE_SIZE; // Place buffer on the next page
-    uint32_t transfer_size = 1024;
+void run_stream_descriptor_test(RhDma* dma) {
+    CoreAXI4DMAController_Regs_t* regs = rh_dma_regs(dma);
+    RhDmaCompletion done;
 
     printf("\n--- Running Stream Descriptor Setup Test ---\n");
 
-    // 1. Map memory for the stream descriptor and destination buffer
-    stream_desc = mmap(NULL, sizeof(StreamDescriptor_t), PROT_READ | PROT_WRITE, MAP_SHARED, mem_fd, stream_desc_phys_addr);
-    dest_buf = mmap(NULL, transfer_size, PROT_READ | PROT_WRITE, MAP_SHARED, mem_fd, dest_buf_phys_addr);
-    if (stream_desc == MAP_FAILED || dest_buf == MAP_FAILED) {
-        perror("Failed to mmap memory for stream test");
-        // Clean up any successful mappings before returning
-        if(stream_desc != MAP_FAILED) munmap(stream_desc, sizeof(StreamDescriptor_t));
-        if(dest_buf != MAP_FAILED) munmap(dest_buf, transfer_size);
+    printf(" Step 1: Submitting a %d-byte stream transfer on TDEST=0...\n", STREAM_TRANSFER_SIZE);
+    printf("         Descriptor Physical Address: 0x%08lX\n", (unsigned long)STREAM_DESC_PHYS);
+
+    RhDmaTransfer xfer = {
+        .kind = RH_DMA_STREAM_TO_MEM,
+        .stream = 0,
+        .dst_phys = STREAM_DEST_PHYS,
+        .bytes = STREAM_TRANSFER_SIZE,
+    };
+    if (rh_dma_submit(dma, &xfer, 1) != 1) {
+        printf("         FAILURE: The transfer was not accepted.\n");
         return;
     }
 
-    printf(" Step 1: Configuring a Stream Descriptor in DDR memory...\n");
-    printf("         Descriptor Physical Address: 0x%08X\n", stream_desc_phys_addr);
-
-    // 2. Configure the stream descriptor in memory
-    // This is what a processor would do before a stream transaction begins
-    stream_desc->DEST_ADDR_REG = dest_buf_phys_addr;
-    stream_desc->BYTE_COUNT_REG = transfer_size;
-    stream_desc->CONFIG_REG = STREAM_FLAG_DEST_OP_INCR | STREAM_FLAG_DEST_RDY | STREAM_FLAG_VALID;
-    
-    // Ensure this write is visible to the DMA hardware
-    __sync_synchronize();
-
-    printf(" Step 2: Pointing DMA's STREAM_0_ADDR_REG to the descriptor...\n");
-    
-    // 3. Write the physical address of the descriptor to the DMA controller.
-    // This associates the descriptor with stream TDEST = 0b00
-    dma_regs->STREAM_DESC_ADDR_REG[0] = stream_desc_phys_addr;
-    
-    // 4. Verify the register was written correctly
-    uint32_t read_back_addr = dma_regs->STREAM_DESC_ADDR_REG[0];
-    if (read_back_addr == stream_desc_phys_addr) {
-        printf("         SUCCESS: Register readback matches written value (0x%08X).\n", read_back_addr);
+    // Verify the library pointed the controller at the descriptor
+    printf(" Step 2: Reading back the DMA's STREAM_0_ADDR_REG...\n");
+    uint32_t read_back_addr = regs->STREAM_DESC_ADDR_REG[0];
+    if (read_back_addr == (uint32_t)STREAM_DESC_PHYS) {
+        printf("         SUCCESS: Register readback matches the descriptor (0x%08X).\n", read_back_addr);
     } else {
-        printf("         FAILURE: Wrote 0x%08X but read back 0x%08X.\n", stream_desc_phys_addr, read_back_addr);
+        printf("         FAILURE: Expected 0x%08lX but read back 0x%08X.\n", (unsigned long)STREAM_DESC_PHYS, read_back_addr);
+    }
+
+    // Nothing drives the stream here, so a completion would mean a packet was already waiting
+    if (rh_dma_reap(dma, &done, 1, 0) == 1) {
+        printf("         A packet arrived: %u bytes, status %d.\n", done.bytes, done.status);
     }
 
     printf("\n***** Stream Descriptor Setup Complete *****\n");
-    printf("The DMA is now configured to process a stream transaction on TDEST=0.\n");
+    printf("The DMA was configured to process a stream transaction on TDEST=0.\n");
     printf("To proceed, a hardware AXI4-Stream initiator would need to start a transfer.\n");
     printf("**********************************************\n");
 
-    // Cleanup
-    munmap(stream_desc, sizeof(StreamDescriptor_t));
-    munmap(dest_buf, transfer_size);
+    // Withdraw the descriptor so a later packet does not land in the test buffer
+    rh_dma_reset(dma);
 }
 
-
 /**
  * @brief Main entry point for the application.
  */
 int main(void) {
-    int dma_uio_fd = -1, mem_fd = -1, uio_num;
-    CoreAXI4DMAController_Regs_t *dma_regs = NULL;
+    int mem_fd = -1;
+    void *stream_desc = NULL;
+    RhDmaConfig dma_config;
+    RhDma dma;
     char cmd;
 
     printf("--- PolarFire SoC DMA Test Application ---\n");
@@ -373,62 +322,54 @@ int main(void) {
         return 1;
     }
 
-    // Find the UIO device for the DMA controller
-    uio_num = get_uio_device_number(UIO_DMA_DEVNAME);
-    if (uio_num < 0) {
-        fprintf(stderr, "Fatal: Could not find UIO device for %s.\n", UIO_DMA_DEVNAME);
-        return 1;
-    }
-    
-    // Open the UIO device file
-    char uio_dev_path[UIO_DEVICE_PATH_LEN];
-    snprintf(uio_dev_path, UIO_DEVICE_PATH_LEN, "/dev/uio%d", uio_num);
-    dma_uio_fd = open(uio_dev_path, O_RDWR);
-    if (dma_uio_fd < 0) {
-        perror("Fatal: Failed to open UIO device file");
+    // Open /dev/mem to map other physical memory regions (DDR)
+    mem_fd = open("/dev/mem", O_RDWR | O_SYNC);
+    if (mem_fd < 0) {
+        perror("Fatal: Failed to open /dev/mem");
         return 1;
     }
 
-    // Map the DMA controller's registers into the application's virtual address space
-    dma_regs = mmap(NULL, MAP_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, dma_uio_fd, 0);
-    if (dma_regs == MAP_FAILED) {
-        perror("Fatal: Failed to mmap UIO device");
-        close(dma_uio_fd);
+    // Map the page the library writes the stream descriptors into
+    stream_desc = mmap(NULL, DESC_PAGE_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, mem_fd, STREAM_DESC_PHYS);
+    if (stream_desc == MAP_FAILED) {
+        perror("Fatal: Failed to mmap stream descriptor page");
+        close(mem_fd);
         return 1;
     }
 
-    // Open /dev/mem to map other physical memory regions (DDR)
-    mem_fd = open("/dev/mem", O_RDWR | O_SYNC);
-    if (mem_fd < 0) {
-        perror("Fatal: Failed to open /dev/mem");
-        munmap(dma_regs, MAP_SIZE);
-        close(dma_uio_fd);
+    // Find, open and map the DMA controller (by its device tree name)
+    rh_dma_config_default(&dma_config);
+    dma_config.desc_phys = STREAM_DESC_PHYS;
+    dma_config.desc_virt = stream_desc;
+    if (rh_dma_open(&dma, &dma_config) != 0) {
+        fprintf(stderr, "Fatal: Could not open the DMA controller %s.\n", dma_config.uio_name);
+        munmap(stream_desc, DESC_PAGE_SIZE);
+        close(mem_fd);
         return 1;
     }
 
-    printf("Reading DMA Controller Version: 0x%08X\n", dma_regs->VERSION_REG);
-
-    // Enable interrupts for the UIO device
-    uint32_t irq_enable = 1;
-    write(dma_uio_fd, &irq_enable, sizeof(irq_enable));
+    printf("Reading DMA Controller Version: 0x%08X\n", rh_dma_regs(&dma)->VERSION_REG);
 
     // Main menu loop
     while(1){
         printf("\n# Choose one of the following options:\n");
         printf("  1 - Run Memory-to-Memory Loopback Test\n");
-        printf("  2 - Run Chained DDR-to-DDR Throughput Test\n");
-        printf("  3 - Run Stream Descriptor Setup Test\n");
-        printf("  4 - Exit\n> ");
-        
+        printf("  2 - Run Batched DDR-to-DDR Throughput Test\n");
+        printf("  3 - Run Chained DDR-to-DDR Throughput Test\n");
+        printf("  4 - Run Stream Descriptor Setup Test\n");
+        printf("  5 - Exit\n> ");
+
         scanf(" %c", &cmd);
 
         if (cmd == '1') {
-            run_loopback_test(dma_regs, dma_uio_fd, mem_fd);
+            run_loopback_test(&dma, mem_fd);
         } else if (cmd == '2') {
-            run_chained_throughput_test(dma_regs, dma_uio_fd, mem_fd);
+            run_batched_throughput_test(&dma);
         } else if (cmd == '3') {
-            run_stream_descriptor_test(dma_regs, mem_fd);
-        } else if (cmd == '4' || cmd == 'q') {
+            run_chained_throughput_test(&dma);
+        } else if (cmd == '4') {
+            run_stream_descriptor_test(&dma);
+        } else if (cmd == '5' || cmd == 'q') {
             break;
         } else {
             printf("Invalid option.\n");
@@ -436,10 +377,10 @@ int main(void) {
     }
 
     // --- Cleanup ---
-    munmap(dma_regs, MAP_SIZE);
-    close(dma_uio_fd);
+    rh_dma_close(&dma);
+    munmap(stream_desc, DESC_PAGE_SIZE);
     close(mem_fd);
     printf("\nExiting.\n");
 
     return 0;
-}
\ No newline at end of file
+}
@@ -14,9 +14,27 @@
 #define DMA_PHYSICAL_BASE_ADDR 0xc8000000
 
 // --- Buffer Configuration within the UDMABuf region ---
-#define STREAM_DESCRIPTOR_OFFSET 0x0      // Descriptors at the start of the buffer
+#define STREAM_DESCRIPTOR_OFFSET 0x0      // Stream descriptors (one per TDEST) at the start of the buffer
 #define STREAM_DEST_OFFSET       0x1000   // 4KB offset for the data destination buffer
-#define DMA_BUFFER_SIZE          (STREAM_DEST_OFFSET + 8192) // Total size for descriptors + 8KB data buffer
+
+// --- Segmented Capture Configuration ---
+// The stream source only looks at NUM_BYTES_REG[23:0] and counts beats in a 24-bit
+// transfer_counter, so a single packet is limited to just under 16MB. Packets are kept
+// page-aligned so slots can be handed to O_DIRECT writers without bounce buffers.
+#define STREAM_BEAT_BYTES            4
+#define CAPTURE_MAX_PACKET_BYTES     (((1UL << 24) - 1) & ~0xFFFUL)
+#define CAPTURE_DEFAULT_PACKET_BYTES (4UL * 1024 * 1024)  // 4MB per stream packet / ring slot
+#define CAPTURE_MAX_RING_SLOTS       256                  // Upper bound on slots in the ring
+#define CAPTURE_RING_OFFSET          0x100000             // 1MB offset for the capture ring
+#define CAPTURE_RING_BYTES           (64UL * 1024 * 1024) // 64MB ring of packet-sized slots
+#define CAPTURE_STREAM_CHANNELS      2                    // TDEST channels used to ping-pong packets
+#define CAPTURE_TIMEBASE_HZ          1000000ULL           // RISC-V `time` CSR rate (device tree timebase-frequency)
+#define CAPTURE_SLOT_CHECKSUM        1                    // CRC32C every slot as it completes (see crc32c.h)
+
+// The application maps DMA_BUFFER_SIZE at startup; the larger CAPTURE_BUFFER_SIZE is only mapped
+// when a capture runs, so the single-packet tests still work on a udmabuf too small for the ring.
+#define DMA_BUFFER_SIZE          (STREAM_DEST_OFFSET + 8192)                // Descriptors + 8KB data buffer
+#define CAPTURE_BUFFER_SIZE      (CAPTURE_RING_OFFSET + CAPTURE_RING_BYTES) // Descriptors, test buffer and capture ring
 
 #endif // APP_CONFIG_H
 
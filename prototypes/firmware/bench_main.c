@@ -0,0 +1,122 @@
+// =================================================================================================
+// File: bench_main.c
+// Description: Command-line entry point for the software benchmarks (no FPGA hardware required).
+// =================================================================================================
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench_suite.h"
+
+static void print_usage(const char* prog) {
+    printf("Usage: %s <benchmark> [args]\n", prog);
+    printf("  recorder <path> [size_mb]   Compare recorder backends writing to <path>\n");
+    printf("  sigmf <base> [size_mb]      Stream a SigMF recording to <base>.sigmf-{data,meta}\n");
+    printf("  net <udp|tcp> <host> <port> [size_mb]\n");
+    printf("                              Send slots to a running net_receiver\n");
+    printf("  psd [size_mb]               Welch PSD throughput for each FFT size and path\n");
+    printf("  fir [size_mb]               Polyphase FIR decimator throughput per hart\n");
+    printf("  ddc [size_mb]               DDC bank: shared input pass vs one pass per band\n");
+    printf("  unpack [msamples]           Packed ADC unpack/convert kernels per implementation\n");
+    printf("  stats [size_mb]             Per-slot min/max/mean/RMS/clipping statistics\n");
+    printf("  occupancy [size_mb]         PSD frames summarized into occupancy records\n");
+    printf("  goertzel [size_mb]          Goertzel bank vs FFT crossover\n");
+    printf("  channelizer [size_mb]       Polyphase channelizer, channels x samples/s\n");
+    printf("  correlator [size_mb]        Overlap-save preamble correlator and detections\n");
+    printf("  cfar [frames]               CA-/OS-CFAR time per PSD frame and detections\n");
+    printf("  compress [size_mb]          Lossless slot compression ratio and MB/s per core\n");
+    printf("  bfp [size_mb]               Block floating point ratio, SQNR and rate\n");
+    printf("  trigger [size_mb]           Triggered capture snippets, discarded data and latency\n");
+    printf("  timemodel [slots]           Slot timestamp fit accuracy and per-call cost\n");
+    printf("  capfile <path> [size_mb]    Indexed capture file write, seek and verify\n");
+    printf("  lod <path> [size_mb]        Min/max/RMS pyramid build rate, size and zoom queries\n");
+    printf("  replay <path> [size_mb]     Max input rate per pipeline stage replaying a capture\n");
+    printf("  crc [size_mb]               Slot CRC32C per implementation and line-rate overhead\n");
+    printf("  dmaapi [transfers] [hw]     DMA library submit/reap cost per batch size (hw: on the controller)\n");
+    printf("  dmaasync [tasks] [hw]       Coroutine event loop: awaited transfers, sleepers and a capture\n");
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    if (strcmp(argv[1], "recorder") == 0 && argc >= 3) {
+        uint64_t size_mb = argc >= 4 ? strtoull(argv[3], NULL, 0) : 256;
+        run_recorder_benchmark(argv[2], size_mb * 1024 * 1024);
+    } else if (strcmp(argv[1], "sigmf") == 0 && argc >= 3) {
+        uint64_t size_mb = argc >= 4 ? strtoull(argv[3], NULL, 0) : 256;
+        run_sigmf_benchmark(argv[2], size_mb * 1024 * 1024);
+    } else if (strcmp(argv[1], "net") == 0 && argc >= 5) {
+        uint64_t size_mb = argc >= 6 ? strtoull(argv[5], NULL, 0) : 256;
+        run_net_sink_benchmark(strcmp(argv[2], "tcp") == 0, argv[3], (uint16_t)atoi(argv[4]), size_mb * 1024 * 1024);
+    } else if (strcmp(argv[1], "psd") == 0) {
+        uint64_t size_mb = argc >= 3 ? strtoull(argv[2], NULL, 0) : 256;
+        run_psd_benchmark(size_mb * 1024 * 1024);
+    } else if (strcmp(argv[1], "fir") == 0) {
+        uint64_t size_mb = argc >= 3 ? strtoull(argv[2], NULL, 0) : 256;
+        run_fir_decimator_benchmark(size_mb * 1024 * 1024);
+    } else if (strcmp(argv[1], "ddc") == 0) {
+        uint64_t size_mb = argc >= 3 ? strtoull(argv[2], NULL, 0) : 256;
+        run_ddc_benchmark(size_mb * 1024 * 1024);
+    } else if (strcmp(argv[1], "unpack") == 0) {
+        uint64_t msamples = argc >= 3 ? strtoull(argv[2], NULL, 0) : 256;
+        run_sample_unpack_benchmark(msamples * 1000000);
+    } else if (strcmp(argv[1], "stats") == 0) {
+        uint64_t size_mb = argc >= 3 ? strtoull(argv[2], NULL, 0) : 256;
+        run_sample_stats_benchmark(size_mb * 1024 * 1024);
+    } else if (strcmp(argv[1], "occupancy") == 0) {
+        uint64_t size_mb = argc >= 3 ? strtoull(argv[2], NULL, 0) : 256;
+        run_occupancy_benchmark(size_mb * 1024 * 1024);
+    } else if (strcmp(argv[1], "goertzel") == 0) {
+        uint64_t size_mb = argc >= 3 ? strtoull(argv[2], NULL, 0) : 64;
+        run_goertzel_benchmark(size_mb * 1024 * 1024);
+    } else if (strcmp(argv[1], "channelizer") == 0) {
+        uint64_t size_mb = argc >= 3 ? strtoull(argv[2], NULL, 0) : 256;
+        run_channelizer_benchmark(size_mb * 1024 * 1024);
+    } else if (strcmp(argv[1], "correlator") == 0) {
+        uint64_t size_mb = argc >= 3 ? strtoull(argv[2], NULL, 0) : 256;
+        run_correlator_benchmark(size_mb * 1024 * 1024);
+    } else if (strcmp(argv[1], "cfar") == 0) {
+        unsigned frames = argc >= 3 ? (unsigned)strtoul(argv[2], NULL, 0) : 2000;
+        run_cfar_benchmark(frames);
+    } else if (strcmp(argv[1], "compress") == 0) {
+        uint64_t size_mb = argc >= 3 ? strtoull(argv[2], NULL, 0) : 256;
+        run_compress_benchmark(size_mb * 1024 * 1024);
+    } else if (strcmp(argv[1], "bfp") == 0) {
+        uint64_t size_mb = argc >= 3 ? strtoull(argv[2], NULL, 0) : 256;
+        run_bfp_benchmark(size_mb * 1024 * 1024);
+    } else if (strcmp(argv[1], "trigger") == 0) {
+        uint64_t size_mb = argc >= 3 ? strtoull(argv[2], NULL, 0) : 256;
+        run_trigger_benchmark(size_mb * 1024 * 1024);
+    } else if (strcmp(argv[1], "timemodel") == 0) {
+        unsigned slots = argc >= 3 ? (unsigned)strtoul(argv[2], NULL, 0) : 10000;
+        run_time_model_benchmark(slots);
+    } else if (strcmp(argv[1], "capfile") == 0 && argc >= 3) {
+        uint64_t size_mb = argc >= 4 ? strtoull(argv[3], NULL, 0) : 256;
+        run_capture_file_benchmark(argv[2], size_mb * 1024 * 1024);
+    } else if (strcmp(argv[1], "lod") == 0 && argc >= 3) {
+        uint64_t size_mb = argc >= 4 ? strtoull(argv[3], NULL, 0) : 256;
+        run_lod_benchmark(argv[2], size_mb * 1024 * 1024);
+    } else if (strcmp(argv[1], "replay") == 0 && argc >= 3) {
+        uint64_t size_mb = argc >= 4 ? strtoull(argv[3], NULL, 0) : 256;
+        run_replay_benchmark(argv[2], size_mb * 1024 * 1024);
+    } else if (strcmp(argv[1], "crc") == 0) {
+        uint64_t size_mb = argc >= 3 ? strtoull(argv[2], NULL, 0) : 256;
+        run_crc_benchmark(size_mb * 1024 * 1024);
+    } else if (strcmp(argv[1], "dmaapi") == 0) {
+        unsigned transfers = argc >= 3 ? (unsigned)strtoul(argv[2], NULL, 0) : 100000;
+        int hardware = argc >= 4 && strcmp(argv[3], "hw") == 0;
+        run_dma_api_benchmark(transfers, hardware);
+    } else if (strcmp(argv[1], "dmaasync") == 0) {
+        unsigned tasks = argc >= 3 ? (unsigned)strtoul(argv[2], NULL, 0) : 10000;
+        int hardware = argc >= 4 && strcmp(argv[3], "hw") == 0;
+        run_dma_async_benchmark(tasks, hardware);
+    } else {
+        print_usage(argv[0]);
+        return 1;
+    }
+    return 0;
+}
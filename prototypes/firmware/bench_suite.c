@@ -0,0 +1,1918 @@
+// =================================================================================================
+// File: bench_suite.c
+// Description: Implementation of the software benchmarks.
+// =================================================================================================
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include "bench_suite.h"
+#include "app_config.h"
+#include "hw_platform.h"
+#include "radiohound_dma_api.h"
+#include "recorder.h"
+#include "sigmf_writer.h"
+#include "net_sink.h"
+#include "psd.h"
+#include "fir_decimator.h"
+#include "ddc.h"
+#include "sample_unpack.h"
+#include "sample_stats.h"
+#include "occupancy.h"
+#include "goertzel.h"
+#include "channelizer.h"
+#include "correlator.h"
+#include "cfar.h"
+#include "compress.h"
+#include "bfp.h"
+#include "trigger.h"
+#include "time_model.h"
+#include "capture_file.h"
+#include "lod_pyramid.h"
+#include "replay.h"
+#include "crc32c.h"
+
+// --- Internal Helpers ---
+
+#define BENCH_RING_SLOTS 8
+
+// Allocates a page-aligned stand-in for the udmabuf slot ring, filled like the stream source would.
+static uint8_t* alloc_slot_ring(size_t slot_bytes, size_t slots) {
+    size_t len = slot_bytes * slots;
+    uint8_t* ring = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0);
+    if (ring == MAP_FAILED) {
+        perror("Failed to allocate benchmark slot ring");
+        return NULL;
+    }
+    for (size_t s = 0; s < slots; ++s) {
+        uint32_t* words = (uint32_t*)(ring + s * slot_bytes);
+        for (size_t i = 0; i < slot_bytes / 4; ++i) words[i] = (uint32_t)i;
+    }
+    return ring;
+}
+
+// Fills a slot ring with complex int16 samples: a tone at `tone_fraction` of the sample rate on top
+// of low-level noise, so spectral benchmarks have something recognizable to find.
+static void fill_tone_ring(uint8_t* ring, size_t bytes, double tone_fraction) {
+    int16_t* iq = (int16_t*)ring;
+    uint32_t lcg = 12345;
+    for (size_t i = 0; i < bytes / 4; ++i) {
+        double phase = 2.0 * M_PI * tone_fraction * (double)i;
+        lcg = lcg * 1664525U + 1013904223U;
+        int noise_i = (int)((lcg >> 16) & 0xFF) - 128;
+        lcg = lcg * 1664525U + 1013904223U;
+        int noise_q = (int)((lcg >> 16) & 0xFF) - 128;
+        iq[2 * i] = (int16_t)(8000.0 * cos(phase) + noise_i);
+        iq[2 * i + 1] = (int16_t)(8000.0 * sin(phase) + noise_q);
+    }
+}
+
+static double elapsed_since(const struct timespec* start) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+
+// --- Benchmarks ---
+
+void run_recorder_benchmark(const char* path, uint64_t total_bytes) {
+    printf("\n--- Running Recorder Benchmark ---\n");
+
+    const size_t slot_bytes = CAPTURE_DEFAULT_PACKET_BYTES;
+    uint8_t* ring = alloc_slot_ring(slot_bytes, BENCH_RING_SLOTS);
+    if (!ring) return;
+
+    const RecorderBackend backends[] = { RECORDER_BACKEND_IO_URING, RECORDER_BACKEND_DIRECT, RECORDER_BACKEND_PWRITE };
+    printf("  Writing %llu MB to %s in %zu KB slots.\n",
+           (unsigned long long)(total_bytes / (1024 * 1024)), path, slot_bytes / 1024);
+
+    for (size_t b = 0; b < sizeof(backends) / sizeof(backends[0]); ++b) {
+        RecorderConfig config;
+        Recorder rec;
+        RecorderStats stats;
+
+        recorder_config_default(&config, backends[b]);
+        config.preallocate_bytes = total_bytes;
+        if (recorder_open(&rec, path, &config) != 0) continue;
+        recorder_register_region(&rec, ring, slot_bytes * BENCH_RING_SLOTS);
+
+        uint64_t written = 0;
+        size_t slot = 0;
+        while (written < total_bytes) {
+            size_t len = (total_bytes - written) < slot_bytes ? (size_t)(total_bytes - written) : slot_bytes;
+            if (recorder_write(&rec, ring + slot * slot_bytes, len) != 0) break;
+            written += len;
+            slot = (slot + 1) % BENCH_RING_SLOTS;
+        }
+
+        int rc = recorder_close(&rec, &stats);
+        printf("  %-20s qd=%-2u %8.2f MB/s (%llu writes, %.3f s)%s\n",
+               recorder_backend_name(rec.config.backend), rec.config.queue_depth, stats.bandwidth_mbps,
+               (unsigned long long)stats.writes, stats.elapsed_seconds, rc == 0 ? "" : "  [ERRORS]");
+    }
+
+    unlink(path);
+    munmap(ring, slot_bytes * BENCH_RING_SLOTS);
+}
+
+void run_sigmf_benchmark(const char* base_path, uint64_t total_bytes) {
+    printf("\n--- Running SigMF Writer Benchmark ---\n");
+
+    const size_t slot_bytes = CAPTURE_DEFAULT_PACKET_BYTES;
+    uint8_t* ring = alloc_slot_ring(slot_bytes, BENCH_RING_SLOTS);
+    if (!ring) return;
+
+    SigmfConfig config;
+    SigmfWriter writer;
+    RecorderStats stats;
+    sigmf_config_default(&config, 50e6, 2.4e9);
+    config.description = "bench_app SigMF throughput run";
+    if (sigmf_writer_open(&writer, base_path, &config) != 0) {
+        munmap(ring, slot_bytes * BENCH_RING_SLOTS);
+        return;
+    }
+    recorder_register_region(&writer.data, ring, slot_bytes * BENCH_RING_SLOTS);
+
+    CaptureSlot slot;
+    memset(&slot, 0, sizeof(slot));
+    uint64_t written = 0;
+    while (written < total_bytes) {
+        slot.data = ring + (slot.sequence % BENCH_RING_SLOTS) * slot_bytes;
+        slot.length = (total_bytes - written) < slot_bytes ? (size_t)(total_bytes - written) : slot_bytes;
+        slot.stream_offset = written;
+        if (sigmf_writer_write_slot(&writer, &slot) != 0) break;
+        written += slot.length;
+        slot.sequence++;
+    }
+
+    uint64_t samples = writer.samples_written;
+    uint64_t annotations = writer.annotations;
+    int rc = sigmf_writer_close(&writer, &stats);
+
+    char path[SIGMF_PATH_LEN + 16];
+    snprintf(path, sizeof(path), "%s.sigmf-meta", base_path);
+    FILE* fp = fopen(path, "r");
+    long meta_bytes = 0;
+    if (fp) {
+        fseek(fp, 0, SEEK_END);
+        meta_bytes = ftell(fp);
+        fclose(fp);
+    }
+    unlink(path);
+    snprintf(path, sizeof(path), "%s.sigmf-data", base_path);
+    unlink(path);
+
+    printf("  %llu samples, %llu annotations, %ld byte metadata file\n",
+           (unsigned long long)samples, (unsigned long long)annotations, meta_bytes);
+    printf("  %.2f MB/s = %.2f Msamples/s sustained over %.3f s%s\n", stats.bandwidth_mbps,
+           (double)samples / stats.elapsed_seconds / 1e6, stats.elapsed_seconds, rc == 0 ? "" : "  [ERRORS]");
+
+    munmap(ring, slot_bytes * BENCH_RING_SLOTS);
+}
+
+void run_net_sink_benchmark(int tcp, const char* host, uint16_t port, uint64_t total_bytes) {
+    printf("\n--- Running Network Sink Benchmark ---\n");
+
+    const size_t slot_bytes = CAPTURE_DEFAULT_PACKET_BYTES;
+    uint8_t* ring = alloc_slot_ring(slot_bytes, BENCH_RING_SLOTS);
+    if (!ring) return;
+
+    printf("  Sending %llu MB over %s to %s:%u (start net_receiver first).\n",
+           (unsigned long long)(total_bytes / (1024 * 1024)), tcp ? "TCP" : "UDP", host, port);
+
+    // Slots carry a completion CRC like the capture session's, so the sink verifies them and the
+    // receiver checks them end to end.
+    uint32_t ring_crc[BENCH_RING_SLOTS];
+    for (unsigned i = 0; i < BENCH_RING_SLOTS; ++i) ring_crc[i] = crc32c(ring + i * slot_bytes, slot_bytes);
+
+    // UDP runs once per mode; TCP carries a single connection, so it is measured once.
+    for (int zerocopy = 1; zerocopy >= (tcp ? 1 : 0); --zerocopy) {
+        NetSinkConfig config;
+        NetSink sink;
+        NetSinkStats stats;
+
+        net_sink_config_default(&config, tcp ? NET_TRANSPORT_TCP : NET_TRANSPORT_UDP, host, port);
+        config.zerocopy = zerocopy;
+        if (net_sink_open(&sink, &config) != 0) break;
+
+        CaptureSlot slot;
+        memset(&slot, 0, sizeof(slot));
+        uint64_t sent = 0;
+        while (sent < total_bytes) {
+            // Never reuse a slot the kernel may still be reading from.
+            while (sink.slots_sent - net_sink_retired(&sink) >= BENCH_RING_SLOTS) { }
+            slot.data = ring + (slot.sequence % BENCH_RING_SLOTS) * slot_bytes;
+            slot.length = (total_bytes - sent) < slot_bytes ? (size_t)(total_bytes - sent) : slot_bytes;
+            slot.stream_offset = sent;
+            slot.crc32c = slot.length == slot_bytes ? ring_crc[slot.sequence % BENCH_RING_SLOTS]
+                                                    : crc32c(slot.data, slot.length);
+            slot.flags = CAPTURE_SLOT_CRC;
+            if (net_sink_send_slot(&sink, &slot) != 0) break;
+            sent += slot.length;
+            slot.sequence++;
+        }
+
+        int rc = net_sink_close(&sink, &stats);
+        printf("  %-9s %8.2f MB/s, %llu chunks in %llu sendmmsg calls, %llu zero-copy sends copied, "
+               "%llu CRC mismatches%s\n",
+               sink.zerocopy ? "zerocopy" : "copy", stats.bandwidth_mbps,
+               (unsigned long long)stats.chunks_sent, (unsigned long long)stats.send_calls,
+               (unsigned long long)stats.zerocopy_copied, (unsigned long long)stats.crc_errors,
+               rc == 0 ? "" : "  [ERRORS]");
+        usleep(200000); // Let the receiver drain before the next run
+    }
+
+    munmap(ring, slot_bytes * BENCH_RING_SLOTS);
+}
+
+// Keeps what the PSD benchmark needs from the last frame: where the tone landed and the floor.
+typedef struct {
+    uint64_t frames;
+    unsigned peak_bin;
+    double   peak_db;
+    double   floor_db;
+} PsdBenchResult;
+
+static void psd_bench_frame(const PsdFrame* frame, void* user) {
+    PsdBenchResult* result = user;
+    unsigned peak = 0;
+    for (unsigned k = 1; k < frame->fft_size; ++k) {
+        if (frame->bins[k] > frame->bins[peak]) peak = k;
+    }
+    double floor_sum = 0.0;
+    unsigned floor_bins = 0;
+    for (unsigned k = 0; k < frame->fft_size; ++k) {
+        if (k + 16 < peak || k > peak + 16) {
+            floor_sum += frame->bins[k];
+            floor_bins++;
+        }
+    }
+    result->frames++;
+    result->peak_bin = peak;
+    result->peak_db = 10.0 * log10(frame->bins[peak]);
+    result->floor_db = floor_bins ? 10.0 * log10(floor_sum / floor_bins) : 0.0;
+}
+
+void run_psd_benchmark(uint64_t total_bytes) {
+    printf("\n--- Running Welch PSD Benchmark ---\n");
+
+    const size_t slot_bytes = CAPTURE_DEFAULT_PACKET_BYTES;
+    const double sample_rate = 50e6;
+    const double tone_fraction = 0.1;
+    uint8_t* ring = alloc_slot_ring(slot_bytes, BENCH_RING_SLOTS);
+    if (!ring) return;
+    fill_tone_ring(ring, slot_bytes * BENCH_RING_SLOTS, tone_fraction);
+
+    const unsigned sizes[] = { 256, 1024, 4096, 16384 };
+    const PsdPath paths[] = { PSD_PATH_FLOAT, PSD_PATH_FIXED };
+    printf("  %llu MB of complex int16 samples per run, Hann window, 50%% overlap, 64 averages.\n",
+           (unsigned long long)(total_bytes / (1024 * 1024)));
+    printf("  %-6s %-12s %10s %10s %8s %10s %9s %9s\n",
+           "fft", "path", "Msamples/s", "MB/s in", "frames", "reduction", "tone dB", "floor dB");
+
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s) {
+        for (size_t p = 0; p < sizeof(paths) / sizeof(paths[0]); ++p) {
+            PsdConfig config;
+            PsdEngine engine;
+            PsdBenchResult result;
+            memset(&result, 0, sizeof(result));
+
+            psd_config_default(&config, sample_rate);
+            config.fft_size = sizes[s];
+            config.overlap = sizes[s] / 2;
+            config.path = paths[p];
+            if (psd_engine_init(&engine, &config, psd_bench_frame, &result) != 0) continue;
+
+            struct timespec start;
+            clock_gettime(CLOCK_MONOTONIC, &start);
+            CaptureSlot slot;
+            memset(&slot, 0, sizeof(slot));
+            uint64_t consumed = 0;
+            while (consumed < total_bytes) {
+                slot.data = ring + (slot.sequence % BENCH_RING_SLOTS) * slot_bytes;
+                slot.length = (total_bytes - consumed) < slot_bytes ? (size_t)(total_bytes - consumed) : slot_bytes;
+                psd_engine_push_slot(&engine, &slot);
+                consumed += slot.length;
+                slot.sequence++;
+            }
+            double elapsed = elapsed_since(&start);
+
+            // The tone should land in the bin nearest tone_fraction above DC (bin fft/2 after the shift).
+            unsigned expected_bin = sizes[s] / 2 + (unsigned)lround(tone_fraction * sizes[s]);
+            double output_bytes = (double)result.frames * sizes[s] * sizeof(float);
+            printf("  %-6u %-12s %10.2f %10.2f %8llu %9.0fx %9.1f %9.1f%s\n",
+                   sizes[s], psd_path_name(paths[p]), (double)consumed / PSD_BYTES_PER_SAMPLE / elapsed / 1e6,
+                   (double)consumed / elapsed / (1024.0 * 1024.0), (unsigned long long)result.frames,
+                   output_bytes > 0 ? (double)consumed / output_bytes : 0.0, result.peak_db, result.floor_db,
+                   result.frames && result.peak_bin != expected_bin ? "  [TONE MISPLACED]" : "");
+            psd_engine_free(&engine);
+        }
+    }
+
+    munmap(ring, slot_bytes * BENCH_RING_SLOTS);
+}
+
+void run_fir_decimator_benchmark(uint64_t total_bytes) {
+    printf("\n--- Running FIR Decimator Benchmark ---\n");
+
+    const size_t slot_bytes = CAPTURE_DEFAULT_PACKET_BYTES;
+    uint8_t* ring = alloc_slot_ring(slot_bytes, BENCH_RING_SLOTS);
+    if (!ring) return;
+    fill_tone_ring(ring, slot_bytes * BENCH_RING_SLOTS, 0.01);
+
+    const unsigned decimations[] = { 2, 4, 16, 64 };
+    const FirPath paths[] = { FIR_PATH_FLOAT, FIR_PATH_FIXED };
+    printf("  %llu MB of complex int16 samples per run, decimated in place, single thread (one hart).\n",
+           (unsigned long long)(total_bytes / (1024 * 1024)));
+    printf("  %-5s %-5s %-6s %14s %14s %10s\n", "decim", "taps", "path", "Msamples/s in", "Msamples/s out", "GMAC/s");
+
+    for (size_t d = 0; d < sizeof(decimations) / sizeof(decimations[0]); ++d) {
+        for (size_t p = 0; p < sizeof(paths) / sizeof(paths[0]); ++p) {
+            FirDecimatorConfig config;
+            FirDecimator fir;
+            fir_decimator_config_default(&config, decimations[d]);
+            config.path = paths[p];
+            if (fir_decimator_init(&fir, &config) != 0) continue;
+
+            struct timespec start;
+            clock_gettime(CLOCK_MONOTONIC, &start);
+            CaptureSlot slot;
+            memset(&slot, 0, sizeof(slot));
+            uint64_t consumed = 0;
+            while (consumed < total_bytes) {
+                slot.data = ring + (slot.sequence % BENCH_RING_SLOTS) * slot_bytes;
+                slot.length = (total_bytes - consumed) < slot_bytes ? (size_t)(total_bytes - consumed) : slot_bytes;
+                consumed += slot.length;
+                fir_decimator_process_slot(&fir, &slot);
+                slot.sequence++;
+            }
+            double elapsed = elapsed_since(&start);
+
+            // Each output costs num_taps complex-by-real MACs (two real MACs).
+            printf("  %-5u %-5u %-6s %14.2f %14.2f %10.3f\n", decimations[d], config.num_taps,
+                   paths[p] == FIR_PATH_FIXED ? "fixed" : "float",
+                   (double)fir.samples_in / elapsed / 1e6, (double)fir.samples_out / elapsed / 1e6,
+                   2.0 * (double)fir.samples_out * config.num_taps / elapsed / 1e9);
+            fir_decimator_free(&fir);
+        }
+    }
+
+    munmap(ring, slot_bytes * BENCH_RING_SLOTS);
+}
+
+// Feeds `total_bytes` of the ring through a DDC bank and returns the elapsed time.
+static double run_ddc_bank(DdcBank* bank, uint8_t* ring, size_t slot_bytes, uint64_t total_bytes) {
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    CaptureSlot slot;
+    memset(&slot, 0, sizeof(slot));
+    uint64_t consumed = 0;
+    while (consumed < total_bytes) {
+        slot.data = ring + (slot.sequence % BENCH_RING_SLOTS) * slot_bytes;
+        slot.length = (total_bytes - consumed) < slot_bytes ? (size_t)(total_bytes - consumed) : slot_bytes;
+        ddc_bank_process_slot(bank, &slot);
+        consumed += slot.length;
+        slot.sequence++;
+    }
+    return elapsed_since(&start);
+}
+
+void run_ddc_benchmark(uint64_t total_bytes) {
+    printf("\n--- Running DDC Bank Benchmark ---\n");
+
+    const size_t slot_bytes = CAPTURE_DEFAULT_PACKET_BYTES;
+    const double sample_rate = 100e6;
+    uint8_t* ring = alloc_slot_ring(slot_bytes, BENCH_RING_SLOTS);
+    if (!ring) return;
+    fill_tone_ring(ring, slot_bytes * BENCH_RING_SLOTS, 0.05);
+
+    const unsigned band_counts[] = { 1, 2, 4, 8 };
+    printf("  %llu MB of real int16 samples, CIC 16 (order 4) + FIR 4 per band, one hart.\n",
+           (unsigned long long)(total_bytes / (1024 * 1024)));
+    // On a host the input stays cached either way; the gain shows on the board, where the
+    // udmabuf mapping is non-cached and every extra pass is another full read from DRAM.
+    printf("  %-5s %22s %22s %8s\n", "bands", "shared pass Msamples/s", "pass/band Msamples/s", "speedup");
+
+    for (size_t c = 0; c < sizeof(band_counts) / sizeof(band_counts[0]); ++c) {
+        const unsigned bands = band_counts[c];
+        DdcConfig config;
+
+        // One bank, every band sharing each sweep over the input.
+        DdcBank shared;
+        if (ddc_bank_init(&shared, sample_rate, NULL, NULL) != 0) break;
+        for (unsigned b = 0; b < bands; ++b) {
+            ddc_config_default(&config, sample_rate * (b + 1) / (2.0 * (bands + 1)), 16, 4);
+            ddc_bank_add(&shared, &config);
+        }
+        double shared_time = run_ddc_bank(&shared, ring, slot_bytes, total_bytes);
+        ddc_bank_free(&shared);
+
+        // The same bands as separate single-band banks, each sweeping the whole input.
+        double separate_time = 0.0;
+        for (unsigned b = 0; b < bands; ++b) {
+            DdcBank single;
+            if (ddc_bank_init(&single, sample_rate, NULL, NULL) != 0) break;
+            ddc_config_default(&config, sample_rate * (b + 1) / (2.0 * (bands + 1)), 16, 4);
+            ddc_bank_add(&single, &config);
+            separate_time += run_ddc_bank(&single, ring, slot_bytes, total_bytes);
+            ddc_bank_free(&single);
+        }
+
+        double samples = (double)total_bytes / DDC_BYTES_PER_SAMPLE;
+        printf("  %-5u %22.2f %22.2f %7.2fx\n", bands, samples / shared_time / 1e6,
+               samples / separate_time / 1e6, separate_time / shared_time);
+    }
+
+    munmap(ring, slot_bytes * BENCH_RING_SLOTS);
+}
+
+void run_sample_unpack_benchmark(uint64_t total_samples) {
+    printf("\n--- Running Sample Unpack Benchmark ---\n");
+
+    // Work in cache-friendly blocks, as a slot consumer would, and repeat to reach total_samples.
+    const size_t block = 64 * 1024;
+    uint8_t* packed = malloc(sample_packed_bytes(16, block));
+    int16_t* reference = malloc(block * sizeof(int16_t));
+    int16_t* samples = malloc(block * sizeof(int16_t));
+    int16_t* i_out = malloc(block / 2 * sizeof(int16_t));
+    int16_t* q_out = malloc(block / 2 * sizeof(int16_t));
+    float* floats = malloc(block * sizeof(float));
+    if (!packed || !reference || !samples || !i_out || !q_out || !floats) {
+        perror("Failed to allocate unpack benchmark buffers");
+        goto cleanup;
+    }
+    uint32_t lcg = 1;
+    for (size_t i = 0; i < sample_packed_bytes(16, block); ++i) {
+        lcg = lcg * 1664525U + 1013904223U;
+        packed[i] = (uint8_t)(lcg >> 24);
+    }
+
+    SampleKernels scalar;
+    sample_kernels_select(&scalar, SAMPLE_IMPL_SCALAR);
+    SampleKernels best;
+    sample_kernels_select(&best, SAMPLE_IMPL_AUTO);
+    printf("  %llu Msamples per kernel in %zu-sample blocks; runtime selection picks %s.\n",
+           (unsigned long long)(total_samples / 1000000), block, sample_impl_name(best.impl));
+    printf("  %-8s %12s %12s %12s %12s\n", "impl", "unpack12", "unpack14", "to_float", "deinterleave");
+
+    const SampleImpl impls[] = { SAMPLE_IMPL_SCALAR, SAMPLE_IMPL_SWAR, SAMPLE_IMPL_AVX2 };
+    const uint64_t rounds = total_samples / block ? total_samples / block : 1;
+    for (size_t n = 0; n < sizeof(impls) / sizeof(impls[0]); ++n) {
+        SampleKernels k;
+        if (sample_kernels_select(&k, impls[n]) != 0) {
+            printf("  %-8s (not supported on this CPU)\n", sample_impl_name(impls[n]));
+            continue;
+        }
+
+        double rate[4];
+        int mismatch = 0;
+        for (int kernel = 0; kernel < 4; ++kernel) {
+            struct timespec start;
+            clock_gettime(CLOCK_MONOTONIC, &start);
+            for (uint64_t r = 0; r < rounds; ++r) {
+                switch (kernel) {
+                    case 0: k.unpack12(packed, samples, block); break;
+                    case 1: k.unpack14(packed, samples, block); break;
+                    case 2: k.to_float((const int16_t*)packed, floats, block); break;
+                    case 3: k.deinterleave((const int16_t*)packed, i_out, q_out, block / 2); break;
+                }
+            }
+            rate[kernel] = (double)rounds * block / elapsed_since(&start) / 1e6;
+
+            // Every implementation must match the scalar reference bit for bit.
+            if (kernel < 2) {
+                if (kernel == 0) scalar.unpack12(packed, reference, block);
+                else scalar.unpack14(packed, reference, block);
+                mismatch |= memcmp(samples, reference, block * sizeof(int16_t)) != 0;
+            } else if (kernel == 3) {
+                scalar.deinterleave((const int16_t*)packed, reference, reference + block / 2, block / 2);
+                mismatch |= memcmp(i_out, reference, block / 2 * sizeof(int16_t)) != 0 ||
+                            memcmp(q_out, reference + block / 2, block / 2 * sizeof(int16_t)) != 0;
+            }
+        }
+        printf("  %-8s %9.1f M/s %9.1f M/s %9.1f M/s %9.1f M/s%s\n", sample_impl_name(impls[n]),
+               rate[0], rate[1], rate[2], rate[3], mismatch ? "  [MISMATCH]" : "");
+    }
+
+cleanup:
+    free(packed);
+    free(reference);
+    free(samples);
+    free(i_out);
+    free(q_out);
+    free(floats);
+}
+
+void run_sample_stats_benchmark(uint64_t total_bytes) {
+    printf("\n--- Running Sample Statistics Benchmark ---\n");
+
+    const size_t slot_bytes = CAPTURE_DEFAULT_PACKET_BYTES;
+    uint8_t* ring = alloc_slot_ring(slot_bytes, BENCH_RING_SLOTS);
+    if (!ring) return;
+    fill_tone_ring(ring, slot_bytes * BENCH_RING_SLOTS, 0.01);
+
+    const SampleImpl impls[] = { SAMPLE_IMPL_SCALAR, SAMPLE_IMPL_AVX2 };
+    SampleStatsRecord reference;
+    memset(&reference, 0, sizeof(reference));
+    printf("  %llu MB of I/Q slots, one %zu-byte record per %zu KB slot.\n",
+           (unsigned long long)(total_bytes / (1024 * 1024)), sizeof(SampleStatsRecord), slot_bytes / 1024);
+
+    for (size_t n = 0; n < sizeof(impls) / sizeof(impls[0]); ++n) {
+        SampleStatsConfig config;
+        SampleStats stats;
+        sample_stats_config_default(&config);
+        config.impl = impls[n];
+        if (sample_stats_init(&stats, &config) != 0) continue;
+
+        SampleStatsRecord record;
+        CaptureSlot slot;
+        memset(&slot, 0, sizeof(slot));
+        struct timespec start;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        uint64_t consumed = 0;
+        while (consumed < total_bytes) {
+            slot.data = ring + (slot.sequence % BENCH_RING_SLOTS) * slot_bytes;
+            slot.length = (total_bytes - consumed) < slot_bytes ? (size_t)(total_bytes - consumed) : slot_bytes;
+            slot.stream_offset = consumed;
+            sample_stats_compute_slot(&stats, &slot, &record);
+            consumed += slot.length;
+            slot.sequence++;
+        }
+        double elapsed = elapsed_since(&start);
+
+        // Every kernel must produce the same record for the same slot.
+        int mismatch = 0;
+        if (n == 0) {
+            reference = record;
+        } else {
+            mismatch = memcmp(&record, &reference, sizeof(record)) != 0;
+        }
+        printf("  %-7s %9.2f MB/s %9.2f Msamples/s%s\n", sample_impl_name(stats.config.impl),
+               (double)consumed / elapsed / (1024.0 * 1024.0), (double)consumed / 4 / elapsed / 1e6,
+               mismatch ? "  [MISMATCH]" : "");
+    }
+    sample_stats_print(&reference, 2);
+
+    munmap(ring, slot_bytes * BENCH_RING_SLOTS);
+}
+
+typedef struct {
+    OccupancyTracker tracker;
+    uint64_t         record_bytes;
+    uint8_t          last[1024];
+} OccupancyBench;
+
+static void occupancy_bench_frame(const PsdFrame* frame, void* user) {
+    OccupancyBench* bench = user;
+    occupancy_add_frame(&bench->tracker, frame);
+}
+
+static void occupancy_bench_record(const OccupancyRecord* record, size_t bytes, void* user) {
+    OccupancyBench* bench = user;
+    bench->record_bytes += bytes;
+    memcpy(bench->last, record, bytes < sizeof(bench->last) ? bytes : sizeof(bench->last));
+}
+
+void run_occupancy_benchmark(uint64_t total_bytes) {
+    printf("\n--- Running Spectrum Occupancy Benchmark ---\n");
+
+    const size_t slot_bytes = CAPTURE_DEFAULT_PACKET_BYTES;
+    const double sample_rate = 50e6;
+    uint8_t* ring = alloc_slot_ring(slot_bytes, BENCH_RING_SLOTS);
+    if (!ring) return;
+    fill_tone_ring(ring, slot_bytes * BENCH_RING_SLOTS, 0.1);
+
+    static OccupancyBench bench;
+    memset(&bench, 0, sizeof(bench));
+    OccupancyConfig occ_config;
+    occupancy_config_default(&occ_config);
+    occ_config.bucket_seconds = 0.01; // Short buckets so a benchmark-sized capture spans several
+    PsdConfig psd_config;
+    psd_config_default(&psd_config, sample_rate);
+    psd_config.averages = 16;
+    PsdEngine engine;
+    if (occupancy_init(&bench.tracker, &occ_config, occupancy_bench_record, &bench) != 0 ||
+        psd_engine_init(&engine, &psd_config, occupancy_bench_frame, &bench) != 0) {
+        occupancy_free(&bench.tracker);
+        munmap(ring, slot_bytes * BENCH_RING_SLOTS);
+        return;
+    }
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    CaptureSlot slot;
+    memset(&slot, 0, sizeof(slot));
+    uint64_t consumed = 0;
+    while (consumed < total_bytes) {
+        slot.data = ring + (slot.sequence % BENCH_RING_SLOTS) * slot_bytes;
+        slot.length = (total_bytes - consumed) < slot_bytes ? (size_t)(total_bytes - consumed) : slot_bytes;
+        psd_engine_push_slot(&engine, &slot);
+        consumed += slot.length;
+        slot.sequence++;
+    }
+    occupancy_flush(&bench.tracker);
+    double elapsed = elapsed_since(&start);
+
+    const OccupancyRecord* last = (const OccupancyRecord*)bench.last;
+    unsigned busy = 0;
+    for (unsigned c = 0; c < last->channels; ++c) busy += last->occupancy[c] > 128;
+    double capture_seconds = (double)consumed / PSD_BYTES_PER_SAMPLE / sample_rate;
+    printf("  %.3f s of capture at %.0f Msamples/s processed in %.3f s (%.2fx real time)\n",
+           capture_seconds, sample_rate / 1e6, elapsed, capture_seconds / elapsed);
+    printf("  %llu frames -> %llu records, %llu bytes (%.1f MB of raw samples)\n",
+           (unsigned long long)engine.frames, (unsigned long long)bench.tracker.records,
+           (unsigned long long)bench.record_bytes, (double)consumed / (1024.0 * 1024.0));
+    printf("  Last record: floor %.1f dBFS/Hz, %u of %u channels mostly occupied (tone at +0.1 fs)\n",
+           last->noise_floor_cdb / 100.0, busy, last->channels);
+    printf("  At 1 s buckets this configuration logs %.2f MB per day.\n",
+           occupancy_record_bytes(occ_config.channels) * 86400.0 / (1024.0 * 1024.0));
+
+    psd_engine_free(&engine);
+    occupancy_free(&bench.tracker);
+    munmap(ring, slot_bytes * BENCH_RING_SLOTS);
+}
+
+static void goertzel_bench_frame(const GoertzelFrame* frame, void* user) {
+    *(float*)user = frame->power[0];
+}
+
+static void psd_bench_tone(const PsdFrame* frame, void* user) {
+    // Bin of +fs/8 in FFT-shifted order.
+    *(float*)user = frame->bins[frame->fft_size / 2 + frame->fft_size / 8];
+}
+
+void run_goertzel_benchmark(uint64_t total_bytes) {
+    printf("\n--- Running Goertzel vs FFT Benchmark ---\n");
+
+    const size_t slot_bytes = CAPTURE_DEFAULT_PACKET_BYTES;
+    const double sample_rate = 50e6;
+    uint8_t* ring = alloc_slot_ring(slot_bytes, BENCH_RING_SLOTS);
+    if (!ring) return;
+    fill_tone_ring(ring, slot_bytes * BENCH_RING_SLOTS, 0.125); // Bin-centered for every block size
+
+    const unsigned sizes[] = { 256, 1024, 4096 };
+    const unsigned counts[] = { 1, 2, 4, 8, 16, 32, 64, 128 };
+    printf("  %llu MB per run, no overlap, 64 averages; rates in Msamples/s.\n",
+           (unsigned long long)(total_bytes / (1024 * 1024)));
+
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s) {
+        // FFT path: one rectangular-window PSD over the same blocks.
+        PsdConfig psd_config;
+        PsdEngine engine;
+        float psd_tone = 0.0f;
+        psd_config_default(&psd_config, sample_rate);
+        psd_config.fft_size = sizes[s];
+        psd_config.overlap = 0;
+        psd_config.window = PSD_WINDOW_RECTANGULAR;
+        if (psd_engine_init(&engine, &psd_config, psd_bench_tone, &psd_tone) != 0) continue;
+
+        struct timespec start;
+        CaptureSlot slot;
+        memset(&slot, 0, sizeof(slot));
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (uint64_t consumed = 0; consumed < total_bytes; consumed += slot.length, slot.sequence++) {
+            slot.data = ring + (slot.sequence % BENCH_RING_SLOTS) * slot_bytes;
+            slot.length = (total_bytes - consumed) < slot_bytes ? (size_t)(total_bytes - consumed) : slot_bytes;
+            psd_engine_push_slot(&engine, &slot);
+        }
+        double fft_rate = (double)total_bytes / PSD_BYTES_PER_SAMPLE / elapsed_since(&start) / 1e6;
+        psd_engine_free(&engine);
+
+        printf("  block %-5u FFT (%s): %8.2f | Goertzel by frequency count:", sizes[s],
+               psd_path_name(psd_config.path), fft_rate);
+        unsigned crossover = 0;
+        float goertzel_tone = 0.0f;
+        for (size_t c = 0; c < sizeof(counts) / sizeof(counts[0]); ++c) {
+            GoertzelConfig config;
+            GoertzelBank bank;
+            goertzel_config_default(&config, sample_rate);
+            config.block_size = sizes[s];
+            // The tone bin first, then neighbouring bins (wrapped into -fs/2..fs/2).
+            for (unsigned f = 0; f < counts[c]; ++f) {
+                double freq = fmod(sample_rate / 8 + f * sample_rate / sizes[s], sample_rate);
+                goertzel_config_add(&config, freq > sample_rate / 2 ? freq - sample_rate : freq);
+            }
+            if (goertzel_bank_init(&bank, &config, goertzel_bench_frame, &goertzel_tone) != 0) continue;
+
+            memset(&slot, 0, sizeof(slot));
+            clock_gettime(CLOCK_MONOTONIC, &start);
+            for (uint64_t consumed = 0; consumed < total_bytes; consumed += slot.length, slot.sequence++) {
+                slot.data = ring + (slot.sequence % BENCH_RING_SLOTS) * slot_bytes;
+                slot.length = (total_bytes - consumed) < slot_bytes ? (size_t)(total_bytes - consumed) : slot_bytes;
+                goertzel_bank_push_slot(&bank, &slot);
+            }
+            double rate = (double)total_bytes / GOERTZEL_BYTES_PER_SAMPLE / elapsed_since(&start) / 1e6;
+            printf(" %u:%.1f", counts[c], rate);
+            if (!crossover && rate < fft_rate) crossover = counts[c];
+        }
+        printf("\n");
+        if (crossover) {
+            printf("    -> the FFT is faster from %u frequencies on", crossover);
+        } else {
+            printf("    -> Goertzel stays faster up to %u frequencies", counts[sizeof(counts) / sizeof(counts[0]) - 1]);
+        }
+        printf(" (tone power: FFT %.2f dB, Goertzel %.2f dB)\n",
+               10.0 * log10(psd_tone), 10.0 * log10(goertzel_tone));
+    }
+
+    munmap(ring, slot_bytes * BENCH_RING_SLOTS);
+}
+
+static void channelizer_bench_block(const int16_t* iq, unsigned channels, size_t samples, size_t stride, void* user) {
+    (void)iq;
+    (void)stride;
+    *(uint64_t*)user += (uint64_t)channels * samples;
+}
+
+void run_channelizer_benchmark(uint64_t total_bytes) {
+    printf("\n--- Running Polyphase Channelizer Benchmark ---\n");
+
+    const size_t slot_bytes = CAPTURE_DEFAULT_PACKET_BYTES;
+    uint8_t* ring = alloc_slot_ring(slot_bytes, BENCH_RING_SLOTS);
+    if (!ring) return;
+    fill_tone_ring(ring, slot_bytes * BENCH_RING_SLOTS, 0.125);
+
+    const unsigned channel_counts[] = { 16, 64, 256, 1024 };
+    const ChannelizerMode modes[] = { CHANNELIZER_CRITICAL, CHANNELIZER_OVERSAMPLED };
+    printf("  %llu MB per run, %u taps per branch.\n", (unsigned long long)(total_bytes / (1024 * 1024)),
+           CHANNELIZER_TAPS_PER_BRANCH);
+    printf("  %-9s %-12s %14s %24s\n", "Channels", "Mode", "In (MS/s)", "Channels x out (MS/s)");
+
+    for (size_t c = 0; c < sizeof(channel_counts) / sizeof(channel_counts[0]); ++c) {
+        for (size_t m = 0; m < sizeof(modes) / sizeof(modes[0]); ++m) {
+            ChannelizerConfig config;
+            Channelizer ch;
+            uint64_t produced = 0;
+            channelizer_config_default(&config, channel_counts[c], modes[m]);
+            if (channelizer_init(&ch, &config, channelizer_bench_block, &produced) != 0) continue;
+
+            struct timespec start;
+            CaptureSlot slot;
+            memset(&slot, 0, sizeof(slot));
+            clock_gettime(CLOCK_MONOTONIC, &start);
+            for (uint64_t consumed = 0; consumed < total_bytes; consumed += slot.length, slot.sequence++) {
+                slot.data = ring + (slot.sequence % BENCH_RING_SLOTS) * slot_bytes;
+                slot.length = (total_bytes - consumed) < slot_bytes ? (size_t)(total_bytes - consumed) : slot_bytes;
+                channelizer_push_slot(&ch, &slot);
+            }
+            channelizer_flush(&ch);
+            double elapsed = elapsed_since(&start);
+            channelizer_free(&ch);
+
+            printf("  %-9u %-12s %14.2f %24.2f\n", channel_counts[c],
+                   modes[m] == CHANNELIZER_CRITICAL ? "critical" : "2x oversamp",
+                   (double)total_bytes / CHANNELIZER_BYTES_PER_SAMPLE / elapsed / 1e6, (double)produced / elapsed / 1e6);
+        }
+    }
+
+    munmap(ring, slot_bytes * BENCH_RING_SLOTS);
+}
+
+#define CORR_BENCH_TEMPLATES 4
+#define CORR_BENCH_LENGTH    256
+#define CORR_BENCH_SPACING   65536 // Samples between inserted bursts
+#define CORR_BENCH_OFFSET    1000  // Sample index of the first burst
+
+typedef struct {
+    uint64_t ring_samples;
+    uint64_t found;
+    uint64_t misplaced;
+    float    min_score;
+} CorrelatorBenchState;
+
+static void correlator_bench_detection(const CorrelatorDetection* d, void* user) {
+    CorrelatorBenchState* state = user;
+    uint64_t index = d->sample % state->ring_samples;
+    uint64_t burst = (index - CORR_BENCH_OFFSET) / CORR_BENCH_SPACING;
+    if (index < CORR_BENCH_OFFSET || (index - CORR_BENCH_OFFSET) % CORR_BENCH_SPACING != 0 ||
+        burst % CORR_BENCH_TEMPLATES != d->template_id) {
+        state->misplaced++;
+    } else {
+        state->found++;
+    }
+    if (d->score < state->min_score) state->min_score = d->score;
+}
+
+// Pseudo-random QPSK preamble, distinct per seed.
+static void make_bench_template(int16_t* iq, unsigned samples, uint32_t seed) {
+    for (unsigned i = 0; i < samples; ++i) {
+        seed = seed * 1664525U + 1013904223U;
+        iq[2 * i] = (seed & 0x10000) ? 8000 : -8000;
+        iq[2 * i + 1] = (seed & 0x20000) ? 8000 : -8000;
+    }
+}
+
+void run_correlator_benchmark(uint64_t total_bytes) {
+    printf("\n--- Running Overlap-Save Correlator Benchmark ---\n");
+
+    const size_t slot_bytes = CAPTURE_DEFAULT_PACKET_BYTES;
+    const size_t ring_bytes = slot_bytes * BENCH_RING_SLOTS;
+    uint8_t* ring = alloc_slot_ring(slot_bytes, BENCH_RING_SLOTS);
+    if (!ring) return;
+    fill_tone_ring(ring, ring_bytes, 0.125);
+
+    // Add bursts of each template on top of the tone, cycling through the templates.
+    static int16_t templates[CORR_BENCH_TEMPLATES][2 * CORR_BENCH_LENGTH];
+    const uint64_t ring_samples = ring_bytes / CORRELATOR_BYTES_PER_SAMPLE;
+    int16_t* iq = (int16_t*)ring;
+    for (unsigned t = 0; t < CORR_BENCH_TEMPLATES; ++t) make_bench_template(templates[t], CORR_BENCH_LENGTH, 777 + t);
+    for (uint64_t pos = CORR_BENCH_OFFSET, burst = 0; pos + CORR_BENCH_LENGTH <= ring_samples;
+         pos += CORR_BENCH_SPACING, burst++) {
+        const int16_t* t = templates[burst % CORR_BENCH_TEMPLATES];
+        for (unsigned i = 0; i < 2 * CORR_BENCH_LENGTH; ++i) iq[2 * pos + i] += t[i];
+    }
+
+    const uint64_t total_samples = total_bytes / CORRELATOR_BYTES_PER_SAMPLE;
+    const unsigned sizes[] = { 1024, 4096, 16384 };
+    const unsigned counts[] = { 1, CORR_BENCH_TEMPLATES };
+    printf("  %llu MB per run, %u-sample QPSK templates on a full-scale/4 tone, threshold 0.25.\n",
+           (unsigned long long)(total_bytes / (1024 * 1024)), CORR_BENCH_LENGTH);
+    printf("  %-6s %-10s %12s %12s %10s %10s\n", "FFT", "Templates", "Rate (MS/s)", "Detections", "Expected", "Misplaced");
+
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s) {
+        for (size_t c = 0; c < sizeof(counts) / sizeof(counts[0]); ++c) {
+            CorrelatorConfig config;
+            Correlator corr;
+            CorrelatorBenchState state = { .ring_samples = ring_samples, .min_score = 1.0f };
+            correlator_config_default(&config, 50e6);
+            config.fft_size = sizes[s];
+            config.threshold = 0.25;
+            if (correlator_init(&corr, &config, correlator_bench_detection, &state) != 0) continue;
+            for (unsigned t = 0; t < counts[c]; ++t) correlator_add_template(&corr, templates[t], CORR_BENCH_LENGTH);
+
+            struct timespec start;
+            CaptureSlot slot;
+            memset(&slot, 0, sizeof(slot));
+            clock_gettime(CLOCK_MONOTONIC, &start);
+            for (uint64_t consumed = 0; consumed < total_bytes; consumed += slot.length, slot.sequence++) {
+                slot.data = ring + (slot.sequence % BENCH_RING_SLOTS) * slot_bytes;
+                slot.length = (total_bytes - consumed) < slot_bytes ? (size_t)(total_bytes - consumed) : slot_bytes;
+                correlator_push_slot(&corr, &slot);
+            }
+            correlator_flush(&corr);
+            double elapsed = elapsed_since(&start);
+
+            // Bursts of the loaded templates whose lags were searched (all but the final partial block).
+            uint64_t searched = corr.base;
+            uint64_t expected = 0;
+            for (uint64_t pass = 0; pass * ring_samples < searched; ++pass) {
+                uint64_t burst = 0;
+                for (uint64_t pos = CORR_BENCH_OFFSET; pos + CORR_BENCH_LENGTH <= ring_samples;
+                     pos += CORR_BENCH_SPACING, burst++) {
+                    if (pass * ring_samples + pos < searched && burst % CORR_BENCH_TEMPLATES < counts[c]) expected++;
+                }
+            }
+            correlator_free(&corr);
+
+            printf("  %-6u %-10u %12.2f %12llu %10llu %10llu\n", sizes[s], counts[c],
+                   (double)total_samples / elapsed / 1e6, (unsigned long long)state.found,
+                   (unsigned long long)expected, (unsigned long long)state.misplaced);
+        }
+    }
+
+    munmap(ring, ring_bytes);
+}
+
+#define CFAR_BENCH_SIGNALS 9
+
+typedef struct {
+    unsigned found;      // Inserted signals reported in the last frame
+    unsigned count;      // Detections in the last frame
+    size_t   bytes;      // Size of the last report
+    unsigned bins[CFAR_BENCH_SIGNALS];
+} CfarBenchState;
+
+static void cfar_bench_report(const CfarReport* report, size_t bytes, void* user) {
+    CfarBenchState* state = user;
+    state->found = 0;
+    for (unsigned s = 0; s < CFAR_BENCH_SIGNALS; ++s) {
+        for (unsigned k = 0; k < report->count; ++k) {
+            if (report->detections[k].bin == state->bins[s]) {
+                state->found++;
+                break;
+            }
+        }
+    }
+    state->count = report->count;
+    state->bytes = bytes;
+}
+
+void run_cfar_benchmark(unsigned frames) {
+    printf("\n--- Running CFAR Detector Benchmark ---\n");
+
+    const unsigned sizes[] = { 1024, 4096, 16384 };
+    const CfarMethod methods[] = { CFAR_CELL_AVERAGING, CFAR_ORDERED_STATISTIC };
+    const double sample_rate = 50e6;
+    CfarConfig defaults;
+    cfar_config_default(&defaults);
+    printf("  %u frames per run, %u guard / %u training cells, %.0f dB threshold.\n", frames,
+           defaults.guard_cells, defaults.training_cells, defaults.threshold_db);
+    printf("  %u signals at 13-30 dB SNR, two of them 4 bins apart. Budgets are the frame rates of a\n"
+           "  50%%-overlap PSD at %.0f MS/s, unaveraged and with 64 averages.\n", CFAR_BENCH_SIGNALS, sample_rate / 1e6);
+    printf("  %-6s %-8s %10s %10s %10s %8s %8s %14s\n", "FFT", "Method", "us/frame", "Frames/s", "Budget", "(64 avg)",
+           "Found", "Report bytes");
+
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s) {
+        const unsigned n = sizes[s];
+        float* bins = malloc(n * sizeof(*bins));
+        if (!bins) return;
+
+        // Noise floor like an 8-average Welch estimate: mean of 8 exponential draws per bin.
+        uint32_t lcg = 4242;
+        for (unsigned i = 0; i < n; ++i) {
+            double sum = 0.0;
+            for (int a = 0; a < 8; ++a) {
+                lcg = lcg * 1664525U + 1013904223U;
+                sum -= log(((lcg >> 8) + 1.0) / 16777217.0);
+            }
+            bins[i] = (float)(1e-11 * sum / 8);
+        }
+        CfarBenchState state;
+        const double snr_db[CFAR_BENCH_SIGNALS] = { 13, 16, 20, 24, 30, 18, 18, 22, 26 };
+        for (unsigned k = 0; k < CFAR_BENCH_SIGNALS; ++k) {
+            // Bins 5 and 6 are the close pair; each signal spreads to its neighbours at -6 dB.
+            unsigned bin = k == 6 ? state.bins[5] + 4 : (k + 1) * n / (CFAR_BENCH_SIGNALS + 2);
+            state.bins[k] = bin;
+            float peak = (float)(1e-11 * pow(10.0, snr_db[k] / 10.0));
+            bins[bin] += peak;
+            bins[bin - 1] += peak / 4;
+            bins[bin + 1] += peak / 4;
+        }
+        PsdFrame frame = { .sequence = 0, .first_sample = 0, .fft_size = n, .averages = 8,
+                           .sample_rate = sample_rate, .bins = bins };
+        const double budget = sample_rate / (n / 2);
+
+        for (size_t m = 0; m < sizeof(methods) / sizeof(methods[0]); ++m) {
+            CfarConfig config = defaults;
+            CfarDetector detector;
+            config.method = methods[m];
+            if (cfar_init(&detector, &config, cfar_bench_report, &state) != 0) continue;
+
+            struct timespec start;
+            clock_gettime(CLOCK_MONOTONIC, &start);
+            for (unsigned f = 0; f < frames; ++f) {
+                frame.sequence = f;
+                frame.first_sample = (uint64_t)f * n;
+                cfar_process_frame(&detector, &frame);
+            }
+            double elapsed = elapsed_since(&start);
+            cfar_free(&detector);
+
+            printf("  %-6u %-8s %10.2f %10.0f %10.0f %8.0f %5u/%-2u %7zu (%zu)\n", n, cfar_method_name(methods[m]),
+                   elapsed / frames * 1e6, frames / elapsed, budget, budget / 64, state.found, CFAR_BENCH_SIGNALS,
+                   state.bytes, n * sizeof(float));
+        }
+        free(bins);
+    }
+}
+
+// Fills a slot ring like a 12-bit ADC stored MSB-aligned: Gaussian-ish noise of `noise_lsb` plus a
+// tone of `tone_lsb`, both in 12-bit LSBs.
+static void fill_adc12_ring(uint8_t* ring, size_t bytes, double noise_lsb, double tone_lsb) {
+    int16_t* iq = (int16_t*)ring;
+    uint32_t lcg = 2024;
+    for (size_t i = 0; i < bytes / 2; ++i) {
+        int sum = 0;
+        for (int a = 0; a < 4; ++a) {
+            lcg = lcg * 1664525U + 1013904223U;
+            sum += (int)(lcg >> 24) - 128;
+        }
+        double noise = sum * noise_lsb / 147.8; // Sum of 4 uniforms: sigma = 147.8
+        double tone = tone_lsb * ((i & 1) ? sin(0.05 * (double)(i / 2)) : cos(0.05 * (double)(i / 2)));
+        long v = lround(noise + tone);
+        if (v > 2047) v = 2047;
+        if (v < -2048) v = -2048;
+        iq[i] = (int16_t)(v * 16);
+    }
+}
+
+void run_compress_benchmark(uint64_t total_bytes) {
+    printf("\n--- Running Lossless Compression Benchmark ---\n");
+
+    const size_t slot_bytes = CAPTURE_DEFAULT_PACKET_BYTES;
+    const size_t ring_bytes = slot_bytes * BENCH_RING_SLOTS;
+    uint8_t* ring = alloc_slot_ring(slot_bytes, BENCH_RING_SLOTS);
+    if (!ring) return;
+
+    CompressConfig config;
+    compress_config_default(&config);
+    const size_t bound = compress_bound(&config, slot_bytes);
+    uint8_t* packed = malloc(bound);
+    uint8_t* restored = malloc(slot_bytes);
+    if (!packed || !restored) {
+        perror("Failed to allocate compression buffers");
+        free(packed);
+        free(restored);
+        munmap(ring, ring_bytes);
+        return;
+    }
+
+    printf("  %llu MB per source in %zu KB slots, %u-frame blocks; rates are per core.\n",
+           (unsigned long long)(total_bytes / (1024 * 1024)), slot_bytes / 1024, config.block_frames);
+    printf("  %-30s %8s %14s %14s %8s\n", "Source", "Ratio", "Encode (MB/s)", "Decode (MB/s)", "Exact");
+
+    for (int source = 0; source < 4; ++source) {
+        const char* name;
+        switch (source) {
+            case 0:
+                fill_adc12_ring(ring, ring_bytes, 4.0, 0.0);
+                name = "12-bit ADC, noise 4 LSB";
+                break;
+            case 1:
+                fill_adc12_ring(ring, ring_bytes, 30.0, 0.0);
+                name = "12-bit ADC, noise 30 LSB";
+                break;
+            case 2:
+                fill_adc12_ring(ring, ring_bytes, 4.0, 1500.0);
+                name = "12-bit ADC, tone + noise 4 LSB";
+                break;
+            default:
+                fill_tone_ring(ring, ring_bytes, 0.125);
+                name = "16-bit, tone at fs/8";
+                break;
+        }
+
+        uint64_t in_total = 0, out_total = 0;
+        double encode_time = 0.0, decode_time = 0.0;
+        int exact = 1;
+        CaptureSlot slot;
+        memset(&slot, 0, sizeof(slot));
+        for (uint64_t consumed = 0; consumed < total_bytes; consumed += slot.length, slot.sequence++) {
+            slot.data = ring + (slot.sequence % BENCH_RING_SLOTS) * slot_bytes;
+            slot.length = (total_bytes - consumed) < slot_bytes ? (size_t)(total_bytes - consumed) : slot_bytes;
+
+            struct timespec start;
+            clock_gettime(CLOCK_MONOTONIC, &start);
+            size_t out = compress_encode_slot(&config, &slot, packed, bound);
+            encode_time += elapsed_since(&start);
+            if (out == 0) {
+                exact = 0;
+                break;
+            }
+
+            clock_gettime(CLOCK_MONOTONIC, &start);
+            size_t back = compress_decode(packed, out, restored, slot_bytes);
+            decode_time += elapsed_since(&start);
+            if (back != slot.length || memcmp(restored, slot.data, slot.length) != 0) exact = 0;
+
+            in_total += slot.length;
+            out_total += out;
+        }
+
+        printf("  %-30s %8.2f %14.2f %14.2f %8s\n", name, out_total ? (double)in_total / out_total : 0.0,
+               in_total / encode_time / 1e6, in_total / decode_time / 1e6, exact ? "yes" : "NO");
+    }
+
+    free(packed);
+    free(restored);
+    munmap(ring, ring_bytes);
+}
+
+void run_bfp_benchmark(uint64_t total_bytes) {
+    printf("\n--- Running Block Floating Point Benchmark ---\n");
+
+    const size_t slot_bytes = CAPTURE_DEFAULT_PACKET_BYTES;
+    const size_t ring_bytes = slot_bytes * BENCH_RING_SLOTS;
+    uint8_t* ring = alloc_slot_ring(slot_bytes, BENCH_RING_SLOTS);
+    if (!ring) return;
+    uint8_t* packed = malloc(slot_bytes + 4096);
+    int16_t* restored = malloc(slot_bytes);
+    if (!packed || !restored) {
+        perror("Failed to allocate BFP buffers");
+        free(packed);
+        free(restored);
+        munmap(ring, ring_bytes);
+        return;
+    }
+
+    const BfpConfig configs[] = { { 64, 4 }, { 64, 6 }, { 64, 8 }, { 64, 10 }, { 16, 8 }, { 256, 8 } };
+    printf("  %llu MB per source in %zu KB slots; rates are per core, in complex Msamples/s.\n",
+           (unsigned long long)(total_bytes / (1024 * 1024)), slot_bytes / 1024);
+    printf("  %-30s %6s %5s %7s %10s %10s %10s\n", "Source", "Block", "Bits", "Ratio", "SQNR (dB)", "Encode", "Decode");
+
+    for (int source = 0; source < 2; ++source) {
+        const char* name;
+        if (source == 0) {
+            fill_tone_ring(ring, ring_bytes, 0.125);
+            name = "16-bit, tone at fs/8";
+        } else {
+            fill_adc12_ring(ring, ring_bytes, 30.0, 1500.0);
+            name = "12-bit ADC, tone + noise 30 LSB";
+        }
+
+        for (size_t c = 0; c < sizeof(configs) / sizeof(configs[0]); ++c) {
+            double encode_time = 0.0, decode_time = 0.0, sqnr = 0.0;
+            uint64_t in_total = 0, out_total = 0;
+            CaptureSlot slot;
+            memset(&slot, 0, sizeof(slot));
+            for (uint64_t consumed = 0; consumed < total_bytes; consumed += slot.length, slot.sequence++) {
+                slot.data = ring + (slot.sequence % BENCH_RING_SLOTS) * slot_bytes;
+                slot.length = (total_bytes - consumed) < slot_bytes ? (size_t)(total_bytes - consumed) : slot_bytes;
+
+                struct timespec start;
+                clock_gettime(CLOCK_MONOTONIC, &start);
+                size_t out = bfp_encode_slot(&configs[c], &slot, packed, slot_bytes + 4096);
+                encode_time += elapsed_since(&start);
+
+                clock_gettime(CLOCK_MONOTONIC, &start);
+                size_t back = bfp_decode(packed, out, restored, slot_bytes);
+                decode_time += elapsed_since(&start);
+                if (out == 0 || back != slot.length) break;
+
+                // The sources are stationary, so the last slot's SQNR stands for the run.
+                sqnr = bfp_sqnr_db((const int16_t*)slot.data, restored, slot.length / 2);
+                in_total += slot.length;
+                out_total += out;
+            }
+
+            const double samples = in_total / 4.0;
+            printf("  %-30s %6u %5u %7.2f %10.2f %10.1f %10.1f\n", c == 0 ? name : "", configs[c].block_values,
+                   configs[c].mantissa_bits, out_total ? (double)in_total / out_total : 0.0,
+                   sqnr, samples / encode_time / 1e6,
+                   samples / decode_time / 1e6);
+        }
+    }
+
+    free(packed);
+    free(restored);
+    munmap(ring, ring_bytes);
+}
+
+#define TRIG_BENCH_SPACING  1500000 // Samples between inserted bursts
+#define TRIG_BENCH_OFFSET   700000  // Sample index of the first burst
+#define TRIG_BENCH_LENGTH   2000    // Burst length, samples
+#define TRIG_BENCH_PRE      50000   // 1 ms at 50 MS/s
+#define TRIG_BENCH_POST     100000  // 2 ms at 50 MS/s
+
+typedef struct {
+    uint64_t ring_samples;
+    uint64_t snippets;   // Completed snippets
+    uint64_t misplaced;  // Snippets not triggered at an inserted burst
+    uint64_t checksum;   // Every delivered byte is read, like a sink would
+} TriggerBenchState;
+
+static void trigger_bench_chunk(const TriggerChunk* chunk, void* user) {
+    TriggerBenchState* state = user;
+    const uint64_t* words = chunk->data;
+    for (size_t i = 0; i < chunk->bytes / 8; ++i) state->checksum += words[i];
+    if (chunk->first) {
+        uint64_t index = chunk->trigger_sample % state->ring_samples;
+        uint64_t offset = index >= TRIG_BENCH_OFFSET ? (index - TRIG_BENCH_OFFSET) % TRIG_BENCH_SPACING : UINT64_MAX;
+        // Energy windows may start up to a window before the burst.
+        if (offset > 256 && offset < TRIG_BENCH_SPACING - 256) state->misplaced++;
+    }
+    if (chunk->last) state->snippets++;
+}
+
+void run_trigger_benchmark(uint64_t total_bytes) {
+    printf("\n--- Running Triggered Capture Benchmark ---\n");
+
+    const size_t slot_bytes = CAPTURE_DEFAULT_PACKET_BYTES;
+    const size_t ring_bytes = slot_bytes * BENCH_RING_SLOTS;
+    uint8_t* ring = alloc_slot_ring(slot_bytes, BENCH_RING_SLOTS);
+    if (!ring) return;
+
+    // Noise well below the level threshold with short strong tone bursts on top.
+    fill_adc12_ring(ring, ring_bytes, 30.0, 0.0);
+    const uint64_t ring_samples = ring_bytes / TRIGGER_BYTES_PER_SAMPLE;
+    int16_t* iq = (int16_t*)ring;
+    for (uint64_t pos = TRIG_BENCH_OFFSET; pos + TRIG_BENCH_LENGTH <= ring_samples; pos += TRIG_BENCH_SPACING) {
+        for (unsigned i = 0; i < TRIG_BENCH_LENGTH; ++i) {
+            iq[2 * (pos + i)] = (int16_t)lround(24000.0 * cos(0.05 * i));
+            iq[2 * (pos + i) + 1] = (int16_t)lround(24000.0 * sin(0.05 * i));
+        }
+    }
+
+    const uint64_t total_samples = total_bytes / TRIGGER_BYTES_PER_SAMPLE;
+    uint64_t expected = 0;
+    for (uint64_t pass = 0; pass * ring_samples < total_samples; ++pass) {
+        for (uint64_t pos = TRIG_BENCH_OFFSET; pos + TRIG_BENCH_LENGTH <= ring_samples; pos += TRIG_BENCH_SPACING) {
+            if (pass * ring_samples + pos < total_samples) expected++;
+        }
+    }
+
+    // "late ext" reports each external trigger only after its slot was pushed, like a GPIO
+    // timestamp read once the DMA completion has already been handed on.
+    const TriggerMode modes[] = { TRIGGER_LEVEL, TRIGGER_ENERGY, TRIGGER_EXTERNAL, TRIGGER_EXTERNAL };
+    const char* names[] = { "level", "energy", "external", "late ext" };
+    printf("  %llu MB per run, %u-sample bursts every %u samples, %u pre / %u post samples kept.\n",
+           (unsigned long long)(total_bytes / (1024 * 1024)), TRIG_BENCH_LENGTH, TRIG_BENCH_SPACING,
+           TRIG_BENCH_PRE, TRIG_BENCH_POST);
+    printf("  %-9s %12s %9s %9s %10s %10s %12s %12s\n", "Trigger", "Rate (MS/s)", "Snippets", "Expected",
+           "Misplaced", "Discarded", "Save (us)", "Trigger (us)");
+
+    for (size_t m = 0; m < sizeof(modes) / sizeof(modes[0]); ++m) {
+        TriggerConfig config;
+        TriggerStage stage;
+        TriggerBenchState state = { .ring_samples = ring_samples };
+        trigger_config_default(&config, modes[m], TRIG_BENCH_PRE, TRIG_BENCH_POST);
+        if (trigger_init(&stage, &config, trigger_bench_chunk, NULL, &state) != 0) continue;
+
+        struct timespec start;
+        CaptureSlot slot;
+        memset(&slot, 0, sizeof(slot));
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (uint64_t consumed = 0; consumed < total_bytes; consumed += slot.length, slot.sequence++) {
+            slot.data = ring + (slot.sequence % BENCH_RING_SLOTS) * slot_bytes;
+            slot.length = (total_bytes - consumed) < slot_bytes ? (size_t)(total_bytes - consumed) : slot_bytes;
+            slot.stream_offset = consumed;
+            const int late = m == 3;
+            if (late) trigger_push_slot(&stage, &slot);
+            if (modes[m] == TRIGGER_EXTERNAL) {
+                // A trigger line asserted at each burst, reported with the slot it falls in.
+                const uint64_t first = consumed / TRIGGER_BYTES_PER_SAMPLE;
+                const uint64_t end = first + slot.length / TRIGGER_BYTES_PER_SAMPLE;
+                const uint64_t base = first - first % ring_samples;
+                for (uint64_t pos = base + TRIG_BENCH_OFFSET; pos < end; pos += TRIG_BENCH_SPACING) {
+                    if (pos >= first && (pos - base) + TRIG_BENCH_LENGTH <= ring_samples) trigger_fire(&stage, pos);
+                }
+            }
+            if (!late) trigger_push_slot(&stage, &slot);
+        }
+        trigger_flush(&stage);
+        double elapsed = elapsed_since(&start);
+
+        TriggerStats stats;
+        trigger_get_stats(&stage, &stats);
+        printf("  %-9s %12.1f %9llu %9llu %10llu %9.2f%% %5.0f/%-6.0f %5.0f/%-6.0f\n", names[m],
+               (double)total_samples / elapsed / 1e6, (unsigned long long)state.snippets,
+               (unsigned long long)expected, (unsigned long long)state.misplaced, 100.0 * stats.discarded,
+               stats.save_latency_mean * 1e6, stats.save_latency_max * 1e6,
+               stats.trigger_latency_mean * 1e6, stats.trigger_latency_max * 1e6);
+    }
+    printf("  Latencies are mean/max from the slot completing (Save) or triggering (Trigger) a snippet\n"
+           "  to its last byte reaching the sink; live, Trigger also waits for the post-trigger samples.\n");
+
+    munmap(ring, ring_bytes);
+}
+
+#define TIME_BENCH_RATE_HZ    50e6
+#define TIME_BENCH_DRIFT_PPM  20.0   // Sample clock against the capture clock
+#define TIME_BENCH_LATENCY_NS 5000.0 // Fixed part of the completion latency
+
+// Uniform in (0, 1) from a 32-bit LCG.
+static double time_bench_uniform(uint32_t* lcg) {
+    *lcg = *lcg * 1664525U + 1013904223U;
+    return ((double)(*lcg >> 8) + 0.5) / 16777216.0;
+}
+
+void run_time_model_benchmark(unsigned slots) {
+    printf("\n--- Running Slot Timestamp Model Benchmark ---\n");
+
+    const uint64_t slot_samples = CAPTURE_DEFAULT_PACKET_BYTES / TIME_MODEL_BYTES_PER_SAMPLE;
+    const double true_ns_per_sample = 1e9 / (TIME_BENCH_RATE_HZ * (1.0 + TIME_BENCH_DRIFT_PPM * 1e-6));
+    const uint64_t t0 = 1000000000ULL;
+
+    // Completion stamps: fixed latency, exponential jitter (mean 3 us), and 2% picked up 0.2-2 ms late.
+    uint64_t* stamps = malloc(slots * sizeof(uint64_t));
+    if (!stamps) {
+        perror("Failed to allocate timestamps");
+        return;
+    }
+    uint32_t lcg = 99;
+    double raw_sq = 0.0;
+    for (unsigned i = 0; i < slots; ++i) {
+        double truth = (double)((i + 1) * slot_samples - 1) * true_ns_per_sample;
+        double latency = TIME_BENCH_LATENCY_NS - 3000.0 * log(time_bench_uniform(&lcg));
+        if (time_bench_uniform(&lcg) < 0.02) latency += 200000.0 + 1800000.0 * time_bench_uniform(&lcg);
+        stamps[i] = t0 + (uint64_t)llround(truth + latency);
+        raw_sq += (latency - TIME_BENCH_LATENCY_NS) * (latency - TIME_BENCH_LATENCY_NS);
+    }
+
+    printf("  %u slots of %llu samples at %.0f MS/s %+.0f ppm; stamps %.0f us late plus jitter, 2%% up to 2 ms late.\n",
+           slots, (unsigned long long)slot_samples, TIME_BENCH_RATE_HZ / 1e6, TIME_BENCH_DRIFT_PPM,
+           TIME_BENCH_LATENCY_NS / 1e3);
+    printf("  Raw stamps: %.1f us RMS error beyond the fixed latency.\n", sqrt(raw_sq / slots) / 1e3);
+    printf("  %-24s %10s %12s %12s %10s %10s\n", "Model", "Rate ppm", "Bias (us)", "RMS (us)", "Max (us)", "Rejected");
+
+    struct { const char* name; double forget; double reject_ns; } variants[] = {
+        { "least squares, keep all", 1.0, 0.0 },
+        { "least squares, reject", 1.0, 50000.0 },
+        { "forget 0.99, reject", 0.99, 50000.0 },
+    };
+    for (size_t v = 0; v < sizeof(variants) / sizeof(variants[0]); ++v) {
+        TimeModelConfig config;
+        TimeModel model;
+        time_model_config_default(&config, TIME_BENCH_RATE_HZ);
+        config.forget = variants[v].forget;
+        config.reject_ns = variants[v].reject_ns;
+        if (time_model_init(&model, &config) != 0) continue;
+
+        // Error of the running fit for every slot's first sample, once a few stamps are in.
+        double sum = 0.0, sum_sq = 0.0, max_err = 0.0;
+        unsigned measured = 0;
+        for (unsigned i = 0; i < slots; ++i) {
+            time_model_add_point(&model, (i + 1) * slot_samples - 1, stamps[i]);
+            if (i < 16 || i + 1 == slots) continue;
+            uint64_t sample = (uint64_t)(i + 1) * slot_samples;
+            double truth = (double)sample * true_ns_per_sample;
+            double err = (double)(int64_t)(time_model_sample_time_ns(&model, sample) - t0) - truth
+                         - TIME_BENCH_LATENCY_NS;
+            sum += err;
+            sum_sq += err * err;
+            if (fabs(err) > max_err) max_err = fabs(err);
+            measured++;
+        }
+        double bias = measured ? sum / measured : 0.0;
+        double rms = measured ? sqrt(sum_sq / measured - bias * bias) : 0.0;
+        printf("  %-24s %10.2f %12.2f %12.2f %10.2f %10llu\n", variants[v].name,
+               (time_model_rate_hz(&model) / TIME_BENCH_RATE_HZ - 1.0) * 1e6, bias / 1e3, rms / 1e3,
+               max_err / 1e3, (unsigned long long)model.rejected);
+    }
+    printf("  Bias and RMS are for the next slot's first sample, beyond the fixed %.0f us latency.\n",
+           TIME_BENCH_LATENCY_NS / 1e3);
+
+    // Per-call cost of the pieces that run in the capture path.
+    const unsigned calls = 1000000;
+    TimeModelConfig config;
+    TimeModel model;
+    time_model_config_default(&config, TIME_BENCH_RATE_HZ);
+    time_model_init(&model, &config);
+    for (unsigned i = 0; i < slots; ++i) time_model_add_point(&model, (i + 1) * slot_samples - 1, stamps[i]);
+
+    struct timespec start;
+    volatile uint64_t sink = 0;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (unsigned i = 0; i < calls; ++i) sink += capture_clock_ns();
+    double clock_ns = elapsed_since(&start) * 1e9 / calls;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (unsigned i = 0; i < calls; ++i) sink += time_model_sample_time_ns(&model, (uint64_t)i * 977);
+    double lookup_ns = elapsed_since(&start) * 1e9 / calls;
+    printf("  capture_clock_ns(): %.1f ns per call, time_model_sample_time_ns(): %.1f ns per call.\n",
+           clock_ns, lookup_ns);
+
+    free(stamps);
+}
+
+void run_capture_file_benchmark(const char* path, uint64_t total_bytes) {
+    printf("\n--- Running Indexed Capture File Benchmark ---\n");
+
+    const size_t slot_bytes = CAPTURE_DEFAULT_PACKET_BYTES;
+    uint8_t* ring = alloc_slot_ring(slot_bytes, BENCH_RING_SLOTS);
+    if (!ring) return;
+    char index_path[CAPTURE_FILE_PATH_LEN + 8];
+    snprintf(index_path, sizeof(index_path), "%s.idx", path);
+
+    // Slots arrive every slot_bytes / 4 samples at 50 MS/s.
+    const uint64_t slot_ns = (uint64_t)(slot_bytes / 4) * 20;
+    const uint64_t t0 = 1000000000ULL;
+    printf("  %llu MB in %zu KB chunks to %s\n", (unsigned long long)(total_bytes / (1024 * 1024)),
+           slot_bytes / 1024, path);
+
+    for (int checksum = 0; checksum <= 1; ++checksum) {
+        CaptureFileConfig config;
+        CaptureFileWriter writer;
+        RecorderStats stats;
+        capture_file_config_default(&config, 50e6, 2.4e9);
+        config.checksum = checksum;
+        if (capture_file_open(&writer, path, &config) != 0) break;
+        recorder_register_region(&writer.data, ring, slot_bytes * BENCH_RING_SLOTS);
+
+        CaptureSlot slot;
+        memset(&slot, 0, sizeof(slot));
+        for (uint64_t written = 0; written < total_bytes; written += slot.length, slot.sequence++) {
+            slot.data = ring + (slot.sequence % BENCH_RING_SLOTS) * slot_bytes;
+            slot.length = (total_bytes - written) < slot_bytes ? (size_t)(total_bytes - written) : slot_bytes;
+            slot.stream_offset = written;
+            slot.timestamp_ns = t0 + (slot.sequence + 1) * slot_ns;
+            if (capture_file_append_slot(&writer, &slot) != 0) break;
+        }
+        uint64_t chunks = writer.chunks;
+        int rc = capture_file_close(&writer, &stats);
+        printf("  Write, CRC32C %-3s %9.2f MB/s over %.3f s, %llu chunks%s\n", checksum ? "on" : "off",
+               stats.bandwidth_mbps, stats.elapsed_seconds, (unsigned long long)chunks, rc == 0 ? "" : "  [ERRORS]");
+    }
+
+    CaptureFileReader reader;
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    if (capture_reader_open(&reader, path) == 0) {
+        double open_time = elapsed_since(&start);
+        const uint64_t samples = total_bytes / 4;
+        const unsigned lookups = 1000000;
+        uint64_t misses = 0;
+        uint32_t lcg = 1;
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (unsigned i = 0; i < lookups; ++i) {
+            lcg = lcg * 1664525U + 1013904223U;
+            uint64_t sample = ((uint64_t)lcg * samples) >> 32;
+            int64_t chunk = capture_reader_find_sample(&reader, sample);
+            if (chunk < 0 || sample - reader.records[chunk].first_sample >= reader.records[chunk].bytes / 4) misses++;
+        }
+        double sample_ns = elapsed_since(&start) * 1e9 / lookups;
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (unsigned i = 0; i < lookups; ++i) {
+            lcg = lcg * 1664525U + 1013904223U;
+            uint64_t time_ns = t0 + (((uint64_t)lcg * (reader.chunks * slot_ns)) >> 32);
+            int64_t chunk = capture_reader_find_time(&reader, time_ns);
+            if (chunk < 0 || (uint64_t)chunk != (time_ns - t0) / slot_ns - ((time_ns - t0) % slot_ns == 0)) misses++;
+        }
+        double time_ns = elapsed_since(&start) * 1e9 / lookups;
+
+        uint64_t bad = 0;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (uint64_t c = 0; c < reader.chunks; ++c) bad += capture_reader_verify_chunk(&reader, c) != 1;
+        double verify_time = elapsed_since(&start);
+
+        printf("  Reader: open %.1f us, %llu records (%zu B index), %llu wrong lookups\n", open_time * 1e6,
+               (unsigned long long)reader.chunks, reader.index_bytes, (unsigned long long)misses);
+        printf("  Seek by sample %.0f ns, by time %.0f ns; verify all chunks %.2f MB/s, %llu bad\n", sample_ns,
+               time_ns, total_bytes / verify_time / (1024 * 1024), (unsigned long long)bad);
+        capture_reader_close(&reader);
+    }
+
+    unlink(path);
+    unlink(index_path);
+    munmap(ring, slot_bytes * BENCH_RING_SLOTS);
+}
+
+void run_lod_benchmark(const char* path, uint64_t total_bytes) {
+    printf("\n--- Running Min/Max/RMS Pyramid Benchmark ---\n");
+
+    const size_t slot_bytes = CAPTURE_DEFAULT_PACKET_BYTES;
+    const size_t ring_bytes = slot_bytes * BENCH_RING_SLOTS;
+    uint8_t* ring = alloc_slot_ring(slot_bytes, BENCH_RING_SLOTS);
+    if (!ring) return;
+    fill_tone_ring(ring, ring_bytes, 0.01);
+
+    const uint64_t total_samples = total_bytes / LOD_BYTES_PER_SAMPLE;
+    LodConfig config;
+    LodWriter writer;
+    lod_config_default(&config, total_samples);
+    if (lod_writer_open(&writer, path, &config) != 0) {
+        munmap(ring, ring_bytes);
+        return;
+    }
+
+    struct timespec start;
+    CaptureSlot slot;
+    memset(&slot, 0, sizeof(slot));
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (uint64_t consumed = 0; consumed < total_bytes; consumed += slot.length, slot.sequence++) {
+        slot.data = ring + (slot.sequence % BENCH_RING_SLOTS) * slot_bytes;
+        slot.length = (total_bytes - consumed) < slot_bytes ? (size_t)(total_bytes - consumed) : slot_bytes;
+        if (lod_writer_add_slot(&writer, &slot) != 0) break;
+    }
+    const unsigned levels = writer.header.levels;
+    int rc = lod_writer_close(&writer);
+    double build_time = elapsed_since(&start);
+
+    char lod_path[256];
+    snprintf(lod_path, sizeof(lod_path), "%s.lod", path);
+    struct stat st;
+    off_t lod_bytes = stat(lod_path, &st) == 0 ? st.st_size : 0;
+    printf("  %llu MB: %u levels, %.1f KB pyramid (%.2f%% of the capture), built at %.1f MS/s per core%s\n",
+           (unsigned long long)(total_bytes / (1024 * 1024)), levels, lod_bytes / 1024.0,
+           100.0 * lod_bytes / total_bytes, total_samples / build_time / 1e6, rc == 0 ? "" : "  [ERRORS]");
+
+    LodReader reader;
+    if (lod_reader_open(&reader, path) == 0) {
+        const unsigned points = 1920; // One screen width
+        static LodEntry out[1920];
+        struct { const char* name; uint64_t first; uint64_t samples; } views[] = {
+            { "whole capture", 0, total_samples },
+            { "middle 1%", total_samples / 2, total_samples / 100 },
+            { "1 ms at 50 MS/s", total_samples / 3, 50000 },
+        };
+        printf("  %-18s %6s %12s %12s\n", "View (1920 points)", "Level", "Read (KB)", "Query (us)");
+        for (size_t v = 0; v < sizeof(views) / sizeof(views[0]); ++v) {
+            unsigned level = 0;
+            const unsigned repeats = 100;
+            clock_gettime(CLOCK_MONOTONIC, &start);
+            for (unsigned r = 0; r < repeats; ++r) {
+                lod_reader_query(&reader, views[v].first, views[v].samples, points, out, &level);
+            }
+            double query_time = elapsed_since(&start) / repeats;
+            uint64_t span = config.base_samples;
+            for (unsigned l = 0; l < level; ++l) span *= config.fanout;
+            double read_kb = (double)(views[v].samples / span + 2) * sizeof(LodEntry) / 1024.0;
+            printf("  %-18s %6u %12.1f %12.1f\n", views[v].name, level, read_kb, query_time * 1e6);
+        }
+        printf("  Reading the raw samples of the whole capture instead: %llu MB.\n",
+               (unsigned long long)(total_bytes / (1024 * 1024)));
+        lod_reader_close(&reader);
+    }
+
+    unlink(lod_path);
+    munmap(ring, ring_bytes);
+}
+
+#define REPLAY_BENCH_STAGES 9
+
+typedef struct {
+    SampleStats    stats;
+    PsdEngine      psd;
+    Channelizer    channelizer;
+    Correlator     correlator;
+    TriggerStage   trigger;
+    CompressConfig compress;
+    BfpConfig      bfp;
+    uint8_t*       out;
+    size_t         out_capacity;
+    uint64_t       sink;  // Keeps the read-only stage from being optimized away
+} ReplayBenchState;
+
+static void replay_bench_psd_frame(const PsdFrame* frame, void* user) {
+    (void)frame;
+    (*(uint64_t*)user)++;
+}
+
+static void replay_bench_detection(const CorrelatorDetection* d, void* user) {
+    (void)d;
+    (*(uint64_t*)user)++;
+}
+
+static void replay_bench_chunk(const TriggerChunk* chunk, void* user) {
+    *(uint64_t*)user += chunk->bytes;
+}
+
+static void replay_bench_release(const CaptureSlot* slot, void* user) {
+    (void)slot;
+    (void)user;
+}
+
+static void replay_stage_touch(const CaptureSlot* slot, void* user) {
+    ReplayBenchState* state = user;
+    const uint64_t* words = (const uint64_t*)slot->data;
+    uint64_t sum = 0;
+    for (size_t i = 0; i < slot->length / 8; ++i) sum += words[i];
+    state->sink += sum;
+}
+
+static void replay_stage_stats(const CaptureSlot* slot, void* user) {
+    ReplayBenchState* state = user;
+    SampleStatsRecord record;
+    sample_stats_compute_slot(&state->stats, slot, &record);
+    state->sink += record.samples;
+}
+
+static void replay_stage_psd(const CaptureSlot* slot, void* user) {
+    psd_engine_push_slot(&((ReplayBenchState*)user)->psd, slot);
+}
+
+static void replay_stage_channelizer(const CaptureSlot* slot, void* user) {
+    channelizer_push_slot(&((ReplayBenchState*)user)->channelizer, slot);
+}
+
+static void replay_stage_correlator(const CaptureSlot* slot, void* user) {
+    correlator_push_slot(&((ReplayBenchState*)user)->correlator, slot);
+}
+
+static void replay_stage_trigger(const CaptureSlot* slot, void* user) {
+    trigger_push_slot(&((ReplayBenchState*)user)->trigger, slot);
+}
+
+static void replay_stage_compress(const CaptureSlot* slot, void* user) {
+    ReplayBenchState* state = user;
+    state->sink += compress_encode_slot(&state->compress, slot, state->out, state->out_capacity);
+}
+
+static void replay_stage_bfp(const CaptureSlot* slot, void* user) {
+    ReplayBenchState* state = user;
+    state->sink += bfp_encode_slot(&state->bfp, slot, state->out, state->out_capacity);
+}
+
+// Writes `total_bytes` of 12-bit ADC-like slots as an indexed capture at 50 MS/s.
+static int write_replay_recording(const char* path, uint64_t total_bytes) {
+    const size_t slot_bytes = CAPTURE_DEFAULT_PACKET_BYTES;
+    uint8_t* ring = alloc_slot_ring(slot_bytes, BENCH_RING_SLOTS);
+    if (!ring) return -1;
+    fill_adc12_ring(ring, slot_bytes * BENCH_RING_SLOTS, 4.0, 1500.0);
+
+    CaptureFileConfig config;
+    CaptureFileWriter writer;
+    capture_file_config_default(&config, 50e6, 2.4e9);
+    if (capture_file_open(&writer, path, &config) != 0) {
+        munmap(ring, slot_bytes * BENCH_RING_SLOTS);
+        return -1;
+    }
+    recorder_register_region(&writer.data, ring, slot_bytes * BENCH_RING_SLOTS);
+
+    CaptureSlot slot;
+    memset(&slot, 0, sizeof(slot));
+    for (uint64_t written = 0; written < total_bytes; written += slot.length, slot.sequence++) {
+        slot.data = ring + (slot.sequence % BENCH_RING_SLOTS) * slot_bytes;
+        slot.length = (total_bytes - written) < slot_bytes ? (size_t)(total_bytes - written) : slot_bytes;
+        slot.stream_offset = written;
+        slot.timestamp_ns = 1000000000ULL + (written + slot.length) / 4 * 20; // Last sample + 1 at 50 MS/s
+        if (capture_file_append_slot(&writer, &slot) != 0) break;
+    }
+    int rc = capture_file_close(&writer, NULL);
+    munmap(ring, slot_bytes * BENCH_RING_SLOTS);
+    return rc;
+}
+
+void run_replay_benchmark(const char* path, uint64_t total_bytes) {
+    printf("\n--- Running Capture Replay Benchmark ---\n");
+
+    char index_path[CAPTURE_FILE_PATH_LEN + 8];
+    snprintf(index_path, sizeof(index_path), "%s.idx", path);
+    int created = 0;
+    if (access(path, R_OK) != 0) {
+        printf("  %s not found; recording %llu MB of 12-bit ADC noise + tone there first.\n", path,
+               (unsigned long long)(total_bytes / (1024 * 1024)));
+        if (write_replay_recording(path, total_bytes) != 0) return;
+        created = 1;
+    }
+
+    ReplayBenchState state;
+    memset(&state, 0, sizeof(state));
+    compress_config_default(&state.compress);
+    bfp_config_default(&state.bfp);
+    state.out_capacity = compress_bound(&state.compress, CAPTURE_DEFAULT_PACKET_BYTES);
+    if (bfp_encoded_bytes(&state.bfp, CAPTURE_DEFAULT_PACKET_BYTES) > state.out_capacity) {
+        state.out_capacity = bfp_encoded_bytes(&state.bfp, CAPTURE_DEFAULT_PACKET_BYTES);
+    }
+    state.out = malloc(state.out_capacity);
+    if (!state.out) {
+        perror("Failed to allocate replay output buffer");
+        return;
+    }
+
+    static int16_t preamble[2 * CORR_BENCH_LENGTH];
+    make_bench_template(preamble, CORR_BENCH_LENGTH, 777);
+    SampleStatsConfig stats_config;
+    PsdConfig psd_config;
+    ChannelizerConfig ch_config;
+    CorrelatorConfig corr_config;
+    TriggerConfig trig_config;
+    uint64_t events = 0;
+    sample_stats_config_default(&stats_config);
+    psd_config_default(&psd_config, 50e6);
+    channelizer_config_default(&ch_config, 64, CHANNELIZER_CRITICAL);
+    correlator_config_default(&corr_config, 50e6);
+    trigger_config_default(&trig_config, TRIGGER_LEVEL, 50000, 100000);
+    trig_config.level = 32000; // Above the recorded tone, so every sample is scanned
+
+    struct { const char* name; ReplayStageFn fn; } stages[REPLAY_BENCH_STAGES] = {
+        { "read only (sum)", replay_stage_touch },
+        { "sample statistics", replay_stage_stats },
+        { "PSD (default)", replay_stage_psd },
+        { "channelizer, 64 ch", replay_stage_channelizer },
+        { "correlator, 1 template", replay_stage_correlator },
+        { "level trigger", replay_stage_trigger },
+        { "lossless compression", replay_stage_compress },
+        { "block floating point", replay_stage_bfp },
+        { "PSD, paced at 1x", replay_stage_psd },
+    };
+    double recorded_rate = 0.0;
+    printf("  %-24s %8s %12s %12s %16s\n", "Stage", "Slots", "Max (MS/s)", "x recorded", "Late, worst");
+
+    for (unsigned s = 0; s < REPLAY_BENCH_STAGES; ++s) {
+        ReplayConfig config;
+        ReplaySource src;
+        ReplayStats stats;
+        replay_config_default(&config);
+        if (s == REPLAY_BENCH_STAGES - 1) config.pacing = REPLAY_REALTIME;
+        if (replay_open(&src, path, &config) != 0) break;
+        recorded_rate = src.indexed ? src.reader.header->sample_rate : config.sample_rate;
+
+        int ready = 0;
+        if (stages[s].fn == replay_stage_stats) ready = sample_stats_init(&state.stats, &stats_config) == 0;
+        else if (stages[s].fn == replay_stage_psd) ready = psd_engine_init(&state.psd, &psd_config, replay_bench_psd_frame, &events) == 0;
+        else if (stages[s].fn == replay_stage_channelizer) ready = channelizer_init(&state.channelizer, &ch_config, channelizer_bench_block, &events) == 0;
+        else if (stages[s].fn == replay_stage_correlator) {
+            ready = correlator_init(&state.correlator, &corr_config, replay_bench_detection, &events) == 0 &&
+                    correlator_add_template(&state.correlator, preamble, CORR_BENCH_LENGTH) == 0;
+        } else if (stages[s].fn == replay_stage_trigger) {
+            ready = trigger_init(&state.trigger, &trig_config, replay_bench_chunk, replay_bench_release, &events) == 0;
+        } else ready = 1;
+
+        int rc = ready ? replay_run(&src, stages[s].fn, &state, &stats) : -1;
+        if (stages[s].fn == replay_stage_psd) psd_engine_free(&state.psd);
+        else if (stages[s].fn == replay_stage_channelizer) channelizer_free(&state.channelizer);
+        else if (stages[s].fn == replay_stage_correlator) correlator_free(&state.correlator);
+        else if (stages[s].fn == replay_stage_trigger) trigger_flush(&state.trigger);
+        replay_close(&src);
+
+        if (rc != 0) {
+            printf("  %-24s %8s\n", stages[s].name, "failed");
+            continue;
+        }
+        char late[32] = "-";
+        if (config.pacing == REPLAY_REALTIME) {
+            snprintf(late, sizeof(late), "%llu, %.1f ms", (unsigned long long)stats.late_slots, stats.max_lateness * 1e3);
+        }
+        printf("  %-24s %8llu %12.1f %12.2f %16s\n", stages[s].name, (unsigned long long)stats.slots,
+               stats.max_rate / 1e6, stats.max_rate / recorded_rate, late);
+    }
+    printf("  Max is samples over time inside the stage; the recording runs at %.1f MS/s.\n", recorded_rate / 1e6);
+
+    free(state.out);
+    if (created) {
+        unlink(path);
+        unlink(index_path);
+    }
+}
+
+void run_crc_benchmark(uint64_t total_bytes) {
+    printf("\n--- Running Slot CRC32C Benchmark ---\n");
+
+    const size_t slot_bytes = CAPTURE_DEFAULT_PACKET_BYTES;
+    const size_t ring_bytes = slot_bytes * BENCH_RING_SLOTS;
+    uint8_t* ring = alloc_slot_ring(slot_bytes, BENCH_RING_SLOTS);
+    if (!ring) return;
+    fill_adc12_ring(ring, ring_bytes, 30.0, 1500.0);
+
+    const Crc32cImpl auto_impl = crc32c_impl();
+    const Crc32cImpl impls[] = { CRC32C_IMPL_BYTEWISE, CRC32C_IMPL_SLICE8, CRC32C_IMPL_HW };
+    const double line_rate = 50e6 * 4; // Bytes per second at 50 MS/s complex int16
+
+    // Reference values: the standard check value, then odd lengths and alignments against bytewise.
+    crc32c_select(CRC32C_IMPL_BYTEWISE);
+    uint32_t reference[64];
+    for (unsigned k = 0; k < 64; ++k) reference[k] = crc32c(ring + k, 4096 + 37 * k);
+
+    printf("  %llu MB in %zu KB slots; 'core at line rate' is the share of one core CRC32C takes at 50 MS/s.\n",
+           (unsigned long long)(total_bytes / (1024 * 1024)), slot_bytes / 1024);
+    printf("  %-12s %8s %12s %14s %20s\n", "Impl", "Correct", "Rate (MB/s)", "Per slot (us)", "Core at line rate");
+    for (size_t n = 0; n < sizeof(impls) / sizeof(impls[0]); ++n) {
+        if (crc32c_select(impls[n]) != 0) {
+            printf("  %-12s %8s\n", crc32c_impl_name(impls[n]), "n/a");
+            continue;
+        }
+        int correct = crc32c("123456789", 9) == 0xE3069283U;
+        for (unsigned k = 0; k < 64; ++k) correct &= crc32c(ring + k, 4096 + 37 * k) == reference[k];
+        uint32_t chained = crc32c_extend(crc32c(ring, 1000), ring + 1000, 3096);
+        correct &= chained == crc32c(ring, 4096);
+
+        struct timespec start;
+        CaptureSlot slot;
+        memset(&slot, 0, sizeof(slot));
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (uint64_t consumed = 0; consumed < total_bytes; consumed += slot.length, slot.sequence++) {
+            slot.data = ring + (slot.sequence % BENCH_RING_SLOTS) * slot_bytes;
+            slot.length = (total_bytes - consumed) < slot_bytes ? (size_t)(total_bytes - consumed) : slot_bytes;
+            slot.flags = 0;
+            capture_slot_checksum(&slot);
+        }
+        double elapsed = elapsed_since(&start);
+        double rate = total_bytes / elapsed;
+        printf("  %-12s %8s %12.1f %14.1f %19.2f%%\n", crc32c_impl_name(impls[n]), correct ? "yes" : "NO",
+               rate / 1e6, elapsed * 1e6 / slot.sequence, 100.0 * line_rate / rate);
+    }
+    crc32c_select(auto_impl);
+
+    // What a sink pays on top: the completion CRC plus one verification pass per sink.
+    CaptureSlot slot;
+    memset(&slot, 0, sizeof(slot));
+    slot.data = ring;
+    slot.length = slot_bytes;
+    capture_slot_checksum(&slot);
+    int verified = capture_slot_verify(&slot) == 1;
+    slot.data[12345] ^= 0x10;
+    int detected = capture_slot_verify(&slot) == 0;
+    slot.data[12345] ^= 0x10;
+    printf("  Using %s: intact slot verifies: %s, one flipped bit detected: %s.\n", crc32c_impl_name(auto_impl),
+           verified ? "yes" : "NO", detected ? "yes" : "NO");
+
+    munmap(ring, ring_bytes);
+}
+
+// Copies `transfers` blocks of `bytes` from the start of the window to eight rotating destinations
+// behind it, submitting `batch` at a time and reaping each batch before the next. Returns seconds,
+// or a negative value if a transfer failed or came back twice.
+static double time_dma_batches(RhDma* dma, uint64_t base, size_t bytes, unsigned batch, unsigned transfers) {
+    RhDmaTransfer xfers[RH_DMA_QUEUE_DEPTH];
+    RhDmaCompletion done[RH_DMA_QUEUE_DEPTH];
+    uint64_t expected_sum = 0, seen_sum = 0;
+    unsigned submitted = 0;
+    struct timespec start;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    while (submitted < transfers) {
+        const unsigned n = transfers - submitted < batch ? transfers - submitted : batch;
+        for (unsigned i = 0; i < n; ++i) {
+            const unsigned id = submitted + i;
+            xfers[i].kind = RH_DMA_MEM_TO_MEM;
+            xfers[i].stream = 0;
+            xfers[i].src_phys = base;
+            xfers[i].dst_phys = base + bytes * (1 + id % 8);
+            xfers[i].bytes = (uint32_t)bytes;
+            xfers[i].user_data = id;
+            expected_sum += id;
+        }
+        if (rh_dma_submit(dma, xfers, n) != (int)n) return -1.0;
+        submitted += n;
+        while (rh_dma_outstanding(dma) > 0) {
+            int got = rh_dma_reap(dma, done, RH_DMA_QUEUE_DEPTH, 1000);
+            if (got <= 0) return -1.0;
+            for (int i = 0; i < got; ++i) {
+                if (done[i].status != RH_DMA_STATUS_OK) return -1.0;
+                seen_sum += done[i].user_data;
+            }
+        }
+    }
+    double elapsed = elapsed_since(&start);
+    return seen_sum == expected_sum ? elapsed : -1.0;
+}
+
+// The software backend's copies done straight from the CPU, to the same destinations in the same order.
+static double time_memmove(uint8_t* src, size_t bytes, unsigned transfers) {
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (unsigned k = 0; k < transfers; ++k) memmove(src + bytes * (1 + k % 8), src, bytes);
+    return elapsed_since(&start);
+}
+
+void run_dma_api_benchmark(unsigned transfers, int hardware) {
+    printf("\n--- Running DMA API Benchmark ---\n");
+
+    const size_t sizes[] = { 64, 4096, 256 * 1024 };
+    const unsigned batches[] = { 1, 4, 16, RH_DMA_QUEUE_DEPTH };
+    const size_t window_bytes = 9 * sizes[sizeof(sizes) / sizeof(sizes[0]) - 1];
+    RhDmaConfig config;
+    RhDma dma;
+    uint8_t* window = NULL;
+    uint64_t base;
+    int udma_fd = -1;
+
+    rh_dma_config_default(&config);
+    if (hardware) {
+        // Copies run inside the capture ring of the udmabuf region, which the DMA can reach.
+        udma_fd = open(UDMABUF_DEVICE_NAME, O_RDWR);
+        if (udma_fd < 0) {
+            perror("Failed to open udmabuf device");
+            return;
+        }
+        window = mmap(NULL, CAPTURE_BUFFER_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, udma_fd, 0);
+        if (window == MAP_FAILED) {
+            perror("Failed to mmap udmabuf");
+            close(udma_fd);
+            return;
+        }
+        config.uio_path = UIO_DMA_DEV_NAME;
+        base = DMA_PHYSICAL_BASE_ADDR + CAPTURE_RING_OFFSET;
+    } else {
+        window = alloc_slot_ring(window_bytes, 1);
+        if (!window) return;
+        config.backend = RH_DMA_BACKEND_SOFTWARE;
+        config.mem_phys = DMA_PHYSICAL_BASE_ADDR + CAPTURE_RING_OFFSET;
+        config.mem_virt = window;
+        config.mem_bytes = window_bytes;
+        base = config.mem_phys;
+    }
+    if (rh_dma_open(&dma, &config) != 0) {
+        if (hardware) {
+            munmap(window, CAPTURE_BUFFER_SIZE);
+            close(udma_fd);
+        } else {
+            munmap(window, window_bytes);
+        }
+        return;
+    }
+    uint8_t* src = hardware ? window + CAPTURE_RING_OFFSET : window;
+
+    printf("  %u memory-to-memory transfers per run on the %s backend; each batch is reaped before the next.\n",
+           transfers, hardware ? "UIO" : "software");
+    if (!hardware) {
+        printf("  'memmove' times the same copies done directly, alternating with the API runs.\n");
+    }
+    printf("  %-10s %6s %14s %14s %12s %12s\n", "Size", "Batch", "Transfers/s", "Per xfer (ns)",
+           hardware ? "IRQ waits" : "memmove (ns)", "MB/s");
+    for (size_t z = 0; z < sizeof(sizes) / sizeof(sizes[0]); ++z) {
+        const size_t bytes = sizes[z];
+        const unsigned runs = bytes > 4096 ? transfers / 16 + 1 : transfers;
+        for (size_t i = 0; i < bytes; ++i) src[i] = (uint8_t)(i * 13 + z);
+        // Touch every destination once so neither side pays the first page faults.
+        if (time_dma_batches(&dma, base, bytes, 8, 8) < 0.0) rh_dma_reset(&dma);
+
+        for (size_t b = 0; b < sizeof(batches) / sizeof(batches[0]); ++b) {
+            const uint64_t waits_before = dma.stats.waits;
+            const double copy_ns = hardware ? 0.0 : time_memmove(src, bytes, runs) * 1e9 / runs;
+            double elapsed = time_dma_batches(&dma, base, bytes, batches[b], runs);
+            if (elapsed < 0.0) {
+                printf("  %-10zu %6u   FAILED (error, timeout or lost completion)\n", bytes, batches[b]);
+                rh_dma_reset(&dma);
+                continue;
+            }
+            const double per_ns = elapsed * 1e9 / runs;
+            const double extra = hardware ? (double)(dma.stats.waits - waits_before) : copy_ns;
+            printf("  %-10zu %6u %14.0f %14.1f %12.1f %12.1f\n", bytes, batches[b], runs / elapsed, per_ns, extra,
+                   (double)bytes * runs / elapsed / 1e6);
+        }
+        int intact = memcmp(src + bytes * 8, src, bytes) == 0;
+        if (!intact) printf("  ERROR: %zu byte copies do not match the source.\n", bytes);
+    }
+    printf("  Library totals: %llu submitted in %llu batches, %llu starts, %llu interrupt events, %llu stray.\n",
+           (unsigned long long)dma.stats.submitted, (unsigned long long)dma.stats.batches,
+           (unsigned long long)dma.stats.starts, (unsigned long long)dma.stats.events,
+           (unsigned long long)dma.stats.stray_events);
+
+    rh_dma_close(&dma);
+    if (hardware) {
+        munmap(window, CAPTURE_BUFFER_SIZE);
+        close(udma_fd);
+    } else {
+        munmap(window, window_bytes);
+    }
+}
@@ -0,0 +1,169 @@
+// =================================================================================================
+// File: bench_suite.h
+// Description: Software benchmarks for the capture pipeline. These need no FPGA hardware, so they
+//              run both on the BeagleV-Fire's U54 cores and on a development host.
+// =================================================================================================
+
+#ifndef BENCH_SUITE_H
+#define BENCH_SUITE_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// --- Function Prototypes ---
+
+/**
+ * @brief Writes `total_bytes` of slot-sized buffers to `path` with every recorder backend and
+ *        reports the sustained write bandwidth of each. The file is removed afterwards.
+ */
+void run_recorder_benchmark(const char* path, uint64_t total_bytes);
+
+/**
+ * @brief Streams `total_bytes` of slots into a SigMF recording at `base_path` with one annotation
+ *        per slot and reports sample throughput. The recording is removed afterwards.
+ */
+void run_sigmf_benchmark(const char* base_path, uint64_t total_bytes);
+
+/**
+ * @brief Sends `total_bytes` of slots to a running net_receiver and reports send throughput,
+ *        with and without MSG_ZEROCOPY.
+ * @param tcp Non-zero for TCP, zero for UDP.
+ */
+void run_net_sink_benchmark(int tcp, const char* host, uint16_t port, uint64_t total_bytes);
+
+/**
+ * @brief Runs `total_bytes` of synthetic complex samples (a tone over noise) through the Welch
+ *        PSD engine for each FFT size and both processing paths, and reports sample throughput,
+ *        output data reduction and where the tone was found.
+ */
+void run_psd_benchmark(uint64_t total_bytes);
+
+/**
+ * @brief Decimates `total_bytes` of synthetic complex samples in place for several rates with both
+ *        kernels and reports input and output samples per second on a single hart.
+ */
+void run_fir_decimator_benchmark(uint64_t total_bytes);
+
+/**
+ * @brief Extracts 1 to 8 sub-bands from `total_bytes` of real samples, once with all bands in one
+ *        DDC bank and once with a separate pass per band, and reports the input sample rate of each.
+ */
+void run_ddc_benchmark(uint64_t total_bytes);
+
+/**
+ * @brief Times every sample conversion kernel for each implementation the CPU supports, checks
+ *        each against the scalar reference, and reports samples per second.
+ */
+void run_sample_unpack_benchmark(uint64_t total_samples);
+
+/**
+ * @brief Computes per-slot statistics records over `total_bytes` of I/Q slots with each available
+ *        kernel, checks that the kernels agree and reports the sustained rate.
+ */
+void run_sample_stats_benchmark(uint64_t total_bytes);
+
+/**
+ * @brief Runs `total_bytes` of synthetic samples through the PSD engine into the occupancy
+ *        summarizer and reports processing rate, record volume and the last record.
+ */
+void run_occupancy_benchmark(uint64_t total_bytes);
+
+/**
+ * @brief Compares the Goertzel bank against the FFT-based PSD for several block sizes and numbers
+ *        of watched frequencies, and reports where the FFT becomes the cheaper path.
+ */
+void run_goertzel_benchmark(uint64_t total_bytes);
+
+/**
+ * @brief Runs `total_bytes` of synthetic samples through the polyphase channelizer for several
+ *        channel counts in critically sampled and 2x oversampled mode, and reports input rate and
+ *        aggregate output rate (channels x samples per second).
+ */
+void run_channelizer_benchmark(uint64_t total_bytes);
+
+/**
+ * @brief Streams synthetic samples with embedded preamble bursts through the overlap-save
+ *        correlator for several block sizes and template counts, and reports processing rate and
+ *        detections against the inserted bursts.
+ */
+void run_correlator_benchmark(uint64_t total_bytes);
+
+/**
+ * @brief Runs CA- and OS-CFAR over `frames` synthetic PSD frames per FFT size, and reports time
+ *        per frame against the full-rate frame budget, detections found and report size.
+ */
+void run_cfar_benchmark(unsigned frames);
+
+/**
+ * @brief Compresses and decompresses `total_bytes` of several synthetic sources slot by slot, and
+ *        reports compression ratio, encode and decode rate per core, and whether the round trip
+ *        was exact.
+ */
+void run_compress_benchmark(uint64_t total_bytes);
+
+/**
+ * @brief Encodes and decodes `total_bytes` of synthetic samples with several block floating point
+ *        configurations, and reports size ratio, SQNR and encode/decode rate per core.
+ */
+void run_bfp_benchmark(uint64_t total_bytes);
+
+/**
+ * @brief Runs the triggered capture stage over `total_bytes` of noise with inserted bursts using
+ *        level, energy and external triggers, and reports snippets, discarded fraction and latency.
+ */
+void run_trigger_benchmark(uint64_t total_bytes);
+
+/**
+ * @brief Fits the slot timestamp model to `slots` synthetic completion stamps with latency jitter
+ *        and late outliers, and reports rate, bias and timing error plus the per-call cost.
+ */
+void run_time_model_benchmark(unsigned slots);
+
+/**
+ * @brief Writes `total_bytes` of slots as an indexed capture at `path` with and without chunk
+ *        checksums, then maps it back and reports seek cost and checksum verification rate.
+ */
+void run_capture_file_benchmark(const char* path, uint64_t total_bytes);
+
+/**
+ * @brief Builds the min/max/RMS pyramid for `total_bytes` of slots next to `path`, and reports
+ *        build rate, pyramid size and the reads and time for screen-width queries at several zooms.
+ */
+void run_lod_benchmark(const char* path, uint64_t total_bytes);
+
+/**
+ * @brief Replays the capture at `path` as fast as possible through several processing stages and
+ *        reports the highest input rate each sustains, then once paced to the recorded timing.
+ *        A missing `path` is first recorded with `total_bytes` of synthetic samples and removed after.
+ */
+void run_replay_benchmark(const char* path, uint64_t total_bytes);
+
+/**
+ * @brief Checks every CRC32C implementation against known values and reports its rate over
+ *        `total_bytes` of slots and the share of one core it needs at the 50 MS/s line rate.
+ */
+void run_crc_benchmark(uint64_t total_bytes);
+
+/**
+ * @brief Submits `transfers` memory-to-memory copies per size and batch through the DMA library
+ *        and reports transfers per second and the time each costs, against plain memmove() for the
+ *        software backend or with interrupt waits counted on the controller (`hardware`).
+ */
+void run_dma_api_benchmark(unsigned transfers, int hardware);
+
+/**
+ * @brief Drives the DMA library from C++20 coroutines (bench_async.cpp): up to `tasks` coroutines
+ *        each awaiting their own copies, against the C API's full batches; `tasks` coroutines
+ *        sleeping on the loop's timer; and, on the software backend, a capture consumed through
+ *        CaptureSlots while 64 coroutines copy memory. Reports the thread count alongside.
+ */
+void run_dma_async_benchmark(unsigned tasks, int hardware);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BENCH_SUITE_H
@@ -0,0 +1,169 @@
+// =================================================================================================
+// File: bfp.c
+// Description: Implementation of the block floating point encoder and decoder.
+// =================================================================================================
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "bfp.h"
+
+// --- Internal Helpers ---
+
+static size_t block_bytes(unsigned values, unsigned mantissa_bits) {
+    return 1 + ((size_t)values * mantissa_bits + 7) / 8;
+}
+
+static size_t encode_block(const int16_t* in, unsigned n, unsigned m, uint8_t* out) {
+    // OR of the magnitudes (~v for negative v) has the bit length of the largest one.
+    uint32_t mags = 0;
+    for (unsigned i = 0; i < n; ++i) mags |= (uint16_t)(in[i] ^ (in[i] >> 15));
+    const unsigned needed = (mags ? 32 - (unsigned)__builtin_clz(mags) : 0) + 1; // Plus the sign bit
+    const unsigned exponent = needed > m ? needed - m : 0;
+    out[0] = (uint8_t)exponent;
+
+    const int32_t max_q = (1 << (m - 1)) - 1;
+    const int32_t round = exponent ? 1 << (exponent - 1) : 0;
+    const uint32_t mask = (1U << m) - 1;
+    uint8_t* dst = out + 1;
+    uint64_t acc = 0;
+    unsigned bits = 0;
+    for (unsigned i = 0; i < n; ++i) {
+        int32_t q = (in[i] + round) >> exponent;
+        if (q > max_q) q = max_q; // Rounding up the largest value
+        acc |= (uint64_t)((uint32_t)q & mask) << bits;
+        bits += m;
+        if (bits >= 32) {
+            uint32_t word = (uint32_t)acc;
+            memcpy(dst, &word, 4);
+            dst += 4;
+            acc >>= 32;
+            bits -= 32;
+        }
+    }
+    for (; bits > 0; bits = bits > 8 ? bits - 8 : 0) {
+        *dst++ = (uint8_t)acc;
+        acc >>= 8;
+    }
+    return (size_t)(dst - out);
+}
+
+static void decode_block(const uint8_t* in, unsigned n, unsigned m, int16_t* out) {
+    const unsigned exponent = in[0];
+    const uint8_t* src = in + 1;
+    const uint8_t* end = src + ((size_t)n * m + 7) / 8;
+    uint64_t acc = 0;
+    unsigned bits = 0;
+    for (unsigned i = 0; i < n; ++i) {
+        if (bits < m) {
+            if (end - src >= 4) {
+                uint32_t word;
+                memcpy(&word, src, 4);
+                acc |= (uint64_t)word << bits;
+                src += 4;
+                bits += 32;
+            } else {
+                while (bits < m) {
+                    acc |= (uint64_t)*src++ << bits;
+                    bits += 8;
+                }
+            }
+        }
+        int32_t q = (int32_t)((uint32_t)acc << (32 - m)) >> (32 - m);
+        acc >>= m;
+        bits -= m;
+        out[i] = (int16_t)(uint16_t)((uint32_t)q << exponent);
+    }
+}
+
+
+// --- Public API Functions ---
+
+void bfp_config_default(BfpConfig* config) {
+    config->block_values = 64;
+    config->mantissa_bits = 8;
+}
+
+size_t bfp_encoded_bytes(const BfpConfig* config, size_t bytes) {
+    const size_t values = bytes / sizeof(int16_t);
+    const size_t full = values / config->block_values;
+    const unsigned tail = (unsigned)(values % config->block_values);
+    return sizeof(BfpHeader) + full * block_bytes(config->block_values, config->mantissa_bits) +
+           (tail ? block_bytes(tail, config->mantissa_bits) : 0);
+}
+
+size_t bfp_encode(const BfpConfig* config, const void* in, size_t bytes, void* out, size_t out_capacity) {
+    const unsigned block = config->block_values;
+    const unsigned m = config->mantissa_bits;
+    if (block == 0 || block > BFP_MAX_BLOCK || block % 2 != 0 || m < BFP_MIN_MANTISSA || m > BFP_MAX_MANTISSA ||
+        bytes % sizeof(int16_t) != 0 || bytes / sizeof(int16_t) > UINT32_MAX ||
+        out_capacity < bfp_encoded_bytes(config, bytes)) {
+        printf("ERROR: Invalid BFP request (%u-value blocks, %u-bit mantissas, %zu bytes).\n", block, m, bytes);
+        return 0;
+    }
+
+    const int16_t* values = in;
+    const size_t count = bytes / sizeof(int16_t);
+    BfpHeader header = {
+        .magic = BFP_MAGIC,
+        .values = (uint32_t)count,
+        .block_values = (uint16_t)block,
+        .mantissa_bits = (uint8_t)m,
+    };
+    memcpy(out, &header, sizeof(header));
+
+    uint8_t* dst = (uint8_t*)out + sizeof(header);
+    for (size_t i = 0; i < count; i += block) {
+        const unsigned n = count - i < block ? (unsigned)(count - i) : block;
+        dst += encode_block(values + i, n, m, dst);
+    }
+    return (size_t)(dst - (uint8_t*)out);
+}
+
+size_t bfp_encode_slot(const BfpConfig* config, const CaptureSlot* slot, void* out, size_t out_capacity) {
+    return bfp_encode(config, slot->data, slot->length, out, out_capacity);
+}
+
+size_t bfp_decode(const void* in, size_t in_bytes, void* out, size_t out_capacity) {
+    BfpHeader header;
+    if (in_bytes < sizeof(header)) {
+        printf("ERROR: BFP buffer too short (%zu bytes).\n", in_bytes);
+        return 0;
+    }
+    memcpy(&header, in, sizeof(header));
+    const BfpConfig config = { .block_values = header.block_values, .mantissa_bits = header.mantissa_bits };
+    const size_t bytes = (size_t)header.values * sizeof(int16_t);
+    if (header.magic != BFP_MAGIC || config.block_values == 0 || config.block_values > BFP_MAX_BLOCK ||
+        config.mantissa_bits < BFP_MIN_MANTISSA || config.mantissa_bits > BFP_MAX_MANTISSA ||
+        bfp_encoded_bytes(&config, bytes) > in_bytes) {
+        printf("ERROR: Malformed BFP buffer header.\n");
+        return 0;
+    }
+    if (bytes > out_capacity) {
+        printf("ERROR: %u decoded values do not fit in %zu bytes.\n", header.values, out_capacity);
+        return 0;
+    }
+
+    const uint8_t* src = (const uint8_t*)in + sizeof(header);
+    int16_t* values = out;
+    for (size_t i = 0; i < header.values; i += config.block_values) {
+        const unsigned n = header.values - i < config.block_values ? (unsigned)(header.values - i) : config.block_values;
+        if (src[0] > 16 - BFP_MIN_MANTISSA) {
+            printf("ERROR: Corrupt BFP block exponent %u.\n", src[0]);
+            return 0;
+        }
+        decode_block(src, n, config.mantissa_bits, values + i);
+        src += block_bytes(n, config.mantissa_bits);
+    }
+    return bytes;
+}
+
+double bfp_sqnr_db(const int16_t* reference, const int16_t* decoded, size_t values) {
+    double signal = 0.0, noise = 0.0;
+    for (size_t i = 0; i < values; ++i) {
+        double e = (double)reference[i] - decoded[i];
+        signal += (double)reference[i] * reference[i];
+        noise += e * e;
+    }
+    return noise > 0.0 ? 10.0 * log10(signal / noise) : INFINITY;
+}
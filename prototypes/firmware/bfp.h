@@ -0,0 +1,83 @@
+// =================================================================================================
+// File: bfp.h
+// Description: Block floating point encoder that trades controlled quantization loss for a fixed,
+//              smaller recording size.
+//
+// Values are cut into blocks (I and Q of a complex sample stay in the same block and share its
+// exponent). Each block stores one exponent byte, the right shift that makes its largest value
+// fit, followed by every value rounded to a `mantissa_bits` two's complement mantissa, bit-packed
+// LSB first and padded to a byte boundary. The output size depends only on the configuration, so
+// with 8-bit mantissas and 64-value blocks a slot shrinks to 51% of its size, and with 4-bit
+// mantissas to 26%.
+//
+// The quantization error of a block scales with its largest value, so the signal-to-quantization-
+// noise ratio stays roughly constant (about 6 dB per mantissa bit) as the signal level changes.
+// =================================================================================================
+
+#ifndef BFP_H
+#define BFP_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "capture_session.h"
+
+// --- Configuration ---
+
+#define BFP_MAGIC          0x31504642 // "BFP1"
+#define BFP_MIN_MANTISSA   2
+#define BFP_MAX_MANTISSA   15
+#define BFP_MAX_BLOCK      4096       // Values per block
+
+typedef struct {
+    unsigned block_values;  // int16 values sharing one exponent (even, so I/Q pairs are not split)
+    unsigned mantissa_bits; // Bits per value, sign included
+} BfpConfig;
+
+/**
+ * @brief Header at the start of every encoded buffer (little-endian).
+ */
+typedef struct __attribute__((packed)) {
+    uint32_t magic;
+    uint32_t values;        // int16 values encoded
+    uint16_t block_values;
+    uint8_t  mantissa_bits;
+    uint8_t  reserved;
+} BfpHeader;
+
+
+// --- Function Prototypes ---
+
+/**
+ * @brief Fills in a configuration: 64-value blocks with 8-bit mantissas.
+ */
+void bfp_config_default(BfpConfig* config);
+
+/**
+ * @brief Exact encoded size of `bytes` of int16 input, header included.
+ */
+size_t bfp_encoded_bytes(const BfpConfig* config, size_t bytes);
+
+/**
+ * @brief Encodes int16 values into `out`. Safe to call concurrently on different buffers.
+ * @return Encoded size in bytes, or 0 on invalid parameters or a too-small `out`.
+ */
+size_t bfp_encode(const BfpConfig* config, const void* in, size_t bytes, void* out, size_t out_capacity);
+
+/**
+ * @brief Encodes the contents of a filled capture slot.
+ */
+size_t bfp_encode_slot(const BfpConfig* config, const CaptureSlot* slot, void* out, size_t out_capacity);
+
+/**
+ * @brief Reconstructs int16 values from one encoded buffer.
+ * @return Decoded size in bytes, or 0 if the buffer is malformed or `out` is too small.
+ */
+size_t bfp_decode(const void* in, size_t in_bytes, void* out, size_t out_capacity);
+
+/**
+ * @brief Signal-to-quantization-noise ratio of `decoded` against `reference`, in dB.
+ * @return +INFINITY when the two are identical.
+ */
+double bfp_sqnr_db(const int16_t* reference, const int16_t* decoded, size_t values);
+
+#endif // BFP_H
@@ -0,0 +1,60 @@
+// =================================================================================================
+// File: capture_async.cpp
+// Description: Implementation of the awaitable capture slots.
+// =================================================================================================
+
+#include <cstdio>
+#include "capture_async.hpp"
+#include "app_config.h"
+
+// --- Internal Helpers ---
+
+void CaptureSlots::on_completion(void* context, const RhDmaCompletion& done) {
+    CaptureSlots* self = static_cast<CaptureSlots*>(context);
+    if (self->failed_) return;
+
+    // Landed slots are unreleased, so there are never more than the ring holds.
+    CaptureSlot slot;
+    if (self->count_ == self->landed_.size() || capture_session_complete(self->session_, &done, &slot) != 1) {
+        self->failed_ = true;
+    } else {
+        self->landed_[(self->head_ + self->count_) % self->landed_.size()] = slot;
+        self->count_++;
+    }
+    if (self->waiter_) {
+        self->loop_.schedule(self->waiter_);
+        self->waiter_ = {};
+    }
+}
+
+bool CaptureSlots::must_wait() const {
+    const CaptureSession* s = session_;
+    return count_ == 0 && !failed_ && s->packets_completed < s->total_packets &&
+           s->packets_started != s->packets_completed;
+}
+
+int CaptureSlots::take(CaptureSlot* out) {
+    if (count_ > 0) {
+        *out = landed_[head_];
+        head_ = (head_ + 1) % landed_.size();
+        count_--;
+        return 1;
+    }
+    if (failed_) return -1;
+    if (session_->packets_completed >= session_->total_packets) return 0;
+    printf("  ERROR: All %u ring slots are held by the consumer; release slots before requesting more.\n",
+           session_->config.ring_slots);
+    return -1;
+}
+
+
+// --- Public API ---
+
+CaptureSlots::CaptureSlots(rhdma::EventLoop& loop, CaptureSession* session)
+    : loop_(loop), session_(session), landed_(session->config.ring_slots) {
+    loop_.route_streams((1U << CAPTURE_STREAM_CHANNELS) - 1, &CaptureSlots::on_completion, this);
+}
+
+CaptureSlots::~CaptureSlots() {
+    loop_.route_streams(0, nullptr, nullptr);
+}
@@ -0,0 +1,77 @@
+// =================================================================================================
+// File: capture_async.hpp
+// Description: Lets coroutines on a radiohound-dma EventLoop `co_await` the slots of a capture
+//              session.
+//
+// The session still submits its own stream transfers; the loop routes their completions here by
+// TDEST, so memory-to-memory transfers and sleeps awaited by other coroutines share the same loop
+// and interrupt fd. Each completion is turned into a slot (and the stream source restarted) as soon
+// as the loop sees it, even while the consumer coroutine is busy; landed slots wait in order until
+// it asks for them.
+// =================================================================================================
+
+#ifndef CAPTURE_ASYNC_HPP
+#define CAPTURE_ASYNC_HPP
+
+#include <coroutine>
+#include <vector>
+#include "capture_session.h"
+#include "radiohound_dma_async.hpp"
+
+class CaptureSlots {
+public:
+    /**
+     * @brief Awaitable returned by next(); resumes with capture_session_next_slot()'s result:
+     *        1 if a slot was returned, 0 once the whole capture has been delivered, -1 on error.
+     */
+    class NextSlot {
+    public:
+        NextSlot(CaptureSlots& slots, CaptureSlot* out) : slots_(slots), out_(out) {}
+        bool await_ready() const noexcept { return !slots_.must_wait(); }
+        void await_suspend(std::coroutine_handle<> waiter) noexcept { slots_.waiter_ = waiter; }
+        int await_resume() { return slots_.take(out_); }
+
+    private:
+        CaptureSlots& slots_;
+        CaptureSlot*  out_;
+    };
+
+    /**
+     * @brief Routes the session's TDEST channels on `loop` to this object. The session must have
+     *        been initialized; start it (which resets the DMA) before the loop submits anything else.
+     */
+    CaptureSlots(rhdma::EventLoop& loop, CaptureSession* session);
+
+    /**
+     * @brief Removes the route. The session is not stopped.
+     */
+    ~CaptureSlots();
+
+    CaptureSlots(const CaptureSlots&) = delete;
+    CaptureSlots& operator=(const CaptureSlots&) = delete;
+
+    /**
+     * @brief Waits for the next slot of the capture. Only one coroutine may wait at a time.
+     */
+    NextSlot next(CaptureSlot* slot) { return NextSlot(*this, slot); }
+
+    /**
+     * @brief Hands a slot back to the ring, in the order received (see capture_session_release_slot()).
+     */
+    int release(const CaptureSlot* slot) { return capture_session_release_slot(session_, slot); }
+
+private:
+    static void on_completion(void* context, const RhDmaCompletion& done);
+    bool must_wait() const;
+    int take(CaptureSlot* out);
+
+    rhdma::EventLoop&        loop_;
+    CaptureSession*          session_;
+    std::vector<CaptureSlot> landed_;   // Ring of slots completed but not yet taken
+    size_t                   head_ = 0;
+    size_t                   count_ = 0;
+    bool                     failed_ = false;
+    std::coroutine_handle<>  waiter_;
+};
+
+#endif // CAPTURE_ASYNC_HPP
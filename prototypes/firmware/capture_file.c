@@ -0,0 +1,266 @@
+// =================================================================================================
+// File: capture_file.c
+// Description: Implementation of the indexed capture container writer and mmap reader.
+// =================================================================================================
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "capture_file.h"
+#include "crc32c.h"
+
+// --- Internal Helpers ---
+
+static void fill_header(CaptureFileHeader* header, uint32_t magic, const CaptureFileConfig* config) {
+    struct timespec now;
+    memset(header, 0, sizeof(*header));
+    header->magic = magic;
+    header->version = CAPTURE_FILE_VERSION;
+    header->record_bytes = sizeof(CaptureChunkRecord);
+    header->bytes_per_sample = config->bytes_per_sample;
+    header->sample_rate = config->sample_rate;
+    header->center_frequency = config->center_frequency;
+    clock_gettime(CLOCK_REALTIME, &now);
+    header->created_clock_ns = capture_clock_ns();
+    header->created_realtime_ns = (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+}
+
+static int map_file(const char* path, int* fd, const uint8_t** map, size_t* bytes) {
+    struct stat st;
+    *fd = open(path, O_RDONLY);
+    if (*fd < 0) {
+        perror("Capture file: failed to open");
+        return -1;
+    }
+    if (fstat(*fd, &st) != 0 || st.st_size < (off_t)sizeof(CaptureFileHeader)) {
+        fprintf(stderr, "Capture file: %s is too short\n", path);
+        return -1;
+    }
+    void* p = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, *fd, 0);
+    if (p == MAP_FAILED) {
+        perror("Capture file: failed to map");
+        return -1;
+    }
+    *map = p;
+    *bytes = (size_t)st.st_size;
+    return 0;
+}
+
+static int header_valid(const CaptureFileHeader* header, uint32_t magic) {
+    return header->magic == magic && header->version == CAPTURE_FILE_VERSION &&
+           header->record_bytes == sizeof(CaptureChunkRecord) && header->bytes_per_sample != 0;
+}
+
+// The CRC is stored as given; writers without checksums pass 0 and leave the flag clear.
+static int append_chunk(CaptureFileWriter* writer, const void* data, size_t bytes, uint64_t first_sample,
+                        uint64_t timestamp_ns, uint32_t sequence, uint32_t crc) {
+    CaptureChunkRecord record = {
+        .file_offset = writer->data_offset,
+        .first_sample = first_sample,
+        .timestamp_ns = timestamp_ns,
+        .bytes = (uint32_t)bytes,
+        .crc32c = crc,
+        .sequence = sequence,
+        .flags = writer->checksum ? CAPTURE_CHUNK_CRC : 0,
+    };
+    if (writer->chunks > 0 && first_sample != writer->next_sample) record.flags |= CAPTURE_CHUNK_GAP;
+
+    if (recorder_write(&writer->data, data, bytes) != 0 || fwrite(&record, sizeof(record), 1, writer->index) != 1) {
+        writer->error = 1;
+        return -1;
+    }
+    writer->data_offset += bytes;
+    writer->next_sample = first_sample + bytes / writer->bytes_per_sample;
+    writer->chunks++;
+    return 0;
+}
+
+
+// --- Public API ---
+
+void capture_file_config_default(CaptureFileConfig* config, double sample_rate, double center_frequency) {
+    config->sample_rate = sample_rate;
+    config->center_frequency = center_frequency;
+    config->bytes_per_sample = 4;
+    config->checksum = 1;
+    config->backend = RECORDER_BACKEND_IO_URING;
+}
+
+int capture_file_open(CaptureFileWriter* writer, const char* path, const CaptureFileConfig* config) {
+    char index_path[CAPTURE_FILE_PATH_LEN];
+    RecorderConfig rec_config;
+    CaptureFileHeader header;
+
+    memset(writer, 0, sizeof(*writer));
+    crc32c_init();
+    if (config->bytes_per_sample == 0) {
+        fprintf(stderr, "Capture file: bytes per sample must be positive\n");
+        return -1;
+    }
+    if (snprintf(index_path, sizeof(index_path), "%s.idx", path) >= (int)sizeof(index_path)) {
+        fprintf(stderr, "Capture file: path too long\n");
+        return -1;
+    }
+    // The header goes through the recorder like the payloads, so it has to meet O_DIRECT alignment.
+    if (posix_memalign((void**)&writer->header_page, RECORDER_ALIGNMENT, CAPTURE_FILE_HEADER_BYTES) != 0) {
+        fprintf(stderr, "Capture file: failed to allocate the header page\n");
+        writer->header_page = NULL;
+        return -1;
+    }
+
+    recorder_config_default(&rec_config, config->backend);
+    if (recorder_open(&writer->data, path, &rec_config) != 0) {
+        free(writer->header_page);
+        writer->header_page = NULL;
+        return -1;
+    }
+    writer->index = fopen(index_path, "wb");
+    if (!writer->index) {
+        perror("Capture file: failed to open index");
+        recorder_close(&writer->data, NULL);
+        free(writer->header_page);
+        writer->header_page = NULL;
+        return -1;
+    }
+
+    writer->checksum = config->checksum;
+    writer->bytes_per_sample = config->bytes_per_sample;
+    writer->data_offset = CAPTURE_FILE_HEADER_BYTES;
+
+    fill_header(&header, CAPTURE_FILE_MAGIC, config);
+    memset(writer->header_page, 0, CAPTURE_FILE_HEADER_BYTES);
+    memcpy(writer->header_page, &header, sizeof(header));
+    header.magic = CAPTURE_INDEX_MAGIC;
+    if (recorder_write(&writer->data, writer->header_page, CAPTURE_FILE_HEADER_BYTES) != 0 ||
+        fwrite(&header, sizeof(header), 1, writer->index) != 1) {
+        fprintf(stderr, "Capture file: failed to write the headers\n");
+        capture_file_close(writer, NULL);
+        return -1;
+    }
+    return 0;
+}
+
+int capture_file_append(CaptureFileWriter* writer, const void* data, size_t bytes, uint64_t first_sample,
+                        uint64_t timestamp_ns, uint32_t sequence) {
+    uint32_t crc = writer->checksum ? crc32c(data, bytes) : 0;
+    return append_chunk(writer, data, bytes, first_sample, timestamp_ns, sequence, crc);
+}
+
+int capture_file_append_slot(CaptureFileWriter* writer, const CaptureSlot* slot) {
+    const uint64_t first_sample = slot->stream_offset / writer->bytes_per_sample;
+    if (!writer->checksum || !(slot->flags & CAPTURE_SLOT_CRC)) {
+        return capture_file_append(writer, slot->data, slot->length, first_sample, slot->timestamp_ns, slot->sequence);
+    }
+
+    // The index keeps the CRC taken at completion, so a reader checks the payload against the DMA
+    // output itself rather than against whatever reached the writer.
+    if (crc32c(slot->data, slot->length) != slot->crc32c) {
+        fprintf(stderr, "Capture file: slot %u changed since completion (CRC32C mismatch)\n", slot->sequence);
+        writer->crc_errors++;
+    }
+    return append_chunk(writer, slot->data, slot->length, first_sample, slot->timestamp_ns, slot->sequence,
+                        slot->crc32c);
+}
+
+uint64_t capture_file_retired(const CaptureFileWriter* writer) {
+    const uint64_t retired = recorder_retired(&writer->data);
+    return retired > 0 ? retired - 1 : 0; // Not counting the header page
+}
+
+int capture_file_close(CaptureFileWriter* writer, RecorderStats* stats) {
+    int rc = writer->error ? -1 : 0;
+
+    if (recorder_close(&writer->data, stats) != 0) rc = -1;
+    if (stats) stats->crc_errors += writer->crc_errors;
+    if (writer->index) {
+        if (fflush(writer->index) != 0 || fdatasync(fileno(writer->index)) != 0) rc = -1;
+        if (fclose(writer->index) != 0) rc = -1;
+        writer->index = NULL;
+    }
+    free(writer->header_page);
+    writer->header_page = NULL;
+    return rc;
+}
+
+int capture_reader_open(CaptureFileReader* reader, const char* path) {
+    char index_path[CAPTURE_FILE_PATH_LEN];
+
+    memset(reader, 0, sizeof(*reader));
+    crc32c_init();
+    reader->data_fd = -1;
+    reader->index_fd = -1;
+    if (snprintf(index_path, sizeof(index_path), "%s.idx", path) >= (int)sizeof(index_path)) {
+        fprintf(stderr, "Capture file: path too long\n");
+        return -1;
+    }
+    if (map_file(path, &reader->data_fd, &reader->data, &reader->data_bytes) != 0 ||
+        map_file(index_path, &reader->index_fd, &reader->index_map, &reader->index_bytes) != 0) {
+        capture_reader_close(reader);
+        return -1;
+    }
+
+    const CaptureFileHeader* data_header = (const CaptureFileHeader*)reader->data;
+    reader->header = (const CaptureFileHeader*)reader->index_map;
+    if (!header_valid(data_header, CAPTURE_FILE_MAGIC) || !header_valid(reader->header, CAPTURE_INDEX_MAGIC)) {
+        fprintf(stderr, "Capture file: %s is not a version %d capture\n", path, CAPTURE_FILE_VERSION);
+        capture_reader_close(reader);
+        return -1;
+    }
+    reader->records = (const CaptureChunkRecord*)(reader->index_map + sizeof(CaptureFileHeader));
+    reader->chunks = (reader->index_bytes - sizeof(CaptureFileHeader)) / sizeof(CaptureChunkRecord);
+    return 0;
+}
+
+int64_t capture_reader_find_sample(const CaptureFileReader* reader, uint64_t sample) {
+    // Last chunk starting at or before the sample.
+    uint64_t lo = 0, hi = reader->chunks;
+    while (lo < hi) {
+        uint64_t mid = lo + (hi - lo) / 2;
+        if (reader->records[mid].first_sample <= sample) lo = mid + 1;
+        else hi = mid;
+    }
+    if (lo == 0) return -1;
+    const CaptureChunkRecord* r = &reader->records[lo - 1];
+    return sample < r->first_sample + r->bytes / reader->header->bytes_per_sample ? (int64_t)(lo - 1) : -1;
+}
+
+int64_t capture_reader_find_time(const CaptureFileReader* reader, uint64_t time_ns) {
+    uint64_t lo = 0, hi = reader->chunks;
+    while (lo < hi) {
+        uint64_t mid = lo + (hi - lo) / 2;
+        if (reader->records[mid].timestamp_ns < time_ns) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo < reader->chunks ? (int64_t)lo : -1;
+}
+
+const void* capture_reader_chunk_data(const CaptureFileReader* reader, uint64_t chunk) {
+    if (chunk >= reader->chunks) return NULL;
+    const CaptureChunkRecord* r = &reader->records[chunk];
+    if (r->file_offset < CAPTURE_FILE_HEADER_BYTES || r->file_offset > reader->data_bytes ||
+        r->bytes > reader->data_bytes - r->file_offset) {
+        return NULL; // Index written ahead of a payload that never reached the disk
+    }
+    return reader->data + r->file_offset;
+}
+
+int capture_reader_verify_chunk(const CaptureFileReader* reader, uint64_t chunk) {
+    const void* data = capture_reader_chunk_data(reader, chunk);
+    if (!data || !(reader->records[chunk].flags & CAPTURE_CHUNK_CRC)) return -1;
+    return crc32c(data, reader->records[chunk].bytes) == reader->records[chunk].crc32c;
+}
+
+void capture_reader_close(CaptureFileReader* reader) {
+    if (reader->data) munmap((void*)reader->data, reader->data_bytes);
+    if (reader->index_map) munmap((void*)reader->index_map, reader->index_bytes);
+    if (reader->data_fd >= 0) close(reader->data_fd);
+    if (reader->index_fd >= 0) close(reader->index_fd);
+    memset(reader, 0, sizeof(*reader));
+    reader->data_fd = -1;
+    reader->index_fd = -1;
+}
@@ -0,0 +1,175 @@
+// =================================================================================================
+// File: capture_file.h
+// Description: Indexed capture container that is written straight from DMA slots and read back
+//              through mmap with O(log n) seeks by sample index or time.
+//
+// A capture is two files. <path> holds a one-page header followed by the chunk payloads exactly
+// as they were written, so the recorder's O_DIRECT/io_uring path applies unchanged. <path>.idx
+// holds a small header followed by one fixed-size record per chunk: where the payload lives, its
+// first sample, its completion timestamp, a CRC32C and flags. Records are appended as chunks are
+// queued and the index needs no finishing pass, so a recording cut short by a crash or power loss
+// stays readable up to its last complete record.
+//
+// Records are in stream order, so both sample indices and timestamps increase along the index and
+// a reader finds the chunk holding any sample or instant with a binary search over the mapped
+// records, touching a handful of pages however long the recording is.
+// =================================================================================================
+
+#ifndef CAPTURE_FILE_H
+#define CAPTURE_FILE_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include "capture_session.h"
+#include "recorder.h"
+
+// --- Configuration ---
+
+#define CAPTURE_FILE_MAGIC        0x31504143 // "CAP1", data file
+#define CAPTURE_INDEX_MAGIC       0x31584943 // "CIX1", index file
+#define CAPTURE_FILE_VERSION      1
+#define CAPTURE_FILE_HEADER_BYTES RECORDER_ALIGNMENT // Payloads start on a page boundary
+#define CAPTURE_FILE_PATH_LEN     256
+
+#define CAPTURE_CHUNK_CRC         0x1 // crc32c covers the payload
+#define CAPTURE_CHUNK_GAP         0x2 // Samples are missing before this chunk
+
+typedef struct {
+    double          sample_rate;      // Nominal samples per second, informational
+    double          center_frequency; // Hz, informational
+    uint32_t        bytes_per_sample; // 4 for complex int16
+    int             checksum;         // Compute a CRC32C per chunk (reads every payload once)
+    RecorderBackend backend;          // Backend used for the data file
+} CaptureFileConfig;
+
+/**
+ * @brief Header at the start of both files (little-endian). The data file pads it to one page.
+ */
+typedef struct __attribute__((packed)) {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t record_bytes;     // sizeof(CaptureChunkRecord)
+    uint32_t bytes_per_sample;
+    uint32_t reserved;
+    double   sample_rate;
+    double   center_frequency;
+    uint64_t created_realtime_ns; // CLOCK_REALTIME at open...
+    uint64_t created_clock_ns;    // ...and capture_clock_ns() at the same moment
+} CaptureFileHeader;
+
+/**
+ * @brief One chunk of the index (little-endian).
+ */
+typedef struct __attribute__((packed)) {
+    uint64_t file_offset;   // Payload position in the data file
+    uint64_t first_sample;  // Stream sample index of the payload's first sample
+    uint64_t timestamp_ns;  // capture_clock_ns() when the chunk's last sample completed
+    uint32_t bytes;
+    uint32_t crc32c;
+    uint32_t sequence;      // Slot sequence number
+    uint32_t flags;         // CAPTURE_CHUNK_*
+} CaptureChunkRecord;
+
+typedef struct {
+    Recorder  data;
+    FILE*     index;
+    uint8_t*  header_page;      // Aligned buffer for the data file header
+    int       checksum;
+    uint32_t  bytes_per_sample;
+    uint64_t  data_offset;      // File offset of the next payload
+    uint64_t  next_sample;      // Sample following the last chunk, for gap detection
+    uint64_t  chunks;
+    uint64_t  crc_errors;       // Slots whose data no longer matched their completion CRC32C
+    int       error;
+} CaptureFileWriter;
+
+typedef struct {
+    int                       data_fd;
+    int                       index_fd;
+    const uint8_t*            data;
+    size_t                    data_bytes;
+    const uint8_t*            index_map;
+    size_t                    index_bytes;
+    const CaptureFileHeader*  header;
+    const CaptureChunkRecord* records;
+    uint64_t                  chunks;
+} CaptureFileReader;
+
+
+// --- Function Prototypes ---
+
+/**
+ * @brief Fills in a configuration: complex int16, checksums on, io_uring data path.
+ */
+void capture_file_config_default(CaptureFileConfig* config, double sample_rate, double center_frequency);
+
+/**
+ * @brief Creates <path> and <path>.idx and writes both headers.
+ * @return 0 on success, -1 on failure.
+ */
+int capture_file_open(CaptureFileWriter* writer, const char* path, const CaptureFileConfig* config);
+
+/**
+ * @brief Queues a payload and appends its index record. See recorder_write() for the alignment
+ *        rules of the O_DIRECT backends; unaligned chunks (e.g. trigger snippets) need the
+ *        PWRITE backend.
+ * @return 0 on success, -1 on failure.
+ */
+int capture_file_append(CaptureFileWriter* writer, const void* data, size_t bytes, uint64_t first_sample,
+                        uint64_t timestamp_ns, uint32_t sequence);
+
+/**
+ * @brief Queues a filled capture slot as one chunk. When the slot carries a completion CRC32C and
+ *        checksums are on, the payload is checked against it and the index records that CRC, so
+ *        capture_reader_verify_chunk() tests the stored data against what the DMA produced.
+ */
+int capture_file_append_slot(CaptureFileWriter* writer, const CaptureSlot* slot);
+
+/**
+ * @brief Number of appended chunks whose payload write has completed (see recorder_retired()).
+ */
+uint64_t capture_file_retired(const CaptureFileWriter* writer);
+
+/**
+ * @brief Finishes the data file and makes the index durable.
+ * @param stats Receives the data file statistics and the slot CRC mismatches (may be NULL).
+ * @return 0 on success, -1 if anything failed.
+ */
+int capture_file_close(CaptureFileWriter* writer, RecorderStats* stats);
+
+/**
+ * @brief Maps a capture and its index read-only. A trailing partial record is ignored.
+ * @return 0 on success, -1 if either file is missing or malformed.
+ */
+int capture_reader_open(CaptureFileReader* reader, const char* path);
+
+/**
+ * @brief Index of the chunk holding a stream sample.
+ * @return Chunk index, or -1 if the sample was not recorded.
+ */
+int64_t capture_reader_find_sample(const CaptureFileReader* reader, uint64_t sample);
+
+/**
+ * @brief Index of the first chunk that completed at or after `time_ns` (capture clock), i.e. the
+ *        chunk being captured at that instant.
+ * @return Chunk index, or -1 if the recording ended before `time_ns`.
+ */
+int64_t capture_reader_find_time(const CaptureFileReader* reader, uint64_t time_ns);
+
+/**
+ * @brief Payload of a chunk inside the mapping, or NULL if the record points outside the file.
+ */
+const void* capture_reader_chunk_data(const CaptureFileReader* reader, uint64_t chunk);
+
+/**
+ * @brief Checks a chunk's payload against its CRC32C.
+ * @return 1 if it matches, 0 if it does not, -1 if the chunk has no checksum or no payload.
+ */
+int capture_reader_verify_chunk(const CaptureFileReader* reader, uint64_t chunk);
+
+/**
+ * @brief Unmaps and closes both files.
+ */
+void capture_reader_close(CaptureFileReader* reader);
+
+#endif // CAPTURE_FILE_H
@@ -0,0 +1,250 @@
+// =================================================================================================
+// File: capture_session.c
+// Description: Implementation of the segmented capture session.
+//
+// The stream source can only describe a packet of just under 16MB (and the DMA takes at most 8MB per
+// stream transaction), so a long capture is cut into packet-sized segments. Each segment owns one
+// slot of a ring in the udmabuf region and is submitted to the DMA library as one stream transfer
+// into that slot. Consecutive packets alternate between two TDEST channels: while packet N streams
+// on one channel, the transfer for packet N+1 is already armed on the other, so restarting after a
+// completion is a single register write to the stream source. That write still has to wait for the
+// completion: the source has no way to queue a second packet, so it idles between packets for the
+// interrupt and the wakeup that delivers it (see restart_ns_* in CaptureSession).
+// =================================================================================================
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "capture_session.h"
+#include "app_config.h"
+#include "crc32c.h"
+
+// --- Internal Helpers ---
+
+static size_t packet_length(const CaptureSession* session, uint32_t sequence) {
+    uint64_t offset = (uint64_t)sequence * session->config.packet_bytes;
+    uint64_t remaining = session->config.capture_bytes - offset;
+    return remaining < session->config.packet_bytes ? (size_t)remaining : session->config.packet_bytes;
+}
+
+static uint32_t slot_free(const CaptureSession* session, uint32_t sequence) {
+    return (sequence - session->packets_released) < session->config.ring_slots;
+}
+
+// Submits the stream transfer for a packet on the packet's TDEST channel; the library arms the
+// channel's descriptor straight away because the previous packet on it has completed.
+static int arm_packet(CaptureSession* session, uint32_t sequence) {
+    uint32_t ring_index = sequence % session->config.ring_slots;
+    RhDmaTransfer xfer = {
+        .kind = RH_DMA_STREAM_TO_MEM,
+        .stream = sequence % CAPTURE_STREAM_CHANNELS,
+        .dst_phys = session->ring_phys + (uintptr_t)ring_index * session->config.packet_bytes,
+        .bytes = (uint32_t)packet_length(session, sequence),
+        .user_data = sequence,
+    };
+    return rh_dma_submit(session->dma, &xfer, 1) == 1 ? 0 : -1;
+}
+
+// Arms transfers ahead of the stream source: the packet about to start and the one after it,
+// each on its own TDEST channel, as long as their ring slots have been released.
+static void arm_ahead(CaptureSession* session) {
+    while (session->packets_armed < session->total_packets &&
+           session->packets_armed <= session->packets_started &&
+           slot_free(session, session->packets_armed)) {
+        if (arm_packet(session, session->packets_armed) != 0) break;
+        session->packets_armed++;
+    }
+}
+
+// Starts the next packet if the source is idle and its transfer is armed.
+// Returns 1 if a packet was started.
+static int try_start_next(CaptureSession* session) {
+    uint32_t sequence = session->packets_started;
+
+    if (sequence != session->packets_completed) return 0;  // A packet is still in flight
+    if (sequence >= session->total_packets) return 0;      // Nothing left to capture
+
+    arm_ahead(session);
+    if (session->packets_armed <= sequence) return 0;      // Consumer still holds every slot
+
+    AxiStreamSource_Regs_t* src = session->stream_src_regs;
+    src->NUM_BYTES_REG = (uint32_t)packet_length(session, sequence);
+    src->DEST_REG = sequence % CAPTURE_STREAM_CHANNELS;
+    __sync_synchronize();
+    src->CONTROL_REG = 1; // Assert start bit
+    __sync_synchronize();
+    src->CONTROL_REG = 0; // De-assert start (it's a pulse)
+    session->packets_started++;
+
+    if (session->packets_completed > 0) {
+        uint64_t gap = capture_clock_ns() - session->completed_ns;
+        session->restart_ns_total += gap;
+        if (gap > session->restart_ns_max) session->restart_ns_max = gap;
+        session->restarts++;
+    }
+
+    arm_ahead(session);
+    return 1;
+}
+
+
+// --- Public API ---
+
+void capture_config_default(CaptureConfig* config, uint64_t capture_bytes) {
+    config->capture_bytes = capture_bytes;
+    config->packet_bytes = CAPTURE_DEFAULT_PACKET_BYTES;
+    config->ring_slots = (uint32_t)(CAPTURE_RING_BYTES / CAPTURE_DEFAULT_PACKET_BYTES);
+    config->checksum = CAPTURE_SLOT_CHECKSUM;
+}
+
+int capture_session_init(
+    CaptureSession* session,
+    const CaptureConfig* config,
+    RhDma* dma,
+    AxiStreamSource_Regs_t* stream_src_regs,
+    uintptr_t dma_phys_base,
+    uint8_t* dma_virt_base,
+    size_t dma_buffer_size)
+{
+    memset(session, 0, sizeof(*session));
+
+    if (config->packet_bytes == 0 || config->packet_bytes > CAPTURE_MAX_PACKET_BYTES) {
+        printf("  ERROR: Packet size %zu exceeds the stream source limit of %lu bytes.\n",
+               config->packet_bytes, (unsigned long)CAPTURE_MAX_PACKET_BYTES);
+        return -1;
+    }
+    if (config->packet_bytes > FDMA_MAX_STREAM_BYTES) {
+        printf("  ERROR: Packet size %zu exceeds the DMA stream transaction limit of %lu bytes.\n",
+               config->packet_bytes, (unsigned long)FDMA_MAX_STREAM_BYTES);
+        return -1;
+    }
+    if (config->packet_bytes % 4096 != 0) {
+        printf("  ERROR: Packet size %zu is not a multiple of the 4KB page size.\n", config->packet_bytes);
+        return -1;
+    }
+    if (config->capture_bytes == 0 || config->capture_bytes % STREAM_BEAT_BYTES != 0) {
+        printf("  ERROR: Capture length must be a non-zero multiple of %d bytes.\n", STREAM_BEAT_BYTES);
+        return -1;
+    }
+    if (config->ring_slots < CAPTURE_STREAM_CHANNELS || config->ring_slots > CAPTURE_MAX_RING_SLOTS) {
+        printf("  ERROR: Ring must have between %d and %d slots.\n", CAPTURE_STREAM_CHANNELS, CAPTURE_MAX_RING_SLOTS);
+        return -1;
+    }
+    if (CAPTURE_RING_OFFSET + (uint64_t)config->ring_slots * config->packet_bytes > dma_buffer_size) {
+        printf("  ERROR: %u slots of %zu bytes do not fit in the %zu byte DMA region.\n",
+               config->ring_slots, config->packet_bytes, dma_buffer_size);
+        return -1;
+    }
+
+    uint64_t total_packets = (config->capture_bytes + config->packet_bytes - 1) / config->packet_bytes;
+    if (total_packets > UINT32_MAX) {
+        printf("  ERROR: Capture of %llu bytes needs too many packets.\n", (unsigned long long)config->capture_bytes);
+        return -1;
+    }
+
+    session->dma = dma;
+    session->stream_src_regs = stream_src_regs;
+    session->ring_virt = dma_virt_base + CAPTURE_RING_OFFSET;
+    session->ring_phys = dma_phys_base + CAPTURE_RING_OFFSET;
+    session->config = *config;
+    session->total_packets = (uint32_t)total_packets;
+    crc32c_init();
+    return 0;
+}
+
+int capture_session_start(CaptureSession* session) {
+    // Nothing from an earlier user of the controller may complete into this session.
+    rh_dma_reset(session->dma);
+
+    if (!try_start_next(session)) {
+        printf("  ERROR: Could not start the first capture packet.\n");
+        return -1;
+    }
+    return 0;
+}
+
+int capture_session_next_slot(CaptureSession* session, CaptureSlot* slot) {
+    if (session->packets_completed >= session->total_packets) return 0;
+
+    if (session->packets_started == session->packets_completed) {
+        try_start_next(session);
+        if (session->packets_started == session->packets_completed) {
+            printf("  ERROR: All %u ring slots are held by the consumer; release slots before requesting more.\n",
+                   session->config.ring_slots);
+            return -1;
+        }
+    }
+
+    RhDmaCompletion done;
+    if (rh_dma_reap(session->dma, &done, 1, -1) != 1) return -1;
+    return capture_session_complete(session, &done, slot);
+}
+
+int capture_session_complete(CaptureSession* session, const RhDmaCompletion* done, CaptureSlot* slot) {
+    // Stamp before anything else so the restart below does not add to the latency.
+    slot->timestamp_ns = capture_clock_ns();
+    uint32_t sequence = session->packets_completed;
+    if (done->status != RH_DMA_STATUS_OK || done->user_data != sequence) {
+        printf("  ERROR: Packet %u completed with DMA status 0x%08X (expected packet %u).\n",
+               (uint32_t)done->user_data, done->irq_status, sequence);
+        return -1;
+    }
+    session->packets_completed++;
+    session->completed_ns = slot->timestamp_ns;
+
+    // Restart the source immediately so the next packet streams while the consumer works.
+    if (!try_start_next(session) && session->packets_started < session->total_packets) {
+        session->stalls++;
+    }
+
+    uint32_t ring_index = sequence % session->config.ring_slots;
+    slot->data = session->ring_virt + (size_t)ring_index * session->config.packet_bytes;
+    slot->phys_addr = session->ring_phys + (uintptr_t)ring_index * session->config.packet_bytes;
+    slot->length = packet_length(session, sequence);
+    slot->stream_offset = (uint64_t)sequence * session->config.packet_bytes;
+    slot->sequence = sequence;
+    slot->ring_index = ring_index;
+    slot->flags = 0;
+    if (session->config.checksum) capture_slot_checksum(slot);
+    return 1;
+}
+
+int capture_session_release_slot(CaptureSession* session, const CaptureSlot* slot) {
+    if (slot->sequence != session->packets_released) {
+        printf("  ERROR: Slot %u released out of order (expected %u).\n", slot->sequence, session->packets_released);
+        return -1;
+    }
+    session->packets_released++;
+
+    // If the source was stalled on this slot, get it going again; otherwise pre-arm the
+    // packet that was waiting for this slot.
+    if (!try_start_next(session)) arm_ahead(session);
+    return 0;
+}
+
+void capture_session_stop(CaptureSession* session) {
+    if (session->stream_src_regs) session->stream_src_regs->CONTROL_REG = 0;
+    if (session->dma) rh_dma_reset(session->dma);
+}
+
+void capture_slot_checksum(CaptureSlot* slot) {
+    slot->crc32c = crc32c(slot->data, slot->length);
+    slot->flags |= CAPTURE_SLOT_CRC;
+}
+
+int capture_slot_verify(const CaptureSlot* slot) {
+    if (!(slot->flags & CAPTURE_SLOT_CRC)) return -1;
+    return crc32c(slot->data, slot->length) == slot->crc32c;
+}
+
+uint64_t capture_clock_ns(void) {
+#if defined(__riscv)
+    uint64_t ticks;
+    __asm__ volatile ("rdtime %0" : "=r"(ticks));
+    return ticks / CAPTURE_TIMEBASE_HZ * 1000000000ULL + ticks % CAPTURE_TIMEBASE_HZ * 1000000000ULL / CAPTURE_TIMEBASE_HZ;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+#endif
+}
@@ -0,0 +1,161 @@
+// =================================================================================================
+// File: capture_session.h
+// Description: Segments a large capture into stream packets and presents the packets to consumers
+//              as one gapless logical stream of DMA slots.
+//
+// The logical stream has no holes, but the wire does: the stream source takes one packet per start
+// pulse and cannot queue the next, so packet N+1 is only started once the completion of packet N has
+// reached userspace, even though its DMA descriptor was armed long before. Every packet boundary
+// therefore idles the source for one interrupt plus one wakeup; the restart_* counters measure the
+// part of that gap spent between seeing the completion and pulsing the source.
+// =================================================================================================
+
+#ifndef CAPTURE_SESSION_H
+#define CAPTURE_SESSION_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "hw_platform.h"
+#include "radiohound_dma_api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// --- Data Types ---
+
+#define CAPTURE_SLOT_CRC 0x1 // CaptureSlot.crc32c is valid
+
+/**
+ * @brief One filled packet of the capture, as seen by consumers.
+ * Slots are delivered strictly in order and are contiguous in the logical stream:
+ * every slot starts at the byte where the previous one ended.
+ */
+typedef struct {
+    uint8_t*  data;          // Virtual address of the packet inside the udmabuf mapping
+    uintptr_t phys_addr;     // Physical address the DMA wrote the packet to
+    size_t    length;        // Number of valid bytes in this slot
+    uint64_t  stream_offset; // Byte offset of the first byte within the logical capture stream
+    uint32_t  sequence;      // Packet number within the session (0-based)
+    uint32_t  ring_index;    // Position in the slot ring (needed to release the slot)
+    uint64_t  timestamp_ns;  // capture_clock_ns() when the completion was seen (see time_model.h)
+    uint32_t  crc32c;        // CRC32C of data[0, length) at completion, if CAPTURE_SLOT_CRC is set
+    uint32_t  flags;         // CAPTURE_SLOT_* bits
+} CaptureSlot;
+
+/**
+ * @brief Parameters for a capture session.
+ */
+typedef struct {
+    uint64_t capture_bytes;  // Total number of bytes to capture (may exceed the ring size)
+    size_t   packet_bytes;   // Bytes per stream packet; one packet fills one ring slot
+    uint32_t ring_slots;     // Number of packet-sized slots in the ring
+    int      checksum;       // CRC32C each slot as it completes, for the sinks to verify
+} CaptureConfig;
+
+/**
+ * @brief State of a running capture session.
+ */
+typedef struct {
+    RhDma*                  dma;
+    AxiStreamSource_Regs_t* stream_src_regs;
+
+    uint8_t*                ring_virt;
+    uintptr_t               ring_phys;
+
+    CaptureConfig           config;
+    uint32_t                total_packets;
+    uint32_t                packets_armed;     // Packets whose transfer has been submitted
+    uint32_t                packets_started;   // Packets handed to the stream source
+    uint32_t                packets_completed; // Packets the DMA has finished writing
+    uint32_t                packets_released;  // Packets the consumer has handed back
+    uint32_t                stalls;            // Times the source idled waiting for a free slot
+    uint64_t                completed_ns;      // capture_clock_ns() when the last completion was seen
+    uint64_t                restart_ns_total;  // Sum of completion-seen-to-next-start gaps
+    uint64_t                restart_ns_max;    // Longest such gap (includes any stall)
+    uint32_t                restarts;          // Packets started after a completion
+} CaptureSession;
+
+
+// --- Function Prototypes ---
+
+/**
+ * @brief Fills in a configuration using the defaults from app_config.h.
+ * @param config Configuration to fill in.
+ * @param capture_bytes Total number of bytes to capture.
+ */
+void capture_config_default(CaptureConfig* config, uint64_t capture_bytes);
+
+/**
+ * @brief Validates the configuration and lays the slot ring out in the udmabuf region.
+ *        No hardware is touched until capture_session_start().
+ * @param dma Open DMA library handle; its stream descriptors must be DMA-visible.
+ * @return 0 on success, -1 if the configuration does not fit the hardware or the DMA region.
+ */
+int capture_session_init(
+    CaptureSession* session,
+    const CaptureConfig* config,
+    RhDma* dma,
+    AxiStreamSource_Regs_t* stream_src_regs,
+    uintptr_t dma_phys_base,
+    uint8_t* dma_virt_base,
+    size_t dma_buffer_size
+);
+
+/**
+ * @brief Drops anything left on the DMA and starts streaming the first packet.
+ * @return 0 on success, -1 on failure.
+ */
+int capture_session_start(CaptureSession* session);
+
+/**
+ * @brief Blocks until the next packet has landed and returns it as a slot.
+ * The following packet is started before this function returns, so the hardware keeps
+ * streaming while the consumer works on the returned slot.
+ * @return 1 if a slot was returned, 0 once the whole capture has been delivered, -1 on error.
+ */
+int capture_session_next_slot(CaptureSession* session, CaptureSlot* slot);
+
+/**
+ * @brief Turns a completion of one of the session's transfers into the next slot and restarts the
+ *        source, as capture_session_next_slot() does after it reaps. For callers that reap the DMA
+ *        themselves, such as the coroutine event loop (see capture_async.hpp).
+ * @return 1 if a slot was returned, -1 if the completion failed or is not the packet expected next.
+ */
+int capture_session_complete(CaptureSession* session, const RhDmaCompletion* done, CaptureSlot* slot);
+
+/**
+ * @brief Hands a slot back to the ring. Slots must be released in the order they were received.
+ * @return 0 on success, -1 if the slot is not the oldest outstanding one.
+ */
+int capture_session_release_slot(CaptureSession* session, const CaptureSlot* slot);
+
+/**
+ * @brief Stops the DMA and the stream source. Safe to call at any point after init.
+ */
+void capture_session_stop(CaptureSession* session);
+
+/**
+ * @brief Computes the slot's CRC32C and marks it valid. Called on completion when the session
+ *        checksums slots; sources that build slots themselves (e.g. replay) may call it too.
+ */
+void capture_slot_checksum(CaptureSlot* slot);
+
+/**
+ * @brief Checks the slot's contents against the CRC32C taken at completion.
+ * @return 1 if they match, 0 if the data changed since, -1 if the slot carries no CRC.
+ */
+int capture_slot_verify(const CaptureSlot* slot);
+
+/**
+ * @brief Reads the clock used for slot timestamps, in nanoseconds.
+ * On RISC-V this is the `rdtime` counter (CAPTURE_TIMEBASE_HZ), which needs no system call;
+ * elsewhere it is CLOCK_MONOTONIC_RAW. Neither is slewed by NTP.
+ */
+uint64_t capture_clock_ns(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CAPTURE_SESSION_H
@@ -0,0 +1,248 @@
+// =================================================================================================
+// File: cfar.c
+// Description: Implementation of the CA-/OS-CFAR spectrum detector.
+// =================================================================================================
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "cfar.h"
+
+// --- Internal Helpers ---
+
+static int16_t to_cdb(double linear) {
+    double cdb = 1000.0 * log10(linear > 0.0 ? linear : 1e-30);
+    if (cdb < -32768.0) return -32768;
+    if (cdb > 32767.0) return 32767;
+    return (int16_t)lround(cdb);
+}
+
+// Replaces one occurrence of `old` in a sorted window of `n` cells by `value`. Both positions come
+// from branch-free counts, and only the cells between them move.
+static void window_replace(float* w, unsigned n, float old, float value) {
+    unsigned from = 0, to = 0;
+    for (unsigned j = 0; j < n; ++j) {
+        from += w[j] < old;
+        to += w[j] < value;
+    }
+    if (to > from) {
+        to--; // `old` was counted below `value`
+        memmove(w + from, w + from + 1, (to - from) * sizeof(*w));
+    } else {
+        memmove(w + to + 1, w + to, (from - to) * sizeof(*w));
+    }
+    w[to] = value;
+}
+
+// Both estimators read `padded`, the spectrum with guard + training bins of wrap-around on each
+// side, so bin i's cells are plain offsets from padded[i + guard + training].
+static void estimate_noise_ca(CfarDetector* d, const float* padded, unsigned n) {
+    const unsigned g = d->config.guard_cells, t = d->config.training_cells;
+    const float* left_cells = padded;                  // Bins i - g - t .. i - g - 1
+    const float* right_cells = padded + t + 2 * g + 1; // Bins i + g + 1 .. i + g + t
+    double left = 0.0, right = 0.0;
+    for (unsigned j = 0; j < t; ++j) {
+        left += left_cells[j];
+        right += right_cells[j];
+    }
+    const double scale = 1.0 / (2.0 * t);
+    for (unsigned i = 0; i < n; ++i) {
+        d->noise[i] = (float)((left + right) * scale);
+        left += left_cells[i + t] - left_cells[i];
+        right += right_cells[i + t] - right_cells[i];
+    }
+}
+
+static void estimate_noise_os(CfarDetector* d, const float* padded, unsigned n) {
+    const unsigned g = d->config.guard_cells, t = d->config.training_cells;
+    const float* left_cells = padded;
+    const float* right_cells = padded + t + 2 * g + 1;
+    float* w = d->window;
+    for (unsigned j = 0; j < t; ++j) {
+        w[2 * j] = left_cells[j];
+        w[2 * j + 1] = right_cells[j];
+    }
+    for (unsigned i = 1; i < 2 * t; ++i) {
+        float key = w[i];
+        unsigned j = i;
+        while (j > 0 && w[j - 1] > key) {
+            w[j] = w[j - 1];
+            --j;
+        }
+        w[j] = key;
+    }
+    for (unsigned i = 0; i < n; ++i) {
+        d->noise[i] = w[d->rank];
+        window_replace(w, 2 * t, left_cells[i], left_cells[i + t]);
+        window_replace(w, 2 * t, right_cells[i], right_cells[i + t]);
+    }
+}
+
+// Appends a detection, or replaces the weakest one when the list is full.
+static void add_detection(CfarDetector* d, const CfarDetection* det, int* overflowed) {
+    CfarReport* r = d->report;
+    if (r->count < d->config.max_detections) {
+        r->detections[r->count++] = *det;
+        return;
+    }
+    *overflowed = 1;
+    unsigned weakest = 0;
+    for (unsigned k = 1; k < r->count; ++k) {
+        if (r->detections[k].snr_cdb < r->detections[weakest].snr_cdb) weakest = k;
+    }
+    if (det->snr_cdb > r->detections[weakest].snr_cdb) r->detections[weakest] = *det;
+}
+
+// Reports a run of `width` detected bins at its strongest bin.
+static void add_run(CfarDetector* d, const float* p, unsigned peak, unsigned width, float peak_ratio,
+                    int* overflowed) {
+    CfarDetection det = {
+        .bin = (uint16_t)peak,
+        .width = (uint16_t)width,
+        .power_cdb = to_cdb(p[peak]),
+        .snr_cdb = to_cdb(peak_ratio),
+    };
+    add_detection(d, &det, overflowed);
+}
+
+static void sort_by_bin(CfarDetection* det, unsigned count) {
+    for (unsigned i = 1; i < count; ++i) {
+        CfarDetection key = det[i];
+        unsigned j = i;
+        while (j > 0 && det[j - 1].bin > key.bin) {
+            det[j] = det[j - 1];
+            --j;
+        }
+        det[j] = key;
+    }
+}
+
+
+// --- Public API Functions ---
+
+void cfar_config_default(CfarConfig* config) {
+    config->method = CFAR_CELL_AVERAGING;
+    config->guard_cells = 2;
+    config->training_cells = 16;
+    config->threshold_db = 10.0;
+    config->os_rank = 0.75;
+    config->max_detections = 64;
+}
+
+const char* cfar_method_name(CfarMethod method) {
+    return method == CFAR_ORDERED_STATISTIC ? "OS-CFAR" : "CA-CFAR";
+}
+
+size_t cfar_report_bytes(unsigned count) {
+    return sizeof(CfarReport) + count * sizeof(CfarDetection);
+}
+
+int cfar_init(CfarDetector* detector, const CfarConfig* config, CfarCallback callback, void* user) {
+    memset(detector, 0, sizeof(*detector));
+    if (config->training_cells == 0 || config->training_cells > CFAR_MAX_TRAINING_CELLS ||
+        config->max_detections == 0 || config->max_detections > CFAR_MAX_DETECTIONS ||
+        config->os_rank < 0.0 || config->os_rank > 1.0) {
+        printf("ERROR: Invalid CFAR configuration (%u training cells, %u detections, rank %.2f).\n",
+               config->training_cells, config->max_detections, config->os_rank);
+        return -1;
+    }
+
+    detector->report = malloc(cfar_report_bytes(config->max_detections));
+    detector->window = malloc(2 * config->training_cells * sizeof(*detector->window));
+    if (!detector->report || !detector->window) {
+        perror("Failed to allocate CFAR buffers");
+        cfar_free(detector);
+        return -1;
+    }
+    detector->config = *config;
+    detector->threshold = pow(10.0, config->threshold_db / 10.0);
+    detector->rank = (unsigned)lround(config->os_rank * (2 * config->training_cells - 1));
+    detector->callback = callback;
+    detector->user = user;
+    return 0;
+}
+
+int cfar_process_frame(CfarDetector* d, const PsdFrame* frame) {
+    const unsigned n = frame->fft_size;
+    const float* p = frame->bins;
+    if (n < 2 * (d->config.guard_cells + d->config.training_cells) + 1) {
+        printf("ERROR: %u bins are too few for %u guard and %u training cells.\n",
+               n, d->config.guard_cells, d->config.training_cells);
+        return -1;
+    }
+    // Buffers follow the frame size, which is fixed for a PSD engine.
+    const unsigned margin = d->config.guard_cells + d->config.training_cells;
+    if (n > d->capacity) {
+        free(d->noise);
+        free(d->padded);
+        d->noise = malloc(n * sizeof(*d->noise));
+        d->padded = malloc((n + 2 * margin + 1) * sizeof(*d->padded));
+        d->capacity = d->noise && d->padded ? n : 0;
+        if (!d->capacity) {
+            perror("Failed to allocate CFAR noise estimate");
+            return -1;
+        }
+    }
+
+    memcpy(d->padded, p + n - margin, margin * sizeof(*p));
+    memcpy(d->padded + margin, p, n * sizeof(*p));
+    memcpy(d->padded + margin + n, p, (margin + 1) * sizeof(*p));
+    if (d->config.method == CFAR_ORDERED_STATISTIC) {
+        estimate_noise_os(d, d->padded, n);
+    } else {
+        estimate_noise_ca(d, d->padded, n);
+    }
+
+    CfarReport* r = d->report;
+    r->sequence = frame->sequence;
+    r->first_sample = frame->first_sample;
+    r->fft_size = (uint16_t)n;
+    r->count = 0;
+
+    int overflowed = 0;
+    const float threshold = (float)d->threshold;
+
+    // The spectrum is circular, so a run through bin n-1 continues at bin 0. Start the scan at
+    // the first bin below the threshold and go once around, ending on that bin, so a wrapped
+    // run is reported once; it then comes last and the list is sorted back into bin order.
+    unsigned start = 0;
+    while (start < n && p[start] > threshold * d->noise[start]) start++;
+    if (start == n) start = n - 1; // Every bin is a hit: one run, closed after the loop
+
+    unsigned run = 0, peak = 0;
+    float peak_ratio = 0.0f;
+    for (unsigned j = 1; j <= n; ++j) {
+        const unsigned i = (start + j) % n;
+        if (p[i] > threshold * d->noise[i]) {
+            const float ratio = p[i] / d->noise[i];
+            if (run == 0 || p[i] > p[peak]) {
+                peak = i;
+                peak_ratio = ratio;
+            }
+            run++;
+        } else if (run) {
+            add_run(d, p, peak, run, peak_ratio, &overflowed);
+            run = 0;
+        }
+    }
+    if (run) add_run(d, p, peak, run, peak_ratio, &overflowed);
+    if (overflowed || start > 0) sort_by_bin(r->detections, r->count);
+
+    if (d->callback) d->callback(r, cfar_report_bytes(r->count), d->user);
+    d->frames++;
+    d->detections += r->count;
+    return r->count;
+}
+
+void cfar_free(CfarDetector* detector) {
+    free(detector->report);
+    free(detector->window);
+    free(detector->noise);
+    free(detector->padded);
+    detector->report = NULL;
+    detector->window = NULL;
+    detector->noise = NULL;
+    detector->padded = NULL;
+    detector->capacity = 0;
+}
@@ -0,0 +1,120 @@
+// =================================================================================================
+// File: cfar.h
+// Description: CFAR detector that turns PSD frames into compact lists of detected signals.
+//
+// For every bin the noise level is estimated from `training_cells` bins on each side, skipping
+// `guard_cells` bins next to the bin under test so a signal does not raise its own estimate.
+// Cell-averaging (CA) uses the mean of the training cells and runs in O(bins) with sliding sums;
+// ordered-statistic (OS) uses the k-th smallest training cell, which is not pulled up by a strong
+// neighbouring signal, at O(bins * training_cells) with a sorted sliding window. A bin exceeding
+// the estimate by the threshold is detected; a run of adjacent detected bins is reported once, at
+// its strongest bin. The spectrum is treated as circular, matching complex baseband where -fs/2
+// and +fs/2 meet: training cells wrap around the ends, and a run through the last bin and bin 0 is
+// one detection.
+//
+// Each frame produces one small little-endian report (20 bytes plus 8 per detection), so a busy
+// 4096-bin spectrum shrinks from 16 KB of floats to a few hundred bytes.
+// =================================================================================================
+
+#ifndef CFAR_H
+#define CFAR_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "psd.h"
+
+// --- Configuration ---
+
+#define CFAR_MAX_TRAINING_CELLS 128 // Per side
+#define CFAR_MAX_DETECTIONS     1024
+
+typedef enum {
+    CFAR_CELL_AVERAGING,
+    CFAR_ORDERED_STATISTIC
+} CfarMethod;
+
+typedef struct {
+    CfarMethod method;
+    unsigned   guard_cells;    // Per side, next to the bin under test
+    unsigned   training_cells; // Per side
+    double     threshold_db;   // Detection when power exceeds the noise estimate by this much
+    double     os_rank;        // OS-CFAR: training cell percentile used as the estimate (0-1)
+    unsigned   max_detections; // Per frame; the strongest are kept when there are more
+} CfarConfig;
+
+/**
+ * @brief One detected signal. `bin` is in FFT-shifted order (bin 0 is -fs/2).
+ */
+typedef struct __attribute__((packed)) {
+    uint16_t bin;       // Strongest bin of the run
+    uint16_t width;     // Adjacent bins above the threshold
+    int16_t  power_cdb; // Peak power, 0.01 dB relative to full scale per Hz
+    int16_t  snr_cdb;   // Peak power over the noise estimate, 0.01 dB
+} CfarDetection;
+
+/**
+ * @brief Report for one PSD frame, followed by `count` detections in bin order.
+ */
+typedef struct __attribute__((packed)) {
+    uint64_t      sequence;     // PSD frame sequence number
+    uint64_t      first_sample; // Stream sample index where the frame starts
+    uint16_t      fft_size;     // 0 means 65536
+    uint16_t      count;
+    CfarDetection detections[];
+} CfarReport;
+
+typedef void (*CfarCallback)(const CfarReport* report, size_t bytes, void* user);
+
+typedef struct {
+    CfarConfig   config;
+    double       threshold;  // Linear power ratio for threshold_db
+    unsigned     rank;       // OS-CFAR: index into the sorted training cells
+    float*       noise;      // Noise estimate per bin
+    float*       padded;     // Frame with wrap-around margins for the training cells
+    float*       window;     // OS-CFAR: sorted training cells
+    unsigned     capacity;   // Bins the buffers hold
+    CfarReport*  report;
+    CfarCallback callback;
+    void*        user;
+    uint64_t     frames;
+    uint64_t     detections;
+} CfarDetector;
+
+
+// --- Function Prototypes ---
+
+/**
+ * @brief Fills in a configuration: CA-CFAR, 2 guard and 16 training cells per side, 10 dB
+ *        threshold, OS rank 0.75, at most 64 detections per frame.
+ */
+void cfar_config_default(CfarConfig* config);
+
+/**
+ * @brief Returns a short name for a CFAR method.
+ */
+const char* cfar_method_name(CfarMethod method);
+
+/**
+ * @brief Bytes in a report with `count` detections.
+ */
+size_t cfar_report_bytes(unsigned count);
+
+/**
+ * @brief Validates the configuration and allocates the report buffer.
+ * @return 0 on success, -1 on failure.
+ */
+int cfar_init(CfarDetector* detector, const CfarConfig* config, CfarCallback callback, void* user);
+
+/**
+ * @brief Runs the detector over one PSD frame and hands its report to the callback.
+ * Usable directly as the body of a PsdFrameCallback.
+ * @return Number of detections reported, or -1 if the frame is too small for the cell counts.
+ */
+int cfar_process_frame(CfarDetector* detector, const PsdFrame* frame);
+
+/**
+ * @brief Releases the detector buffers.
+ */
+void cfar_free(CfarDetector* detector);
+
+#endif // CFAR_H
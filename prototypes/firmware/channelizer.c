@@ -0,0 +1,180 @@
+// =================================================================================================
+// File: channelizer.c
+// Description: Implementation of the polyphase filter-bank channelizer.
+// =================================================================================================
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "channelizer.h"
+#include "fir_decimator.h"
+
+// --- Internal Helpers ---
+
+static inline int16_t saturate_q15(float v) {
+    if (v >= 32767.0f) return 32767;
+    if (v <= -32768.0f) return -32768;
+    return (int16_t)lrintf(v);
+}
+
+static void deliver_output(Channelizer* ch) {
+    if (ch->output_fill == 0) return;
+    if (ch->callback) {
+        ch->callback(ch->output, ch->config.channels, ch->output_fill, CHANNELIZER_OUTPUT_BLOCK, ch->user);
+    }
+    ch->output_fill = 0;
+}
+
+// Produces one sample of every channel from the filter window ending at `newest`.
+//
+// Channel k is y_k[m] = sum_n h[n] x[mD - n] e^(-j2pi k (mD - n) / N). Splitting n = r + pN, the
+// sum over p is the polyphase fold and the sum over r is an N-point DFT; the leftover factor
+// e^(-j2pi k mD / N) is 1 when D = N and (-1)^(km) when D = N/2.
+static void compute_output(Channelizer* ch, size_t newest) {
+    const unsigned n = ch->config.channels;
+    const size_t len = ch->filter_len;
+    const float* window = (const float*)(ch->input + newest + 1 - len);
+    float* fold = (float*)ch->fold;
+
+    // Fold the windowed history into N branch outputs. Taps and samples are both walked forward,
+    // with each tap stored twice so the complex samples can be treated as a flat float array.
+    memset(fold, 0, 2 * n * sizeof(float));
+    for (size_t base = 0; base < 2 * len; base += 2 * n) {
+        const float* x = window + base;
+        const float* h = ch->taps + base;
+        for (unsigned q = 0; q < 2 * n; ++q) fold[q] += h[q] * x[q];
+    }
+
+    // With the taps reversed, branch q holds the DFT input for index q + 1 (mod N).
+    ch->fft_buf[0] = ch->fold[n - 1];
+    memcpy(ch->fft_buf + 1, ch->fold, (n - 1) * sizeof(*ch->fft_buf));
+    fft_forward_f32(ch->plan, ch->fft_buf);
+
+    const int flip = ch->config.mode == CHANNELIZER_OVERSAMPLED && (ch->outputs & 1);
+    int16_t* out = ch->output + 2 * ch->output_fill;
+    for (unsigned k = 0; k < n; ++k) {
+        float re = ch->fft_buf[k].re;
+        float im = ch->fft_buf[k].im;
+        if (flip && (k & 1)) {
+            re = -re;
+            im = -im;
+        }
+        out[2 * (size_t)k * CHANNELIZER_OUTPUT_BLOCK] = saturate_q15(re);
+        out[2 * (size_t)k * CHANNELIZER_OUTPUT_BLOCK + 1] = saturate_q15(im);
+    }
+    ch->outputs++;
+    if (++ch->output_fill == CHANNELIZER_OUTPUT_BLOCK) deliver_output(ch);
+}
+
+
+// --- Public API Functions ---
+
+void channelizer_config_default(ChannelizerConfig* config, unsigned channels, ChannelizerMode mode) {
+    config->channels = channels;
+    config->taps_per_branch = CHANNELIZER_TAPS_PER_BRANCH;
+    config->mode = mode;
+}
+
+int channelizer_init(Channelizer* ch, const ChannelizerConfig* config, ChannelizerCallback callback, void* user) {
+    memset(ch, 0, sizeof(*ch));
+    const unsigned n = config->channels;
+    if (n < CHANNELIZER_MIN_CHANNELS || n > CHANNELIZER_MAX_CHANNELS || (n & (n - 1)) != 0 ||
+        config->taps_per_branch == 0 || config->taps_per_branch > CHANNELIZER_MAX_TAPS_PER_BRANCH ||
+        (config->mode != CHANNELIZER_CRITICAL && config->mode != CHANNELIZER_OVERSAMPLED)) {
+        printf("ERROR: Invalid channelizer configuration (%u channels, %u taps per branch).\n",
+               n, config->taps_per_branch);
+        return -1;
+    }
+
+    ch->config = *config;
+    ch->decimation = config->mode == CHANNELIZER_CRITICAL ? n : n / 2;
+    ch->filter_len = (size_t)n * config->taps_per_branch;
+    ch->callback = callback;
+    ch->user = user;
+
+    float* prototype = malloc(ch->filter_len * sizeof(*prototype));
+    ch->taps = malloc(2 * ch->filter_len * sizeof(*ch->taps));
+    ch->fold = malloc(n * sizeof(*ch->fold));
+    ch->fft_buf = malloc(n * sizeof(*ch->fft_buf));
+    ch->input = calloc(ch->filter_len + CHANNELIZER_INPUT_BLOCK, sizeof(*ch->input));
+    ch->output = malloc((size_t)n * CHANNELIZER_OUTPUT_BLOCK * CHANNELIZER_BYTES_PER_SAMPLE);
+    if (!prototype || !ch->taps || !ch->fold || !ch->fft_buf || !ch->input || !ch->output) {
+        perror("Failed to allocate channelizer buffers");
+        free(prototype);
+        channelizer_free(ch);
+        return -1;
+    }
+
+    // Channels are N bins apart with a -6 dB crossover at the band edges.
+    ch->plan = fft_plan_acquire(n);
+    if (!ch->plan || fir_design_lowpass(prototype, (unsigned)ch->filter_len, 0.5 / n) != 0) {
+        free(prototype);
+        channelizer_free(ch);
+        return -1;
+    }
+    for (size_t i = 0; i < ch->filter_len; ++i) {
+        ch->taps[2 * i] = ch->taps[2 * i + 1] = prototype[ch->filter_len - 1 - i];
+    }
+    free(prototype);
+
+    // Start with a zeroed history; the first output lands after `decimation` samples.
+    ch->input_fill = ch->filter_len - 1;
+    ch->next_output = ch->input_fill + ch->decimation - 1;
+    return 0;
+}
+
+void channelizer_push(Channelizer* ch, const void* samples, size_t bytes) {
+    const int16_t* iq = samples;
+    const size_t count = bytes / CHANNELIZER_BYTES_PER_SAMPLE;
+    const size_t capacity = ch->filter_len + CHANNELIZER_INPUT_BLOCK;
+    size_t i = 0;
+
+    while (i < count) {
+        size_t n = capacity - ch->input_fill;
+        if (n > count - i) n = count - i;
+        FftComplexF32* dst = ch->input + ch->input_fill;
+        for (size_t t = 0; t < n; ++t) {
+            dst[t].re = (float)iq[2 * (i + t)];
+            dst[t].im = (float)iq[2 * (i + t) + 1];
+        }
+        ch->input_fill += n;
+        i += n;
+
+        while (ch->next_output < ch->input_fill) {
+            compute_output(ch, ch->next_output);
+            ch->next_output += ch->decimation;
+        }
+
+        // Keep only the history the next output still needs.
+        size_t keep = ch->next_output + 1 - ch->filter_len;
+        if (keep > 0) {
+            memmove(ch->input, ch->input + keep, (ch->input_fill - keep) * sizeof(*ch->input));
+            ch->input_fill -= keep;
+            ch->next_output -= keep;
+        }
+    }
+}
+
+void channelizer_push_slot(Channelizer* ch, const CaptureSlot* slot) {
+    channelizer_push(ch, slot->data, slot->length);
+}
+
+void channelizer_flush(Channelizer* ch) {
+    deliver_output(ch);
+}
+
+void channelizer_free(Channelizer* ch) {
+    fft_plan_release(ch->plan);
+    ch->plan = NULL;
+    free(ch->taps);
+    free(ch->fold);
+    free(ch->fft_buf);
+    free(ch->input);
+    free(ch->output);
+    ch->taps = NULL;
+    ch->fold = NULL;
+    ch->fft_buf = NULL;
+    ch->input = NULL;
+    ch->output = NULL;
+}
@@ -0,0 +1,105 @@
+// =================================================================================================
+// File: channelizer.h
+// Description: Polyphase filter-bank channelizer that splits a wideband complex capture into N
+//              equal sub-bands in one pass.
+//
+// Channel k is centered at k * sample_rate / N (channels above N/2 are the negative frequencies)
+// and is brought to DC. Every `decimation` input samples the last N*P samples are folded through
+// the polyphase branches of the prototype low-pass filter and one N-point FFT produces the next
+// sample of every channel. With decimation N the bank is critically sampled; with N/2 it is 2x
+// oversampled, which keeps the transition bands of neighbouring channels from aliasing into each
+// other.
+//
+// Output is delivered in blocks laid out channel-major: all samples of channel 0, then channel 1,
+// and so on, so a per-channel stage downstream walks memory sequentially.
+// =================================================================================================
+
+#ifndef CHANNELIZER_H
+#define CHANNELIZER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "capture_session.h"
+#include "fft.h"
+
+// --- Configuration ---
+
+#define CHANNELIZER_MIN_CHANNELS        FFT_MIN_SIZE
+#define CHANNELIZER_MAX_CHANNELS        4096
+#define CHANNELIZER_TAPS_PER_BRANCH     8
+#define CHANNELIZER_MAX_TAPS_PER_BRANCH 64
+#define CHANNELIZER_INPUT_BLOCK         4096 // Input samples buffered beyond the filter history
+#define CHANNELIZER_OUTPUT_BLOCK        256  // Samples per channel in each output block
+#define CHANNELIZER_BYTES_PER_SAMPLE    4    // Complex int16 (I low, Q high)
+
+typedef enum {
+    CHANNELIZER_CRITICAL,    // Decimation = channels
+    CHANNELIZER_OVERSAMPLED  // Decimation = channels / 2
+} ChannelizerMode;
+
+typedef struct {
+    unsigned        channels;        // Power of two
+    unsigned        taps_per_branch; // Prototype filter length = channels * taps_per_branch
+    ChannelizerMode mode;
+} ChannelizerConfig;
+
+/**
+ * @brief Receives a block of channel-major complex int16 output (I/Q interleaved):
+ *        channel k's samples start at `iq + 2 * k * stride`.
+ */
+typedef void (*ChannelizerCallback)(const int16_t* iq, unsigned channels, size_t samples, size_t stride, void* user);
+
+typedef struct {
+    ChannelizerConfig   config;
+    unsigned            decimation;
+    size_t              filter_len;
+    float*              taps;        // Prototype filter reversed, each tap repeated for I and Q
+    const FftPlan*      plan;
+    FftComplexF32*      fold;        // Polyphase branch outputs
+    FftComplexF32*      fft_buf;
+    FftComplexF32*      input;       // Filter history followed by newly pushed samples
+    size_t              input_fill;
+    size_t              next_output; // Index in `input` of the newest sample of the next output
+    int16_t*            output;      // Channel-major output block
+    size_t              output_fill; // Samples per channel in `output`
+    uint64_t            outputs;     // Output instants since init
+    ChannelizerCallback callback;
+    void*               user;
+} Channelizer;
+
+
+// --- Function Prototypes ---
+
+/**
+ * @brief Fills in a configuration with the default filter length.
+ */
+void channelizer_config_default(ChannelizerConfig* config, unsigned channels, ChannelizerMode mode);
+
+/**
+ * @brief Designs the prototype filter and allocates the channelizer state.
+ * @return 0 on success, -1 on failure.
+ */
+int channelizer_init(Channelizer* ch, const ChannelizerConfig* config, ChannelizerCallback callback, void* user);
+
+/**
+ * @brief Consumes complex int16 samples continuing the stream from the previous push. Full output
+ *        blocks are delivered to the callback as they fill.
+ */
+void channelizer_push(Channelizer* ch, const void* samples, size_t bytes);
+
+/**
+ * @brief Consumes a filled capture slot.
+ */
+void channelizer_push_slot(Channelizer* ch, const CaptureSlot* slot);
+
+/**
+ * @brief Delivers any partially filled output block.
+ */
+void channelizer_flush(Channelizer* ch);
+
+/**
+ * @brief Releases the channelizer state.
+ */
+void channelizer_free(Channelizer* ch);
+
+#endif // CHANNELIZER_H
@@ -0,0 +1,308 @@
+// =================================================================================================
+// File: compress.c
+// Description: Implementation of the per-slot lossless sample compressor.
+// =================================================================================================
+
+#include <stdio.h>
+#include <string.h>
+#include "compress.h"
+
+// --- Internal Helpers ---
+
+#define ORDER_BITS   2
+#define ORDER_RAW    3   // Order field value marking a plain bit-packed block
+#define RICE_BITS    4
+#define RICE_MAX_K   14
+#define ESCAPE_Q     24  // Unary prefixes this long are followed by the value itself
+#define ESCAPE_BITS  20  // Enough for any zigzagged order-2 residual of int16 data
+
+typedef struct {
+    uint8_t* out;
+    uint64_t acc;
+    unsigned bits;
+} BitWriter;
+
+typedef struct {
+    const uint8_t* in;
+    const uint8_t* end;
+    uint64_t       acc;
+    unsigned       bits;
+    int            overrun;
+} BitReader;
+
+// Bits are packed LSB first; whole 32-bit words are stored as soon as they fill.
+static inline void put_bits(BitWriter* w, uint32_t value, unsigned n) {
+    w->acc |= (uint64_t)value << w->bits;
+    w->bits += n;
+    if (w->bits >= 32) {
+        uint32_t word = (uint32_t)w->acc;
+        memcpy(w->out, &word, 4);
+        w->out += 4;
+        w->acc >>= 32;
+        w->bits -= 32;
+    }
+}
+
+static void flush_bits(BitWriter* w) {
+    while (w->bits > 0) {
+        *w->out++ = (uint8_t)w->acc;
+        w->acc >>= 8;
+        w->bits = w->bits > 8 ? w->bits - 8 : 0;
+    }
+}
+
+static inline void refill(BitReader* r) {
+    if (r->end - r->in >= 8) {
+        uint64_t word;
+        memcpy(&word, r->in, 8);
+        r->acc |= word << r->bits;
+        r->in += (63 - r->bits) >> 3;
+        r->bits |= 56;
+        return;
+    }
+    while (r->bits <= 56 && r->in < r->end) {
+        r->acc |= (uint64_t)*r->in++ << r->bits;
+        r->bits += 8;
+    }
+}
+
+static inline uint32_t get_bits(BitReader* r, unsigned n) {
+    if (n == 0) return 0;
+    if (r->bits < n) refill(r);
+    if (r->bits < n) {
+        r->overrun = 1;
+        return 0;
+    }
+    uint32_t v = (uint32_t)(r->acc & ((1ULL << n) - 1));
+    r->acc >>= n;
+    r->bits -= n;
+    return v;
+}
+
+// Counts ones up to a terminating zero; returns ESCAPE_Q without a terminator for escapes. An
+// escaped residual never fills all ESCAPE_BITS, so a longer run of ones (or an all-ones
+// accumulator, where __builtin_ctzll(0) would be undefined) can only come from a corrupt stream.
+static inline unsigned get_unary(BitReader* r) {
+    if (r->bits <= ESCAPE_Q) refill(r);
+    const uint64_t zeros = ~r->acc;
+    unsigned ones = zeros ? (unsigned)__builtin_ctzll(zeros) : 64;
+    if (ones >= ESCAPE_Q + ESCAPE_BITS) {
+        r->overrun = 1;
+        return 0;
+    }
+    if (ones >= ESCAPE_Q) ones = ESCAPE_Q;
+    unsigned used = ones == ESCAPE_Q ? ESCAPE_Q : ones + 1;
+    if (used > r->bits) {
+        r->overrun = 1;
+        return 0;
+    }
+    r->acc >>= used;
+    r->bits -= used;
+    return ones;
+}
+
+static inline uint32_t zigzag(int32_t v) {
+    return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+}
+
+static inline int32_t unzigzag(uint32_t u) {
+    return (int32_t)(u >> 1) ^ -(int32_t)(u & 1);
+}
+
+// Wraps instead of overflowing: corrupt input can drive the history anywhere in int32_t.
+static inline int32_t predict(unsigned order, int32_t h1, int32_t h2) {
+    return order == 0 ? 0 : order == 1 ? h1 : (int32_t)(2U * (uint32_t)h1 - (uint32_t)h2);
+}
+
+// Encodes one channel of one block. `x` holds the shifted values; h1/h2 are the two values
+// before the block and are advanced past it.
+static void encode_channel(BitWriter* w, const int32_t* x, unsigned n, unsigned raw_bits,
+                           int32_t* h1, int32_t* h2) {
+    // Pick the predictor order with the smallest total residual.
+    uint64_t sum[3] = { 0, 0, 0 };
+    int32_t p1 = *h1, p2 = *h2;
+    for (unsigned i = 0; i < n; ++i) {
+        int32_t r0 = x[i], r1 = x[i] - p1, r2 = x[i] - 2 * p1 + p2;
+        sum[0] += (uint32_t)(r0 < 0 ? -r0 : r0);
+        sum[1] += (uint32_t)(r1 < 0 ? -r1 : r1);
+        sum[2] += (uint32_t)(r2 < 0 ? -r2 : r2);
+        p2 = p1;
+        p1 = x[i];
+    }
+    unsigned order = sum[1] < sum[0] ? 1 : 0;
+    if (sum[2] < sum[order]) order = 2;
+
+    // Rice parameter near log2 of the mean zigzagged residual (about twice the mean magnitude).
+    const uint64_t zsum = 2 * sum[order];
+    unsigned k = 0;
+    while (k < RICE_MAX_K && ((uint64_t)n << (k + 1)) < zsum) k++;
+
+    uint32_t u[COMPRESS_MAX_BLOCK];
+    uint64_t cost = 0;
+    p1 = *h1;
+    p2 = *h2;
+    for (unsigned i = 0; i < n; ++i) {
+        u[i] = zigzag(x[i] - predict(order, p1, p2));
+        uint32_t q = u[i] >> k;
+        cost += q < ESCAPE_Q ? q + 1 + k : ESCAPE_Q + ESCAPE_BITS;
+        p2 = p1;
+        p1 = x[i];
+    }
+
+    if (cost >= (uint64_t)n * raw_bits) {
+        put_bits(w, ORDER_RAW, ORDER_BITS);
+        const uint32_t mask = (1U << raw_bits) - 1;
+        for (unsigned i = 0; i < n; ++i) put_bits(w, (uint32_t)x[i] & mask, raw_bits);
+    } else {
+        put_bits(w, order, ORDER_BITS);
+        put_bits(w, k, RICE_BITS);
+        const uint32_t low_mask = (1U << k) - 1;
+        for (unsigned i = 0; i < n; ++i) {
+            uint32_t q = u[i] >> k;
+            if (q < ESCAPE_Q) {
+                put_bits(w, (1U << q) - 1, q + 1);
+                put_bits(w, u[i] & low_mask, k);
+            } else {
+                put_bits(w, (1U << ESCAPE_Q) - 1, ESCAPE_Q);
+                put_bits(w, u[i], ESCAPE_BITS);
+            }
+        }
+    }
+    *h1 = p1;
+    *h2 = p2;
+}
+
+
+// --- Public API Functions ---
+
+void compress_config_default(CompressConfig* config) {
+    config->channels = 2;
+    config->block_frames = 256;
+}
+
+size_t compress_bound(const CompressConfig* config, size_t bytes) {
+    const size_t values = bytes / sizeof(int16_t);
+    const size_t frames = config->channels ? values / config->channels : 0;
+    const size_t blocks = config->block_frames ? (frames + config->block_frames - 1) / config->block_frames : 0;
+    const size_t bits = values * 16 + blocks * config->channels * (ORDER_BITS + RICE_BITS);
+    return sizeof(CompressHeader) + (bits + 7) / 8 + 4;
+}
+
+size_t compress_encode(const CompressConfig* config, const void* in, size_t bytes, void* out, size_t out_capacity) {
+    const unsigned ch = config->channels;
+    const unsigned block = config->block_frames;
+    if (ch == 0 || ch > COMPRESS_MAX_CHANNELS || block == 0 || block > COMPRESS_MAX_BLOCK ||
+        bytes % (ch * sizeof(int16_t)) != 0 || bytes / sizeof(int16_t) > UINT32_MAX ||
+        out_capacity < compress_bound(config, bytes)) {
+        printf("ERROR: Invalid compression request (%u channels, %u-frame blocks, %zu bytes).\n", ch, block, bytes);
+        return 0;
+    }
+
+    const int16_t* samples = in;
+    const size_t values = bytes / sizeof(int16_t);
+    const size_t frames = values / ch;
+
+    // Drop the low bits that are zero in every value.
+    uint32_t bits_used = 0;
+    for (size_t i = 0; i < values; ++i) bits_used |= (uint16_t)samples[i];
+    unsigned shift = bits_used ? (unsigned)__builtin_ctz(bits_used) : 15;
+    if (shift > 15) shift = 15;
+    const unsigned raw_bits = 16 - shift;
+
+    CompressHeader header = {
+        .magic = COMPRESS_MAGIC,
+        .values = (uint32_t)values,
+        .block_frames = (uint16_t)block,
+        .channels = (uint8_t)ch,
+        .shift = (uint8_t)shift,
+    };
+    BitWriter w = { .out = (uint8_t*)out + sizeof(header), .acc = 0, .bits = 0 };
+
+    int32_t h1[COMPRESS_MAX_CHANNELS] = { 0 }, h2[COMPRESS_MAX_CHANNELS] = { 0 };
+    int32_t x[COMPRESS_MAX_BLOCK];
+    for (size_t f0 = 0; f0 < frames; f0 += block) {
+        const unsigned n = frames - f0 < block ? (unsigned)(frames - f0) : block;
+        for (unsigned c = 0; c < ch; ++c) {
+            const int16_t* src = samples + f0 * ch + c;
+            for (unsigned i = 0; i < n; ++i) x[i] = src[(size_t)i * ch] >> shift;
+            encode_channel(&w, x, n, raw_bits, &h1[c], &h2[c]);
+        }
+    }
+    flush_bits(&w);
+
+    header.payload_bytes = (uint32_t)(w.out - ((uint8_t*)out + sizeof(header)));
+    memcpy(out, &header, sizeof(header));
+    return sizeof(header) + header.payload_bytes;
+}
+
+size_t compress_encode_slot(const CompressConfig* config, const CaptureSlot* slot, void* out, size_t out_capacity) {
+    return compress_encode(config, slot->data, slot->length, out, out_capacity);
+}
+
+size_t compress_decode(const void* in, size_t in_bytes, void* out, size_t out_capacity) {
+    CompressHeader header;
+    if (in_bytes < sizeof(header)) {
+        printf("ERROR: Compressed buffer too short (%zu bytes).\n", in_bytes);
+        return 0;
+    }
+    memcpy(&header, in, sizeof(header));
+    const unsigned ch = header.channels;
+    const unsigned block = header.block_frames;
+    if (header.magic != COMPRESS_MAGIC || ch == 0 || ch > COMPRESS_MAX_CHANNELS || block == 0 ||
+        block > COMPRESS_MAX_BLOCK || header.shift > 15 || header.values % ch != 0 ||
+        header.payload_bytes > in_bytes - sizeof(header)) {
+        printf("ERROR: Malformed compressed buffer header.\n");
+        return 0;
+    }
+    if ((size_t)header.values * sizeof(int16_t) > out_capacity) {
+        printf("ERROR: %u decoded values do not fit in %zu bytes.\n", header.values, out_capacity);
+        return 0;
+    }
+
+    const uint8_t* payload = (const uint8_t*)in + sizeof(header);
+    BitReader r = { .in = payload, .end = payload + header.payload_bytes, .acc = 0, .bits = 0, .overrun = 0 };
+    const unsigned shift = header.shift;
+    const unsigned raw_bits = 16 - shift;
+    const size_t frames = header.values / ch;
+    int16_t* samples = out;
+
+    int32_t h1[COMPRESS_MAX_CHANNELS] = { 0 }, h2[COMPRESS_MAX_CHANNELS] = { 0 };
+    for (size_t f0 = 0; f0 < frames && !r.overrun; f0 += block) {
+        const unsigned n = frames - f0 < block ? (unsigned)(frames - f0) : block;
+        for (unsigned c = 0; c < ch; ++c) {
+            int16_t* dst = samples + f0 * ch + c;
+            int32_t p1 = h1[c], p2 = h2[c];
+            const unsigned order = get_bits(&r, ORDER_BITS);
+            if (order == ORDER_RAW) {
+                for (unsigned i = 0; i < n; ++i) {
+                    // Sign-extend the raw_bits-wide value.
+                    int32_t v = (int32_t)(get_bits(&r, raw_bits) << (32 - raw_bits)) >> (32 - raw_bits);
+                    dst[(size_t)i * ch] = (int16_t)(uint16_t)((uint32_t)v << shift);
+                    p2 = p1;
+                    p1 = v;
+                }
+            } else {
+                const unsigned k = get_bits(&r, RICE_BITS);
+                if (k > RICE_MAX_K) {
+                    r.overrun = 1;
+                    break;
+                }
+                for (unsigned i = 0; i < n; ++i) {
+                    unsigned q = get_unary(&r);
+                    uint32_t u = q == ESCAPE_Q ? get_bits(&r, ESCAPE_BITS) : (q << k) | get_bits(&r, k);
+                    int32_t v = (int32_t)((uint32_t)unzigzag(u) + (uint32_t)predict(order, p1, p2));
+                    dst[(size_t)i * ch] = (int16_t)(uint16_t)((uint32_t)v << shift);
+                    p2 = p1;
+                    p1 = v;
+                }
+            }
+            h1[c] = p1;
+            h2[c] = p2;
+        }
+    }
+    if (r.overrun) {
+        printf("ERROR: Compressed bit stream is corrupt or truncated.\n");
+        return 0;
+    }
+    return (size_t)header.values * sizeof(int16_t);
+}
@@ -0,0 +1,79 @@
+// =================================================================================================
+// File: compress.h
+// Description: Lossless compressor for captured int16 samples, one independent DMA slot at a time.
+//
+// Each slot becomes a self-describing buffer: a 16-byte header followed by a bit stream. Trailing
+// zero bits common to every value in the slot (the unused low bits of a 12- or 14-bit ADC stored
+// MSB-aligned) are dropped first. The samples are then cut into blocks, and for every block and
+// channel (I and Q are separate channels) the encoder picks the fixed polynomial predictor of order
+// 0, 1 or 2 with the smallest residuals and a Rice parameter matched to their mean size, falling
+// back to plain bit-packing when the data does not compress. Noisy low bits cost about their own
+// width while the predictable high bits shrink to a few bits per sample.
+//
+// Nothing carries over between slots, so slots can be compressed on different harts in any order,
+// and a lost slot never affects its neighbours.
+// =================================================================================================
+
+#ifndef COMPRESS_H
+#define COMPRESS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "capture_session.h"
+
+// --- Configuration ---
+
+#define COMPRESS_MAGIC          0x31504D43 // "CMP1"
+#define COMPRESS_MAX_CHANNELS   8
+#define COMPRESS_MAX_BLOCK      1024       // Frames per block
+
+typedef struct {
+    unsigned channels;     // Interleaved int16 values per frame (2 for complex I/Q)
+    unsigned block_frames; // Frames sharing one predictor and Rice parameter per channel
+} CompressConfig;
+
+/**
+ * @brief Header at the start of every compressed slot (little-endian).
+ */
+typedef struct __attribute__((packed)) {
+    uint32_t magic;
+    uint32_t values;        // int16 values encoded (frames * channels)
+    uint32_t payload_bytes; // Bit stream bytes after the header
+    uint16_t block_frames;
+    uint8_t  channels;
+    uint8_t  shift;         // Common trailing zero bits removed from every value
+} CompressHeader;
+
+
+// --- Function Prototypes ---
+
+/**
+ * @brief Fills in a configuration: complex I/Q samples, 256-frame blocks.
+ */
+void compress_config_default(CompressConfig* config);
+
+/**
+ * @brief Largest possible compressed size of `bytes` of input, header included.
+ */
+size_t compress_bound(const CompressConfig* config, size_t bytes);
+
+/**
+ * @brief Compresses int16 samples into `out`. Safe to call concurrently on different buffers.
+ * @param bytes Input length; a whole number of frames.
+ * @param out_capacity At least compress_bound(config, bytes).
+ * @return Compressed size in bytes, or 0 on invalid parameters.
+ */
+size_t compress_encode(const CompressConfig* config, const void* in, size_t bytes, void* out, size_t out_capacity);
+
+/**
+ * @brief Compresses the contents of a filled capture slot.
+ */
+size_t compress_encode_slot(const CompressConfig* config, const CaptureSlot* slot, void* out, size_t out_capacity);
+
+/**
+ * @brief Restores the samples of one compressed buffer.
+ * @return Decoded size in bytes, or 0 if the buffer is malformed or `out` is too small.
+ */
+size_t compress_decode(const void* in, size_t in_bytes, void* out, size_t out_capacity);
+
+#endif // COMPRESS_H
@@ -0,0 +1,203 @@
+// =================================================================================================
+// File: correlator.c
+// Description: Implementation of the overlap-save correlator.
+// =================================================================================================
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "correlator.h"
+
+// --- Internal Helpers ---
+
+static void emit_candidate(Correlator* corr, CorrelatorTemplate* t) {
+    if (corr->callback) corr->callback(&t->candidate, corr->user);
+    corr->detections++;
+    t->pending = 0;
+}
+
+// Scores the valid lags of one template against the current block.
+static void scan_template(Correlator* corr, unsigned id) {
+    CorrelatorTemplate* t = &corr->templates[id];
+    const unsigned n = corr->config.fft_size;
+    const float threshold = (float)corr->config.threshold;
+
+    for (unsigned k = 0; k < n; ++k) {
+        const FftComplexF32 x = corr->spectrum[k];
+        const FftComplexF32 h = t->spectrum[k];
+        corr->work[k].re = x.re * h.re - x.im * h.im;
+        corr->work[k].im = x.re * h.im + x.im * h.re;
+    }
+    fft_inverse_f32(corr->plan, corr->work);
+
+    // Lags below `step` see only samples inside the block; the rest wrap around and are left to
+    // the next block.
+    for (unsigned lag = 0; lag < corr->step; ++lag) {
+        const uint64_t sample = corr->base + lag;
+        if (t->pending && sample >= t->candidate.sample + t->length) emit_candidate(corr, t);
+
+        const double window = corr->energy[lag + t->length] - corr->energy[lag];
+        if (window <= 0.0) continue;
+        const double re = corr->work[lag].re, im = corr->work[lag].im;
+        const float score = (float)((re * re + im * im) / (t->energy * window));
+        if (score < threshold || (t->pending && score <= t->candidate.score)) continue;
+
+        t->pending = 1;
+        t->candidate.template_id = id;
+        t->candidate.sample = sample;
+        t->candidate.time = (double)sample / corr->config.sample_rate;
+        t->candidate.score = score;
+        t->candidate.phase = (float)atan2(im, re);
+        t->candidate.power_db = (float)(10.0 * log10(window / t->length / (32768.0 * 32768.0)));
+    }
+}
+
+static void process_block(Correlator* corr) {
+    const unsigned n = corr->config.fft_size;
+
+    // Double precision keeps the window energies (differences of large running sums) exact.
+    corr->energy[0] = 0.0;
+    for (unsigned i = 0; i < n; ++i) {
+        const FftComplexF32 x = corr->block[i];
+        corr->energy[i + 1] = corr->energy[i] + (double)x.re * x.re + (double)x.im * x.im;
+    }
+
+    memcpy(corr->spectrum, corr->block, n * sizeof(*corr->spectrum));
+    fft_forward_f32(corr->plan, corr->spectrum);
+    for (unsigned id = 0; id < corr->num_templates; ++id) scan_template(corr, id);
+
+    // Overlap-save: the last fft_size - step samples start the next block.
+    memmove(corr->block, corr->block + corr->step, (n - corr->step) * sizeof(*corr->block));
+    corr->fill = n - corr->step;
+    corr->base += corr->step;
+}
+
+
+// --- Public API Functions ---
+
+void correlator_config_default(CorrelatorConfig* config, double sample_rate) {
+    config->fft_size = 4096;
+    config->threshold = 0.5;
+    config->sample_rate = sample_rate;
+}
+
+int correlator_init(Correlator* corr, const CorrelatorConfig* config, CorrelatorCallback callback, void* user) {
+    memset(corr, 0, sizeof(*corr));
+    if (config->threshold <= 0.0 || config->threshold > 1.0 || config->sample_rate <= 0.0) {
+        printf("ERROR: Invalid correlator configuration (threshold %.3f, rate %.0f).\n",
+               config->threshold, config->sample_rate);
+        return -1;
+    }
+    corr->plan = fft_plan_acquire(config->fft_size);
+    if (!corr->plan) return -1;
+
+    const unsigned n = config->fft_size;
+    corr->config = *config;
+    corr->callback = callback;
+    corr->user = user;
+    corr->block = malloc(n * sizeof(*corr->block));
+    corr->spectrum = malloc(n * sizeof(*corr->spectrum));
+    corr->work = malloc(n * sizeof(*corr->work));
+    corr->energy = malloc((n + 1) * sizeof(*corr->energy));
+    if (!corr->block || !corr->spectrum || !corr->work || !corr->energy) {
+        perror("Failed to allocate correlator buffers");
+        correlator_free(corr);
+        return -1;
+    }
+    return 0;
+}
+
+int correlator_add_template(Correlator* corr, const int16_t* iq, unsigned samples) {
+    const unsigned n = corr->config.fft_size;
+    if (corr->base != 0 || corr->fill != 0) {
+        printf("ERROR: Correlator templates must be added before streaming starts.\n");
+        return -1;
+    }
+    if (corr->num_templates >= CORRELATOR_MAX_TEMPLATES || samples == 0 || samples > n / 2) {
+        printf("ERROR: Cannot add a %u-sample correlator template (limit %u samples, %u templates).\n",
+               samples, n / 2, CORRELATOR_MAX_TEMPLATES);
+        return -1;
+    }
+
+    CorrelatorTemplate* t = &corr->templates[corr->num_templates];
+    t->spectrum = calloc(n, sizeof(*t->spectrum));
+    if (!t->spectrum) {
+        perror("Failed to allocate correlator template");
+        return -1;
+    }
+
+    double energy = 0.0;
+    for (unsigned i = 0; i < samples; ++i) {
+        t->spectrum[i].re = (float)iq[2 * i];
+        t->spectrum[i].im = (float)iq[2 * i + 1];
+        energy += (double)iq[2 * i] * iq[2 * i] + (double)iq[2 * i + 1] * iq[2 * i + 1];
+    }
+    if (energy == 0.0) {
+        printf("ERROR: Correlator template is all zeros.\n");
+        free(t->spectrum);
+        t->spectrum = NULL;
+        return -1;
+    }
+
+    // Fold the conjugate for the correlation and the 1/N of the inverse transform into the spectrum.
+    fft_forward_f32(corr->plan, t->spectrum);
+    for (unsigned k = 0; k < n; ++k) {
+        t->spectrum[k].re /= (float)n;
+        t->spectrum[k].im /= -(float)n;
+    }
+    t->length = samples;
+    t->energy = energy;
+    if (samples > corr->max_length) corr->max_length = samples;
+    corr->step = n - corr->max_length + 1;
+    return (int)corr->num_templates++;
+}
+
+void correlator_push(Correlator* corr, const void* samples, size_t bytes) {
+    const int16_t* iq = samples;
+    const size_t count = bytes / CORRELATOR_BYTES_PER_SAMPLE;
+    const unsigned n = corr->config.fft_size;
+    if (corr->num_templates == 0) return;
+
+    size_t i = 0;
+    while (i < count) {
+        size_t take = n - corr->fill;
+        if (take > count - i) take = count - i;
+        FftComplexF32* dst = corr->block + corr->fill;
+        for (size_t t = 0; t < take; ++t) {
+            dst[t].re = (float)iq[2 * (i + t)];
+            dst[t].im = (float)iq[2 * (i + t) + 1];
+        }
+        corr->fill += (unsigned)take;
+        i += take;
+        if (corr->fill == n) process_block(corr);
+    }
+}
+
+void correlator_push_slot(Correlator* corr, const CaptureSlot* slot) {
+    correlator_push(corr, slot->data, slot->length);
+}
+
+void correlator_flush(Correlator* corr) {
+    for (unsigned id = 0; id < corr->num_templates; ++id) {
+        if (corr->templates[id].pending) emit_candidate(corr, &corr->templates[id]);
+    }
+}
+
+void correlator_free(Correlator* corr) {
+    for (unsigned id = 0; id < corr->num_templates; ++id) {
+        free(corr->templates[id].spectrum);
+        corr->templates[id].spectrum = NULL;
+    }
+    corr->num_templates = 0;
+    fft_plan_release(corr->plan);
+    corr->plan = NULL;
+    free(corr->block);
+    free(corr->spectrum);
+    free(corr->work);
+    free(corr->energy);
+    corr->block = NULL;
+    corr->spectrum = NULL;
+    corr->work = NULL;
+    corr->energy = NULL;
+}
@@ -0,0 +1,113 @@
+// =================================================================================================
+// File: correlator.h
+// Description: Fast-convolution correlator that finds known waveforms (preambles, bursts) in the
+//              live capture and reports only the detections.
+//
+// The stream is cut into FFT blocks that overlap by the longest template length minus one
+// (overlap-save). Each block is transformed once, multiplied by the conjugate spectrum of every
+// template and transformed back, which yields the cross-correlation at every lag in the block for
+// a few FFTs instead of a template-length dot product per sample. Each lag is scored by the
+// normalized correlation |r|^2 / (E_template * E_window), so the threshold does not depend on the
+// signal level. A score above the threshold opens a candidate; the highest score within one
+// template length is published as a detection. No sample data leaves the stage.
+//
+// FFT tables come from the shared plan cache, so a PSD engine of the same size reuses them.
+// =================================================================================================
+
+#ifndef CORRELATOR_H
+#define CORRELATOR_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "capture_session.h"
+#include "fft.h"
+
+// --- Configuration ---
+
+#define CORRELATOR_MAX_TEMPLATES     8
+#define CORRELATOR_BYTES_PER_SAMPLE  4 // Complex int16 (I low, Q high)
+
+typedef struct {
+    unsigned fft_size;    // Block size, power of two; templates may be up to half of it
+    double   threshold;   // Normalized correlation score (0-1) that opens a detection
+    double   sample_rate; // Hz, used to turn sample indices into times
+} CorrelatorConfig;
+
+typedef struct {
+    unsigned template_id;
+    uint64_t sample;      // Stream index of the first sample of the matched waveform
+    double   time;        // Seconds since the start of the stream
+    float    score;       // Normalized correlation at the peak, 0-1
+    float    phase;       // Phase of the stream relative to the template at the peak, radians
+    float    power_db;    // Mean power of the matched window, dB relative to int16 full scale
+} CorrelatorDetection;
+
+typedef void (*CorrelatorCallback)(const CorrelatorDetection* detection, void* user);
+
+typedef struct {
+    unsigned            length;
+    double              energy;
+    FftComplexF32*      spectrum;  // conj(FFT(template)) / fft_size
+    int                 pending;   // A candidate peak is open
+    CorrelatorDetection candidate;
+} CorrelatorTemplate;
+
+typedef struct {
+    CorrelatorConfig   config;
+    const FftPlan*     plan;
+    CorrelatorTemplate templates[CORRELATOR_MAX_TEMPLATES];
+    unsigned           num_templates;
+    unsigned           max_length;   // Longest template
+    unsigned           step;         // New samples per block: fft_size - max_length + 1
+    FftComplexF32*     block;        // Overlap from the previous block followed by new samples
+    unsigned           fill;         // Samples in `block`
+    FftComplexF32*     spectrum;     // FFT of the current block
+    FftComplexF32*     work;
+    double*            energy;       // Running sum of |x|^2 over the block, fft_size + 1 entries
+    uint64_t           base;         // Stream index of block[0]
+    uint64_t           detections;
+    CorrelatorCallback callback;
+    void*              user;
+} Correlator;
+
+
+// --- Function Prototypes ---
+
+/**
+ * @brief Fills in a configuration: 4096-point blocks and a 0.5 score threshold.
+ */
+void correlator_config_default(CorrelatorConfig* config, double sample_rate);
+
+/**
+ * @brief Validates the configuration and allocates the block buffers.
+ * @return 0 on success, -1 on failure.
+ */
+int correlator_init(Correlator* corr, const CorrelatorConfig* config, CorrelatorCallback callback, void* user);
+
+/**
+ * @brief Adds a complex int16 reference waveform. Templates must be added before the first push.
+ * @return The template id reported in detections, or -1 on failure.
+ */
+int correlator_add_template(Correlator* corr, const int16_t* iq, unsigned samples);
+
+/**
+ * @brief Consumes complex int16 samples continuing the stream from the previous push.
+ */
+void correlator_push(Correlator* corr, const void* samples, size_t bytes);
+
+/**
+ * @brief Consumes a filled capture slot.
+ */
+void correlator_push_slot(Correlator* corr, const CaptureSlot* slot);
+
+/**
+ * @brief Publishes any open candidates. Lags in the final partial block are not searched.
+ */
+void correlator_flush(Correlator* corr);
+
+/**
+ * @brief Releases the templates and block buffers.
+ */
+void correlator_free(Correlator* corr);
+
+#endif // CORRELATOR_H
@@ -0,0 +1,171 @@
+// =================================================================================================
+// File: crc32c.c
+// Description: Implementation of the CRC32C kernels and their run-time selection.
+// =================================================================================================
+
+#include <string.h>
+#include "crc32c.h"
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#elif defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#endif
+
+// --- Internal Helpers ---
+
+#define CRC32C_POLY 0x82F63B78U // Reflected Castagnoli polynomial
+
+typedef uint32_t (*Crc32cKernel)(uint32_t crc, const uint8_t* p, size_t len);
+
+// Table k advances a byte through k further zero bytes, so eight bytes fold in one step.
+static uint32_t crc32c_table[8][256];
+static int tables_ready = 0;
+static Crc32cKernel kernel = NULL;
+static Crc32cImpl selected = CRC32C_IMPL_AUTO;
+
+static void init_tables(void) {
+    for (uint32_t i = 0; i < 256; ++i) {
+        uint32_t c = i;
+        for (int k = 0; k < 8; ++k) c = (c >> 1) ^ (CRC32C_POLY & (0U - (c & 1)));
+        crc32c_table[0][i] = c;
+    }
+    for (uint32_t i = 0; i < 256; ++i) {
+        for (int t = 1; t < 8; ++t) {
+            uint32_t prev = crc32c_table[t - 1][i];
+            crc32c_table[t][i] = (prev >> 8) ^ crc32c_table[0][prev & 0xFF];
+        }
+    }
+    tables_ready = 1;
+}
+
+// The kernels work on the raw register; crc32c_extend() applies the inversions.
+static uint32_t crc32c_bytewise(uint32_t crc, const uint8_t* p, size_t len) {
+    for (size_t i = 0; i < len; ++i) crc = crc32c_table[0][(crc ^ p[i]) & 0xFF] ^ (crc >> 8);
+    return crc;
+}
+
+// Assumes a little-endian CPU (the U54 and x86 both are).
+static uint32_t crc32c_slice8(uint32_t crc, const uint8_t* p, size_t len) {
+    while (len > 0 && ((uintptr_t)p & 7) != 0) {
+        crc = crc32c_table[0][(crc ^ *p++) & 0xFF] ^ (crc >> 8);
+        len--;
+    }
+    while (len >= 8) {
+        uint64_t w;
+        memcpy(&w, p, 8);
+        w ^= crc;
+        crc = crc32c_table[7][w & 0xFF] ^ crc32c_table[6][(w >> 8) & 0xFF] ^
+              crc32c_table[5][(w >> 16) & 0xFF] ^ crc32c_table[4][(w >> 24) & 0xFF] ^
+              crc32c_table[3][(w >> 32) & 0xFF] ^ crc32c_table[2][(w >> 40) & 0xFF] ^
+              crc32c_table[1][(w >> 48) & 0xFF] ^ crc32c_table[0][w >> 56];
+        p += 8;
+        len -= 8;
+    }
+    return crc32c_bytewise(crc, p, len);
+}
+
+#if defined(__x86_64__)
+__attribute__((target("sse4.2")))
+static uint32_t crc32c_hw(uint32_t crc, const uint8_t* p, size_t len) {
+    uint64_t c = crc;
+    while (len > 0 && ((uintptr_t)p & 7) != 0) {
+        c = _mm_crc32_u8((uint32_t)c, *p++);
+        len--;
+    }
+    while (len >= 8) {
+        uint64_t w;
+        memcpy(&w, p, 8);
+        c = _mm_crc32_u64(c, w);
+        p += 8;
+        len -= 8;
+    }
+    while (len-- > 0) c = _mm_crc32_u8((uint32_t)c, *p++);
+    return (uint32_t)c;
+}
+
+static int hw_supported(void) {
+    return __builtin_cpu_supports("sse4.2");
+}
+#elif defined(__ARM_FEATURE_CRC32)
+static uint32_t crc32c_hw(uint32_t crc, const uint8_t* p, size_t len) {
+    while (len > 0 && ((uintptr_t)p & 7) != 0) {
+        crc = __crc32cb(crc, *p++);
+        len--;
+    }
+    while (len >= 8) {
+        uint64_t w;
+        memcpy(&w, p, 8);
+        crc = __crc32cd(crc, w);
+        p += 8;
+        len -= 8;
+    }
+    while (len-- > 0) crc = __crc32cb(crc, *p++);
+    return crc;
+}
+
+static int hw_supported(void) {
+    return 1;
+}
+#else
+static int hw_supported(void) {
+    return 0;
+}
+#endif
+
+
+// --- Public API Functions ---
+
+int crc32c_select(Crc32cImpl impl) {
+    if (!tables_ready) init_tables();
+    if (impl == CRC32C_IMPL_AUTO) impl = hw_supported() ? CRC32C_IMPL_HW : CRC32C_IMPL_SLICE8;
+
+    switch (impl) {
+        case CRC32C_IMPL_BYTEWISE:
+            kernel = crc32c_bytewise;
+            break;
+        case CRC32C_IMPL_SLICE8:
+            kernel = crc32c_slice8;
+            break;
+        case CRC32C_IMPL_HW:
+#if defined(__x86_64__) || defined(__ARM_FEATURE_CRC32)
+            if (hw_supported()) {
+                kernel = crc32c_hw;
+                break;
+            }
+#endif
+            return -1;
+        default:
+            return -1;
+    }
+    selected = impl;
+    return 0;
+}
+
+Crc32cImpl crc32c_impl(void) {
+    if (!kernel) crc32c_select(CRC32C_IMPL_AUTO);
+    return selected;
+}
+
+const char* crc32c_impl_name(Crc32cImpl impl) {
+    switch (impl) {
+        case CRC32C_IMPL_AUTO:     return "auto";
+        case CRC32C_IMPL_BYTEWISE: return "bytewise";
+        case CRC32C_IMPL_SLICE8:   return "slice-by-8";
+        case CRC32C_IMPL_HW:       return "hardware";
+    }
+    return "unknown";
+}
+
+void crc32c_init(void) {
+    if (!kernel) crc32c_select(CRC32C_IMPL_AUTO);
+}
+
+uint32_t crc32c_extend(uint32_t crc, const void* data, size_t len) {
+    if (!kernel) crc32c_select(CRC32C_IMPL_AUTO);
+    return ~kernel(~crc, data, len);
+}
+
+uint32_t crc32c(const void* data, size_t len) {
+    return crc32c_extend(0, data, len);
+}
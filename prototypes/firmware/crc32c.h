@@ -0,0 +1,71 @@
+// =================================================================================================
+// File: crc32c.h
+// Description: CRC32C (Castagnoli) checksums at line rate, used to follow each capture slot from
+//              DMA completion to wherever it ends up (file, index, network).
+//
+// Three implementations share one interface: the classic byte-at-a-time table, slicing-by-8 (eight
+// 256-entry tables, one 64-bit load and eight lookups per 8 bytes), and the CPU's own CRC32C
+// instruction where there is one (SSE4.2 on x86 hosts, the CRC extension on ARMv8). The U54 has
+// neither a CRC instruction nor carry-less multiply, so slicing-by-8 is the fast path on the board.
+// crc32c_init() selects the best available implementation, and crc32c_select() overrides it for
+// the whole process. Neither is thread-safe: they fill in the tables the kernels read, so modules
+// that may checksum from several harts (capture sessions, sinks, capture files) call crc32c_init()
+// while they are set up, before any worker runs. A single-threaded caller that skips it gets the
+// same selection on first use.
+//
+// Values are the standard CRC32C (init and final XOR 0xFFFFFFFF), so crc32c("123456789") is
+// 0xE3069283 and results match iSCSI, ext4 and the SSE4.2 instruction sequence.
+// =================================================================================================
+
+#ifndef CRC32C_H
+#define CRC32C_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// --- Configuration ---
+
+typedef enum {
+    CRC32C_IMPL_AUTO,     // Best implementation the CPU supports
+    CRC32C_IMPL_BYTEWISE,
+    CRC32C_IMPL_SLICE8,
+    CRC32C_IMPL_HW        // CRC32C instruction (SSE4.2 / ARMv8 CRC)
+} Crc32cImpl;
+
+
+// --- Function Prototypes ---
+
+/**
+ * @brief Builds the tables and selects the best implementation, unless one was already selected.
+ *        Call before any thread computes a CRC; later calls do nothing.
+ */
+void crc32c_init(void);
+
+/**
+ * @brief Selects the implementation used by every later call (CRC32C_IMPL_AUTO picks the fastest).
+ * @return 0 on success, -1 if the CPU or build does not support `impl`.
+ */
+int crc32c_select(Crc32cImpl impl);
+
+/**
+ * @brief Returns the implementation in use, selecting one if none has been yet.
+ */
+Crc32cImpl crc32c_impl(void);
+
+/**
+ * @brief Returns a printable name for an implementation.
+ */
+const char* crc32c_impl_name(Crc32cImpl impl);
+
+/**
+ * @brief Continues a CRC over more data: crc32c_extend(crc32c(a), b) == crc32c(a followed by b).
+ * @param crc CRC of the data so far (0 for none).
+ */
+uint32_t crc32c_extend(uint32_t crc, const void* data, size_t len);
+
+/**
+ * @brief CRC32C of a buffer.
+ */
+uint32_t crc32c(const void* data, size_t len);
+
+#endif // CRC32C_H
@@ -0,0 +1,196 @@
+// =================================================================================================
+// File: ddc.c
+// Description: Implementation of the NCO/CIC/FIR digital down-converters and the DDC bank.
+// =================================================================================================
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "ddc.h"
+
+// --- Internal Helpers ---
+
+#define NCO_TABLE_SIZE (1U << DDC_NCO_TABLE_BITS)
+// Mixer products (int16 x Q15) are kept with 7 fractional bits going into the CIC. With the CIC's
+// worst-case growth of 5 * 8 bits this still fits comfortably in 64 bits.
+#define MIX_SHIFT      8
+
+static inline int16_t sat_i16_f64(double v) {
+    if (v >= 32767.0) return INT16_MAX;
+    if (v <= -32768.0) return INT16_MIN;
+    return (int16_t)lrint(v);
+}
+
+static inline int16_t sat_i16(int32_t v) {
+    if (v > INT16_MAX) return INT16_MAX;
+    if (v < INT16_MIN) return INT16_MIN;
+    return (int16_t)v;
+}
+
+// Mixes one tile of real samples down to DC and runs the CIC. Returns the complex samples
+// written to the band buffer.
+static size_t mix_and_cic(Ddc* ddc, const int16_t* nco, const int16_t* x, size_t count) {
+    const unsigned order = ddc->config.cic_order;
+    const unsigned rate = ddc->config.cic_decimation;
+    int16_t* out = ddc->band_buffer;
+    uint32_t phase = ddc->phase;
+    size_t produced = 0;
+
+    if (rate == 1) {
+        for (size_t i = 0; i < count; ++i) {
+            const int16_t* w = nco + 2 * (phase >> (32 - DDC_NCO_TABLE_BITS));
+            phase += ddc->phase_step;
+            out[2 * i] = sat_i16(((int32_t)x[i] * w[0] + (1 << 14)) >> 15);
+            out[2 * i + 1] = sat_i16(((int32_t)x[i] * w[1] + (1 << 14)) >> 15);
+        }
+        ddc->phase = phase;
+        return count;
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        const int16_t* w = nco + 2 * (phase >> (32 - DDC_NCO_TABLE_BITS));
+        phase += ddc->phase_step;
+
+        // Integrators run at the input rate; unsigned arithmetic gives the modular wrap CIC needs.
+        uint64_t re = (uint64_t)(int64_t)(((int32_t)x[i] * w[0]) >> MIX_SHIFT);
+        uint64_t im = (uint64_t)(int64_t)(((int32_t)x[i] * w[1]) >> MIX_SHIFT);
+        for (unsigned k = 0; k < order; ++k) {
+            re = ddc->integrators[k][0] += re;
+            im = ddc->integrators[k][1] += im;
+        }
+        if (++ddc->cic_count < rate) continue;
+        ddc->cic_count = 0;
+
+        // Combs run at the decimated rate.
+        for (unsigned k = 0; k < order; ++k) {
+            uint64_t dre = re - ddc->comb_delay[k][0];
+            uint64_t dim = im - ddc->comb_delay[k][1];
+            ddc->comb_delay[k][0] = re;
+            ddc->comb_delay[k][1] = im;
+            re = dre;
+            im = dim;
+        }
+        out[2 * produced] = sat_i16_f64((double)(int64_t)re * ddc->cic_scale);
+        out[2 * produced + 1] = sat_i16_f64((double)(int64_t)im * ddc->cic_scale);
+        produced++;
+    }
+    ddc->phase = phase;
+    return produced;
+}
+
+
+// --- Public API Functions ---
+
+void ddc_config_default(DdcConfig* config, double center_frequency, unsigned cic_decimation, unsigned fir_decimation) {
+    FirDecimatorConfig fir;
+    fir_decimator_config_default(&fir, fir_decimation);
+
+    config->center_frequency = center_frequency;
+    config->cic_decimation = cic_decimation;
+    config->cic_order = 4;
+    config->fir_decimation = fir_decimation;
+    config->fir_taps = 0;
+    config->fir_path = fir.path;
+}
+
+int ddc_bank_init(DdcBank* bank, double sample_rate, DdcOutputCallback callback, void* user) {
+    memset(bank, 0, sizeof(*bank));
+    if (sample_rate <= 0.0) {
+        printf("ERROR: DDC sample rate must be positive.\n");
+        return -1;
+    }
+
+    bank->nco_table = malloc(2 * NCO_TABLE_SIZE * sizeof(*bank->nco_table));
+    bank->tile = malloc(DDC_TILE_SAMPLES * sizeof(*bank->tile));
+    if (!bank->nco_table || !bank->tile) {
+        perror("Failed to allocate DDC bank buffers");
+        ddc_bank_free(bank);
+        return -1;
+    }
+    // exp(-j*theta): multiplying by it shifts the band at +f down to DC.
+    for (unsigned i = 0; i < NCO_TABLE_SIZE; ++i) {
+        double theta = 2.0 * M_PI * (double)i / NCO_TABLE_SIZE;
+        bank->nco_table[2 * i] = (int16_t)lrint(cos(theta) * 32767.0);
+        bank->nco_table[2 * i + 1] = (int16_t)lrint(-sin(theta) * 32767.0);
+    }
+
+    bank->sample_rate = sample_rate;
+    bank->callback = callback;
+    bank->user = user;
+    return 0;
+}
+
+int ddc_bank_add(DdcBank* bank, const DdcConfig* config) {
+    if (bank->num_ddcs >= DDC_MAX_BANDS) {
+        printf("ERROR: DDC bank is full (%d bands).\n", DDC_MAX_BANDS);
+        return -1;
+    }
+    if (config->cic_decimation < 1 || config->cic_decimation > DDC_MAX_CIC_DECIMATION ||
+        config->cic_order < 1 || config->cic_order > DDC_MAX_CIC_ORDER ||
+        fabs(config->center_frequency) > bank->sample_rate / 2) {
+        printf("ERROR: Invalid DDC configuration (%.0f Hz, CIC %u/%u).\n",
+               config->center_frequency, config->cic_decimation, config->cic_order);
+        return -1;
+    }
+
+    Ddc* ddc = &bank->ddcs[bank->num_ddcs];
+    memset(ddc, 0, sizeof(*ddc));
+    ddc->config = *config;
+
+    FirDecimatorConfig fir_config;
+    fir_decimator_config_default(&fir_config, config->fir_decimation);
+    if (config->fir_taps) fir_config.num_taps = config->fir_taps;
+    fir_config.path = config->fir_path;
+    if (fir_decimator_init(&ddc->fir, &fir_config) != 0) return -1;
+
+    ddc->band_buffer = malloc(2 * DDC_TILE_SAMPLES * sizeof(*ddc->band_buffer));
+    if (!ddc->band_buffer) {
+        perror("Failed to allocate DDC band buffer");
+        fir_decimator_free(&ddc->fir);
+        return -1;
+    }
+
+    ddc->phase_step = (uint32_t)(int64_t)llround(config->center_frequency / bank->sample_rate * 4294967296.0);
+    ddc->cic_scale = 1.0 / (pow((double)config->cic_decimation, (double)config->cic_order) * (1 << (15 - MIX_SHIFT)));
+    return (int)bank->num_ddcs++;
+}
+
+void ddc_bank_process(DdcBank* bank, const void* samples, size_t bytes) {
+    const int16_t* x = samples;
+    const size_t count = bytes / DDC_BYTES_PER_SAMPLE;
+
+    for (size_t base = 0; base < count; base += DDC_TILE_SAMPLES) {
+        size_t tile = count - base < DDC_TILE_SAMPLES ? count - base : DDC_TILE_SAMPLES;
+
+        // One bulk read of the tile from the slot; every DDC then works from the cached copy.
+        memcpy(bank->tile, x + base, tile * sizeof(*x));
+        for (unsigned b = 0; b < bank->num_ddcs; ++b) {
+            Ddc* ddc = &bank->ddcs[b];
+            size_t produced = mix_and_cic(ddc, bank->nco_table, bank->tile, tile);
+            size_t out_bytes = fir_decimator_process(&ddc->fir, ddc->band_buffer, ddc->band_buffer,
+                                                     produced * FIR_BYTES_PER_SAMPLE);
+            size_t out_samples = out_bytes / FIR_BYTES_PER_SAMPLE;
+            ddc->samples_out += out_samples;
+            if (out_samples && bank->callback) bank->callback(b, ddc->band_buffer, out_samples, bank->user);
+        }
+    }
+    bank->samples_in += count;
+}
+
+void ddc_bank_process_slot(DdcBank* bank, const CaptureSlot* slot) {
+    ddc_bank_process(bank, slot->data, slot->length);
+}
+
+void ddc_bank_free(DdcBank* bank) {
+    for (unsigned b = 0; b < bank->num_ddcs; ++b) {
+        fir_decimator_free(&bank->ddcs[b].fir);
+        free(bank->ddcs[b].band_buffer);
+        bank->ddcs[b].band_buffer = NULL;
+    }
+    bank->num_ddcs = 0;
+    free(bank->nco_table);
+    free(bank->tile);
+    bank->nco_table = NULL;
+    bank->tile = NULL;
+}
@@ -0,0 +1,107 @@
+// =================================================================================================
+// File: ddc.h
+// Description: Digital down-converters that extract narrow sub-bands from real ADC samples.
+//
+// Each DDC mixes the real input with a table-driven NCO to move its band to DC, then decimates with
+// a CIC filter followed by a FIR stage (the polyphase decimator). A DDC bank runs any number of
+// DDCs over the same input in one sweep: each cache-sized tile of the slot is copied once into a
+// cached buffer and every DDC consumes it from there. The udmabuf mapping is non-cached, so this
+// makes extracting N bands cost one read of the slot from DRAM instead of N.
+// =================================================================================================
+
+#ifndef DDC_H
+#define DDC_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "capture_session.h"
+#include "fir_decimator.h"
+
+// --- Configuration ---
+
+#define DDC_MAX_BANDS          16
+#define DDC_NCO_TABLE_BITS     12    // 4096-entry sine table; phase truncation spurs near -72 dBc
+#define DDC_MAX_CIC_ORDER      5
+#define DDC_MAX_CIC_DECIMATION 256
+#define DDC_TILE_SAMPLES       4096  // Input samples per tile (8KB, comfortably inside L1)
+#define DDC_BYTES_PER_SAMPLE   2     // Real int16 ADC samples, two per 32-bit stream beat
+
+typedef struct {
+    double   center_frequency; // Band center in Hz, 0 to sample_rate / 2
+    unsigned cic_decimation;   // 1 bypasses the CIC
+    unsigned cic_order;        // Number of integrator/comb pairs
+    unsigned fir_decimation;   // Decimation of the FIR stage that follows the CIC (>= 2)
+    unsigned fir_taps;         // 0 for the FIR decimator's default length
+    FirPath  fir_path;
+} DdcConfig;
+
+/**
+ * @brief One DDC: NCO, CIC state and FIR stage, all carried across input buffers.
+ */
+typedef struct {
+    DdcConfig    config;
+    uint32_t     phase;           // NCO phase accumulator (full turn = 2^32)
+    uint32_t     phase_step;
+    uint64_t     integrators[DDC_MAX_CIC_ORDER][2]; // [stage][I/Q], wrap modulo 2^64 by design
+    uint64_t     comb_delay[DDC_MAX_CIC_ORDER][2];
+    unsigned     cic_count;       // Input samples since the last CIC output
+    double       cic_scale;       // 1 / cic_decimation^cic_order
+    FirDecimator fir;
+    int16_t*     band_buffer;     // CIC output for one tile, then decimated in place by the FIR
+    uint64_t     samples_out;
+} Ddc;
+
+/**
+ * @brief Receives each DDC's decimated complex int16 output (I/Q interleaved) once per tile.
+ */
+typedef void (*DdcOutputCallback)(unsigned band, const int16_t* iq, size_t samples, void* user);
+
+typedef struct {
+    double            sample_rate;
+    int16_t*          nco_table;  // cos/-sin pairs in Q15, shared by every DDC
+    int16_t*          tile;       // Cached copy of the input tile being processed
+    Ddc               ddcs[DDC_MAX_BANDS];
+    unsigned          num_ddcs;
+    DdcOutputCallback callback;
+    void*             user;
+    uint64_t          samples_in;
+} DdcBank;
+
+
+// --- Function Prototypes ---
+
+/**
+ * @brief Fills in a configuration for a band at `center_frequency` decimated by
+ *        `cic_decimation * fir_decimation`, with a 4th-order CIC.
+ */
+void ddc_config_default(DdcConfig* config, double center_frequency, unsigned cic_decimation, unsigned fir_decimation);
+
+/**
+ * @brief Builds the shared NCO table for an input at `sample_rate`.
+ * @return 0 on success, -1 on failure.
+ */
+int ddc_bank_init(DdcBank* bank, double sample_rate, DdcOutputCallback callback, void* user);
+
+/**
+ * @brief Adds a DDC to the bank.
+ * @return The band index passed to the callback, or -1 on an invalid configuration.
+ */
+int ddc_bank_add(DdcBank* bank, const DdcConfig* config);
+
+/**
+ * @brief Runs every DDC over a buffer of real int16 samples that continues the previous one.
+ * @param bytes A multiple of DDC_BYTES_PER_SAMPLE.
+ */
+void ddc_bank_process(DdcBank* bank, const void* samples, size_t bytes);
+
+/**
+ * @brief Runs every DDC over a filled capture slot.
+ */
+void ddc_bank_process_slot(DdcBank* bank, const CaptureSlot* slot);
+
+/**
+ * @brief Releases the bank and all of its DDCs.
+ */
+void ddc_bank_free(DdcBank* bank);
+
+#endif // DDC_H
@@ -0,0 +1,220 @@
+// =================================================================================================
+// File: fft.c
+// Description: Implementation of the radix-2 float and Q15 FFTs.
+// =================================================================================================
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "fft.h"
+
+// --- Internal Helpers ---
+
+// Largest component magnitude for which an unscaled butterfly cannot overflow: a stage at most
+// doubles the complex magnitude, and the magnitude must stay below 32767 (32767 / (2 * sqrt(2))).
+#define Q15_UNSCALED_LIMIT 11584
+// Largest component magnitude accepted as transform input (32767 / sqrt(2)).
+#define Q15_INPUT_LIMIT    23170
+
+static inline int16_t sat_q15(int32_t v) {
+    if (v > INT16_MAX) return INT16_MAX;
+    if (v < INT16_MIN) return INT16_MIN;
+    return (int16_t)v;
+}
+
+static inline int32_t abs_i32(int32_t v) {
+    return v < 0 ? -v : v;
+}
+
+static void bitrev_permute_f32(const FftPlan* plan, FftComplexF32* data) {
+    for (unsigned i = 0; i < plan->size; ++i) {
+        unsigned j = plan->bitrev[i];
+        if (j > i) {
+            FftComplexF32 tmp = data[i];
+            data[i] = data[j];
+            data[j] = tmp;
+        }
+    }
+}
+
+static void conjugate_f32(FftComplexF32* data, unsigned n) {
+    for (unsigned i = 0; i < n; ++i) data[i].im = -data[i].im;
+}
+
+static void bitrev_permute_q15(const FftPlan* plan, FftComplexQ15* data) {
+    for (unsigned i = 0; i < plan->size; ++i) {
+        unsigned j = plan->bitrev[i];
+        if (j > i) {
+            FftComplexQ15 tmp = data[i];
+            data[i] = data[j];
+            data[j] = tmp;
+        }
+    }
+}
+
+
+// --- Public API Functions ---
+
+int fft_plan_init(FftPlan* plan, unsigned size) {
+    plan->bitrev = NULL;
+    plan->twiddle_f32 = NULL;
+    plan->twiddle_q15 = NULL;
+
+    if (size < FFT_MIN_SIZE || size > FFT_MAX_SIZE || (size & (size - 1)) != 0) {
+        printf("ERROR: FFT size %u must be a power of two between %u and %u.\n", size, FFT_MIN_SIZE, FFT_MAX_SIZE);
+        return -1;
+    }
+
+    plan->size = size;
+    plan->log2_size = 0;
+    while ((1U << plan->log2_size) < size) plan->log2_size++;
+
+    plan->bitrev = malloc(size * sizeof(*plan->bitrev));
+    plan->twiddle_f32 = malloc(size / 2 * sizeof(*plan->twiddle_f32));
+    plan->twiddle_q15 = malloc(size / 2 * sizeof(*plan->twiddle_q15));
+    if (!plan->bitrev || !plan->twiddle_f32 || !plan->twiddle_q15) {
+        perror("Failed to allocate FFT tables");
+        fft_plan_free(plan);
+        return -1;
+    }
+
+    for (unsigned i = 0; i < size; ++i) {
+        unsigned r = 0;
+        for (unsigned b = 0; b < plan->log2_size; ++b) {
+            if (i & (1U << b)) r |= 1U << (plan->log2_size - 1 - b);
+        }
+        plan->bitrev[i] = (uint16_t)r;
+    }
+
+    for (unsigned k = 0; k < size / 2; ++k) {
+        double angle = -2.0 * M_PI * (double)k / (double)size;
+        plan->twiddle_f32[k].re = (float)cos(angle);
+        plan->twiddle_f32[k].im = (float)sin(angle);
+        plan->twiddle_q15[k].re = sat_q15((int32_t)lround(cos(angle) * 32767.0));
+        plan->twiddle_q15[k].im = sat_q15((int32_t)lround(sin(angle) * 32767.0));
+    }
+    return 0;
+}
+
+void fft_plan_free(FftPlan* plan) {
+    free(plan->bitrev);
+    free(plan->twiddle_f32);
+    free(plan->twiddle_q15);
+    plan->bitrev = NULL;
+    plan->twiddle_f32 = NULL;
+    plan->twiddle_q15 = NULL;
+}
+
+void fft_forward_f32(const FftPlan* plan, FftComplexF32* data) {
+    const unsigned n = plan->size;
+    bitrev_permute_f32(plan, data);
+
+    for (unsigned half = 1; half < n; half <<= 1) {
+        const unsigned stride = n / (2 * half);
+        for (unsigned start = 0; start < n; start += 2 * half) {
+            FftComplexF32* a = data + start;
+            FftComplexF32* b = a + half;
+            for (unsigned k = 0; k < half; ++k) {
+                const FftComplexF32 w = plan->twiddle_f32[k * stride];
+                float tr = b[k].re * w.re - b[k].im * w.im;
+                float ti = b[k].re * w.im + b[k].im * w.re;
+                b[k].re = a[k].re - tr;
+                b[k].im = a[k].im - ti;
+                a[k].re += tr;
+                a[k].im += ti;
+            }
+        }
+    }
+}
+
+void fft_inverse_f32(const FftPlan* plan, FftComplexF32* data) {
+    // ifft(x) = conj(fft(conj(x))), up to the 1/size factor.
+    conjugate_f32(data, plan->size);
+    fft_forward_f32(plan, data);
+    conjugate_f32(data, plan->size);
+}
+
+int fft_forward_q15(const FftPlan* plan, FftComplexQ15* data) {
+    const unsigned n = plan->size;
+    int exponent = 0;
+
+    // The butterflies rely on every complex magnitude staying below full scale.
+    int32_t peak = 0;
+    for (unsigned i = 0; i < n; ++i) {
+        int32_t m = abs_i32(data[i].re) > abs_i32(data[i].im) ? abs_i32(data[i].re) : abs_i32(data[i].im);
+        if (m > peak) peak = m;
+    }
+    if (peak > Q15_INPUT_LIMIT) {
+        for (unsigned i = 0; i < n; ++i) {
+            data[i].re = (int16_t)(data[i].re >> 1);
+            data[i].im = (int16_t)(data[i].im >> 1);
+        }
+        peak = (peak + 1) >> 1;
+        exponent++;
+    }
+
+    bitrev_permute_q15(plan, data);
+
+    for (unsigned half = 1; half < n; half <<= 1) {
+        const unsigned stride = n / (2 * half);
+        const int shift = peak > Q15_UNSCALED_LIMIT ? 1 : 0;
+        exponent += shift;
+        peak = 0;
+
+        for (unsigned start = 0; start < n; start += 2 * half) {
+            FftComplexQ15* a = data + start;
+            FftComplexQ15* b = a + half;
+            for (unsigned k = 0; k < half; ++k) {
+                const FftComplexQ15 w = plan->twiddle_q15[k * stride];
+                int32_t tr = ((int32_t)b[k].re * w.re - (int32_t)b[k].im * w.im + (1 << 14)) >> 15;
+                int32_t ti = ((int32_t)b[k].re * w.im + (int32_t)b[k].im * w.re + (1 << 14)) >> 15;
+                int32_t ar = a[k].re, ai = a[k].im;
+
+                int16_t yr = sat_q15((ar + tr) >> shift);
+                int16_t yi = sat_q15((ai + ti) >> shift);
+                int16_t zr = sat_q15((ar - tr) >> shift);
+                int16_t zi = sat_q15((ai - ti) >> shift);
+                a[k].re = yr;
+                a[k].im = yi;
+                b[k].re = zr;
+                b[k].im = zi;
+
+                // OR is a cheap upper bound on the largest of the four (at most 2x too high).
+                int32_t m = abs_i32(yr) | abs_i32(yi) | abs_i32(zr) | abs_i32(zi);
+                if (m > peak) peak = m;
+            }
+        }
+    }
+    return exponent;
+}
+
+
+// --- Shared Plans ---
+
+typedef struct {
+    FftPlan  plan;
+    unsigned refs;
+} SharedFftPlan;
+
+static SharedFftPlan shared_plans[32]; // Indexed by log2 of the size
+
+const FftPlan* fft_plan_acquire(unsigned size) {
+    if (size < FFT_MIN_SIZE || size > FFT_MAX_SIZE || (size & (size - 1)) != 0) {
+        printf("ERROR: FFT size %u must be a power of two between %u and %u.\n", size, FFT_MIN_SIZE, FFT_MAX_SIZE);
+        return NULL;
+    }
+    unsigned log2_size = 0;
+    while ((1U << log2_size) < size) log2_size++;
+
+    SharedFftPlan* shared = &shared_plans[log2_size];
+    if (shared->refs == 0 && fft_plan_init(&shared->plan, size) != 0) return NULL;
+    shared->refs++;
+    return &shared->plan;
+}
+
+void fft_plan_release(const FftPlan* plan) {
+    if (!plan) return;
+    SharedFftPlan* shared = &shared_plans[plan->log2_size];
+    if (&shared->plan != plan || shared->refs == 0) return;
+    if (--shared->refs == 0) fft_plan_free(&shared->plan);
+}
@@ -0,0 +1,91 @@
+// =================================================================================================
+// File: fft.h
+// Description: Radix-2 complex FFTs for the on-board signal processing.
+//
+// Two transforms share one plan: a single-precision float FFT for the host, and a Q15 fixed-point
+// FFT for the U54 cores. The Q15 transform uses block floating point: a stage is scaled by 1/2
+// only when its inputs are large enough to overflow, and the number of scaled stages is returned
+// as the block exponent, so small signals keep their precision.
+// =================================================================================================
+
+#ifndef FFT_H
+#define FFT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// --- Configuration ---
+
+#define FFT_MIN_SIZE 16
+#define FFT_MAX_SIZE 16384
+
+// --- Data Types ---
+
+typedef struct {
+    float re;
+    float im;
+} FftComplexF32;
+
+typedef struct {
+    int16_t re;
+    int16_t im;
+} FftComplexQ15;
+
+/**
+ * @brief Precomputed tables for one transform size.
+ */
+typedef struct {
+    unsigned       size;         // Number of complex points (power of two)
+    unsigned       log2_size;
+    uint16_t*      bitrev;       // Bit-reversed index of every input position
+    FftComplexF32* twiddle_f32;  // exp(-2*pi*i*k/size) for k < size/2
+    FftComplexQ15* twiddle_q15;  // The same twiddles rounded to Q15
+} FftPlan;
+
+
+// --- Function Prototypes ---
+
+/**
+ * @brief Allocates and fills the tables for a transform of `size` points.
+ * @param size Power of two between FFT_MIN_SIZE and FFT_MAX_SIZE.
+ * @return 0 on success, -1 on an invalid size or allocation failure.
+ */
+int fft_plan_init(FftPlan* plan, unsigned size);
+
+/**
+ * @brief Releases the tables of a plan.
+ */
+void fft_plan_free(FftPlan* plan);
+
+/**
+ * @brief In-place forward FFT of `plan->size` float points (unnormalized).
+ */
+void fft_forward_f32(const FftPlan* plan, FftComplexF32* data);
+
+/**
+ * @brief In-place inverse FFT of `plan->size` float points (unnormalized: the result is
+ *        `size` times the true inverse).
+ */
+void fft_inverse_f32(const FftPlan* plan, FftComplexF32* data);
+
+/**
+ * @brief In-place forward FFT of `plan->size` Q15 points with block floating point scaling.
+ * @return The block exponent e: the true (unnormalized) transform is `data * 2^e`.
+ */
+int fft_forward_q15(const FftPlan* plan, FftComplexQ15* data);
+
+/**
+ * @brief Returns the process-wide plan for `size`, creating it on first use. Stages that run
+ *        transforms of the same size share one set of tables. Not thread-safe: acquire plans
+ *        while setting up the pipeline.
+ * @return The shared plan, or NULL on an invalid size or allocation failure.
+ */
+const FftPlan* fft_plan_acquire(unsigned size);
+
+/**
+ * @brief Drops one reference to a shared plan; the tables are freed with the last one.
+ *        NULL is ignored.
+ */
+void fft_plan_release(const FftPlan* plan);
+
+#endif // FFT_H
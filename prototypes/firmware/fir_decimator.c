@@ -0,0 +1,199 @@
+// =================================================================================================
+// File: fir_decimator.c
+// Description: Implementation of the streaming polyphase FIR decimator.
+// =================================================================================================
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "fir_decimator.h"
+
+// --- Internal Helpers ---
+
+static inline int16_t sat_i16(int64_t v) {
+    if (v > INT16_MAX) return INT16_MAX;
+    if (v < INT16_MIN) return INT16_MIN;
+    return (int16_t)v;
+}
+
+static inline int16_t sat_i16_f32(float v) {
+    if (v >= 32767.0f) return INT16_MAX;
+    if (v <= -32768.0f) return INT16_MIN;
+    return (int16_t)lrintf(v);
+}
+
+// One filter output from `n` interleaved I/Q samples and reversed taps.
+static inline void dot_f32(const int16_t* x, const float* h, unsigned n, int16_t* y) {
+    float re = 0.0f, im = 0.0f;
+    for (unsigned j = 0; j < n; ++j) {
+        re += h[j] * (float)x[2 * j];
+        im += h[j] * (float)x[2 * j + 1];
+    }
+    y[0] = sat_i16_f32(re);
+    y[1] = sat_i16_f32(im);
+}
+
+static inline void dot_q15(const int16_t* x, const int16_t* h, unsigned n, int16_t* y) {
+    int64_t re = 0, im = 0;
+    for (unsigned j = 0; j < n; ++j) {
+        re += (int32_t)h[j] * x[2 * j];
+        im += (int32_t)h[j] * x[2 * j + 1];
+    }
+    y[0] = sat_i16((re + (1 << 14)) >> 15);
+    y[1] = sat_i16((im + (1 << 14)) >> 15);
+}
+
+
+// --- Public API Functions ---
+
+void fir_decimator_config_default(FirDecimatorConfig* config, unsigned decimation) {
+    config->decimation = decimation;
+    config->num_taps = FIR_TAPS_PER_PHASE * decimation;
+    if (config->num_taps > FIR_MAX_TAPS) config->num_taps = FIR_MAX_TAPS;
+    config->taps = NULL;
+#if defined(__riscv)
+    config->path = FIR_PATH_FIXED;
+#else
+    config->path = FIR_PATH_FLOAT;
+#endif
+}
+
+int fir_design_lowpass(float* taps, unsigned num_taps, double cutoff) {
+    if (num_taps == 0 || cutoff <= 0.0 || cutoff >= 0.5) {
+        printf("ERROR: Invalid low-pass design (%u taps, cutoff %.3f).\n", num_taps, cutoff);
+        return -1;
+    }
+
+    double sum = 0.0;
+    double center = (num_taps - 1) / 2.0;
+    for (unsigned i = 0; i < num_taps; ++i) {
+        double t = (double)i - center;
+        double sinc = t == 0.0 ? 2.0 * cutoff : sin(2.0 * M_PI * cutoff * t) / (M_PI * t);
+        double window = num_taps > 1 ? 0.54 - 0.46 * cos(2.0 * M_PI * i / (num_taps - 1)) : 1.0;
+        taps[i] = (float)(sinc * window);
+        sum += taps[i];
+    }
+    for (unsigned i = 0; i < num_taps; ++i) taps[i] = (float)(taps[i] / sum);
+    return 0;
+}
+
+int fir_decimator_init(FirDecimator* fir, const FirDecimatorConfig* config) {
+    memset(fir, 0, sizeof(*fir));
+    const unsigned n = config->num_taps;
+
+    if (config->decimation < 2 || config->decimation > FIR_MAX_DECIMATION || n == 0 || n > FIR_MAX_TAPS) {
+        printf("ERROR: Invalid FIR decimator configuration (decimation %u, %u taps).\n", config->decimation, n);
+        return -1;
+    }
+
+    fir->config = *config;
+    fir->config.taps = NULL;
+    fir->taps_f32 = malloc(n * sizeof(*fir->taps_f32));
+    fir->taps_q15 = malloc(n * sizeof(*fir->taps_q15));
+    fir->history = calloc(2 * n, sizeof(*fir->history));
+    fir->next_history = calloc(2 * n, sizeof(*fir->next_history));
+    // Holds the history plus the head of an input buffer: outputs whose window reaches back into
+    // data an in-place pass has already overwritten are computed from here (see process()).
+    fir->scratch = malloc(2 * (3 * (size_t)n) * sizeof(*fir->scratch));
+    if (!fir->taps_f32 || !fir->taps_q15 || !fir->history || !fir->next_history || !fir->scratch) {
+        perror("Failed to allocate FIR decimator state");
+        fir_decimator_free(fir);
+        return -1;
+    }
+
+    float* prototype = fir->taps_f32;
+    if (config->taps) {
+        memcpy(prototype, config->taps, n * sizeof(*prototype));
+    } else if (fir_design_lowpass(prototype, n, 0.45 / config->decimation) != 0) {
+        fir_decimator_free(fir);
+        return -1;
+    }
+
+    // Store the taps reversed so that output y[p] = sum(taps_rev[j] * x[p - n + 1 + j]).
+    for (unsigned i = 0; i < n / 2; ++i) {
+        float tmp = prototype[i];
+        prototype[i] = prototype[n - 1 - i];
+        prototype[n - 1 - i] = tmp;
+    }
+    for (unsigned i = 0; i < n; ++i) {
+        fir->taps_q15[i] = sat_i16(lrint(prototype[i] * 32767.0));
+    }
+    return 0;
+}
+
+size_t fir_decimator_process(FirDecimator* fir, const void* in, void* out, size_t in_bytes) {
+    const int16_t* x = in;
+    int16_t* y = out;
+    const size_t len = in_bytes / FIR_BYTES_PER_SAMPLE;
+    const unsigned n = fir->config.num_taps;
+    const unsigned hist = n - 1;
+    const size_t step = fir->config.decimation;
+    const int in_place = (const void*)y == in;
+
+    // The scratch copy covers every output that may read data already overwritten in place:
+    // output m reads from p_m - hist, which passes m before m reaches hist / (step - 1) < n, so
+    // all such windows end before input index 2n.
+    size_t head = len < 2 * (size_t)n ? len : 2 * (size_t)n;
+    memcpy(fir->scratch, fir->history, 2 * hist * sizeof(*x));
+    memcpy(fir->scratch + 2 * hist, x, 2 * head * sizeof(*x));
+
+    // Save the new history before the output can overwrite it.
+    if (len >= hist) {
+        memcpy(fir->next_history, x + 2 * (len - hist), 2 * hist * sizeof(*x));
+    } else {
+        memcpy(fir->next_history, fir->scratch + 2 * len, 2 * hist * sizeof(*x));
+    }
+
+    size_t m = 0;
+    size_t p = fir->next_input;
+    for (; p < len; p += step, ++m) {
+        ptrdiff_t start = (ptrdiff_t)p - (ptrdiff_t)hist;
+        const int16_t* window;
+        if (start >= 0 && (!in_place || (size_t)start >= m)) {
+            window = x + 2 * start;
+        } else {
+            window = fir->scratch + 2 * (hist + start);
+        }
+
+        if (fir->config.path == FIR_PATH_FIXED) {
+            dot_q15(window, fir->taps_q15, n, y + 2 * m);
+        } else {
+            dot_f32(window, fir->taps_f32, n, y + 2 * m);
+        }
+    }
+    fir->next_input = p - len;
+
+    int16_t* tmp = fir->history;
+    fir->history = fir->next_history;
+    fir->next_history = tmp;
+
+    fir->samples_in += len;
+    fir->samples_out += m;
+    return m * FIR_BYTES_PER_SAMPLE;
+}
+
+size_t fir_decimator_process_slot(FirDecimator* fir, CaptureSlot* slot) {
+    slot->length = fir_decimator_process(fir, slot->data, slot->data, slot->length);
+    return slot->length;
+}
+
+void fir_decimator_reset(FirDecimator* fir) {
+    memset(fir->history, 0, 2 * fir->config.num_taps * sizeof(*fir->history));
+    fir->next_input = 0;
+    fir->samples_in = 0;
+    fir->samples_out = 0;
+}
+
+void fir_decimator_free(FirDecimator* fir) {
+    free(fir->taps_f32);
+    free(fir->taps_q15);
+    free(fir->history);
+    free(fir->next_history);
+    free(fir->scratch);
+    fir->taps_f32 = NULL;
+    fir->taps_q15 = NULL;
+    fir->history = NULL;
+    fir->next_history = NULL;
+    fir->scratch = NULL;
+}
@@ -0,0 +1,95 @@
+// =================================================================================================
+// File: fir_decimator.h
+// Description: Streaming polyphase FIR decimation stage for complex int16 capture data.
+//
+// Only every `decimation`-th filter output is evaluated, so the cost per input sample is
+// num_taps / decimation multiply-accumulates. The filter history is carried from one slot to the
+// next, so a capture split over many DMA slots decimates exactly like one long buffer. Output can
+// be written over the input, letting a slot be decimated in place inside the udmabuf mapping.
+// =================================================================================================
+
+#ifndef FIR_DECIMATOR_H
+#define FIR_DECIMATOR_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "capture_session.h"
+
+// --- Configuration ---
+
+#define FIR_MAX_TAPS          1024
+#define FIR_MAX_DECIMATION    256
+#define FIR_BYTES_PER_SAMPLE  4     // Complex int16 (I low, Q high), as delivered by the stream source
+#define FIR_TAPS_PER_PHASE    16    // Default filter length per polyphase branch
+
+typedef enum {
+    FIR_PATH_FLOAT, // Single-precision multiply-accumulate (host)
+    FIR_PATH_FIXED  // Q15 taps with 64-bit accumulators (U54)
+} FirPath;
+
+typedef struct {
+    unsigned     decimation; // Output rate = input rate / decimation
+    unsigned     num_taps;
+    const float* taps;       // Prototype low-pass filter, or NULL to design one with fir_design_lowpass()
+    FirPath      path;
+} FirDecimatorConfig;
+
+typedef struct {
+    FirDecimatorConfig config;
+    float*             taps_f32;       // Taps in reverse order, so each output is a forward dot product
+    int16_t*           taps_q15;
+    int16_t*           history;        // Last num_taps-1 input samples (interleaved I/Q)
+    int16_t*           next_history;   // Tail of the current input, saved before it can be overwritten
+    int16_t*           scratch;        // History followed by the head of the current input
+    size_t             next_input;     // Index, in the next input buffer, of the next retained sample
+    uint64_t           samples_in;
+    uint64_t           samples_out;
+} FirDecimator;
+
+
+// --- Function Prototypes ---
+
+/**
+ * @brief Fills in a configuration for `decimation` with a designed filter of
+ *        FIR_TAPS_PER_PHASE taps per branch and the kernel suited to the build target.
+ */
+void fir_decimator_config_default(FirDecimatorConfig* config, unsigned decimation);
+
+/**
+ * @brief Designs a Hamming-windowed sinc low-pass filter with unity gain at DC.
+ * @param cutoff Cutoff frequency as a fraction of the input sample rate (0 < cutoff < 0.5).
+ * @return 0 on success, -1 on invalid parameters.
+ */
+int fir_design_lowpass(float* taps, unsigned num_taps, double cutoff);
+
+/**
+ * @brief Validates the configuration, converts the taps and allocates the filter state.
+ * @return 0 on success, -1 on failure.
+ */
+int fir_decimator_init(FirDecimator* fir, const FirDecimatorConfig* config);
+
+/**
+ * @brief Filters and decimates a run of samples that continues the stream from the previous call.
+ * @param out Output buffer; may be the same as `in` (but must not otherwise overlap it).
+ * @param in_bytes Input length, a multiple of FIR_BYTES_PER_SAMPLE.
+ * @return Number of output bytes written.
+ */
+size_t fir_decimator_process(FirDecimator* fir, const void* in, void* out, size_t in_bytes);
+
+/**
+ * @brief Decimates a capture slot in place and shrinks its length to the decimated data.
+ * The slot's stream_offset still refers to the full-rate stream.
+ */
+size_t fir_decimator_process_slot(FirDecimator* fir, CaptureSlot* slot);
+
+/**
+ * @brief Clears the filter history so the next call starts a new stream.
+ */
+void fir_decimator_reset(FirDecimator* fir);
+
+/**
+ * @brief Releases the filter state.
+ */
+void fir_decimator_free(FirDecimator* fir);
+
+#endif // FIR_DECIMATOR_H
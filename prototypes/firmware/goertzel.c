@@ -0,0 +1,181 @@
+// =================================================================================================
+// File: goertzel.c
+// Description: Implementation of the streaming Goertzel filter bank.
+// =================================================================================================
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "goertzel.h"
+
+// --- Internal Helpers ---
+
+// Runs one filter over a tile: s0 = x + 2cos(w) s1 - s2, on the I and Q parts independently.
+static void run_filter(GoertzelFilter* f, const float* re, const float* im, unsigned n) {
+    float s1r = f->s1_re, s1i = f->s1_im, s2r = f->s2_re, s2i = f->s2_im;
+    const float c = f->coeff;
+    for (unsigned i = 0; i < n; ++i) {
+        float s0r = re[i] + c * s1r - s2r;
+        float s0i = im[i] + c * s1i - s2i;
+        s2r = s1r;
+        s2i = s1i;
+        s1r = s0r;
+        s1i = s0i;
+    }
+    f->s1_re = s1r;
+    f->s1_im = s1i;
+    f->s2_re = s2r;
+    f->s2_im = s2i;
+}
+
+// Runs four filters over a tile together. Each recursion is a serial dependency chain, so
+// interleaving independent filters keeps the FPU pipeline busy.
+#define GOERTZEL_GROUP 4
+static void run_filter_group(GoertzelFilter* f, const float* re, const float* im, unsigned n) {
+    float s1r[GOERTZEL_GROUP], s1i[GOERTZEL_GROUP], s2r[GOERTZEL_GROUP], s2i[GOERTZEL_GROUP], c[GOERTZEL_GROUP];
+    for (int g = 0; g < GOERTZEL_GROUP; ++g) {
+        s1r[g] = f[g].s1_re;
+        s1i[g] = f[g].s1_im;
+        s2r[g] = f[g].s2_re;
+        s2i[g] = f[g].s2_im;
+        c[g] = f[g].coeff;
+    }
+    for (unsigned i = 0; i < n; ++i) {
+        for (int g = 0; g < GOERTZEL_GROUP; ++g) {
+            float s0r = re[i] + c[g] * s1r[g] - s2r[g];
+            float s0i = im[i] + c[g] * s1i[g] - s2i[g];
+            s2r[g] = s1r[g];
+            s2i[g] = s1i[g];
+            s1r[g] = s0r;
+            s1i[g] = s0i;
+        }
+    }
+    for (int g = 0; g < GOERTZEL_GROUP; ++g) {
+        f[g].s1_re = s1r[g];
+        f[g].s1_im = s1i[g];
+        f[g].s2_re = s2r[g];
+        f[g].s2_im = s2i[g];
+    }
+}
+
+// Ends a block: |s1 - exp(-jw) s2|^2 is the squared DFT magnitude at w.
+static void finish_block(GoertzelBank* bank) {
+    for (unsigned k = 0; k < bank->config.num_frequencies; ++k) {
+        GoertzelFilter* f = &bank->filters[k];
+        float yr = f->s1_re - (f->cos_w * f->s2_re + f->sin_w * f->s2_im);
+        float yi = f->s1_im - (f->cos_w * f->s2_im - f->sin_w * f->s2_re);
+        bank->accum[k] += yr * yr + yi * yi;
+        f->s1_re = f->s1_im = f->s2_re = f->s2_im = 0.0f;
+    }
+    bank->blocks++;
+    bank->block_pos = 0;
+}
+
+static void emit_frame(GoertzelBank* bank) {
+    const float scale = (float)(bank->scale / bank->accumulated);
+    for (unsigned k = 0; k < bank->config.num_frequencies; ++k) {
+        bank->output[k] = bank->accum[k] * scale;
+        bank->accum[k] = 0.0f;
+    }
+    if (bank->callback) {
+        GoertzelFrame frame = {
+            .sequence = bank->frames,
+            .first_sample = bank->frame_first_sample,
+            .block_size = bank->config.block_size,
+            .averages = bank->accumulated,
+            .num_frequencies = bank->config.num_frequencies,
+            .frequencies = bank->config.frequencies,
+            .power = bank->output,
+        };
+        bank->callback(&frame, bank->user);
+    }
+    bank->frames++;
+    bank->accumulated = 0;
+}
+
+
+// --- Public API Functions ---
+
+void goertzel_config_default(GoertzelConfig* config, double sample_rate) {
+    memset(config, 0, sizeof(*config));
+    config->block_size = 1024;
+    config->averages = 64;
+    config->sample_rate = sample_rate;
+}
+
+int goertzel_config_add(GoertzelConfig* config, double frequency) {
+    if (config->num_frequencies >= GOERTZEL_MAX_FREQUENCIES || fabs(frequency) > config->sample_rate / 2) {
+        printf("ERROR: Cannot add Goertzel frequency %.0f Hz.\n", frequency);
+        return -1;
+    }
+    config->frequencies[config->num_frequencies++] = frequency;
+    return 0;
+}
+
+int goertzel_bank_init(GoertzelBank* bank, const GoertzelConfig* config, GoertzelFrameCallback callback, void* user) {
+    memset(bank, 0, sizeof(*bank));
+    if (config->block_size == 0 || config->averages == 0 || config->sample_rate <= 0.0 ||
+        config->num_frequencies == 0 || config->num_frequencies > GOERTZEL_MAX_FREQUENCIES) {
+        printf("ERROR: Invalid Goertzel configuration (block %u, %u frequencies).\n",
+               config->block_size, config->num_frequencies);
+        return -1;
+    }
+
+    bank->config = *config;
+    bank->callback = callback;
+    bank->user = user;
+    for (unsigned k = 0; k < config->num_frequencies; ++k) {
+        double w = 2.0 * M_PI * config->frequencies[k] / config->sample_rate;
+        bank->filters[k].coeff = (float)(2.0 * cos(w));
+        bank->filters[k].cos_w = (float)cos(w);
+        bank->filters[k].sin_w = (float)sin(w);
+    }
+    // Same scaling as a rectangular-window PSD frame: |X|^2 / (fs * N), int16 full scale.
+    bank->scale = 1.0 / (config->sample_rate * config->block_size * 32768.0 * 32768.0);
+    return 0;
+}
+
+unsigned goertzel_bank_push(GoertzelBank* bank, const void* samples, size_t bytes) {
+    const int16_t* iq = samples;
+    const size_t count = bytes / GOERTZEL_BYTES_PER_SAMPLE;
+    unsigned frames = 0;
+    size_t i = 0;
+
+    while (i < count) {
+        size_t n = count - i;
+        if (n > GOERTZEL_TILE_SAMPLES) n = GOERTZEL_TILE_SAMPLES;
+        if (n > bank->config.block_size - bank->block_pos) n = bank->config.block_size - bank->block_pos;
+
+        if (bank->block_pos == 0 && bank->accumulated == 0) {
+            bank->frame_first_sample = bank->blocks * bank->config.block_size;
+        }
+
+        // Convert once per tile; every filter then runs over the cached float copy.
+        for (size_t t = 0; t < n; ++t) {
+            bank->tile_re[t] = (float)iq[2 * (i + t)];
+            bank->tile_im[t] = (float)iq[2 * (i + t) + 1];
+        }
+        unsigned k = 0;
+        for (; k + GOERTZEL_GROUP <= bank->config.num_frequencies; k += GOERTZEL_GROUP) {
+            run_filter_group(&bank->filters[k], bank->tile_re, bank->tile_im, (unsigned)n);
+        }
+        for (; k < bank->config.num_frequencies; ++k) {
+            run_filter(&bank->filters[k], bank->tile_re, bank->tile_im, (unsigned)n);
+        }
+        bank->block_pos += (unsigned)n;
+        i += n;
+
+        if (bank->block_pos == bank->config.block_size) {
+            finish_block(bank);
+            if (++bank->accumulated == bank->config.averages) {
+                emit_frame(bank);
+                frames++;
+            }
+        }
+    }
+    return frames;
+}
+
+unsigned goertzel_bank_push_slot(GoertzelBank* bank, const CaptureSlot* slot) {
+    return goertzel_bank_push(bank, slot->data, slot->length);
+}
@@ -0,0 +1,104 @@
+// =================================================================================================
+// File: goertzel.h
+// Description: Streaming Goertzel filter bank that measures power at a list of known frequencies.
+//
+// Each frequency costs a few multiply-adds per sample, so watching a handful of channels is far
+// cheaper than a full FFT per frame. Samples are grouped into blocks like the FFT segments of the
+// PSD engine (blocks may straddle DMA slots; the filter states carry across), and every `averages`
+// blocks one frame of averaged powers is handed to a callback. Powers use the same scaling as a
+// rectangular-window PSD frame, so the two paths can be compared directly.
+// =================================================================================================
+
+#ifndef GOERTZEL_H
+#define GOERTZEL_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "capture_session.h"
+
+// --- Configuration ---
+
+#define GOERTZEL_MAX_FREQUENCIES 256
+#define GOERTZEL_TILE_SAMPLES    1024 // Samples converted to float at a time and shared by every filter
+#define GOERTZEL_BYTES_PER_SAMPLE 4   // Complex int16 (I low, Q high)
+
+typedef struct {
+    unsigned block_size;                          // Samples per Goertzel block (the "FFT size")
+    unsigned averages;                            // Blocks averaged into each output frame
+    double   sample_rate;                         // Hz
+    unsigned num_frequencies;
+    double   frequencies[GOERTZEL_MAX_FREQUENCIES]; // Hz, -sample_rate/2 to +sample_rate/2
+} GoertzelConfig;
+
+/**
+ * @brief One frame of averaged powers, in configuration order, as linear power spectral density
+ *        relative to int16 full scale per Hz.
+ */
+typedef struct {
+    uint64_t      sequence;
+    uint64_t      first_sample;
+    unsigned      block_size;
+    unsigned      averages;
+    unsigned      num_frequencies;
+    const double* frequencies;
+    const float*  power;          // Valid only during the callback
+} GoertzelFrame;
+
+typedef void (*GoertzelFrameCallback)(const GoertzelFrame* frame, void* user);
+
+typedef struct {
+    float coeff;    // 2 cos(w)
+    float cos_w;
+    float sin_w;
+    float s1_re, s1_im, s2_re, s2_im;
+} GoertzelFilter;
+
+typedef struct {
+    GoertzelConfig        config;
+    GoertzelFilter        filters[GOERTZEL_MAX_FREQUENCIES];
+    float                 accum[GOERTZEL_MAX_FREQUENCIES];
+    float                 output[GOERTZEL_MAX_FREQUENCIES];
+    float                 tile_re[GOERTZEL_TILE_SAMPLES];
+    float                 tile_im[GOERTZEL_TILE_SAMPLES];
+    double                scale;
+    unsigned              block_pos;    // Samples into the current block
+    unsigned              accumulated;  // Blocks in `accum`
+    uint64_t              blocks;
+    uint64_t              frame_first_sample;
+    uint64_t              frames;
+    GoertzelFrameCallback callback;
+    void*                 user;
+} GoertzelBank;
+
+
+// --- Function Prototypes ---
+
+/**
+ * @brief Fills in a configuration with a 1024-sample block, 64 averages and no frequencies.
+ */
+void goertzel_config_default(GoertzelConfig* config, double sample_rate);
+
+/**
+ * @brief Appends a frequency to a configuration.
+ * @return 0 on success, -1 if the list is full or the frequency is out of range.
+ */
+int goertzel_config_add(GoertzelConfig* config, double frequency);
+
+/**
+ * @brief Validates the configuration and precomputes the filter coefficients.
+ * @return 0 on success, -1 on failure.
+ */
+int goertzel_bank_init(GoertzelBank* bank, const GoertzelConfig* config, GoertzelFrameCallback callback, void* user);
+
+/**
+ * @brief Consumes complex int16 samples continuing the stream from the previous push.
+ * @return Number of frames emitted.
+ */
+unsigned goertzel_bank_push(GoertzelBank* bank, const void* samples, size_t bytes);
+
+/**
+ * @brief Consumes a filled capture slot.
+ */
+unsigned goertzel_bank_push_slot(GoertzelBank* bank, const CaptureSlot* slot);
+
+#endif // GOERTZEL_H
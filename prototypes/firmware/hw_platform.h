@@ -13,6 +13,10 @@
 #define UIO_DMA_DEV_NAME        "/dev/uio0"
 #define UIO_STREAM_SRC_DEV_NAME "/dev/uio1"
 #define UDMABUF_DEVICE_NAME     "/dev/udmabuf-ddr-nc0"
+// The single-packet tests use the first 12KB of the udmabuf (DMA_BUFFER_SIZE); the capture tests
+// map CAPTURE_BUFFER_SIZE (65MB with the default ring), so the udmabuf's `size` in the device tree
+// overlay, and the reserved memory behind it, must be at least that for them to run. The exported
+// overlay (Libero_description_backup) sets 32MB.
 
 // --- Register Map for the Custom AXI Stream Source IP ---
 // The 'volatile' keyword is crucial. It tells the compiler that the value in memory
@@ -27,51 +31,8 @@ typedef volatile struct {
 } AxiStreamSource_Regs_t;
 
 
-// --- Register Map for the Custom DMA Controller IP ---
-// Note: This is a simplified version based on the original code's usage.
-// A real driver would define all registers.
-#define FDMA_MAX_STREAMS 4
-#define FDMA_MAX_MEMORY_WINDOWS 4
-
-typedef volatile struct {
-    uint32_t ID_REG;
-    uint32_t CONFIG_REG;
-    uint32_t START_OPERATION_REG;
-    uint32_t MPU_PROTECT_REG[FDMA_MAX_MEMORY_WINDOWS];
-    uint32_t INTR_0_STAT_REG;
-    uint32_t INTR_0_MASK_REG;
-    uint32_t INTR_1_STAT_REG;
-    uint32_t INTR_1_MASK_REG;
-    uint32_t STREAM_ADDR_REG[FDMA_MAX_STREAMS];
-    // ... other registers from original code ...
-} Dma_Regs_t;
-
-
-// --- DMA Stream Descriptor Structure ---
-// This structure is NOT a register map. It defines the format of the control
-// structure that the CPU writes into the shared DMA memory buffer. The DMA
-// controller reads this structure to get its instructions.
-typedef volatile struct {
-    uint32_t SRC_ADDR_REG;      // Source Address (not used for stream-to-memory)
-    uint32_t DEST_ADDR_REG;     // Physical destination address in DDR
-    uint32_t BYTE_COUNT_REG;    // Number of bytes to transfer
-    uint32_t CONFIG_REG;        // Configuration flags for the transfer
-} DmaStreamDescriptor_t;
-
-
-// --- Bit Definitions for DMA Registers and Descriptors ---
-
-// For START_OPERATION_REG
-#define FDMA_START_STREAM(id)         (1 << (id + 8))
-
-// For INTR_0_MASK_REG
-#define FDMA_IRQ_MASK_STREAM_DONE(id) (1 << (id + 8))
-
-// For DmaStreamDescriptor_t.CONFIG_REG
-#define STREAM_OP_INCR                (1 << 0) // Incrementing destination address
-#define STREAM_FLAG_IRQ_EN            (1 << 1) // Enable interrupt on completion
-#define STREAM_FLAG_DEST_RDY          (1 << 2) // Flow control: Destination is ready
-#define STREAM_FLAG_VALID             (1 << 3) // This descriptor is valid for processing
+// The DMA controller's register map and descriptor formats live with the DMA library
+// (radiohound-dma/inc/radiohound_dma_regs.h); only that library touches the controller.
 
 #endif // HW_PLATFORM_H
 
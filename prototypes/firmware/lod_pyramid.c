@@ -0,0 +1,323 @@
+// =================================================================================================
+// File: lod_pyramid.c
+// Description: Implementation of the min/max/RMS level-of-detail pyramid writer and reader.
+// =================================================================================================
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "lod_pyramid.h"
+
+#define LOD_PATH_LEN 256
+
+// --- Internal Helpers ---
+
+static void acc_reset(LodAccumulator* a) {
+    a->min_i = INT16_MAX;
+    a->max_i = INT16_MIN;
+    a->min_q = INT16_MAX;
+    a->max_q = INT16_MIN;
+    a->power_sum = 0.0;
+    a->samples = 0;
+}
+
+static void acc_merge_entry(LodAccumulator* a, const LodEntry* e, uint64_t samples) {
+    if (e->min_i < a->min_i) a->min_i = e->min_i;
+    if (e->max_i > a->max_i) a->max_i = e->max_i;
+    if (e->min_q < a->min_q) a->min_q = e->min_q;
+    if (e->max_q > a->max_q) a->max_q = e->max_q;
+    a->power_sum += (double)e->power * (double)samples;
+    a->samples += samples;
+}
+
+static LodEntry acc_entry(const LodAccumulator* a) {
+    LodEntry e = { a->min_i, a->max_i, a->min_q, a->max_q, a->samples ? (float)(a->power_sum / a->samples) : 0.0f };
+    return e;
+}
+
+// Summarizes exactly LOD_BLOCK_SAMPLES samples; the fixed length lets the compiler vectorize it.
+static void add_block(LodAccumulator* a, const int16_t* iq) {
+    int16_t min_i = a->min_i, max_i = a->max_i, min_q = a->min_q, max_q = a->max_q;
+    int64_t power = 0;
+    for (unsigned k = 0; k < LOD_BLOCK_SAMPLES; ++k) {
+        const int16_t i = iq[2 * k], q = iq[2 * k + 1];
+        min_i = i < min_i ? i : min_i;
+        max_i = i > max_i ? i : max_i;
+        min_q = q < min_q ? q : min_q;
+        max_q = q > max_q ? q : max_q;
+        power += (int32_t)i * i + (int32_t)q * q;
+    }
+    a->min_i = min_i;
+    a->max_i = max_i;
+    a->min_q = min_q;
+    a->max_q = max_q;
+    a->power_sum += (double)power;
+    a->samples += LOD_BLOCK_SAMPLES;
+}
+
+static void add_samples(LodAccumulator* a, const int16_t* iq, size_t n) {
+    for (size_t k = 0; k < n; ++k) {
+        const int16_t i = iq[2 * k], q = iq[2 * k + 1];
+        if (i < a->min_i) a->min_i = i;
+        if (i > a->max_i) a->max_i = i;
+        if (q < a->min_q) a->min_q = q;
+        if (q > a->max_q) a->max_q = q;
+        a->power_sum += (double)((int32_t)i * i + (int32_t)q * q);
+    }
+    a->samples += n;
+}
+
+static uint64_t level_span(const LodHeader* h, unsigned level) {
+    uint64_t span = h->base_samples;
+    for (unsigned l = 0; l < level; ++l) span *= h->fanout;
+    return span;
+}
+
+static void flush_level(LodWriter* w, unsigned level) {
+    const unsigned n = w->pending_count[level];
+    if (n == 0) return;
+    const uint64_t first = w->header.level_count[level] - n;
+    const off_t offset = (off_t)(w->header.level_offset[level] + first * sizeof(LodEntry));
+    const size_t bytes = n * sizeof(LodEntry);
+    if (pwrite(w->fd, w->pending + (size_t)level * LOD_WRITE_BATCH, bytes, offset) != (ssize_t)bytes) {
+        w->error = 1;
+    }
+    w->pending_count[level] = 0;
+}
+
+// Emits the entry built at `level` and folds it into the level above.
+static void complete_entry(LodWriter* w, unsigned level) {
+    for (;;) {
+        LodAccumulator* a = &w->acc[level];
+        const LodEntry e = acc_entry(a);
+        w->pending[(size_t)level * LOD_WRITE_BATCH + w->pending_count[level]++] = e;
+        w->header.level_count[level]++;
+        if (w->pending_count[level] == LOD_WRITE_BATCH) flush_level(w, level);
+
+        const uint64_t samples = a->samples;
+        acc_reset(a);
+        if (level + 1 >= w->header.levels) return;
+        acc_merge_entry(&w->acc[level + 1], &e, samples);
+        if (w->acc[level + 1].samples < level_span(&w->header, level + 1)) return;
+        level++;
+    }
+}
+
+static int read_entries_ok(const LodReader* r, unsigned level, uint64_t count) {
+    const uint64_t end = r->header->level_offset[level] + count * sizeof(LodEntry);
+    return end <= r->map_bytes;
+}
+
+
+// --- Public API ---
+
+void lod_config_default(LodConfig* config, uint64_t capacity_samples) {
+    config->base_samples = 256;
+    config->fanout = 4;
+    config->capacity_samples = capacity_samples;
+}
+
+int lod_writer_open(LodWriter* writer, const char* path, const LodConfig* config) {
+    char lod_path[LOD_PATH_LEN];
+
+    memset(writer, 0, sizeof(*writer));
+    writer->fd = -1;
+    if (config->base_samples == 0 || config->base_samples % LOD_BLOCK_SAMPLES != 0 || config->fanout < 2 ||
+        config->capacity_samples == 0) {
+        fprintf(stderr, "LOD: base must be a multiple of %d samples, fanout at least 2, capacity positive\n",
+                LOD_BLOCK_SAMPLES);
+        return -1;
+    }
+    if (snprintf(lod_path, sizeof(lod_path), "%s.lod", path) >= (int)sizeof(lod_path)) {
+        fprintf(stderr, "LOD: path too long\n");
+        return -1;
+    }
+
+    // Levels until one entry covers the whole capacity.
+    LodHeader* h = &writer->header;
+    h->magic = LOD_MAGIC;
+    h->version = LOD_VERSION;
+    h->base_samples = config->base_samples;
+    h->fanout = config->fanout;
+    uint64_t offset = sizeof(LodHeader);
+    uint64_t span = config->base_samples;
+    for (unsigned level = 0; level < LOD_MAX_LEVELS; ++level) {
+        writer->capacity[level] = (config->capacity_samples + span - 1) / span;
+        h->level_offset[level] = offset;
+        offset += writer->capacity[level] * sizeof(LodEntry);
+        h->levels = (uint16_t)(level + 1);
+        if (writer->capacity[level] == 1) break;
+        span *= config->fanout;
+    }
+    if (writer->capacity[h->levels - 1] != 1) {
+        fprintf(stderr, "LOD: capacity needs more than %d levels\n", LOD_MAX_LEVELS);
+        return -1;
+    }
+
+    writer->pending = malloc((size_t)h->levels * LOD_WRITE_BATCH * sizeof(LodEntry));
+    if (!writer->pending) {
+        fprintf(stderr, "LOD: failed to allocate write buffers\n");
+        return -1;
+    }
+    writer->fd = open(lod_path, O_CREAT | O_TRUNC | O_RDWR, 0644);
+    if (writer->fd < 0) {
+        perror("LOD: failed to open");
+        free(writer->pending);
+        writer->pending = NULL;
+        return -1;
+    }
+    // Regions not yet written stay holes until their entries arrive.
+    if (ftruncate(writer->fd, (off_t)offset) != 0 ||
+        pwrite(writer->fd, h, sizeof(*h), 0) != (ssize_t)sizeof(*h)) {
+        perror("LOD: failed to size the file");
+        lod_writer_close(writer);
+        return -1;
+    }
+    for (unsigned level = 0; level < h->levels; ++level) acc_reset(&writer->acc[level]);
+    return 0;
+}
+
+int lod_writer_add(LodWriter* writer, const int16_t* iq, size_t samples) {
+    const uint64_t capacity = writer->capacity[0] * writer->header.base_samples;
+    if (writer->header.samples + samples > capacity) {
+        const size_t keep = writer->header.samples < capacity ? (size_t)(capacity - writer->header.samples) : 0;
+        writer->dropped += samples - keep;
+        samples = keep;
+    }
+    writer->header.samples += samples;
+
+    const unsigned base = writer->header.base_samples;
+    LodAccumulator* a = &writer->acc[0];
+    while (samples > 0) {
+        size_t n = base - a->samples;
+        if (n > samples) n = samples;
+        // Whole blocks take the vectorized path; a slot boundary inside a block takes the slow one.
+        if (a->samples % LOD_BLOCK_SAMPLES == 0) {
+            size_t blocks = n / LOD_BLOCK_SAMPLES;
+            for (size_t b = 0; b < blocks; ++b) add_block(a, iq + 2 * b * LOD_BLOCK_SAMPLES);
+            add_samples(a, iq + 2 * blocks * LOD_BLOCK_SAMPLES, n - blocks * LOD_BLOCK_SAMPLES);
+        } else {
+            size_t head = LOD_BLOCK_SAMPLES - a->samples % LOD_BLOCK_SAMPLES;
+            n = head < n ? head : n;
+            add_samples(a, iq, n);
+        }
+        iq += 2 * n;
+        samples -= n;
+        if (a->samples == base) complete_entry(writer, 0);
+    }
+    return writer->error ? -1 : 0;
+}
+
+int lod_writer_add_slot(LodWriter* writer, const CaptureSlot* slot) {
+    return lod_writer_add(writer, (const int16_t*)slot->data, slot->length / LOD_BYTES_PER_SAMPLE);
+}
+
+int lod_writer_close(LodWriter* writer) {
+    int rc = 0;
+    if (writer->fd >= 0) {
+        // Partial entries at every level, lowest first so each is folded into the next.
+        for (unsigned level = 0; level < writer->header.levels; ++level) {
+            if (writer->acc[level].samples > 0) complete_entry(writer, level);
+        }
+        for (unsigned level = 0; level < writer->header.levels; ++level) flush_level(writer, level);
+        if (writer->error ||
+            pwrite(writer->fd, &writer->header, sizeof(writer->header), 0) != (ssize_t)sizeof(writer->header) ||
+            fdatasync(writer->fd) != 0) {
+            rc = -1;
+        }
+        if (close(writer->fd) != 0) rc = -1;
+        writer->fd = -1;
+    }
+    free(writer->pending);
+    writer->pending = NULL;
+    return rc;
+}
+
+int lod_reader_open(LodReader* reader, const char* path) {
+    char lod_path[LOD_PATH_LEN];
+    struct stat st;
+
+    memset(reader, 0, sizeof(*reader));
+    reader->fd = -1;
+    if (snprintf(lod_path, sizeof(lod_path), "%s.lod", path) >= (int)sizeof(lod_path)) {
+        fprintf(stderr, "LOD: path too long\n");
+        return -1;
+    }
+    reader->fd = open(lod_path, O_RDONLY);
+    if (reader->fd < 0) {
+        perror("LOD: failed to open");
+        return -1;
+    }
+    if (fstat(reader->fd, &st) != 0 || st.st_size < (off_t)sizeof(LodHeader)) {
+        fprintf(stderr, "LOD: %s is too short\n", lod_path);
+        lod_reader_close(reader);
+        return -1;
+    }
+    void* map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, reader->fd, 0);
+    if (map == MAP_FAILED) {
+        perror("LOD: failed to map");
+        lod_reader_close(reader);
+        return -1;
+    }
+    reader->map = map;
+    reader->map_bytes = (size_t)st.st_size;
+    reader->header = map;
+
+    const LodHeader* h = reader->header;
+    int valid = h->magic == LOD_MAGIC && h->version == LOD_VERSION && h->levels >= 1 &&
+                h->levels <= LOD_MAX_LEVELS && h->base_samples > 0 && h->fanout >= 2;
+    for (unsigned level = 0; valid && level < h->levels; ++level) {
+        valid = read_entries_ok(reader, level, h->level_count[level]);
+    }
+    if (!valid) {
+        fprintf(stderr, "LOD: %s is not a version %d pyramid\n", lod_path, LOD_VERSION);
+        lod_reader_close(reader);
+        return -1;
+    }
+    return 0;
+}
+
+int lod_reader_query(const LodReader* reader, uint64_t first_sample, uint64_t samples, unsigned points,
+                     LodEntry* out, unsigned* level) {
+    const LodHeader* h = reader->header;
+    if (points == 0 || samples == 0) return -1;
+
+    // Coarsest level whose entries are no longer than a point.
+    const uint64_t per_point = samples / points;
+    unsigned l = 0;
+    while (l + 1 < h->levels && level_span(h, l + 1) <= per_point) l++;
+    if (level) *level = l;
+
+    const uint64_t span = level_span(h, l);
+    const LodEntry* entries = (const LodEntry*)(reader->map + h->level_offset[l]);
+    const uint64_t count = h->level_count[l];
+    int filled = 0;
+    for (unsigned p = 0; p < points; ++p) {
+        const uint64_t a = first_sample + samples * p / points;
+        const uint64_t b = first_sample + samples * (p + 1) / points;
+        if (a >= h->samples) break;
+        uint64_t e0 = a / span;
+        uint64_t e1 = (b > a ? b - 1 : a) / span + 1;
+        if (e1 > count) e1 = count;
+
+        LodAccumulator acc;
+        acc_reset(&acc);
+        for (uint64_t e = e0; e < e1; ++e) {
+            const uint64_t end = (e + 1) * span < h->samples ? (e + 1) * span : h->samples;
+            acc_merge_entry(&acc, &entries[e], end - e * span);
+        }
+        out[filled++] = acc_entry(&acc);
+    }
+    return filled;
+}
+
+void lod_reader_close(LodReader* reader) {
+    if (reader->map) munmap((void*)reader->map, reader->map_bytes);
+    if (reader->fd >= 0) close(reader->fd);
+    memset(reader, 0, sizeof(*reader));
+    reader->fd = -1;
+}
@@ -0,0 +1,143 @@
+// =================================================================================================
+// File: lod_pyramid.h
+// Description: Min/max/RMS level-of-detail pyramid built while recording, so any time range of a
+//              long capture can be drawn or scanned at any zoom from a few KB of reads.
+//
+// Level 0 summarizes every `base_samples` samples with the minimum and maximum of I and Q and the
+// mean power |x|^2; each level above merges `fanout` entries of the one below, up to a level with a
+// single entry. With the defaults (256 samples, fanout 4) level 0 takes 12 bytes per 1 KB of
+// samples and all the levels above add a third of that, about 1.6% of the capture in total.
+// Entries are written as they complete, so building costs one pass over the samples and a few KB
+// of state.
+//
+// The pyramid lives next to the capture in <path>.lod. Every level has a fixed region sized from
+// the capacity given at open, so an entry's position is known without an index; the header with
+// the final counts is written at close. A query for N points over a range reads one level where
+// each point spans at least one entry, i.e. at most N * fanout entries, whatever the range length.
+// =================================================================================================
+
+#ifndef LOD_PYRAMID_H
+#define LOD_PYRAMID_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "capture_session.h"
+
+// --- Configuration ---
+
+#define LOD_MAGIC            0x31444F4C // "LOD1"
+#define LOD_VERSION          1
+#define LOD_MAX_LEVELS       24
+#define LOD_BLOCK_SAMPLES    64   // base_samples must be a multiple of this
+#define LOD_WRITE_BATCH      256  // Entries buffered per level between writes
+#define LOD_BYTES_PER_SAMPLE 4    // Complex int16 (I low, Q high)
+
+typedef struct {
+    unsigned base_samples;     // Samples per level-0 entry
+    unsigned fanout;           // Entries merged into one at the next level
+    uint64_t capacity_samples; // Longest capture the file has room for
+} LodConfig;
+
+/**
+ * @brief Summary of a run of samples (little-endian, stored as is in the file).
+ */
+typedef struct __attribute__((packed)) {
+    int16_t min_i;
+    int16_t max_i;
+    int16_t min_q;
+    int16_t max_q;
+    float   power;  // Mean I^2 + Q^2; RMS amplitude is its square root
+} LodEntry;
+
+/**
+ * @brief File header. Level regions follow in order, each `capacity` entries long.
+ */
+typedef struct __attribute__((packed)) {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t levels;
+    uint32_t base_samples;
+    uint32_t fanout;
+    uint64_t samples;                      // Samples summarized (set at close)
+    uint64_t level_offset[LOD_MAX_LEVELS]; // File offset of each level's region
+    uint64_t level_count[LOD_MAX_LEVELS];  // Entries written per level (set at close)
+} LodHeader;
+
+typedef struct {
+    int16_t  min_i, max_i, min_q, max_q;
+    double   power_sum;
+    uint64_t samples;
+} LodAccumulator;
+
+typedef struct {
+    int            fd;
+    LodHeader      header;
+    LodAccumulator acc[LOD_MAX_LEVELS]; // Entry being built at each level
+    uint64_t       capacity[LOD_MAX_LEVELS];
+    LodEntry*      pending;             // LOD_WRITE_BATCH entries per level
+    unsigned       pending_count[LOD_MAX_LEVELS];
+    uint64_t       dropped;             // Samples beyond the capacity
+    int            error;
+} LodWriter;
+
+typedef struct {
+    int              fd;
+    const uint8_t*   map;
+    size_t           map_bytes;
+    const LodHeader* header;
+} LodReader;
+
+
+// --- Function Prototypes ---
+
+/**
+ * @brief Fills in a configuration: 256-sample level-0 entries, fanout 4.
+ */
+void lod_config_default(LodConfig* config, uint64_t capacity_samples);
+
+/**
+ * @brief Creates <path>.lod with room for `capacity_samples` samples.
+ * @return 0 on success, -1 on failure.
+ */
+int lod_writer_open(LodWriter* writer, const char* path, const LodConfig* config);
+
+/**
+ * @brief Adds complex int16 samples in stream order. Samples past the capacity are counted and
+ *        dropped.
+ * @return 0 on success, -1 if a write failed.
+ */
+int lod_writer_add(LodWriter* writer, const int16_t* iq, size_t samples);
+
+/**
+ * @brief Adds the contents of a filled capture slot.
+ */
+int lod_writer_add_slot(LodWriter* writer, const CaptureSlot* slot);
+
+/**
+ * @brief Writes the partial entries and the final header, and closes the file.
+ * @return 0 on success, -1 if anything failed.
+ */
+int lod_writer_close(LodWriter* writer);
+
+/**
+ * @brief Maps <path>.lod read-only.
+ * @return 0 on success, -1 if the file is missing or malformed.
+ */
+int lod_reader_open(LodReader* reader, const char* path);
+
+/**
+ * @brief Summarizes [first_sample, first_sample + samples) as `points` consecutive summaries.
+ * Each point merges the entries of the chosen level that overlap it, so its bounds may reach up
+ * to one entry beyond the exact range.
+ * @param level Receives the level read (may be NULL).
+ * @return Number of points filled (fewer if the range runs past the recording), or -1 on error.
+ */
+int lod_reader_query(const LodReader* reader, uint64_t first_sample, uint64_t samples, unsigned points,
+                     LodEntry* out, unsigned* level);
+
+/**
+ * @brief Unmaps and closes the file.
+ */
+void lod_reader_close(LodReader* reader);
+
+#endif // LOD_PYRAMID_H
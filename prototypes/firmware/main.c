@@ -12,37 +12,40 @@
 
 #include "app_config.h"
 #include "hw_platform.h"
+#include "radiohound_dma_api.h"
 #include "test_suite.h"
 
 // --- Global Resource Handles ---
 // Grouping these into a struct makes them easier to pass around.
 typedef struct {
-    int dma_uio_fd;
+    RhDma dma;
+    int dma_open;
     int stream_src_uio_fd;
     int udma_buf_fd;
-    Dma_Regs_t* dma_regs;
     AxiStreamSource_Regs_t* stream_src_regs;
     uint8_t* dma_virt_base;
     uintptr_t dma_phys_base;
     size_t dma_buffer_size;
+    uint8_t* capture_virt_base; // Mapping of CAPTURE_BUFFER_SIZE, made by the first capture test
 } AppResources;
 
 
 // --- Function Prototypes for main.c ---
 void display_menu();
 int initialize_system(AppResources* res);
+int map_capture_buffer(AppResources* res);
 void cleanup_system(AppResources* res);
 
 
 // --- Main Application Logic ---
 int main(void) {
     AppResources app = {
-        .dma_uio_fd = -1,
+        .dma_open = 0,
         .stream_src_uio_fd = -1,
         .udma_buf_fd = -1,
-        .dma_regs = NULL,
         .stream_src_regs = NULL,
         .dma_virt_base = NULL,
+        .capture_virt_base = NULL,
         .dma_phys_base = DMA_PHYSICAL_BASE_ADDR,
         .dma_buffer_size = DMA_BUFFER_SIZE
     };
@@ -60,11 +63,64 @@ int main(void) {
         while(getchar() != '\n'); // Clear input buffer
 
         if (choice == '1') {
-            run_axi_stream_source_test(app.dma_regs, app.stream_src_regs, app.dma_uio_fd, app.dma_phys_base, app.dma_virt_base);
+            run_axi_stream_source_test(&app.dma, app.stream_src_regs, app.dma_phys_base, app.dma_virt_base);
         } else if (choice == '2') {
-            run_diagnostics(app.dma_regs, app.stream_src_regs);
+            run_diagnostics(app.dma_open ? &app.dma : NULL, app.stream_src_regs);
         } else if (choice == '3') {
             run_axi_lite_reg_test(app.stream_src_regs);
+        } else if (choice == '4') {
+            unsigned long capture_mb = 0;
+            printf("Capture size in MB: ");
+            if (scanf("%lu", &capture_mb) == 1 && capture_mb > 0) {
+                if (map_capture_buffer(&app) == 0) {
+                    run_segmented_capture_test(&app.dma, app.stream_src_regs, app.dma_phys_base,
+                                               app.capture_virt_base, CAPTURE_BUFFER_SIZE, (uint64_t)capture_mb * 1024 * 1024);
+                }
+            } else {
+                printf("Invalid capture size.\n");
+            }
+            while(getchar() != '\n'); // Clear input buffer
+        } else if (choice == '5') {
+            unsigned long capture_mb = 0;
+            char path[256];
+            printf("Capture size in MB and output file: ");
+            if (scanf("%lu %255s", &capture_mb, path) == 2 && capture_mb > 0) {
+                if (map_capture_buffer(&app) == 0) {
+                    run_capture_recording_test(&app.dma, app.stream_src_regs, app.dma_phys_base,
+                                               app.capture_virt_base, CAPTURE_BUFFER_SIZE, (uint64_t)capture_mb * 1024 * 1024, path);
+                }
+            } else {
+                printf("Invalid input.\n");
+            }
+            while(getchar() != '\n'); // Clear input buffer
+        } else if (choice == '6') {
+            unsigned long capture_mb = 0;
+            int level = 0;
+            char path[256];
+            printf("Capture size in MB, trigger level (1-32767) and output file: ");
+            if (scanf("%lu %d %255s", &capture_mb, &level, path) == 3 && capture_mb > 0 && level > 0 && level <= 32767) {
+                if (map_capture_buffer(&app) == 0) {
+                    run_triggered_capture_test(&app.dma, app.stream_src_regs, app.dma_phys_base,
+                                               app.capture_virt_base, CAPTURE_BUFFER_SIZE, (uint64_t)capture_mb * 1024 * 1024,
+                                               (int16_t)level, path);
+                }
+            } else {
+                printf("Invalid input.\n");
+            }
+            while(getchar() != '\n'); // Clear input buffer
+        } else if (choice == '7') {
+            unsigned long capture_mb = 0;
+            char path[256];
+            printf("Capture size in MB and output file: ");
+            if (scanf("%lu %255s", &capture_mb, path) == 2 && capture_mb > 0) {
+                if (map_capture_buffer(&app) == 0) {
+                    run_capture_file_test(&app.dma, app.stream_src_regs, app.dma_phys_base,
+                                          app.capture_virt_base, CAPTURE_BUFFER_SIZE, (uint64_t)capture_mb * 1024 * 1024, path);
+                }
+            } else {
+                printf("Invalid input.\n");
+            }
+            while(getchar() != '\n'); // Clear input buffer
         } else if (choice == 'Q' || choice == 'q') {
             break;
         } else {
@@ -81,25 +137,16 @@ void display_menu() {
     printf("  1 - Run Custom AXI Stream Source IP Test (Full DMA Test)\n");
     printf("  2 - Run Diagnostics\n");
     printf("  3 - Run AXI-Lite Register R/W Test\n");
+    printf("  4 - Run Segmented Capture Test (multi-packet capture)\n");
+    printf("  5 - Record Capture to File\n");
+    printf("  6 - Triggered Capture to File (pre/post-trigger snippets)\n");
+    printf("  7 - Record Indexed Capture File (seekable, checksummed, min/max pyramid)\n");
     printf("  Q - Exit\n> ");
 }
 
 int initialize_system(AppResources* res) {
     printf("--- Initializing DMA and Peripherals ---\n");
 
-    // Map DMA Controller
-    res->dma_uio_fd = open(UIO_DMA_DEV_NAME, O_RDWR);
-    if (res->dma_uio_fd < 0) {
-        perror("Failed to open DMA UIO device");
-        return -1;
-    }
-    res->dma_regs = mmap(NULL, 4096, PROT_READ | PROT_WRITE, MAP_SHARED, res->dma_uio_fd, 0);
-    if (res->dma_regs == MAP_FAILED) {
-        perror("Failed to mmap DMA registers");
-        res->dma_regs = NULL; // Ensure pointer is NULL on failure
-        return -1;
-    }
-
     // Map AXI Stream Source
     res->stream_src_uio_fd = open(UIO_STREAM_SRC_DEV_NAME, O_RDWR);
     if (res->stream_src_uio_fd < 0) {
@@ -126,8 +173,19 @@ int initialize_system(AppResources* res) {
         return -1;
     }
 
+    // Open the DMA controller; its stream descriptors live at the start of the udmabuf region
+    RhDmaConfig dma_config;
+    rh_dma_config_default(&dma_config);
+    dma_config.uio_path = UIO_DMA_DEV_NAME;
+    dma_config.desc_phys = res->dma_phys_base + STREAM_DESCRIPTOR_OFFSET;
+    dma_config.desc_virt = res->dma_virt_base + STREAM_DESCRIPTOR_OFFSET;
+    if (rh_dma_open(&res->dma, &dma_config) != 0) {
+        return -1;
+    }
+    res->dma_open = 1;
+
     printf("Successfully mapped peripherals:\n");
-    printf("  DMA Controller      (UIO): %s\n", UIO_DMA_DEV_NAME);
+    printf("  DMA Controller      (UIO): %s (Version: 0x%08X)\n", UIO_DMA_DEV_NAME, rh_dma_regs(&res->dma)->VERSION_REG);
     printf("  AXI Stream Source   (UIO): %s\n", UIO_STREAM_SRC_DEV_NAME);
     printf("  DMA Buffer      (UDMABuf): %s (Size: %zu KB, Phys Addr: 0x%lX)\n",
            UDMABUF_DEVICE_NAME, res->dma_buffer_size / 1024, res->dma_phys_base);
@@ -135,14 +193,30 @@ int initialize_system(AppResources* res) {
     return 0; // Success
 }
 
+// Maps the udmabuf up to the end of the capture ring the first time a capture needs it. The
+// descriptors stay in the startup mapping; both map the same pages.
+int map_capture_buffer(AppResources* res) {
+    if (res->capture_virt_base) return 0;
+
+    void* base = mmap(NULL, CAPTURE_BUFFER_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, res->udma_buf_fd, 0);
+    if (base == MAP_FAILED) {
+        perror("Failed to mmap the capture ring");
+        printf("  Captures need a udmabuf of at least %lu KB (see hw_platform.h).\n",
+               (unsigned long)(CAPTURE_BUFFER_SIZE / 1024));
+        return -1;
+    }
+    res->capture_virt_base = base;
+    return 0;
+}
+
 void cleanup_system(AppResources* res) {
     printf("\nCleaning up and exiting.\n");
 
-    if (res->dma_regs) munmap((void*)res->dma_regs, 4096);
+    if (res->dma_open) rh_dma_close(&res->dma);
     if (res->stream_src_regs) munmap((void*)res->stream_src_regs, 4096);
     if (res->dma_virt_base) munmap(res->dma_virt_base, res->dma_buffer_size);
+    if (res->capture_virt_base) munmap(res->capture_virt_base, CAPTURE_BUFFER_SIZE);
 
-    if (res->dma_uio_fd != -1) close(res->dma_uio_fd);
     if (res->stream_src_uio_fd != -1) close(res->stream_src_uio_fd);
     if (res->udma_buf_fd != -1) close(res->udma_buf_fd);
 }
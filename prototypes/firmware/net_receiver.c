@@ -0,0 +1,310 @@
+// =================================================================================================
+// File: net_receiver.c
+// Description: Small receiver for the network sink. Validates chunk headers (rejecting any header
+//              version but NET_SINK_VERSION, whose layout it would misread), counts lost and
+//              reordered chunks from the sequence numbers (and each session's closing chunk count,
+//              so chunks lost at either end of a session are included), checks each fully received
+//              slot against the CRC32C taken when it completed on the board, and reports
+//              throughput once a second.
+//
+// Usage: net_receiver <udp|tcp> <port> [seconds]
+// =================================================================================================
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <endian.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <poll.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#include "net_sink.h"
+#include "crc32c.h"
+
+#define RECV_BATCH        64
+#define RECV_BUFFER_BYTES (sizeof(NetPacketHeader) + NET_SINK_MAX_PAYLOAD)
+#define RECV_SOCKET_BUFFER (16 * 1024 * 1024)
+
+// --- Receiver State ---
+typedef struct {
+    uint32_t session;
+    uint32_t previous_session;
+    uint64_t previous_expected;
+    uint64_t sessions;
+    uint64_t expected_sequence; // One past the highest sequence seen in the session
+    uint64_t chunks;
+    uint64_t bytes;
+    uint64_t lost;
+    uint64_t reordered;
+    uint64_t malformed;
+    uint64_t wrong_version;   // Chunks whose header layout this receiver does not know
+    uint64_t interval_bytes;
+    int      started;
+    int      in_order;        // The last chunk was the one expected next
+
+    int      checking;        // A slot with a CRC is being reassembled from in-order chunks
+    uint32_t slot_sequence;
+    uint32_t slot_crc;
+    uint64_t slots_verified;
+    uint64_t crc_errors;
+} ReceiverStats;
+
+static volatile sig_atomic_t keep_running = 1;
+
+static void handle_signal(int sig) {
+    (void)sig;
+    keep_running = 0;
+}
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Accounts for one chunk. Returns the payload length, or -1 if the header is not valid.
+static long account_chunk(ReceiverStats* st, const NetPacketHeader* wire, size_t available) {
+    if (available < sizeof(NetPacketHeader) || le32toh(wire->magic) != NET_SINK_MAGIC ||
+        le16toh(wire->header_bytes) < sizeof(NetPacketHeader)) {
+        st->malformed++;
+        return -1;
+    }
+    if (le16toh(wire->version) != NET_SINK_VERSION) {
+        if (st->wrong_version++ == 0) {
+            printf("Ignoring chunks with header version %u; this receiver reads version %d.\n",
+                   le16toh(wire->version), NET_SINK_VERSION);
+        }
+        return -1;
+    }
+
+    uint64_t seq = le64toh(wire->sequence);
+    uint32_t payload = le32toh(wire->payload_bytes);
+    uint32_t session = le32toh(wire->session);
+
+    // Every session numbers its chunks from 0, so chunks before the first one seen were lost. A
+    // straggler from the session before is accounted against that session.
+    uint64_t* expected = &st->expected_sequence;
+    if (st->sessions > 1 && session == st->previous_session) {
+        expected = &st->previous_expected;
+    } else if (!st->started || session != st->session) {
+        st->previous_session = st->session;
+        st->previous_expected = st->expected_sequence;
+        st->session = session;
+        st->expected_sequence = 0;
+        st->started = 1;
+        st->sessions++;
+    }
+
+    st->in_order = expected == &st->expected_sequence && seq == *expected;
+    if (le32toh(wire->flags) & NET_CHUNK_SESSION_END) {
+        // `seq` is the number of chunks the session sent; anything past the last one seen was lost.
+        if (seq > *expected) {
+            st->lost += seq - *expected;
+            *expected = seq;
+        }
+        st->in_order = 0;
+        return 0;
+    }
+    if (seq == *expected) {
+        (*expected)++;
+    } else if (seq > *expected) {
+        st->lost += seq - *expected;
+        *expected = seq + 1;
+    } else {
+        // A late chunk we already counted as lost.
+        st->reordered++;
+        if (st->lost > 0) st->lost--;
+    }
+
+    st->chunks++;
+    st->bytes += payload;
+    st->interval_bytes += payload;
+    return payload;
+}
+
+// Starts or continues the slot check for a chunk. A slot is only checked if every one of its chunks
+// arrives in order, starting with the first.
+static void slot_begin_chunk(ReceiverStats* st, const NetPacketHeader* wire) {
+    uint32_t flags = le32toh(wire->flags);
+    uint32_t slot = le32toh(wire->slot_sequence);
+    if (!(flags & NET_CHUNK_SLOT_CRC)) {
+        st->checking = 0;
+    } else if (flags & NET_CHUNK_SLOT_START) {
+        st->checking = 1;
+        st->slot_sequence = slot;
+        st->slot_crc = 0;
+    } else if (!st->in_order || slot != st->slot_sequence) {
+        st->checking = 0;
+    }
+}
+
+static void slot_add_payload(ReceiverStats* st, const void* data, size_t len) {
+    if (st->checking) st->slot_crc = crc32c_extend(st->slot_crc, data, len);
+}
+
+static void slot_end_chunk(ReceiverStats* st, const NetPacketHeader* wire) {
+    if (!st->checking || !(le32toh(wire->flags) & NET_CHUNK_SLOT_END)) return;
+    if (st->slot_crc == le32toh(wire->slot_crc32c)) {
+        st->slots_verified++;
+    } else {
+        st->crc_errors++;
+        printf("  Slot %u failed its CRC32C check (0x%08x, sent 0x%08x).\n", st->slot_sequence, st->slot_crc,
+               le32toh(wire->slot_crc32c));
+    }
+    st->checking = 0;
+}
+
+static void print_summary(const ReceiverStats* st, double elapsed) {
+    uint64_t total = st->chunks + st->lost;
+    printf("\n***** Receiver Summary *****\n");
+    printf("Received %llu chunks (%llu MB) in %.2f s: %.2f MB/s\n",
+           (unsigned long long)st->chunks, (unsigned long long)(st->bytes / (1024 * 1024)), elapsed,
+           elapsed > 0 ? (double)st->bytes / elapsed / (1024.0 * 1024.0) : 0.0);
+    printf("Sessions: %llu. Lost: %llu (%.4f%%), reordered: %llu, malformed: %llu, wrong version: %llu\n",
+           (unsigned long long)st->sessions, (unsigned long long)st->lost, total ? 100.0 * (double)st->lost / (double)total : 0.0,
+           (unsigned long long)st->reordered, (unsigned long long)st->malformed, (unsigned long long)st->wrong_version);
+    printf("Slots checked against their completion CRC32C: %llu, failed: %llu\n",
+           (unsigned long long)(st->slots_verified + st->crc_errors), (unsigned long long)st->crc_errors);
+    printf("****************************\n");
+}
+
+static int open_listener(int tcp, uint16_t port) {
+    int fd = socket(AF_INET, tcp ? SOCK_STREAM : SOCK_DGRAM, 0);
+    if (fd < 0) {
+        perror("socket");
+        return -1;
+    }
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    int bufsize = RECV_SOCKET_BUFFER;
+    setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &bufsize, sizeof(bufsize));
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0 || (tcp && listen(fd, 1) != 0)) {
+        perror("bind/listen");
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// Reads exactly `len` bytes from a stream socket. Returns 0 on success, -1 on EOF/error/stop.
+static int read_full(int fd, void* buf, size_t len) {
+    uint8_t* ptr = buf;
+    while (len > 0 && keep_running) {
+        ssize_t n = recv(fd, ptr, len, 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return -1;
+        ptr += n;
+        len -= (size_t)n;
+    }
+    return len == 0 ? 0 : -1;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 3 || (strcmp(argv[1], "udp") != 0 && strcmp(argv[1], "tcp") != 0)) {
+        printf("Usage: %s <udp|tcp> <port> [seconds]\n", argv[0]);
+        return 1;
+    }
+    int tcp = strcmp(argv[1], "tcp") == 0;
+    uint16_t port = (uint16_t)atoi(argv[2]);
+    double duration = argc >= 4 ? atof(argv[3]) : 0.0;
+
+    signal(SIGINT, handle_signal);
+    signal(SIGTERM, handle_signal);
+
+    int listen_fd = open_listener(tcp, port);
+    if (listen_fd < 0) return 1;
+    printf("Listening for %s chunks on port %u...\n", tcp ? "TCP" : "UDP", port);
+
+    static uint8_t buffers[RECV_BATCH][RECV_BUFFER_BYTES];
+    ReceiverStats st;
+    memset(&st, 0, sizeof(st));
+
+    int fd = listen_fd;
+    if (tcp) {
+        fd = accept(listen_fd, NULL, NULL);
+        if (fd < 0) {
+            perror("accept");
+            close(listen_fd);
+            return 1;
+        }
+    }
+
+    double start = 0.0, last_report = 0.0, last_data = 0.0;
+    while (keep_running) {
+        struct pollfd pfd = { .fd = fd, .events = POLLIN };
+        int ready = poll(&pfd, 1, 200);
+        double now = now_seconds();
+
+        // Stop after the requested duration, or 2 s after traffic stops once it has started.
+        if (st.started && ((duration > 0 && now - start >= duration) || now - last_data > 2.0)) break;
+        if (ready <= 0) continue;
+
+        if (tcp) {
+            NetPacketHeader hdr;
+            if (read_full(fd, &hdr, sizeof(hdr)) != 0) break;
+            long payload = account_chunk(&st, &hdr, sizeof(hdr));
+            if (payload < 0) break; // Lost framing on a stream; nothing sensible left to do
+            size_t extension = le16toh(hdr.header_bytes) - sizeof(hdr);
+            if (extension > 0 && read_full(fd, buffers[0], extension) != 0) break;
+            slot_begin_chunk(&st, &hdr);
+            size_t remaining = (size_t)payload;
+            while (remaining > 0) {
+                size_t n = remaining < RECV_BUFFER_BYTES ? remaining : RECV_BUFFER_BYTES;
+                if (read_full(fd, buffers[0], n) != 0) break;
+                slot_add_payload(&st, buffers[0], n);
+                remaining -= n;
+            }
+            if (remaining > 0) break;
+            slot_end_chunk(&st, &hdr);
+        } else {
+            struct mmsghdr msgs[RECV_BATCH];
+            struct iovec iov[RECV_BATCH];
+            for (int i = 0; i < RECV_BATCH; ++i) {
+                iov[i].iov_base = buffers[i];
+                iov[i].iov_len = RECV_BUFFER_BYTES;
+                memset(&msgs[i].msg_hdr, 0, sizeof(msgs[i].msg_hdr));
+                msgs[i].msg_hdr.msg_iov = &iov[i];
+                msgs[i].msg_hdr.msg_iovlen = 1;
+            }
+            int n = recvmmsg(fd, msgs, RECV_BATCH, MSG_DONTWAIT, NULL);
+            for (int i = 0; i < n; ++i) {
+                const NetPacketHeader* hdr = (const NetPacketHeader*)buffers[i];
+                long payload = account_chunk(&st, hdr, msgs[i].msg_len);
+                if (payload < 0) continue;
+                // A truncated datagram simply fails the check.
+                size_t offset = le16toh(hdr->header_bytes);
+                size_t available = msgs[i].msg_len > offset ? msgs[i].msg_len - offset : 0;
+                slot_begin_chunk(&st, hdr);
+                slot_add_payload(&st, buffers[i] + offset, (size_t)payload < available ? (size_t)payload : available);
+                slot_end_chunk(&st, hdr);
+            }
+        }
+
+        now = now_seconds();
+        if (st.chunks > 0 && start == 0.0) start = last_report = now;
+        last_data = now;
+        if (now - last_report >= 1.0) {
+            printf("  %8.2f MB/s, %llu chunks, %llu lost\n",
+                   (double)st.interval_bytes / (now - last_report) / (1024.0 * 1024.0),
+                   (unsigned long long)st.chunks, (unsigned long long)st.lost);
+            st.interval_bytes = 0;
+            last_report = now;
+        }
+    }
+
+    print_summary(&st, last_data - start);
+    if (fd != listen_fd) close(fd);
+    close(listen_fd);
+    return 0;
+}
@@ -0,0 +1,355 @@
+// =================================================================================================
+// File: net_sink.c
+// Description: Implementation of the batched, zero-copy network sink.
+// =================================================================================================
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <endian.h>
+#include <poll.h>
+#include <time.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <linux/errqueue.h>
+#include "net_sink.h"
+#include "crc32c.h"
+
+// Older libc headers may not carry the zero-copy constants even when the kernel supports them.
+#ifndef SO_ZEROCOPY
+#define SO_ZEROCOPY 60
+#endif
+#ifndef MSG_ZEROCOPY
+#define MSG_ZEROCOPY 0x4000000
+#endif
+#ifndef SO_EE_ORIGIN_ZEROCOPY
+#define SO_EE_ORIGIN_ZEROCOPY 5
+#endif
+#ifndef SO_EE_CODE_ZEROCOPY_COPIED
+#define SO_EE_CODE_ZEROCOPY_COPIED 1
+#endif
+
+#define NET_SINK_SOCKET_BUFFER (8 * 1024 * 1024)
+
+// --- Zero-Copy Completion Tracking ---
+
+static void merge_completed_ranges(NetSink* sink) {
+    int merged = 1;
+    while (merged) {
+        merged = 0;
+        for (unsigned i = 0; i < sink->zc_range_count; ++i) {
+            if (sink->zc_ranges[i][0] == sink->zc_completed) {
+                sink->zc_completed = sink->zc_ranges[i][1] + 1;
+                sink->zc_ranges[i][0] = sink->zc_ranges[sink->zc_range_count - 1][0];
+                sink->zc_ranges[i][1] = sink->zc_ranges[sink->zc_range_count - 1][1];
+                sink->zc_range_count--;
+                merged = 1;
+                break;
+            }
+        }
+    }
+}
+
+// Drains the socket error queue, where the kernel posts zero-copy completion notifications.
+static void poll_zerocopy_completions(NetSink* sink, int timeout_ms) {
+    for (;;) {
+        char control[128];
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+
+        if (recvmsg(sink->fd, &msg, MSG_ERRQUEUE | MSG_DONTWAIT) < 0) {
+            if (errno == EAGAIN && timeout_ms > 0) {
+                struct pollfd pfd = { .fd = sink->fd, .events = 0 };
+                if (poll(&pfd, 1, timeout_ms) <= 0) return;
+                timeout_ms = 0;
+                continue;
+            }
+            return;
+        }
+
+        for (struct cmsghdr* cm = CMSG_FIRSTHDR(&msg); cm; cm = CMSG_NXTHDR(&msg, cm)) {
+            if (!((cm->cmsg_level == SOL_IP && cm->cmsg_type == IP_RECVERR) ||
+                  (cm->cmsg_level == SOL_IPV6 && cm->cmsg_type == IPV6_RECVERR))) continue;
+
+            struct sock_extended_err err;
+            memcpy(&err, CMSG_DATA(cm), sizeof(err));
+            if (err.ee_origin != SO_EE_ORIGIN_ZEROCOPY || err.ee_errno != 0) continue;
+
+            uint32_t lo = err.ee_info, hi = err.ee_data;
+            if (err.ee_code & SO_EE_CODE_ZEROCOPY_COPIED) sink->stats.zerocopy_copied += hi - lo + 1;
+
+            if (lo == sink->zc_completed) {
+                sink->zc_completed = hi + 1;
+                merge_completed_ranges(sink);
+            } else {
+                // Cannot overflow: send_chunks() keeps fewer than NET_SINK_HEADER_POOL ids in flight.
+                sink->zc_ranges[sink->zc_range_count][0] = lo;
+                sink->zc_ranges[sink->zc_range_count][1] = hi;
+                sink->zc_range_count++;
+            }
+        }
+        timeout_ms = 0;
+    }
+}
+
+// Sends `count` prepared messages, resending the tail of any message a stream socket cut short.
+static int send_batch(NetSink* sink, unsigned count) {
+    int flags = sink->zerocopy ? MSG_ZEROCOPY : 0;
+    unsigned done = 0;
+
+    while (done < count) {
+        int n = sendmmsg(sink->fd, &sink->msgs[done], count - done, flags);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno == ENOBUFS && sink->zerocopy) {
+                // Too many zero-copy sends in flight; wait for the kernel to release some.
+                poll_zerocopy_completions(sink, 10);
+                continue;
+            }
+            perror("Net sink: sendmmsg");
+            return -1;
+        }
+        sink->stats.send_calls++;
+        if (sink->zerocopy) sink->zc_next_id += (uint32_t)n;
+
+        for (int i = 0; i < n; ++i) {
+            struct mmsghdr* m = &sink->msgs[done + i];
+            size_t expected = m->msg_hdr.msg_iov[0].iov_len + m->msg_hdr.msg_iov[1].iov_len;
+            size_t sent = m->msg_len;
+
+            // Only stream sockets can send part of a message; finish it with plain sends.
+            while (sent < expected) {
+                struct iovec* iov = m->msg_hdr.msg_iov;
+                const uint8_t* ptr;
+                size_t left;
+                if (sent < iov[0].iov_len) {
+                    ptr = (const uint8_t*)iov[0].iov_base + sent;
+                    left = iov[0].iov_len - sent;
+                } else {
+                    ptr = (const uint8_t*)iov[1].iov_base + (sent - iov[0].iov_len);
+                    left = expected - sent;
+                }
+                ssize_t w = send(sink->fd, ptr, left, 0);
+                if (w < 0 && errno == EINTR) continue;
+                if (w <= 0) {
+                    perror("Net sink: send");
+                    return -1;
+                }
+                sent += (size_t)w;
+            }
+        }
+        done += (unsigned)n;
+    }
+    return 0;
+}
+
+static double seconds_since(const struct timespec* start) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+static int send_chunks(NetSink* sink, const void* data, size_t len, uint64_t stream_offset, uint32_t slot_sequence,
+                       uint32_t slot_crc, uint32_t slot_flags) {
+    if (sink->zerocopy && sink->slots_sent - sink->slots_retired >= NET_SINK_MAX_PENDING) {
+        while (net_sink_retired(sink) + NET_SINK_MAX_PENDING <= sink->slots_sent) {
+            poll_zerocopy_completions(sink, 10);
+        }
+    }
+
+    const uint8_t* ptr = data;
+    size_t offset = 0;
+    while (offset < len) {
+        unsigned count = 0;
+        while (count < sink->config.batch && offset < len) {
+            size_t chunk = len - offset < sink->config.payload_bytes ? len - offset : sink->config.payload_bytes;
+
+            // With zero-copy, message `count` will get send id zc_next_id + count; its header slot
+            // must not still be referenced by the send that used it NET_SINK_HEADER_POOL ids ago.
+            uint32_t id = sink->zc_next_id + count;
+            while (sink->zerocopy && id - sink->zc_completed >= NET_SINK_HEADER_POOL) {
+                poll_zerocopy_completions(sink, 10);
+            }
+            NetPacketHeader* hdr = &sink->headers[sink->zerocopy ? id % NET_SINK_HEADER_POOL : count];
+            sink->iov[count][0].iov_base = hdr;
+            hdr->magic = htole32(NET_SINK_MAGIC);
+            hdr->version = htole16(NET_SINK_VERSION);
+            hdr->header_bytes = htole16(sizeof(NetPacketHeader));
+            hdr->sequence = htole64(sink->sequence++);
+            hdr->stream_offset = htole64(stream_offset + offset);
+            hdr->slot_sequence = htole32(slot_sequence);
+            hdr->payload_bytes = htole32((uint32_t)chunk);
+            hdr->slot_crc32c = htole32(slot_crc);
+            hdr->flags = htole32(slot_flags | (offset == 0 ? NET_CHUNK_SLOT_START : 0) |
+                                 (offset + chunk == len ? NET_CHUNK_SLOT_END : 0));
+            hdr->session = htole32(sink->session);
+
+            sink->iov[count][1].iov_base = (void*)(ptr + offset);
+            sink->iov[count][1].iov_len = chunk;
+            offset += chunk;
+            count++;
+        }
+        if (send_batch(sink, count) != 0) return -1;
+        sink->stats.chunks_sent += count;
+    }
+
+    if (sink->zerocopy) sink->slot_last_id[sink->slots_sent % NET_SINK_MAX_PENDING] = sink->zc_next_id;
+    sink->slots_sent++;
+    sink->stats.bytes_sent += len;
+    return 0;
+}
+
+// Sends the empty chunk that carries the session's chunk count. UDP gets a few copies, since the
+// receiver cannot count chunks lost after the last one it sees without it.
+static void send_session_end(NetSink* sink) {
+    NetPacketHeader hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.magic = htole32(NET_SINK_MAGIC);
+    hdr.version = htole16(NET_SINK_VERSION);
+    hdr.header_bytes = htole16(sizeof(NetPacketHeader));
+    hdr.sequence = htole64(sink->sequence);
+    hdr.flags = htole32(NET_CHUNK_SESSION_END);
+    hdr.session = htole32(sink->session);
+
+    const int repeats = sink->config.transport == NET_TRANSPORT_UDP ? NET_SINK_END_REPEATS : 1;
+    for (int i = 0; i < repeats; ++i) {
+        if (send(sink->fd, &hdr, sizeof(hdr), 0) != (ssize_t)sizeof(hdr)) {
+            perror("Net sink: failed to send the session end");
+            return;
+        }
+    }
+}
+
+
+// --- Public API ---
+
+void net_sink_config_default(NetSinkConfig* config, NetTransport transport, const char* host, uint16_t port) {
+    config->transport = transport;
+    config->host = host;
+    config->port = port;
+    // TCP is not limited by datagram size, so larger chunks mean fewer headers and syscalls.
+    config->payload_bytes = transport == NET_TRANSPORT_UDP ? NET_SINK_DEFAULT_PAYLOAD : 256 * 1024;
+    config->batch = 32;
+    config->zerocopy = 1;
+    config->verify_slots = 1;
+}
+
+int net_sink_open(NetSink* sink, const NetSinkConfig* config) {
+    memset(sink, 0, sizeof(*sink));
+    sink->config = *config;
+    crc32c_init();
+
+    if (sink->config.payload_bytes == 0 ||
+        (sink->config.transport == NET_TRANSPORT_UDP && sink->config.payload_bytes > NET_SINK_MAX_PAYLOAD)) {
+        fprintf(stderr, "Net sink: payload of %zu bytes is not valid for this transport\n", sink->config.payload_bytes);
+        return -1;
+    }
+    if (sink->config.batch == 0) sink->config.batch = 1;
+    if (sink->config.batch > NET_SINK_MAX_BATCH) sink->config.batch = NET_SINK_MAX_BATCH;
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(config->port);
+    if (inet_pton(AF_INET, config->host, &addr.sin_addr) != 1) {
+        fprintf(stderr, "Net sink: invalid IPv4 address '%s'\n", config->host);
+        return -1;
+    }
+
+    int stream = config->transport == NET_TRANSPORT_TCP;
+    sink->fd = socket(AF_INET, stream ? SOCK_STREAM : SOCK_DGRAM, 0);
+    if (sink->fd < 0) {
+        perror("Net sink: socket");
+        return -1;
+    }
+
+    int bufsize = NET_SINK_SOCKET_BUFFER;
+    setsockopt(sink->fd, SOL_SOCKET, SO_SNDBUF, &bufsize, sizeof(bufsize));
+    if (stream) {
+        int one = 1;
+        setsockopt(sink->fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    }
+
+    if (connect(sink->fd, (struct sockaddr*)&addr, sizeof(addr)) != 0) {
+        perror("Net sink: connect");
+        close(sink->fd);
+        sink->fd = -1;
+        return -1;
+    }
+
+    if (config->zerocopy) {
+        int one = 1;
+        if (setsockopt(sink->fd, SOL_SOCKET, SO_ZEROCOPY, &one, sizeof(one)) == 0) {
+            sink->zerocopy = 1;
+        } else {
+            printf("  MSG_ZEROCOPY unavailable (%s), using copying sends.\n", strerror(errno));
+        }
+    }
+
+    for (unsigned i = 0; i < NET_SINK_MAX_BATCH; ++i) {
+        sink->iov[i][0].iov_len = sizeof(NetPacketHeader);
+        sink->msgs[i].msg_hdr.msg_iov = sink->iov[i];
+        sink->msgs[i].msg_hdr.msg_iovlen = 2;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &sink->start_time);
+    struct timespec wall;
+    clock_gettime(CLOCK_REALTIME, &wall);
+    sink->session = (uint32_t)wall.tv_nsec ^ (uint32_t)wall.tv_sec << 12 ^ (uint32_t)getpid() << 20;
+    return 0;
+}
+
+int net_sink_send(NetSink* sink, const void* data, size_t len, uint64_t stream_offset, uint32_t slot_sequence) {
+    return send_chunks(sink, data, len, stream_offset, slot_sequence, 0, 0);
+}
+
+int net_sink_send_slot(NetSink* sink, const CaptureSlot* slot) {
+    if (!(slot->flags & CAPTURE_SLOT_CRC)) {
+        return send_chunks(sink, slot->data, slot->length, slot->stream_offset, slot->sequence, 0, 0);
+    }
+    if (sink->config.verify_slots && capture_slot_verify(slot) == 0) {
+        fprintf(stderr, "Net sink: slot %u changed since completion (CRC32C mismatch)\n", slot->sequence);
+        sink->stats.crc_errors++;
+    }
+    return send_chunks(sink, slot->data, slot->length, slot->stream_offset, slot->sequence, slot->crc32c,
+                       NET_CHUNK_SLOT_CRC);
+}
+
+uint64_t net_sink_retired(NetSink* sink) {
+    if (!sink->zerocopy) return sink->slots_sent;
+
+    poll_zerocopy_completions(sink, 0);
+    while (sink->slots_retired < sink->slots_sent) {
+        uint32_t last_id = sink->slot_last_id[sink->slots_retired % NET_SINK_MAX_PENDING];
+        // Ids are 32-bit and wrap; compare by signed distance.
+        if ((int32_t)(sink->zc_completed - last_id) < 0) break;
+        sink->slots_retired++;
+    }
+    return sink->slots_retired;
+}
+
+int net_sink_close(NetSink* sink, NetSinkStats* stats) {
+    if (sink->fd < 0) return -1;
+
+    // The kernel may still reference slot memory; wait (bounded) for it to let go.
+    for (int tries = 0; tries < 200 && net_sink_retired(sink) < sink->slots_sent; ++tries) {
+        poll_zerocopy_completions(sink, 10);
+    }
+    int rc = net_sink_retired(sink) == sink->slots_sent ? 0 : -1;
+    if (rc != 0) fprintf(stderr, "Net sink: zero-copy completions still outstanding at close\n");
+    send_session_end(sink);
+
+    sink->stats.elapsed_seconds = seconds_since(&sink->start_time);
+    if (sink->stats.elapsed_seconds > 0) {
+        sink->stats.bandwidth_mbps = (double)sink->stats.bytes_sent / sink->stats.elapsed_seconds / (1024.0 * 1024.0);
+    }
+
+    close(sink->fd);
+    sink->fd = -1;
+    if (stats) *stats = sink->stats;
+    return rc;
+}
@@ -0,0 +1,151 @@
+// =================================================================================================
+// File: net_sink.h
+// Description: Streams capture slots to a processing server over UDP or TCP.
+//
+// Each slot is cut into payload-sized chunks, and every chunk is preceded by a small
+// sequence-numbered header. The headers of a slot's chunks also carry the CRC32C taken when the
+// slot completed, so the receiver can check the reassembled slot end to end. Chunks are sent in
+// batches with sendmmsg(). When the kernel supports MSG_ZEROCOPY, the payload is sent straight
+// from the udmabuf mapping; a slot must then stay unreleased until the kernel reports that it no
+// longer references it (see net_sink_retired()).
+// =================================================================================================
+
+#ifndef NET_SINK_H
+#define NET_SINK_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include "capture_session.h"
+
+// --- Wire Format ---
+
+#define NET_SINK_MAGIC           0x534E4852U // "RHNS" in little-endian byte order
+#define NET_SINK_VERSION         3
+#define NET_SINK_DEFAULT_PAYLOAD 8192        // Payload bytes per UDP datagram
+#define NET_SINK_MAX_PAYLOAD     65000       // Keeps header + payload inside one UDP datagram
+#define NET_SINK_MAX_BATCH       64          // Messages per sendmmsg() call
+#define NET_SINK_MAX_PENDING     256         // Slots awaiting zero-copy completion
+#define NET_SINK_HEADER_POOL     4096        // Headers that may be referenced by in-flight zero-copy sends
+
+#define NET_CHUNK_SLOT_START     0x1         // First chunk of a slot
+#define NET_CHUNK_SLOT_END       0x2         // Last chunk of a slot
+#define NET_CHUNK_SLOT_CRC       0x4         // slot_crc32c is valid
+#define NET_CHUNK_SESSION_END    0x8         // Empty chunk closing a session; `sequence` is its chunk count
+#define NET_SINK_END_REPEATS     3           // Copies of the session end sent over UDP
+
+/**
+ * @brief Header in front of every chunk on the wire. All fields are little-endian.
+ */
+typedef struct __attribute__((packed)) {
+    uint32_t magic;          // NET_SINK_MAGIC
+    uint16_t version;        // NET_SINK_VERSION
+    uint16_t header_bytes;   // sizeof(NetPacketHeader), lets receivers skip future extensions
+    uint64_t sequence;       // Chunk sequence number from 0 in each session; gaps mean lost chunks
+    uint64_t stream_offset;  // Byte offset of the payload within the capture stream
+    uint32_t slot_sequence;  // Capture slot the payload came from
+    uint32_t payload_bytes;  // Bytes following this header
+    uint32_t slot_crc32c;    // CRC32C of the whole slot at completion (NET_CHUNK_SLOT_CRC)
+    uint32_t flags;          // NET_CHUNK_* bits
+    uint32_t session;        // Chosen by net_sink_open(); a new value restarts the sequence
+} NetPacketHeader;
+
+// --- Configuration ---
+
+typedef enum {
+    NET_TRANSPORT_UDP,
+    NET_TRANSPORT_TCP
+} NetTransport;
+
+typedef struct {
+    NetTransport transport;
+    const char*  host;          // Receiver IPv4 address, e.g. "127.0.0.1"
+    uint16_t     port;
+    size_t       payload_bytes; // Bytes of slot data per chunk
+    unsigned     batch;         // Chunks per sendmmsg() call
+    int          zerocopy;      // Request MSG_ZEROCOPY (falls back to copying sends if unsupported)
+    int          verify_slots;  // Check slots against their completion CRC32C before sending
+} NetSinkConfig;
+
+typedef struct {
+    uint64_t bytes_sent;        // Payload bytes (headers excluded)
+    uint64_t chunks_sent;
+    uint64_t send_calls;        // sendmmsg() calls
+    uint64_t zerocopy_copied;   // Zero-copy sends the kernel completed by copying instead
+    uint64_t crc_errors;        // Slots whose data no longer matched their completion CRC32C
+    double   elapsed_seconds;
+    double   bandwidth_mbps;
+} NetSinkStats;
+
+typedef struct {
+    int              fd;
+    NetSinkConfig    config;
+    int              zerocopy;           // Zero-copy actually enabled on the socket
+    uint32_t         session;
+    uint64_t         sequence;
+
+    // Per-batch scratch space, allocated once with the sink. Zero-copy sends pin the header memory
+    // too, so headers come from a pool indexed by send id and are only reused once completed.
+    NetPacketHeader  headers[NET_SINK_HEADER_POOL];
+    struct iovec     iov[NET_SINK_MAX_BATCH][2];
+    struct mmsghdr   msgs[NET_SINK_MAX_BATCH];
+
+    // Zero-copy bookkeeping: each send gets a kernel-assigned id, completions arrive as id ranges.
+    uint32_t         zc_next_id;         // Id the kernel will assign to the next zero-copy send
+    uint32_t         zc_completed;       // All ids below this have completed
+    // Out-of-order completed ranges. At most NET_SINK_HEADER_POOL ids are ever in flight past
+    // zc_completed, so there can never be more disjoint ranges than that.
+    uint32_t         zc_ranges[NET_SINK_HEADER_POOL][2];
+    unsigned         zc_range_count;
+    uint32_t         slot_last_id[NET_SINK_MAX_PENDING]; // Last send id used by each pending slot
+    uint64_t         slots_sent;
+    uint64_t         slots_retired;
+
+    struct timespec  start_time;
+    NetSinkStats     stats;
+} NetSink;
+
+
+// --- Function Prototypes ---
+
+/**
+ * @brief Fills in a configuration with the default payload size and batch for a transport.
+ */
+void net_sink_config_default(NetSinkConfig* config, NetTransport transport, const char* host, uint16_t port);
+
+/**
+ * @brief Creates and connects the socket and enables zero-copy if requested and available.
+ * @return 0 on success, -1 on failure.
+ */
+int net_sink_open(NetSink* sink, const NetSinkConfig* config);
+
+/**
+ * @brief Sends a buffer as a run of header+payload chunks.
+ * @param stream_offset Byte offset of `data` within the capture stream.
+ * @param slot_sequence Slot number recorded in each chunk header.
+ * @return 0 on success, -1 on failure.
+ */
+int net_sink_send(NetSink* sink, const void* data, size_t len, uint64_t stream_offset, uint32_t slot_sequence);
+
+/**
+ * @brief Sends a filled capture slot. A slot that carries a CRC32C is checked first if
+ *        verify_slots is set (a mismatch is reported and counted, and the slot is still sent), and
+ *        the CRC travels in its chunk headers.
+ */
+int net_sink_send_slot(NetSink* sink, const CaptureSlot* slot);
+
+/**
+ * @brief Polls zero-copy completions and returns the number of sent slots (in send order) whose
+ *        memory the kernel no longer references. Without zero-copy, every sent slot is retired.
+ */
+uint64_t net_sink_retired(NetSink* sink);
+
+/**
+ * @brief Waits for outstanding zero-copy completions, tells the receiver how many chunks the
+ *        session sent (so chunks lost at the end are counted too), then closes the socket.
+ * @param stats Receives the final statistics (may be NULL).
+ */
+int net_sink_close(NetSink* sink, NetSinkStats* stats);
+
+#endif // NET_SINK_H
@@ -0,0 +1,152 @@
+// =================================================================================================
+// File: occupancy.c
+// Description: Implementation of the spectrum occupancy summarizer.
+// =================================================================================================
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "occupancy.h"
+
+// --- Internal Helpers ---
+
+// Returns the k-th smallest of `n` values, reordering them (quickselect).
+static float select_kth(float* v, unsigned n, unsigned k) {
+    unsigned lo = 0, hi = n - 1;
+    while (lo < hi) {
+        unsigned mid = lo + (hi - lo) / 2;
+        float tmp = v[mid];
+        v[mid] = v[hi];
+        v[hi] = tmp;
+
+        const float pivot = v[hi];
+        unsigned store = lo;
+        for (unsigned i = lo; i < hi; ++i) {
+            if (v[i] < pivot) {
+                tmp = v[i];
+                v[i] = v[store];
+                v[store++] = tmp;
+            }
+        }
+        v[hi] = v[store];
+        v[store] = pivot;
+
+        if (k == store) return pivot;
+        if (k < store) {
+            hi = store - 1;
+        } else {
+            lo = store + 1;
+        }
+    }
+    return v[k];
+}
+
+static void emit_record(OccupancyTracker* t) {
+    const unsigned channels = t->config.channels;
+    OccupancyRecord* r = t->record;
+
+    r->bucket = (uint32_t)t->bucket;
+    r->frames = t->frames;
+    r->first_sample = t->bucket * t->bucket_samples;
+    double floor_db = t->floor_db_sum / t->frames;
+    r->noise_floor_cdb = (int16_t)lround(floor_db < -327.0 ? -32700.0 : floor_db * 100.0);
+    r->channels = (uint16_t)channels;
+    for (unsigned c = 0; c < channels; ++c) {
+        r->occupancy[c] = (uint8_t)((t->counts[c] * 255U + t->frames / 2) / t->frames);
+    }
+
+    if (t->callback) t->callback(r, occupancy_record_bytes(channels), t->user);
+    t->records++;
+    t->frames = 0;
+    t->floor_db_sum = 0.0;
+    memset(t->counts, 0, sizeof(t->counts));
+}
+
+
+// --- Public API Functions ---
+
+void occupancy_config_default(OccupancyConfig* config) {
+    config->channels = 64;
+    config->threshold_db = 6.0;
+    config->bucket_seconds = 1.0;
+}
+
+size_t occupancy_record_bytes(unsigned channels) {
+    return sizeof(OccupancyRecord) + channels;
+}
+
+int occupancy_init(OccupancyTracker* tracker, const OccupancyConfig* config, OccupancyCallback callback, void* user) {
+    memset(tracker, 0, sizeof(*tracker));
+    if (config->channels == 0 || config->channels > OCCUPANCY_MAX_CHANNELS || config->bucket_seconds <= 0.0) {
+        printf("ERROR: Invalid occupancy configuration (%u channels, %.3f s buckets).\n",
+               config->channels, config->bucket_seconds);
+        return -1;
+    }
+
+    tracker->record = calloc(1, occupancy_record_bytes(config->channels));
+    if (!tracker->record) {
+        perror("Failed to allocate occupancy record");
+        return -1;
+    }
+    tracker->config = *config;
+    tracker->threshold = pow(10.0, config->threshold_db / 10.0);
+    tracker->callback = callback;
+    tracker->user = user;
+    return 0;
+}
+
+int occupancy_add_frame(OccupancyTracker* t, const PsdFrame* frame) {
+    const unsigned channels = t->config.channels;
+    if (frame->fft_size % channels != 0) {
+        printf("ERROR: %u FFT bins do not split into %u channels.\n", frame->fft_size, channels);
+        return -1;
+    }
+
+    if (t->bucket_samples == 0) {
+        t->bucket_samples = (uint64_t)llround(t->config.bucket_seconds * frame->sample_rate);
+        if (t->bucket_samples == 0) t->bucket_samples = 1;
+        t->bucket = frame->first_sample / t->bucket_samples;
+    }
+    uint64_t bucket = frame->first_sample / t->bucket_samples;
+    if (bucket != t->bucket) {
+        if (t->frames) emit_record(t);
+        t->bucket = bucket;
+    }
+
+    // Mean power per channel.
+    const unsigned bins = frame->fft_size / channels;
+    for (unsigned c = 0; c < channels; ++c) {
+        const float* b = frame->bins + c * bins;
+        float sum = 0.0f;
+        for (unsigned k = 0; k < bins; ++k) sum += b[k];
+        t->power[c] = sum / bins;
+    }
+
+    // A low percentile of the channel powers tracks the floor even when many channels are busy;
+    // smoothing over frames keeps a single burst from moving it.
+    memcpy(t->sorted, t->power, channels * sizeof(*t->sorted));
+    double estimate = select_kth(t->sorted, channels, (unsigned)(OCCUPANCY_FLOOR_PERCENTILE * (channels - 1)));
+    if (t->floor == 0.0) {
+        t->floor = estimate;
+    } else {
+        t->floor += OCCUPANCY_FLOOR_SMOOTHING * (estimate - t->floor);
+    }
+    t->floor_db_sum += 10.0 * log10(t->floor > 0.0 ? t->floor : 1e-30);
+
+    const float limit = (float)(t->floor * t->threshold);
+    for (unsigned c = 0; c < channels; ++c) {
+        t->counts[c] += t->power[c] > limit;
+    }
+    t->frames++;
+    return 0;
+}
+
+void occupancy_flush(OccupancyTracker* tracker) {
+    if (tracker->frames) emit_record(tracker);
+}
+
+void occupancy_free(OccupancyTracker* tracker) {
+    free(tracker->record);
+    tracker->record = NULL;
+}
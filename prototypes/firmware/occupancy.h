@@ -0,0 +1,99 @@
+// =================================================================================================
+// File: occupancy.h
+// Description: Turns PSD frames into long-term spectrum occupancy statistics.
+//
+// The spectrum is split into equal channels. For every PSD frame the stage estimates the noise
+// floor, marks each channel whose mean power exceeds the floor by a threshold as occupied, and
+// counts occupied frames per channel over fixed time buckets. Each bucket is published as a small
+// fixed-size record (header plus one byte per channel), so e.g. 64 channels in 1 s buckets take
+// about 7 MB per day.
+// =================================================================================================
+
+#ifndef OCCUPANCY_H
+#define OCCUPANCY_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "psd.h"
+
+// --- Configuration ---
+
+#define OCCUPANCY_MAX_CHANNELS   1024
+#define OCCUPANCY_FLOOR_PERCENTILE 0.2  // Channel power percentile taken as the frame's noise floor
+#define OCCUPANCY_FLOOR_SMOOTHING  0.1  // Weight of each new frame in the running floor estimate
+
+typedef struct {
+    unsigned channels;       // Number of equal-width channels across the spectrum (divides fft_size)
+    double   threshold_db;   // Occupied when channel power exceeds the noise floor by this much
+    double   bucket_seconds; // Length of each reporting interval
+} OccupancyConfig;
+
+/**
+ * @brief One reporting interval (little-endian). Followed by `channels` occupancy bytes, each the
+ *        fraction of the bucket's frames in which the channel was occupied, scaled to 0-255.
+ */
+typedef struct __attribute__((packed)) {
+    uint32_t bucket;            // Interval number since the start of the stream
+    uint32_t frames;            // PSD frames that contributed
+    uint64_t first_sample;      // Stream sample index where the interval starts
+    int16_t  noise_floor_cdb;   // Mean noise floor estimate, in 0.01 dB relative to full scale per Hz
+    uint16_t channels;
+    uint8_t  occupancy[];
+} OccupancyRecord;
+
+typedef void (*OccupancyCallback)(const OccupancyRecord* record, size_t bytes, void* user);
+
+typedef struct {
+    OccupancyConfig   config;
+    double            threshold;       // Linear power ratio for threshold_db
+    uint64_t          bucket_samples;  // Set from the first frame's sample rate
+    uint64_t          bucket;          // Interval currently being accumulated
+    uint32_t          frames;
+    uint32_t          counts[OCCUPANCY_MAX_CHANNELS];
+    double            floor;           // Running noise floor (linear), 0 until the first frame
+    double            floor_db_sum;    // Sum of per-frame floor estimates in dB, for the record
+    float             power[OCCUPANCY_MAX_CHANNELS];
+    float             sorted[OCCUPANCY_MAX_CHANNELS];
+    OccupancyRecord*  record;
+    OccupancyCallback callback;
+    void*             user;
+    uint64_t          records;
+} OccupancyTracker;
+
+
+// --- Function Prototypes ---
+
+/**
+ * @brief Fills in a configuration: 64 channels, 6 dB above the floor, 1 second buckets.
+ */
+void occupancy_config_default(OccupancyConfig* config);
+
+/**
+ * @brief Bytes in one record with `channels` channels.
+ */
+size_t occupancy_record_bytes(unsigned channels);
+
+/**
+ * @brief Validates the configuration and allocates the record buffer.
+ * @return 0 on success, -1 on failure.
+ */
+int occupancy_init(OccupancyTracker* tracker, const OccupancyConfig* config, OccupancyCallback callback, void* user);
+
+/**
+ * @brief Accounts one PSD frame; emits the previous bucket's record when the frame starts a new one.
+ * Usable directly as the body of a PsdFrameCallback.
+ * @return 0 on success, -1 if the frame's size does not split into the configured channels.
+ */
+int occupancy_add_frame(OccupancyTracker* tracker, const PsdFrame* frame);
+
+/**
+ * @brief Emits the record of the bucket in progress, if it has any frames.
+ */
+void occupancy_flush(OccupancyTracker* tracker);
+
+/**
+ * @brief Releases the record buffer.
+ */
+void occupancy_free(OccupancyTracker* tracker);
+
+#endif // OCCUPANCY_H
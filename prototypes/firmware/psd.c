@@ -0,0 +1,235 @@
+// =================================================================================================
+// File: psd.c
+// Description: Implementation of the streaming Welch PSD engine.
+// =================================================================================================
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "psd.h"
+
+// --- Internal Helpers ---
+
+static double window_value(PsdWindow window, unsigned i, unsigned n) {
+    // Periodic (DFT-even) forms, which is what spectral averaging wants.
+    double x = 2.0 * M_PI * (double)i / (double)n;
+    switch (window) {
+        case PSD_WINDOW_HANN:            return 0.5 - 0.5 * cos(x);
+        case PSD_WINDOW_HAMMING:         return 0.54 - 0.46 * cos(x);
+        case PSD_WINDOW_BLACKMAN_HARRIS: return 0.35875 - 0.48829 * cos(x) + 0.14128 * cos(2 * x) - 0.01168 * cos(3 * x);
+        case PSD_WINDOW_RECTANGULAR:
+        default:                         return 1.0;
+    }
+}
+
+static void emit_frame(PsdEngine* e) {
+    const unsigned n = e->config.fft_size;
+    const float scale = (float)(e->scale / (double)e->accumulated);
+
+    for (unsigned i = 0; i < n; ++i) {
+        e->output[i] = e->accum[(i + n / 2) & (n - 1)] * scale;
+    }
+
+    if (e->callback) {
+        PsdFrame frame = {
+            .sequence = e->frames,
+            .first_sample = e->frame_first_sample,
+            .fft_size = n,
+            .averages = e->accumulated,
+            .sample_rate = e->config.sample_rate,
+            .bins = e->output,
+        };
+        e->callback(&frame, e->user);
+    }
+
+    e->frames++;
+    e->accumulated = 0;
+    memset(e->accum, 0, n * sizeof(*e->accum));
+}
+
+// Windows, transforms and accumulates one segment. Returns 1 if it completed a frame.
+static int process_segment(PsdEngine* e, const uint32_t* samples) {
+    const unsigned n = e->config.fft_size;
+    const int16_t* iq = (const int16_t*)samples;
+
+    if (e->accumulated == 0) e->frame_first_sample = e->segments * e->hop;
+
+    if (e->config.path == PSD_PATH_FIXED) {
+        FftComplexQ15* work = e->work_q15;
+        for (unsigned i = 0; i < n; ++i) {
+            work[i].re = (int16_t)(((int32_t)iq[2 * i] * e->window_q15[i] + (1 << 14)) >> 15);
+            work[i].im = (int16_t)(((int32_t)iq[2 * i + 1] * e->window_q15[i] + (1 << 14)) >> 15);
+        }
+        int exponent = fft_forward_q15(e->plan, work);
+        const float gain = ldexpf(1.0f, 2 * exponent);
+        for (unsigned k = 0; k < n; ++k) {
+            uint32_t power = (uint32_t)((int32_t)work[k].re * work[k].re) + (uint32_t)((int32_t)work[k].im * work[k].im);
+            e->accum[k] += (float)power * gain;
+        }
+    } else {
+        FftComplexF32* work = e->work_f32;
+        for (unsigned i = 0; i < n; ++i) {
+            work[i].re = (float)iq[2 * i] * e->window_f32[i];
+            work[i].im = (float)iq[2 * i + 1] * e->window_f32[i];
+        }
+        fft_forward_f32(e->plan, work);
+        for (unsigned k = 0; k < n; ++k) {
+            e->accum[k] += work[k].re * work[k].re + work[k].im * work[k].im;
+        }
+    }
+
+    e->segments++;
+    if (++e->accumulated < e->config.averages) return 0;
+    emit_frame(e);
+    return 1;
+}
+
+
+// --- Public API Functions ---
+
+void psd_config_default(PsdConfig* config, double sample_rate) {
+    config->fft_size = 1024;
+    config->window = PSD_WINDOW_HANN;
+    config->overlap = config->fft_size / 2;
+    config->averages = 64;
+#if defined(__riscv)
+    config->path = PSD_PATH_FIXED;
+#else
+    config->path = PSD_PATH_FLOAT;
+#endif
+    config->sample_rate = sample_rate;
+}
+
+const char* psd_window_name(PsdWindow window) {
+    switch (window) {
+        case PSD_WINDOW_RECTANGULAR:     return "rectangular";
+        case PSD_WINDOW_HANN:            return "hann";
+        case PSD_WINDOW_HAMMING:         return "hamming";
+        case PSD_WINDOW_BLACKMAN_HARRIS: return "blackman-harris";
+    }
+    return "unknown";
+}
+
+const char* psd_path_name(PsdPath path) {
+    return path == PSD_PATH_FIXED ? "fixed (Q15)" : "float";
+}
+
+int psd_engine_init(PsdEngine* engine, const PsdConfig* config, PsdFrameCallback callback, void* user) {
+    memset(engine, 0, sizeof(*engine));
+    const unsigned n = config->fft_size;
+
+    if (n < PSD_MIN_FFT_SIZE || n > PSD_MAX_FFT_SIZE || config->overlap >= n ||
+        config->averages == 0 || config->sample_rate <= 0.0) {
+        printf("ERROR: Invalid PSD configuration (fft %u, overlap %u, averages %u, rate %.0f).\n",
+               n, config->overlap, config->averages, config->sample_rate);
+        return -1;
+    }
+    engine->plan = fft_plan_acquire(n);
+    if (!engine->plan) return -1;
+
+    engine->config = *config;
+    engine->hop = n - config->overlap;
+    engine->callback = callback;
+    engine->user = user;
+
+    engine->window_f32 = malloc(n * sizeof(*engine->window_f32));
+    engine->window_q15 = malloc(n * sizeof(*engine->window_q15));
+    engine->work_f32 = malloc(n * sizeof(*engine->work_f32));
+    engine->work_q15 = malloc(n * sizeof(*engine->work_q15));
+    engine->staging = malloc(n * sizeof(*engine->staging));
+    engine->accum = calloc(n, sizeof(*engine->accum));
+    engine->own_output = malloc(n * sizeof(*engine->own_output));
+    engine->output = engine->own_output;
+    if (!engine->window_f32 || !engine->window_q15 || !engine->work_f32 || !engine->work_q15 ||
+        !engine->staging || !engine->accum || !engine->own_output) {
+        perror("Failed to allocate PSD buffers");
+        psd_engine_free(engine);
+        return -1;
+    }
+
+    double power_sum = 0.0;
+    for (unsigned i = 0; i < n; ++i) {
+        double w = window_value(config->window, i, n);
+        engine->window_f32[i] = (float)w;
+        engine->window_q15[i] = (int16_t)lround(w * 32767.0);
+        power_sum += w * w;
+    }
+
+    // Welch scaling: |X|^2 / (fs * sum(w^2)), with samples normalized to int16 full scale.
+    engine->scale = 1.0 / (config->sample_rate * power_sum * 32768.0 * 32768.0);
+    return 0;
+}
+
+unsigned psd_engine_push(PsdEngine* engine, const void* samples, size_t bytes) {
+    const uint32_t* in = samples;
+    const size_t count = bytes / PSD_BYTES_PER_SAMPLE;
+    const unsigned n = engine->config.fft_size;
+    const unsigned keep = n - engine->hop;
+    unsigned frames = 0;
+    size_t i = 0;
+
+    while (i < count) {
+        // Whole segments inside the caller's buffer are transformed in place, without a copy.
+        if (engine->staged == 0 && count - i >= n) {
+            frames += process_segment(engine, in + i);
+            i += engine->hop;
+            continue;
+        }
+
+        size_t take = n - engine->staged;
+        if (take > count - i) take = count - i;
+        memcpy(engine->staging + engine->staged, in + i, take * sizeof(*in));
+        engine->staged += take;
+        i += take;
+
+        if (engine->staged == n) {
+            frames += process_segment(engine, engine->staging);
+            if (i >= keep) {
+                // The overlap of the next segment is still in the caller's buffer; go back to it.
+                i -= keep;
+                engine->staged = 0;
+            } else {
+                memmove(engine->staging, engine->staging + engine->hop, keep * sizeof(*in));
+                engine->staged = keep;
+            }
+        }
+    }
+    return frames;
+}
+
+unsigned psd_engine_push_slot(PsdEngine* engine, const CaptureSlot* slot) {
+    return psd_engine_push(engine, slot->data, slot->length);
+}
+
+void psd_engine_set_output(PsdEngine* engine, float* bins) {
+    engine->output = bins ? bins : engine->own_output;
+}
+
+void psd_engine_reset(PsdEngine* engine) {
+    engine->staged = 0;
+    engine->accumulated = 0;
+    engine->segments = 0;
+    engine->frames = 0;
+    memset(engine->accum, 0, engine->config.fft_size * sizeof(*engine->accum));
+}
+
+void psd_engine_free(PsdEngine* engine) {
+    fft_plan_release(engine->plan);
+    engine->plan = NULL;
+    free(engine->window_f32);
+    free(engine->window_q15);
+    free(engine->work_f32);
+    free(engine->work_q15);
+    free(engine->staging);
+    free(engine->accum);
+    free(engine->own_output);
+    engine->window_f32 = NULL;
+    engine->window_q15 = NULL;
+    engine->work_f32 = NULL;
+    engine->work_q15 = NULL;
+    engine->staging = NULL;
+    engine->accum = NULL;
+    engine->output = NULL;
+    engine->own_output = NULL;
+}
@@ -0,0 +1,138 @@
+// =================================================================================================
+// File: psd.h
+// Description: Streaming Welch power spectral density engine for on-board spectrum sensing.
+//
+// Capture slots are pushed in as they arrive. Each slot is cut into overlapping windowed FFT
+// segments (segments may straddle slot boundaries), the segment power spectra are averaged, and
+// every `averages` segments one averaged spectrum is handed to a callback. Only these frames need
+// to leave the board, which is `averages * hop / fft_size` times less data than the raw samples.
+// =================================================================================================
+
+#ifndef PSD_H
+#define PSD_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "fft.h"
+#include "capture_session.h"
+
+// --- Configuration ---
+
+#define PSD_MIN_FFT_SIZE     256
+#define PSD_MAX_FFT_SIZE     16384
+#define PSD_BYTES_PER_SAMPLE 4     // One complex int16 sample (I low, Q high) per 32-bit stream beat
+
+typedef enum {
+    PSD_WINDOW_RECTANGULAR,
+    PSD_WINDOW_HANN,
+    PSD_WINDOW_HAMMING,
+    PSD_WINDOW_BLACKMAN_HARRIS
+} PsdWindow;
+
+typedef enum {
+    PSD_PATH_FLOAT, // Single-precision FFT (host)
+    PSD_PATH_FIXED  // Q15 block floating point FFT (U54)
+} PsdPath;
+
+typedef struct {
+    unsigned  fft_size;    // Points per segment, power of two in [PSD_MIN_FFT_SIZE, PSD_MAX_FFT_SIZE]
+    PsdWindow window;
+    unsigned  overlap;     // Samples shared by consecutive segments (< fft_size)
+    unsigned  averages;    // Segments averaged into each output frame
+    PsdPath   path;
+    double    sample_rate; // Hz; used to scale the output to power per Hz
+} PsdConfig;
+
+/**
+ * @brief One averaged spectrum handed to the frame callback.
+ * Bins are in FFT-shifted order (bin 0 is -sample_rate/2, bin fft_size/2 is DC) and hold linear
+ * power spectral density relative to a full-scale int16 sample, per Hz.
+ */
+typedef struct {
+    uint64_t     sequence;     // Frame number since the engine was initialized or reset
+    uint64_t     first_sample; // Stream sample index of the first sample in the average
+    unsigned     fft_size;
+    unsigned     averages;
+    double       sample_rate;
+    const float* bins;         // fft_size values, valid only during the callback
+} PsdFrame;
+
+typedef void (*PsdFrameCallback)(const PsdFrame* frame, void* user);
+
+typedef struct {
+    PsdConfig        config;
+    const FftPlan*   plan;           // Shared with other stages of the same size
+    unsigned         hop;            // fft_size - overlap
+
+    float*           window_f32;
+    int16_t*         window_q15;
+    FftComplexF32*   work_f32;
+    FftComplexQ15*   work_q15;
+    uint32_t*        staging;        // Segment assembled from the tail of one slot and the head of the next
+    unsigned         staged;         // Samples currently in `staging`
+    float*           accum;          // Running sum of segment power spectra
+    float*           output;         // Where the next frame is written: own_output or a caller's buffer
+    float*           own_output;
+    double           scale;          // Converts an accumulated sum into the published density
+
+    unsigned         accumulated;    // Segments in `accum`
+    uint64_t         segments;       // Segments processed since init/reset
+    uint64_t         frame_first_sample;
+    uint64_t         frames;
+
+    PsdFrameCallback callback;
+    void*            user;
+} PsdEngine;
+
+
+// --- Function Prototypes ---
+
+/**
+ * @brief Fills in a configuration: 1024 point Hann window, 50% overlap, 64 averages, and the
+ *        fixed-point path on RISC-V or the float path elsewhere.
+ */
+void psd_config_default(PsdConfig* config, double sample_rate);
+
+/**
+ * @brief Returns a printable name for a window or a processing path.
+ */
+const char* psd_window_name(PsdWindow window);
+const char* psd_path_name(PsdPath path);
+
+/**
+ * @brief Validates the configuration and allocates the plan and working buffers.
+ * @param callback Called with every averaged frame (may be NULL to only count frames).
+ * @return 0 on success, -1 on failure.
+ */
+int psd_engine_init(PsdEngine* engine, const PsdConfig* config, PsdFrameCallback callback, void* user);
+
+/**
+ * @brief Consumes a run of samples that continues the stream from the previous push.
+ * @param bytes Length of `samples`; must be a multiple of PSD_BYTES_PER_SAMPLE.
+ * @return Number of frames emitted during this call.
+ */
+unsigned psd_engine_push(PsdEngine* engine, const void* samples, size_t bytes);
+
+/**
+ * @brief Consumes a filled capture slot. The slot can be released as soon as this returns.
+ */
+unsigned psd_engine_push_slot(PsdEngine* engine, const CaptureSlot* slot);
+
+/**
+ * @brief Makes the engine write the following frames into `bins` (fft_size floats, owned by the
+ *        caller) instead of its own buffer. A frame callback that wants to keep a frame hands the
+ *        engine a fresh buffer this way, so no frame is copied. NULL returns to the engine's buffer.
+ */
+void psd_engine_set_output(PsdEngine* engine, float* bins);
+
+/**
+ * @brief Discards partial segments and averages so the next push starts a new stream.
+ */
+void psd_engine_reset(PsdEngine* engine);
+
+/**
+ * @brief Releases the engine's buffers.
+ */
+void psd_engine_free(PsdEngine* engine);
+
+#endif // PSD_H
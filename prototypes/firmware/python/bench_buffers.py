@@ -0,0 +1,115 @@
+#!/usr/bin/env python3
+# =================================================================================================
+# File: bench_buffers.py
+# Description: Shows that capture slots and PSD frames reach Python without a per-buffer copy.
+#
+# For each packet size the same capture is consumed twice: once through views of the slots
+# (memoryview, or numpy.frombuffer when numpy is installed) and once through bytes(slot), the
+# copy a non-buffer-protocol binding would have to make. The consumer's time per slot is measured
+# apart from the capture itself, and the Python heap it allocates in a second, traced run. A view
+# allocates nothing proportional to the packet; the copy allocates the whole packet every time.
+#
+#   make python && python3 python/bench_buffers.py [capture_mb]
+# =================================================================================================
+
+import sys
+import time
+import tracemalloc
+
+import radiohound
+
+try:
+    import numpy
+except ImportError:
+    numpy = None
+
+
+def consume(capture_bytes, packet_bytes, mode, trace=False):
+    """Runs one capture; returns (consumer ns per slot, peak traced bytes, distinct view addresses)."""
+    capture = radiohound.Capture(capture_bytes, packet_bytes=packet_bytes)
+    consumer_ns = 0
+    slots = 0
+    addresses = set()
+    if trace:
+        tracemalloc.start()
+    with capture:
+        for slot in capture:
+            start = time.perf_counter_ns()
+            if mode == "view":
+                if numpy is not None:
+                    words = numpy.frombuffer(slot, dtype=numpy.uint32)
+                    addresses.add(words.__array_interface__["data"][0])
+                else:
+                    words = memoryview(slot).cast("I")
+                ok = words[0] == 0 and words[-1] == len(words) - 1
+                del words
+            else:
+                data = bytes(slot)
+                ok = data[:4] == b"\0\0\0\0"
+                del data
+            consumer_ns += time.perf_counter_ns() - start
+            slot.release()  # Not timed: on the software backend this fills the next packet
+            if not ok:
+                raise RuntimeError(f"slot {slot.sequence} does not hold the stream pattern")
+            slots += 1
+    peak = 0
+    if trace:
+        peak = tracemalloc.get_traced_memory()[1]
+        tracemalloc.stop()
+    if slots != capture.total_packets:
+        raise RuntimeError(f"only {slots} of {capture.total_packets} slots were delivered")
+    return consumer_ns / slots, peak, addresses
+
+
+def bench_slots(capture_bytes):
+    print(f"Capture slots ({capture_bytes >> 20} MB per run, software backend):")
+    print(f"  {'Packet':>8} {'View ns/slot':>14} {'View heap':>11} {'Copy ns/slot':>14} {'Copy heap':>11} {'Copy MB/s':>10}")
+    for packet_bytes in (256 * 1024, 1024 * 1024, 4 * 1024 * 1024):
+        view_ns, _, addresses = consume(capture_bytes, packet_bytes, "view")
+        copy_ns, _, _ = consume(capture_bytes, packet_bytes, "copy")
+        view_peak = consume(capture_bytes, packet_bytes, "view", trace=True)[1]
+        copy_peak = consume(capture_bytes, packet_bytes, "copy", trace=True)[1]
+        print(f"  {packet_bytes >> 10:>6} K {view_ns:>14.0f} {view_peak:>10} B {copy_ns:>14.0f} {copy_peak:>10} B"
+              f" {packet_bytes / copy_ns * 1e3:>10.0f}")
+        if addresses:
+            ring_slots = radiohound.Capture(capture_bytes, packet_bytes=packet_bytes).ring_slots
+            print(f"           numpy arrays landed on {len(addresses)} distinct addresses for {ring_slots} ring slots")
+
+
+def bench_frames(fft_size, frames):
+    psd = radiohound.Psd(20e6, fft_size=fft_size, averages=4, frames=frames)
+    samples = bytes(fft_size // 2 * 4 * radiohound.BYTES_PER_SAMPLE * frames)  # One pool of frames per push
+    view_ns = copy_ns = 0
+    count = 0
+    addresses = set()
+    for _ in range(8):
+        for frame in psd.push(samples):
+            start = time.perf_counter_ns()
+            view = numpy.asarray(frame) if numpy is not None else memoryview(frame)
+            if numpy is not None:
+                addresses.add(view.__array_interface__["data"][0])
+            total = view[0] + view[-1]
+            del view
+            view_ns += time.perf_counter_ns() - start
+
+            start = time.perf_counter_ns()
+            total += bytes(frame)[0]
+            copy_ns += time.perf_counter_ns() - start
+            frame.release()
+            count += 1
+    print(f"PSD frames ({fft_size} bins, pool of {frames}): {count} frames, {view_ns / count:.0f} ns per view,"
+          f" {copy_ns / count:.0f} ns per copy, {psd.dropped_frames} dropped")
+    if addresses:
+        print(f"  numpy arrays landed on {len(addresses)} distinct addresses for {psd.pool_frames} pool buffers")
+
+
+def main():
+    capture_mb = int(sys.argv[1]) if len(sys.argv) > 1 else 256
+    print(f"radiohound buffer benchmark ({'numpy ' + numpy.__version__ if numpy else 'memoryview, numpy not installed'})")
+    bench_slots(capture_mb << 20)
+    for fft_size in (1024, 16384):
+        bench_frames(fft_size, 8)
+
+
+if __name__ == "__main__":
+    main()
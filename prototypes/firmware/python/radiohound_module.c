@@ -0,0 +1,819 @@
+// =================================================================================================
+// File: radiohound_module.c
+// Description: Python extension exposing capture slots and PSD frames through the buffer protocol.
+//
+// A Slot is a view of one packet in the DMA ring and a Frame one averaged spectrum. Both export
+// their memory directly, so memoryview(slot), numpy.frombuffer(slot, numpy.int16) or
+// numpy.asarray(frame) read the ring and the PSD engine's output in place, without a copy. The
+// memory goes back to its ring or pool when release() is called (or the `with` block ends), which
+// is refused while any array still views it. A Slot or Frame that is dropped unreleased is
+// released when it is collected. Slots may be released in any order; the ring reclaims them in
+// capture order.
+//
+// Capture(hardware=False) runs on the software DMA backend, whose stream packets carry the stream
+// source's counting pattern; Capture(hardware=True) maps the udmabuf, the DMA and the stream source
+// like the test application does.
+// =================================================================================================
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include <pythread.h>
+#include <structmember.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include "app_config.h"
+#include "hw_platform.h"
+#include "capture_session.h"
+#include "psd.h"
+#include "radiohound_dma_api.h"
+
+// --- Object Layouts ---
+
+typedef struct {
+    PyObject_HEAD
+    PyThread_type_lock     lock;          // Serializes capture_session_* calls made without the GIL
+    RhDma                  dma;
+    int                    dma_open;
+    int                    hardware;
+    int                    udma_fd;
+    int                    source_fd;
+    uint8_t*               window;
+    AxiStreamSource_Regs_t* source;
+    AxiStreamSource_Regs_t soft_source;   // Register block the software backend "starts"
+    CaptureSession         session;
+    int                    started;
+    uint32_t               held[CAPTURE_MAX_RING_SLOTS];    // Sequence of the slot in each ring position
+    uint8_t                returned[CAPTURE_MAX_RING_SLOTS]; // Released by Python, not yet by the ring
+} CaptureObject;
+
+typedef struct {
+    PyObject_HEAD
+    CaptureObject* capture;   // Strong reference: keeps the ring mapped while the slot exists
+    CaptureSlot    slot;
+    Py_ssize_t     exports;
+    int            released;
+} SlotObject;
+
+typedef struct {
+    uint32_t index;
+    uint64_t sequence;
+    uint64_t first_sample;
+    unsigned averages;
+} PendingFrame;
+
+typedef struct {
+    PyObject_HEAD
+    PyThread_type_lock lock;
+    PsdEngine          engine;
+    int                engine_ready;
+    unsigned           frames;        // Buffers in the pool
+    float*             bins;          // frames * fft_size floats
+    uint32_t*          free_stack;
+    unsigned           free_count;
+    int                current;       // Pool buffer the engine writes the next frame into, -1 if none
+    PendingFrame*      pending;       // Frames emitted during the current push
+    unsigned           pending_count;
+    uint64_t           dropped;       // Frames lost because every pool buffer was held
+} PsdObject;
+
+typedef struct {
+    PyObject_HEAD
+    PsdObject*   psd;
+    uint32_t     index;
+    uint64_t     sequence;
+    uint64_t     first_sample;
+    unsigned     averages;
+    Py_ssize_t   shape;
+    Py_ssize_t   stride;
+    Py_ssize_t   exports;
+    int          released;
+} FrameObject;
+
+static PyTypeObject CaptureType;
+static PyTypeObject SlotType;
+static PyTypeObject PsdType;
+static PyTypeObject FrameType;
+
+
+// --- Internal Helpers ---
+
+static void capture_lock(CaptureObject* self) {
+    if (!PyThread_acquire_lock(self->lock, NOWAIT_LOCK)) {
+        Py_BEGIN_ALLOW_THREADS
+        PyThread_acquire_lock(self->lock, WAIT_LOCK);
+        Py_END_ALLOW_THREADS
+    }
+}
+
+static void psd_lock(PsdObject* self) {
+    if (!PyThread_acquire_lock(self->lock, NOWAIT_LOCK)) {
+        Py_BEGIN_ALLOW_THREADS
+        PyThread_acquire_lock(self->lock, WAIT_LOCK);
+        Py_END_ALLOW_THREADS
+    }
+}
+
+// Hands a slot back. The ring takes slots in capture order, so one released early waits in
+// `returned` until everything before it is back too. Called with the capture lock held.
+static int capture_return_slot(CaptureObject* self, const CaptureSlot* slot) {
+    CaptureSession* s = &self->session;
+    if (!self->started) return 0; // Stopped: releasing would restart the source
+    self->returned[slot->ring_index] = 1;
+    while (s->packets_released < s->packets_completed) {
+        uint32_t index = s->packets_released % s->config.ring_slots;
+        if (!self->returned[index]) break;
+        CaptureSlot oldest = { .sequence = self->held[index], .ring_index = index };
+        if (capture_session_release_slot(s, &oldest) != 0) return -1;
+        self->returned[index] = 0;
+    }
+    return 0;
+}
+
+static int slot_do_release(SlotObject* self) {
+    if (self->released) return 0;
+    self->released = 1;
+    CaptureObject* capture = self->capture;
+    capture_lock(capture);
+    int rc = capture_return_slot(capture, &self->slot);
+    PyThread_release_lock(capture->lock);
+    return rc;
+}
+
+// Gives a pool buffer back; if the engine was left without one, it gets this one.
+// Called with the PSD lock held.
+static void psd_return_buffer(PsdObject* self, uint32_t index) {
+    if (self->current < 0) {
+        self->current = (int)index;
+        psd_engine_set_output(&self->engine, self->bins + (size_t)index * self->engine.config.fft_size);
+    } else {
+        self->free_stack[self->free_count++] = index;
+    }
+}
+
+static void frame_do_release(FrameObject* self) {
+    if (self->released) return;
+    self->released = 1;
+    psd_lock(self->psd);
+    psd_return_buffer(self->psd, self->index);
+    PyThread_release_lock(self->psd->lock);
+}
+
+// Runs inside psd_engine_push(), without the GIL. The frame is already in the pool buffer the
+// engine was given; keep it and give the engine the next free buffer.
+static void on_psd_frame(const PsdFrame* frame, void* user) {
+    PsdObject* self = user;
+
+    if (self->current < 0) {
+        self->dropped++;
+    } else {
+        PendingFrame* p = &self->pending[self->pending_count++];
+        p->index = (uint32_t)self->current;
+        p->sequence = frame->sequence;
+        p->first_sample = frame->first_sample;
+        p->averages = frame->averages;
+    }
+    if (self->free_count > 0) {
+        self->current = (int)self->free_stack[--self->free_count];
+        psd_engine_set_output(&self->engine, self->bins + (size_t)self->current * frame->fft_size);
+    } else {
+        self->current = -1;
+        psd_engine_set_output(&self->engine, NULL);
+    }
+}
+
+static void capture_close(CaptureObject* self) {
+    if (self->started) capture_session_stop(&self->session);
+    self->started = 0;
+    if (self->dma_open) rh_dma_close(&self->dma);
+    self->dma_open = 0;
+    if (self->source && self->hardware) munmap((void*)self->source, 4096);
+    self->source = NULL;
+    if (self->window) munmap(self->window, CAPTURE_BUFFER_SIZE);
+    self->window = NULL;
+    if (self->source_fd >= 0) close(self->source_fd);
+    if (self->udma_fd >= 0) close(self->udma_fd);
+    self->source_fd = self->udma_fd = -1;
+}
+
+// Maps the DMA region and opens the DMA the way the test application does, or sets up the
+// software backend over an anonymous region of the same layout.
+static int capture_open(CaptureObject* self) {
+    RhDmaConfig config;
+    rh_dma_config_default(&config);
+
+    if (self->hardware) {
+        self->source_fd = open(UIO_STREAM_SRC_DEV_NAME, O_RDWR);
+        if (self->source_fd < 0) {
+            PyErr_SetFromErrnoWithFilename(PyExc_OSError, UIO_STREAM_SRC_DEV_NAME);
+            return -1;
+        }
+        void* regs = mmap(NULL, 4096, PROT_READ | PROT_WRITE, MAP_SHARED, self->source_fd, 0);
+        if (regs == MAP_FAILED) {
+            PyErr_SetFromErrno(PyExc_OSError);
+            return -1;
+        }
+        self->source = regs;
+        self->udma_fd = open(UDMABUF_DEVICE_NAME, O_RDWR);
+        if (self->udma_fd < 0) {
+            PyErr_SetFromErrnoWithFilename(PyExc_OSError, UDMABUF_DEVICE_NAME);
+            return -1;
+        }
+        void* window = mmap(NULL, CAPTURE_BUFFER_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, self->udma_fd, 0);
+        if (window == MAP_FAILED) {
+            PyErr_SetFromErrno(PyExc_OSError);
+            return -1;
+        }
+        self->window = window;
+        config.uio_path = UIO_DMA_DEV_NAME;
+        config.desc_phys = DMA_PHYSICAL_BASE_ADDR + STREAM_DESCRIPTOR_OFFSET;
+        config.desc_virt = self->window + STREAM_DESCRIPTOR_OFFSET;
+    } else {
+        void* window = mmap(NULL, CAPTURE_BUFFER_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (window == MAP_FAILED) {
+            PyErr_SetFromErrno(PyExc_OSError);
+            return -1;
+        }
+        self->window = window;
+        self->source = &self->soft_source;
+        config.backend = RH_DMA_BACKEND_SOFTWARE;
+        config.mem_phys = DMA_PHYSICAL_BASE_ADDR;
+        config.mem_virt = self->window;
+        config.mem_bytes = CAPTURE_BUFFER_SIZE;
+    }
+    if (rh_dma_open(&self->dma, &config) != 0) {
+        PyErr_SetString(PyExc_OSError, "could not open the DMA controller (see stderr)");
+        return -1;
+    }
+    self->dma_open = 1;
+    return 0;
+}
+
+
+// --- Slot ---
+
+static void Slot_dealloc(SlotObject* self) {
+    slot_do_release(self);
+    Py_DECREF(self->capture);
+    Py_TYPE(self)->tp_free((PyObject*)self);
+}
+
+static int Slot_getbuffer(SlotObject* self, Py_buffer* view, int flags) {
+    if (self->released) {
+        PyErr_SetString(PyExc_BufferError, "slot has been released to the ring");
+        return -1;
+    }
+    if (PyBuffer_FillInfo(view, (PyObject*)self, self->slot.data, (Py_ssize_t)self->slot.length, 1, flags) != 0) {
+        return -1;
+    }
+    self->exports++;
+    return 0;
+}
+
+static void Slot_releasebuffer(SlotObject* self, Py_buffer* view) {
+    (void)view;
+    self->exports--;
+}
+
+static PyObject* Slot_release(SlotObject* self, PyObject* unused) {
+    (void)unused;
+    if (self->exports > 0) {
+        PyErr_SetString(PyExc_BufferError, "cannot release a slot while arrays or memoryviews still view it");
+        return NULL;
+    }
+    if (slot_do_release(self) != 0) {
+        PyErr_SetString(PyExc_RuntimeError, "the ring refused the slot (see the console)");
+        return NULL;
+    }
+    Py_RETURN_NONE;
+}
+
+static PyObject* Slot_verify(SlotObject* self, PyObject* unused) {
+    (void)unused;
+    if (self->released) {
+        PyErr_SetString(PyExc_ValueError, "slot has been released to the ring");
+        return NULL;
+    }
+    int rc = capture_slot_verify(&self->slot);
+    if (rc < 0) Py_RETURN_NONE;
+    return PyBool_FromLong(rc);
+}
+
+static PyObject* Slot_enter(PyObject* self, PyObject* unused) {
+    (void)unused;
+    return Py_NewRef(self);
+}
+
+static PyObject* Slot_exit(SlotObject* self, PyObject* args) {
+    (void)args;
+    return Slot_release(self, NULL);
+}
+
+static Py_ssize_t Slot_len(SlotObject* self) {
+    return (Py_ssize_t)self->slot.length;
+}
+
+static PyObject* Slot_get_crc32c(SlotObject* self, void* closure) {
+    (void)closure;
+    if (!(self->slot.flags & CAPTURE_SLOT_CRC)) Py_RETURN_NONE;
+    return PyLong_FromUnsignedLong(self->slot.crc32c);
+}
+
+static PyObject* Slot_get_released(SlotObject* self, void* closure) {
+    (void)closure;
+    return PyBool_FromLong(self->released);
+}
+
+static PyMemberDef Slot_members[] = {
+    { "sequence", T_UINT, offsetof(SlotObject, slot.sequence), READONLY, "Packet number within the capture" },
+    { "stream_offset", T_ULONGLONG, offsetof(SlotObject, slot.stream_offset), READONLY, "Byte offset in the capture stream" },
+    { "timestamp_ns", T_ULONGLONG, offsetof(SlotObject, slot.timestamp_ns), READONLY, "capture_clock_ns() at completion" },
+    { "ring_index", T_UINT, offsetof(SlotObject, slot.ring_index), READONLY, "Position in the slot ring" },
+    { NULL }
+};
+
+static PyGetSetDef Slot_getset[] = {
+    { "crc32c", (getter)Slot_get_crc32c, NULL, "CRC32C taken at completion, or None", NULL },
+    { "released", (getter)Slot_get_released, NULL, "True once the slot is back in the ring", NULL },
+    { NULL }
+};
+
+static PyMethodDef Slot_methods[] = {
+    { "release", (PyCFunction)Slot_release, METH_NOARGS, "Hand the slot back to the ring." },
+    { "verify", (PyCFunction)Slot_verify, METH_NOARGS, "Check the data against the completion CRC (None without one)." },
+    { "__enter__", (PyCFunction)Slot_enter, METH_NOARGS, NULL },
+    { "__exit__", (PyCFunction)Slot_exit, METH_VARARGS, NULL },
+    { NULL }
+};
+
+static PyBufferProcs Slot_as_buffer = {
+    .bf_getbuffer = (getbufferproc)Slot_getbuffer,
+    .bf_releasebuffer = (releasebufferproc)Slot_releasebuffer,
+};
+
+static PySequenceMethods Slot_as_sequence = {
+    .sq_length = (lenfunc)Slot_len,
+};
+
+static PyTypeObject SlotType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    .tp_name = "radiohound.Slot",
+    .tp_doc = "One filled packet of the DMA ring, viewed in place through the buffer protocol.",
+    .tp_basicsize = sizeof(SlotObject),
+    .tp_flags = Py_TPFLAGS_DEFAULT,
+    .tp_dealloc = (destructor)Slot_dealloc,
+    .tp_as_buffer = &Slot_as_buffer,
+    .tp_as_sequence = &Slot_as_sequence,
+    .tp_members = Slot_members,
+    .tp_getset = Slot_getset,
+    .tp_methods = Slot_methods,
+};
+
+
+// --- Capture ---
+
+static PyObject* Capture_new(PyTypeObject* type, PyObject* args, PyObject* kwds) {
+    static char* kwlist[] = { "capture_bytes", "packet_bytes", "ring_slots", "hardware", "checksum", NULL };
+    unsigned long long capture_bytes;
+    Py_ssize_t packet_bytes = -1, ring_slots = -1;
+    int hardware = 0, checksum = 0;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "K|nnpp", kwlist, &capture_bytes, &packet_bytes, &ring_slots,
+                                     &hardware, &checksum)) {
+        return NULL;
+    }
+
+    CaptureObject* self = (CaptureObject*)type->tp_alloc(type, 0);
+    if (!self) return NULL;
+    self->udma_fd = self->source_fd = -1;
+    self->hardware = hardware;
+    self->lock = PyThread_allocate_lock();
+    if (!self->lock) {
+        Py_DECREF(self);
+        return PyErr_NoMemory();
+    }
+
+    CaptureConfig config;
+    capture_config_default(&config, capture_bytes);
+    if (packet_bytes > 0) {
+        config.packet_bytes = (size_t)packet_bytes;
+        if (ring_slots <= 0) config.ring_slots = (uint32_t)(CAPTURE_RING_BYTES / config.packet_bytes);
+    }
+    if (ring_slots > 0) config.ring_slots = (uint32_t)ring_slots;
+    config.checksum = checksum;
+
+    if (capture_open(self) != 0) {
+        Py_DECREF(self);
+        return NULL;
+    }
+    if (capture_session_init(&self->session, &config, &self->dma, self->source, DMA_PHYSICAL_BASE_ADDR,
+                             self->window, CAPTURE_BUFFER_SIZE) != 0) {
+        PyErr_SetString(PyExc_ValueError, "capture configuration does not fit the hardware (see the console)");
+        Py_DECREF(self);
+        return NULL;
+    }
+    return (PyObject*)self;
+}
+
+static void Capture_dealloc(CaptureObject* self) {
+    capture_close(self);
+    if (self->lock) PyThread_free_lock(self->lock);
+    Py_TYPE(self)->tp_free((PyObject*)self);
+}
+
+static PyObject* Capture_start(CaptureObject* self, PyObject* unused) {
+    (void)unused;
+    if (self->started) {
+        PyErr_SetString(PyExc_RuntimeError, "capture already started");
+        return NULL;
+    }
+    capture_lock(self);
+    int rc = capture_session_start(&self->session);
+    PyThread_release_lock(self->lock);
+    if (rc != 0) {
+        PyErr_SetString(PyExc_RuntimeError, "could not start the capture (see the console)");
+        return NULL;
+    }
+    self->started = 1;
+    Py_RETURN_NONE;
+}
+
+static PyObject* Capture_next_slot(CaptureObject* self, PyObject* unused) {
+    (void)unused;
+    if (!self->started) {
+        PyErr_SetString(PyExc_RuntimeError, "capture not started");
+        return NULL;
+    }
+    SlotObject* slot = PyObject_New(SlotObject, &SlotType);
+    if (!slot) return NULL;
+    slot->capture = (CaptureObject*)Py_NewRef(self);
+    slot->exports = 0;
+    slot->released = 1; // Nothing to give back until the session hands us a slot
+
+    int rc;
+    Py_BEGIN_ALLOW_THREADS
+    PyThread_acquire_lock(self->lock, WAIT_LOCK);
+    rc = capture_session_next_slot(&self->session, &slot->slot);
+    if (rc == 1) self->held[slot->slot.ring_index] = slot->slot.sequence;
+    PyThread_release_lock(self->lock);
+    Py_END_ALLOW_THREADS
+
+    if (rc != 1) {
+        Py_DECREF(slot);
+        if (rc == 0) Py_RETURN_NONE;
+        PyErr_SetString(PyExc_RuntimeError, "capture failed (see the console)");
+        return NULL;
+    }
+    slot->released = 0;
+    return (PyObject*)slot;
+}
+
+static PyObject* Capture_stop(CaptureObject* self, PyObject* unused) {
+    (void)unused;
+    capture_lock(self);
+    if (self->started) capture_session_stop(&self->session);
+    self->started = 0;
+    PyThread_release_lock(self->lock);
+    Py_RETURN_NONE;
+}
+
+static PyObject* Capture_iternext(CaptureObject* self) {
+    PyObject* slot = Capture_next_slot(self, NULL);
+    if (slot == Py_None) {
+        Py_DECREF(slot);
+        return NULL; // StopIteration
+    }
+    return slot;
+}
+
+static PyObject* Capture_enter(CaptureObject* self, PyObject* unused) {
+    (void)unused;
+    if (!self->started && !Capture_start(self, NULL)) return NULL;
+    return Py_NewRef(self);
+}
+
+static PyObject* Capture_exit(CaptureObject* self, PyObject* args) {
+    (void)args;
+    return Capture_stop(self, NULL);
+}
+
+static PyMemberDef Capture_members[] = {
+    { "total_packets", T_UINT, offsetof(CaptureObject, session.total_packets), READONLY, "Packets in the capture" },
+    { "packets_completed", T_UINT, offsetof(CaptureObject, session.packets_completed), READONLY, "Packets landed so far" },
+    { "packets_released", T_UINT, offsetof(CaptureObject, session.packets_released), READONLY, "Slots back in the ring" },
+    { "stalls", T_UINT, offsetof(CaptureObject, session.stalls), READONLY, "Times the source waited for a free slot" },
+    { "packet_bytes", T_ULONG, offsetof(CaptureObject, session.config.packet_bytes), READONLY, "Bytes per slot" },
+    { "ring_slots", T_UINT, offsetof(CaptureObject, session.config.ring_slots), READONLY, "Slots in the ring" },
+    { NULL }
+};
+
+static PyMethodDef Capture_methods[] = {
+    { "start", (PyCFunction)Capture_start, METH_NOARGS, "Start streaming the first packet." },
+    { "next_slot", (PyCFunction)Capture_next_slot, METH_NOARGS,
+      "Wait for the next packet and return it as a Slot, or None once the capture is complete." },
+    { "stop", (PyCFunction)Capture_stop, METH_NOARGS, "Stop the DMA and the stream source." },
+    { "__enter__", (PyCFunction)Capture_enter, METH_NOARGS, NULL },
+    { "__exit__", (PyCFunction)Capture_exit, METH_VARARGS, NULL },
+    { NULL }
+};
+
+static PyTypeObject CaptureType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    .tp_name = "radiohound.Capture",
+    .tp_doc = "Capture(capture_bytes, packet_bytes=None, ring_slots=None, hardware=False, checksum=False)\n\n"
+              "A segmented capture into the DMA ring. Iterating yields Slots until the capture is complete.",
+    .tp_basicsize = sizeof(CaptureObject),
+    .tp_flags = Py_TPFLAGS_DEFAULT,
+    .tp_new = Capture_new,
+    .tp_dealloc = (destructor)Capture_dealloc,
+    .tp_iter = PyObject_SelfIter,
+    .tp_iternext = (iternextfunc)Capture_iternext,
+    .tp_members = Capture_members,
+    .tp_methods = Capture_methods,
+};
+
+
+// --- Frame ---
+
+static void Frame_dealloc(FrameObject* self) {
+    frame_do_release(self);
+    Py_DECREF(self->psd);
+    Py_TYPE(self)->tp_free((PyObject*)self);
+}
+
+static int Frame_getbuffer(FrameObject* self, Py_buffer* view, int flags) {
+    if (self->released) {
+        PyErr_SetString(PyExc_BufferError, "frame has been released to the pool");
+        return -1;
+    }
+    if (flags & PyBUF_WRITABLE) {
+        PyErr_SetString(PyExc_BufferError, "frames are read-only");
+        return -1;
+    }
+    view->obj = Py_NewRef(self);
+    view->buf = self->psd->bins + (size_t)self->index * (size_t)self->shape;
+    view->len = self->shape * (Py_ssize_t)sizeof(float);
+    view->readonly = 1;
+    view->itemsize = sizeof(float);
+    view->format = (flags & PyBUF_FORMAT) ? "f" : NULL;
+    view->ndim = 1;
+    view->shape = (flags & PyBUF_ND) ? &self->shape : NULL;
+    view->strides = (flags & PyBUF_STRIDES) ? &self->stride : NULL;
+    view->suboffsets = NULL;
+    view->internal = NULL;
+    self->exports++;
+    return 0;
+}
+
+static void Frame_releasebuffer(FrameObject* self, Py_buffer* view) {
+    (void)view;
+    self->exports--;
+}
+
+static PyObject* Frame_release(FrameObject* self, PyObject* unused) {
+    (void)unused;
+    if (self->exports > 0) {
+        PyErr_SetString(PyExc_BufferError, "cannot release a frame while arrays or memoryviews still view it");
+        return NULL;
+    }
+    frame_do_release(self);
+    Py_RETURN_NONE;
+}
+
+static PyObject* Frame_enter(PyObject* self, PyObject* unused) {
+    (void)unused;
+    return Py_NewRef(self);
+}
+
+static PyObject* Frame_exit(FrameObject* self, PyObject* args) {
+    (void)args;
+    return Frame_release(self, NULL);
+}
+
+static Py_ssize_t Frame_len(FrameObject* self) {
+    return self->shape;
+}
+
+static PyObject* Frame_get_sample_rate(FrameObject* self, void* closure) {
+    (void)closure;
+    return PyFloat_FromDouble(self->psd->engine.config.sample_rate);
+}
+
+static PyMemberDef Frame_members[] = {
+    { "sequence", T_ULONGLONG, offsetof(FrameObject, sequence), READONLY, "Frame number since the engine started" },
+    { "first_sample", T_ULONGLONG, offsetof(FrameObject, first_sample), READONLY, "Stream sample index of the first sample" },
+    { "averages", T_UINT, offsetof(FrameObject, averages), READONLY, "Segments averaged into the frame" },
+    { NULL }
+};
+
+static PyGetSetDef Frame_getset[] = {
+    { "sample_rate", (getter)Frame_get_sample_rate, NULL, "Sample rate in Hz", NULL },
+    { NULL }
+};
+
+static PyMethodDef Frame_methods[] = {
+    { "release", (PyCFunction)Frame_release, METH_NOARGS, "Hand the frame buffer back to the pool." },
+    { "__enter__", (PyCFunction)Frame_enter, METH_NOARGS, NULL },
+    { "__exit__", (PyCFunction)Frame_exit, METH_VARARGS, NULL },
+    { NULL }
+};
+
+static PyBufferProcs Frame_as_buffer = {
+    .bf_getbuffer = (getbufferproc)Frame_getbuffer,
+    .bf_releasebuffer = (releasebufferproc)Frame_releasebuffer,
+};
+
+static PySequenceMethods Frame_as_sequence = {
+    .sq_length = (lenfunc)Frame_len,
+};
+
+static PyTypeObject FrameType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    .tp_name = "radiohound.Frame",
+    .tp_doc = "One averaged power spectrum (float32, FFT-shifted), viewed in place through the buffer protocol.",
+    .tp_basicsize = sizeof(FrameObject),
+    .tp_flags = Py_TPFLAGS_DEFAULT,
+    .tp_dealloc = (destructor)Frame_dealloc,
+    .tp_as_buffer = &Frame_as_buffer,
+    .tp_as_sequence = &Frame_as_sequence,
+    .tp_members = Frame_members,
+    .tp_getset = Frame_getset,
+    .tp_methods = Frame_methods,
+};
+
+
+// --- Psd ---
+
+static PyObject* Psd_new(PyTypeObject* type, PyObject* args, PyObject* kwds) {
+    static char* kwlist[] = { "sample_rate", "fft_size", "averages", "overlap", "frames", NULL };
+    double sample_rate;
+    unsigned fft_size = 1024, averages = 64, frames = 16;
+    int overlap = -1;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "d|IIiI", kwlist, &sample_rate, &fft_size, &averages, &overlap,
+                                     &frames)) {
+        return NULL;
+    }
+    if (frames < 2) {
+        PyErr_SetString(PyExc_ValueError, "the frame pool needs at least 2 buffers");
+        return NULL;
+    }
+
+    PsdObject* self = (PsdObject*)type->tp_alloc(type, 0);
+    if (!self) return NULL;
+    self->lock = PyThread_allocate_lock();
+    self->frames = frames;
+    self->bins = PyMem_Calloc((size_t)frames * fft_size, sizeof(float));
+    self->free_stack = PyMem_Calloc(frames, sizeof(uint32_t));
+    self->pending = PyMem_Calloc(frames, sizeof(PendingFrame));
+    if (!self->lock || !self->bins || !self->free_stack || !self->pending) {
+        Py_DECREF(self);
+        return PyErr_NoMemory();
+    }
+
+    PsdConfig config;
+    psd_config_default(&config, sample_rate);
+    config.fft_size = fft_size;
+    config.averages = averages;
+    config.overlap = overlap >= 0 ? (unsigned)overlap : fft_size / 2;
+    if (psd_engine_init(&self->engine, &config, on_psd_frame, self) != 0) {
+        PyErr_SetString(PyExc_ValueError, "invalid PSD configuration (see the console)");
+        Py_DECREF(self);
+        return NULL;
+    }
+    self->engine_ready = 1;
+
+    // The engine writes into pool buffer 0 first; the rest are free.
+    for (unsigned i = frames; i-- > 1;) self->free_stack[self->free_count++] = i;
+    self->current = 0;
+    psd_engine_set_output(&self->engine, self->bins);
+    return (PyObject*)self;
+}
+
+static void Psd_dealloc(PsdObject* self) {
+    if (self->engine_ready) psd_engine_free(&self->engine);
+    PyMem_Free(self->bins);
+    PyMem_Free(self->free_stack);
+    PyMem_Free(self->pending);
+    if (self->lock) PyThread_free_lock(self->lock);
+    Py_TYPE(self)->tp_free((PyObject*)self);
+}
+
+static PyObject* Psd_push(PsdObject* self, PyObject* arg) {
+    Py_buffer input;
+    if (PyObject_GetBuffer(arg, &input, PyBUF_SIMPLE) != 0) return NULL;
+    if (input.len % PSD_BYTES_PER_SAMPLE != 0) {
+        PyBuffer_Release(&input);
+        PyErr_Format(PyExc_ValueError, "input must be whole %d-byte complex int16 samples", PSD_BYTES_PER_SAMPLE);
+        return NULL;
+    }
+    PendingFrame* emitted = PyMem_Malloc(self->frames * sizeof(*emitted));
+    if (!emitted) {
+        PyBuffer_Release(&input);
+        return PyErr_NoMemory();
+    }
+
+    // The engine reads the caller's buffer (e.g. a Slot) in place and writes each frame into a pool
+    // buffer, so a push keeps at most `frames` of them; the rest are counted as dropped.
+    psd_lock(self);
+    self->pending_count = 0;
+    Py_BEGIN_ALLOW_THREADS
+    psd_engine_push(&self->engine, input.buf, (size_t)input.len);
+    Py_END_ALLOW_THREADS
+    const unsigned count = self->pending_count;
+    memcpy(emitted, self->pending, count * sizeof(*emitted));
+    self->pending_count = 0;
+    PyThread_release_lock(self->lock);
+    PyBuffer_Release(&input);
+
+    PyObject* result = PyList_New(count);
+    for (unsigned i = 0; i < count; ++i) {
+        FrameObject* frame = result ? PyObject_New(FrameObject, &FrameType) : NULL;
+        if (!frame) {
+            psd_lock(self);
+            psd_return_buffer(self, emitted[i].index);
+            PyThread_release_lock(self->lock);
+            continue;
+        }
+        frame->psd = (PsdObject*)Py_NewRef(self);
+        frame->index = emitted[i].index;
+        frame->sequence = emitted[i].sequence;
+        frame->first_sample = emitted[i].first_sample;
+        frame->averages = emitted[i].averages;
+        frame->shape = self->engine.config.fft_size;
+        frame->stride = sizeof(float);
+        frame->exports = 0;
+        frame->released = 0;
+        PyList_SET_ITEM(result, i, (PyObject*)frame);
+    }
+    PyMem_Free(emitted);
+    if (result && PyErr_Occurred()) Py_CLEAR(result);
+    return result;
+}
+
+static PyObject* Psd_reset(PsdObject* self, PyObject* unused) {
+    (void)unused;
+    psd_lock(self);
+    psd_engine_reset(&self->engine);
+    PyThread_release_lock(self->lock);
+    Py_RETURN_NONE;
+}
+
+static PyMemberDef Psd_members[] = {
+    { "dropped_frames", T_ULONGLONG, offsetof(PsdObject, dropped), READONLY,
+      "Frames lost because every pool buffer was held by Python" },
+    { "pool_frames", T_UINT, offsetof(PsdObject, frames), READONLY, "Frame buffers in the pool" },
+    { "fft_size", T_UINT, offsetof(PsdObject, engine.config.fft_size), READONLY, "Bins per frame" },
+    { NULL }
+};
+
+static PyMethodDef Psd_methods[] = {
+    { "push", (PyCFunction)Psd_push, METH_O,
+      "Consume complex int16 samples from any buffer (a Slot, bytes, an array) and return the Frames it completed." },
+    { "reset", (PyCFunction)Psd_reset, METH_NOARGS, "Start a new stream." },
+    { NULL }
+};
+
+static PyTypeObject PsdType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    .tp_name = "radiohound.Psd",
+    .tp_doc = "Psd(sample_rate, fft_size=1024, averages=64, overlap=fft_size//2, frames=16)\n\n"
+              "Welch PSD engine writing its frames straight into a pool of `frames` exported buffers.",
+    .tp_basicsize = sizeof(PsdObject),
+    .tp_flags = Py_TPFLAGS_DEFAULT,
+    .tp_new = Psd_new,
+    .tp_dealloc = (destructor)Psd_dealloc,
+    .tp_members = Psd_members,
+    .tp_methods = Psd_methods,
+};
+
+
+// --- Module ---
+
+static struct PyModuleDef radiohound_module = {
+    PyModuleDef_HEAD_INIT,
+    .m_name = "radiohound",
+    .m_doc = "Zero-copy access to RadioHound capture slots and PSD frames.",
+    .m_size = -1,
+};
+
+PyMODINIT_FUNC PyInit_radiohound(void) {
+    PyTypeObject* types[] = { &CaptureType, &SlotType, &PsdType, &FrameType };
+    for (size_t i = 0; i < sizeof(types) / sizeof(types[0]); ++i) {
+        if (PyType_Ready(types[i]) < 0) return NULL;
+    }
+
+    PyObject* module = PyModule_Create(&radiohound_module);
+    if (!module) return NULL;
+    for (size_t i = 0; i < sizeof(types) / sizeof(types[0]); ++i) {
+        const char* name = strrchr(types[i]->tp_name, '.') + 1;
+        if (PyModule_AddObjectRef(module, name, (PyObject*)types[i]) < 0) {
+            Py_DECREF(module);
+            return NULL;
+        }
+    }
+    PyModule_AddIntConstant(module, "DEFAULT_PACKET_BYTES", (long)CAPTURE_DEFAULT_PACKET_BYTES);
+    PyModule_AddIntConstant(module, "BYTES_PER_SAMPLE", PSD_BYTES_PER_SAMPLE);
+    return module;
+}
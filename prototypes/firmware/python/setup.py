@@ -0,0 +1,35 @@
+# Builds the radiohound extension from the firmware modules and the radiohound-dma library sources.
+#
+#   python3 setup.py build_ext --inplace     (or `make python` one directory up)
+
+import os
+
+from setuptools import Extension, setup
+
+# Absolute paths keep the objects of sources outside this directory under build/.
+HERE = os.path.dirname(os.path.abspath(__file__))
+FIRMWARE = os.path.dirname(HERE)
+RHDMA = os.path.abspath(os.path.join(FIRMWARE, "..", "..", "radiohound-dma"))
+
+radiohound = Extension(
+    "radiohound",
+    sources=[
+        os.path.join(HERE, "radiohound_module.c"),
+        f"{FIRMWARE}/capture_session.c",
+        f"{FIRMWARE}/crc32c.c",
+        f"{FIRMWARE}/psd.c",
+        f"{FIRMWARE}/fft.c",
+        f"{RHDMA}/src/radiohound_dma_api.c",
+    ],
+    include_dirs=[FIRMWARE, f"{RHDMA}/inc"],
+    define_macros=[("_GNU_SOURCE", None)],
+    extra_compile_args=["-O2", "-Wall", "-Wextra"],
+    libraries=["m"],
+)
+
+setup(
+    name="radiohound",
+    version="0.1",
+    description="Zero-copy access to RadioHound capture slots and PSD frames",
+    ext_modules=[radiohound],
+)
@@ -0,0 +1,340 @@
+// =================================================================================================
+// File: recorder.c
+// Description: Implementation of the capture recorder (io_uring, O_DIRECT and buffered backends).
+// =================================================================================================
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <linux/io_uring.h>
+#include "recorder.h"
+#include "crc32c.h"
+
+// --- io_uring Plumbing ---
+
+static int uring_setup(RecorderUring* ring, unsigned entries) {
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    memset(ring, 0, sizeof(*ring));
+    ring->ring_fd = -1;
+
+    int fd = (int)syscall(__NR_io_uring_setup, entries, &params);
+    if (fd < 0) return -1;
+    ring->ring_fd = fd;
+
+    ring->sq_len = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    ring->cq_len = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        if (ring->cq_len > ring->sq_len) ring->sq_len = ring->cq_len;
+        ring->cq_len = ring->sq_len;
+    }
+
+    ring->sq_ptr = mmap(NULL, ring->sq_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+    if (ring->sq_ptr == MAP_FAILED) goto fail;
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        ring->cq_ptr = ring->sq_ptr;
+    } else {
+        ring->cq_ptr = mmap(NULL, ring->cq_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+        if (ring->cq_ptr == MAP_FAILED) goto fail;
+    }
+    ring->sqes_len = params.sq_entries * sizeof(struct io_uring_sqe);
+    ring->sqes = mmap(NULL, ring->sqes_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+    if (ring->sqes == MAP_FAILED) goto fail;
+
+    uint8_t* sq = ring->sq_ptr;
+    uint8_t* cq = ring->cq_ptr;
+    ring->sq_head  = (unsigned*)(sq + params.sq_off.head);
+    ring->sq_tail  = (unsigned*)(sq + params.sq_off.tail);
+    ring->sq_mask  = (unsigned*)(sq + params.sq_off.ring_mask);
+    ring->sq_array = (unsigned*)(sq + params.sq_off.array);
+    ring->cq_head  = (unsigned*)(cq + params.cq_off.head);
+    ring->cq_tail  = (unsigned*)(cq + params.cq_off.tail);
+    ring->cq_mask  = (unsigned*)(cq + params.cq_off.ring_mask);
+    ring->cqes     = (struct io_uring_cqe*)(cq + params.cq_off.cqes);
+    return 0;
+
+fail:
+    if (ring->sqes && ring->sqes != MAP_FAILED) munmap(ring->sqes, ring->sqes_len);
+    if (ring->cq_ptr && ring->cq_ptr != MAP_FAILED && ring->cq_ptr != ring->sq_ptr) munmap(ring->cq_ptr, ring->cq_len);
+    if (ring->sq_ptr && ring->sq_ptr != MAP_FAILED) munmap(ring->sq_ptr, ring->sq_len);
+    close(fd);
+    ring->ring_fd = -1;
+    return -1;
+}
+
+static void uring_teardown(RecorderUring* ring) {
+    if (ring->ring_fd < 0) return;
+    munmap(ring->sqes, ring->sqes_len);
+    if (ring->cq_ptr != ring->sq_ptr) munmap(ring->cq_ptr, ring->cq_len);
+    munmap(ring->sq_ptr, ring->sq_len);
+    close(ring->ring_fd);
+    ring->ring_fd = -1;
+}
+
+static int uring_enter(RecorderUring* ring, unsigned to_submit, unsigned min_complete) {
+    unsigned flags = min_complete ? IORING_ENTER_GETEVENTS : 0;
+    int ret;
+    do {
+        ret = (int)syscall(__NR_io_uring_enter, ring->ring_fd, to_submit, min_complete, flags, NULL, 0);
+    } while (ret < 0 && errno == EINTR);
+    return ret;
+}
+
+
+// --- Completion Bookkeeping ---
+
+// Marks write `seq` complete and advances the in-order retirement counter.
+static void complete_write(Recorder* rec, uint64_t seq, int64_t result) {
+    unsigned qd = rec->config.queue_depth;
+    if (result < 0 || (uint64_t)result != rec->expected[seq % qd]) {
+        fprintf(stderr, "Recorder: write %llu failed (%s)\n", (unsigned long long)seq,
+                result < 0 ? strerror((int)-result) : "short write");
+        rec->error = 1;
+    }
+    rec->done[seq % qd] = 1;
+    while (rec->retired < rec->submitted && rec->done[rec->retired % qd]) {
+        rec->done[rec->retired % qd] = 0;
+        rec->retired++;
+    }
+}
+
+// Reaps completions; blocks until at least `min_complete` are available.
+static int reap_completions(Recorder* rec, unsigned min_complete) {
+    RecorderUring* ring = &rec->uring;
+
+    if (min_complete && uring_enter(ring, 0, min_complete) < 0) {
+        perror("Recorder: io_uring_enter");
+        rec->error = 1;
+        return -1;
+    }
+
+    unsigned head = *ring->cq_head;
+    unsigned tail = __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE);
+    while (head != tail) {
+        struct io_uring_cqe* cqe = &ring->cqes[head & *ring->cq_mask];
+        complete_write(rec, cqe->user_data, cqe->res);
+        head++;
+    }
+    __atomic_store_n(ring->cq_head, head, __ATOMIC_RELEASE);
+    return 0;
+}
+
+static int submit_uring_write(Recorder* rec, const void* data, uint32_t len) {
+    RecorderUring* ring = &rec->uring;
+
+    // Keep at most queue_depth writes in flight.
+    while (rec->submitted - rec->retired >= rec->config.queue_depth) {
+        if (reap_completions(rec, 1) != 0) return -1;
+    }
+
+    unsigned tail = *ring->sq_tail;
+    unsigned index = tail & *ring->sq_mask;
+    struct io_uring_sqe* sqe = &ring->sqes[index];
+    memset(sqe, 0, sizeof(*sqe));
+
+    const uint8_t* ptr = data;
+    if (rec->registered_base && ptr >= rec->registered_base &&
+        ptr + len <= rec->registered_base + rec->registered_len) {
+        sqe->opcode = IORING_OP_WRITE_FIXED;
+        sqe->buf_index = 0;
+    } else {
+        sqe->opcode = IORING_OP_WRITE;
+    }
+    sqe->fd = rec->fd;
+    sqe->off = rec->file_offset;
+    sqe->addr = (uint64_t)(uintptr_t)data;
+    sqe->len = len;
+    sqe->user_data = rec->submitted;
+
+    rec->expected[rec->submitted % rec->config.queue_depth] = len;
+    rec->done[rec->submitted % rec->config.queue_depth] = 0;
+    rec->submitted++;
+
+    ring->sq_array[index] = index;
+    __atomic_store_n(ring->sq_tail, tail + 1, __ATOMIC_RELEASE);
+
+    if (uring_enter(ring, 1, 0) < 0) {
+        perror("Recorder: io_uring_enter");
+        rec->error = 1;
+        return -1;
+    }
+
+    // Pick up anything that already finished without blocking.
+    return reap_completions(rec, 0);
+}
+
+static double seconds_since(const struct timespec* start) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+
+// --- Public API ---
+
+void recorder_config_default(RecorderConfig* config, RecorderBackend backend) {
+    config->backend = backend;
+    config->queue_depth = 8;
+    config->preallocate_bytes = 0;
+    config->verify_slots = 1;
+}
+
+const char* recorder_backend_name(RecorderBackend backend) {
+    switch (backend) {
+        case RECORDER_BACKEND_IO_URING: return "io_uring+O_DIRECT";
+        case RECORDER_BACKEND_DIRECT:   return "pwrite+O_DIRECT";
+        case RECORDER_BACKEND_PWRITE:   return "pwrite (buffered)";
+    }
+    return "unknown";
+}
+
+int recorder_open(Recorder* rec, const char* path, const RecorderConfig* config) {
+    memset(rec, 0, sizeof(*rec));
+    rec->fd = -1;
+    rec->uring.ring_fd = -1;
+    rec->config = *config;
+    crc32c_init();
+
+    if (rec->config.queue_depth == 0) rec->config.queue_depth = 1;
+    if (rec->config.queue_depth > RECORDER_MAX_QUEUE_DEPTH) rec->config.queue_depth = RECORDER_MAX_QUEUE_DEPTH;
+
+    if (rec->config.backend == RECORDER_BACKEND_IO_URING && uring_setup(&rec->uring, rec->config.queue_depth) != 0) {
+        printf("  io_uring unavailable (%s), falling back to %s.\n", strerror(errno),
+               recorder_backend_name(RECORDER_BACKEND_DIRECT));
+        rec->config.backend = RECORDER_BACKEND_DIRECT;
+    }
+    if (rec->config.backend != RECORDER_BACKEND_IO_URING) rec->config.queue_depth = 1;
+
+    int flags = O_WRONLY | O_CREAT | O_TRUNC;
+    if (rec->config.backend != RECORDER_BACKEND_PWRITE) flags |= O_DIRECT;
+    rec->fd = open(path, flags, 0644);
+    if (rec->fd < 0) {
+        perror("Recorder: failed to open output file");
+        uring_teardown(&rec->uring);
+        return -1;
+    }
+
+    // Reserve the extents up front so the filesystem does not allocate on the write path.
+    if (rec->config.preallocate_bytes > 0 &&
+        fallocate(rec->fd, 0, 0, (off_t)rec->config.preallocate_bytes) != 0) {
+        printf("  fallocate of %llu bytes failed (%s), continuing without preallocation.\n",
+               (unsigned long long)rec->config.preallocate_bytes, strerror(errno));
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &rec->start_time);
+    return 0;
+}
+
+int recorder_register_region(Recorder* rec, const void* base, size_t len) {
+    if (rec->config.backend != RECORDER_BACKEND_IO_URING) return -1;
+
+    struct iovec iov = { .iov_base = (void*)base, .iov_len = len };
+    if (syscall(__NR_io_uring_register, rec->uring.ring_fd, IORING_REGISTER_BUFFERS, &iov, 1) != 0) {
+        printf("  Could not register %zu byte region as a fixed buffer (%s).\n", len, strerror(errno));
+        return -1;
+    }
+    rec->registered_base = base;
+    rec->registered_len = len;
+    return 0;
+}
+
+int recorder_write(Recorder* rec, const void* data, size_t len) {
+    if (rec->error) return -1;
+    if (len == 0) return 0;
+
+    size_t io_len = len;
+    if (rec->config.backend != RECORDER_BACKEND_PWRITE) {
+        if (((uintptr_t)data % RECORDER_ALIGNMENT) != 0 || (rec->file_offset % RECORDER_ALIGNMENT) != 0) {
+            fprintf(stderr, "Recorder: O_DIRECT write is not 4KB aligned (only the last write may be short).\n");
+            rec->error = 1;
+            return -1;
+        }
+        io_len = (len + RECORDER_ALIGNMENT - 1) & ~(size_t)(RECORDER_ALIGNMENT - 1);
+    }
+    if (io_len > UINT32_MAX) {
+        fprintf(stderr, "Recorder: write of %zu bytes is too large.\n", len);
+        return -1;
+    }
+
+    if (rec->config.backend == RECORDER_BACKEND_IO_URING) {
+        if (submit_uring_write(rec, data, (uint32_t)io_len) != 0) return -1;
+    } else {
+        const uint8_t* ptr = data;
+        size_t remaining = io_len;
+        uint64_t offset = rec->file_offset;
+        while (remaining > 0) {
+            ssize_t n = pwrite(rec->fd, ptr, remaining, (off_t)offset);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) {
+                perror("Recorder: pwrite");
+                rec->error = 1;
+                return -1;
+            }
+            ptr += n;
+            offset += (uint64_t)n;
+            remaining -= (size_t)n;
+        }
+        rec->submitted++;
+        rec->retired++;
+    }
+
+    rec->file_offset += io_len;
+    rec->logical_size += len;
+    rec->stats.writes++;
+    rec->stats.bytes_written += len;
+    return 0;
+}
+
+int recorder_write_slot(Recorder* rec, const CaptureSlot* slot) {
+    if (rec->config.verify_slots && capture_slot_verify(slot) == 0) {
+        fprintf(stderr, "Recorder: slot %u changed since completion (CRC32C mismatch).\n", slot->sequence);
+        rec->stats.crc_errors++;
+    }
+    return recorder_write(rec, slot->data, slot->length);
+}
+
+uint64_t recorder_retired(const Recorder* rec) {
+    return rec->retired;
+}
+
+int recorder_flush(Recorder* rec) {
+    if (rec->config.backend == RECORDER_BACKEND_IO_URING) {
+        while (rec->retired < rec->submitted) {
+            if (reap_completions(rec, 1) != 0) break;
+        }
+    }
+    return rec->error ? -1 : 0;
+}
+
+int recorder_close(Recorder* rec, RecorderStats* stats) {
+    if (rec->fd < 0) return -1;
+
+    int rc = recorder_flush(rec);
+
+    // Drop the O_DIRECT tail padding and any unused preallocation.
+    if (ftruncate(rec->fd, (off_t)rec->logical_size) != 0) {
+        perror("Recorder: ftruncate");
+        rc = -1;
+    }
+    if (fdatasync(rec->fd) != 0) {
+        perror("Recorder: fdatasync");
+        rc = -1;
+    }
+
+    rec->stats.elapsed_seconds = seconds_since(&rec->start_time);
+    if (rec->stats.elapsed_seconds > 0) {
+        rec->stats.bandwidth_mbps = (double)rec->stats.bytes_written / rec->stats.elapsed_seconds / (1024.0 * 1024.0);
+    }
+
+    close(rec->fd);
+    rec->fd = -1;
+    uring_teardown(&rec->uring);
+
+    if (stats) *stats = rec->stats;
+    return rc;
+}
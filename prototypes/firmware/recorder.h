@@ -0,0 +1,140 @@
+// =================================================================================================
+// File: recorder.h
+// Description: Writes filled capture slots from the udmabuf mapping straight to storage.
+// =================================================================================================
+
+#ifndef RECORDER_H
+#define RECORDER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+#include "capture_session.h"
+
+// --- Configuration ---
+
+#define RECORDER_ALIGNMENT       4096 // O_DIRECT offset/length/address alignment
+#define RECORDER_MAX_QUEUE_DEPTH 64   // Upper bound on writes kept in flight
+
+typedef enum {
+    RECORDER_BACKEND_IO_URING, // io_uring + O_DIRECT, several writes in flight, fixed buffers when registered
+    RECORDER_BACKEND_DIRECT,   // Synchronous pwrite() on an O_DIRECT file descriptor
+    RECORDER_BACKEND_PWRITE    // Buffered pwrite() through the page cache (for comparison)
+} RecorderBackend;
+
+typedef struct {
+    RecorderBackend backend;
+    unsigned        queue_depth;        // Writes kept in flight by the io_uring backend
+    uint64_t        preallocate_bytes;  // Size passed to fallocate() at open (0 to skip)
+    int             verify_slots;       // Check slots against their completion CRC32C before writing
+} RecorderConfig;
+
+typedef struct {
+    uint64_t bytes_written;
+    uint64_t writes;
+    double   elapsed_seconds;   // From open until the data is durable (fdatasync at close)
+    double   bandwidth_mbps;    // Sustained MB/s over elapsed_seconds
+    uint64_t crc_errors;        // Slots whose data no longer matched their completion CRC32C
+} RecorderStats;
+
+// Minimal io_uring state; the raw syscalls are used so no liburing is needed on the board.
+typedef struct {
+    int                  ring_fd;
+    unsigned*            sq_head;
+    unsigned*            sq_tail;
+    unsigned*            sq_mask;
+    unsigned*            sq_array;
+    struct io_uring_sqe* sqes;
+    unsigned*            cq_head;
+    unsigned*            cq_tail;
+    unsigned*            cq_mask;
+    struct io_uring_cqe* cqes;
+    void*                sq_ptr;
+    size_t               sq_len;
+    void*                cq_ptr;
+    size_t               cq_len;
+    size_t               sqes_len;
+} RecorderUring;
+
+typedef struct {
+    int             fd;
+    RecorderConfig  config;
+    RecorderUring   uring;
+
+    const uint8_t*  registered_base; // Region registered as an io_uring fixed buffer (or NULL)
+    size_t          registered_len;
+
+    uint64_t        file_offset;     // Next (aligned) write offset
+    uint64_t        logical_size;    // Bytes of real data; the file is truncated to this at close
+    uint64_t        submitted;       // Writes handed to the backend
+    uint64_t        retired;         // Writes completed, counted in submission order
+    uint8_t         done[RECORDER_MAX_QUEUE_DEPTH];
+    uint32_t        expected[RECORDER_MAX_QUEUE_DEPTH];
+    int             error;
+
+    struct timespec start_time;
+    RecorderStats   stats;
+} Recorder;
+
+
+// --- Function Prototypes ---
+
+/**
+ * @brief Fills in a configuration for the given backend with default queue depth and no preallocation.
+ */
+void recorder_config_default(RecorderConfig* config, RecorderBackend backend);
+
+/**
+ * @brief Returns a printable name for a backend.
+ */
+const char* recorder_backend_name(RecorderBackend backend);
+
+/**
+ * @brief Creates (or truncates) the output file and sets up the chosen backend.
+ * Falls back from io_uring to the O_DIRECT backend if the kernel does not support it.
+ * @return 0 on success, -1 on failure.
+ */
+int recorder_open(Recorder* rec, const char* path, const RecorderConfig* config);
+
+/**
+ * @brief Registers a memory region (normally the whole udmabuf mapping) as an io_uring fixed
+ *        buffer so writes from it skip the per-I/O page pinning. Ignored by the other backends.
+ * @return 0 if registered, -1 if the kernel refused (writes then use the normal path).
+ */
+int recorder_register_region(Recorder* rec, const void* base, size_t len);
+
+/**
+ * @brief Queues a write of `len` bytes at the end of the file.
+ * For the O_DIRECT backends `data` must be 4KB aligned, and only the final write may have a length
+ * that is not a multiple of 4KB (the buffer must stay readable up to the next 4KB boundary,
+ * which is always true for capture slots). Blocks only when the queue is full.
+ * @return 0 on success, -1 on failure.
+ */
+int recorder_write(Recorder* rec, const void* data, size_t len);
+
+/**
+ * @brief Queues a filled capture slot. If the slot carries a CRC32C and verify_slots is set, the
+ *        data is checked first; a mismatch is reported and counted but the slot is still written.
+ */
+int recorder_write_slot(Recorder* rec, const CaptureSlot* slot);
+
+/**
+ * @brief Number of writes that have completed, counted in submission order. A caller may release
+ *        the buffer of write N (0-based) once this value exceeds N.
+ */
+uint64_t recorder_retired(const Recorder* rec);
+
+/**
+ * @brief Waits for every queued write to complete.
+ * @return 0 on success, -1 if any write failed.
+ */
+int recorder_flush(Recorder* rec);
+
+/**
+ * @brief Flushes, trims the file to the bytes actually recorded, syncs it and closes it.
+ * @param stats Receives the final statistics (may be NULL).
+ * @return 0 on success, -1 if anything failed along the way.
+ */
+int recorder_close(Recorder* rec, RecorderStats* stats);
+
+#endif // RECORDER_H
@@ -0,0 +1,231 @@
+// =================================================================================================
+// File: replay.c
+// Description: Implementation of the capture replay source.
+// =================================================================================================
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "app_config.h"
+#include "replay.h"
+
+// --- Internal Helpers ---
+
+static double seconds_between(const struct timespec* start, const struct timespec* end) {
+    return (double)(end->tv_sec - start->tv_sec) + (double)(end->tv_nsec - start->tv_nsec) / 1e9;
+}
+
+static void add_ns(struct timespec* ts, uint64_t ns) {
+    ts->tv_sec += (time_t)(ns / 1000000000ULL);
+    ts->tv_nsec += (long)(ns % 1000000000ULL);
+    if (ts->tv_nsec >= 1000000000L) {
+        ts->tv_sec++;
+        ts->tv_nsec -= 1000000000L;
+    }
+}
+
+// Pulls every page into the page cache so the replay measures the stages, not the disk.
+static void preload(const uint8_t* data, size_t bytes) {
+    volatile uint8_t sink = 0;
+    madvise((void*)data, bytes, MADV_WILLNEED);
+    for (size_t i = 0; i < bytes; i += 4096) sink ^= data[i];
+    (void)sink;
+}
+
+static int open_indexed(ReplaySource* src, const char* path) {
+    if (capture_reader_open(&src->reader, path) != 0) return -1;
+    src->indexed = 1;
+    const CaptureFileReader* r = &src->reader;
+    if (r->chunks == 0) {
+        fprintf(stderr, "Replay: %s has no chunks\n", path);
+        return -1;
+    }
+
+    const CaptureChunkRecord* first = &r->records[0];
+    const CaptureChunkRecord* last = &r->records[r->chunks - 1];
+    const uint32_t bps = r->header->bytes_per_sample;
+    const double rate = r->header->sample_rate > 0.0 ? r->header->sample_rate : src->config.sample_rate;
+    src->slots_per_loop = r->chunks;
+    src->loop_samples = last->first_sample + last->bytes / bps - first->first_sample;
+    src->first_ns = first->timestamp_ns;
+    if (r->chunks > 1 && last->timestamp_ns > first->timestamp_ns) {
+        src->slot_ns = (last->timestamp_ns - first->timestamp_ns) / (r->chunks - 1);
+    } else {
+        src->slot_ns = (uint64_t)((double)(first->bytes / bps) * 1e9 / rate);
+    }
+    src->loop_ns = last->timestamp_ns - first->timestamp_ns + src->slot_ns;
+
+    madvise((void*)r->data, r->data_bytes, MADV_SEQUENTIAL);
+    if (src->config.preload) preload(r->data, r->data_bytes);
+    return 0;
+}
+
+static int open_raw(ReplaySource* src, const char* path) {
+    struct stat st;
+    src->fd = open(path, O_RDONLY);
+    if (src->fd < 0) {
+        perror("Replay: failed to open");
+        return -1;
+    }
+    if (fstat(src->fd, &st) != 0 || st.st_size < REPLAY_BYTES_PER_SAMPLE) {
+        fprintf(stderr, "Replay: %s is empty\n", path);
+        return -1;
+    }
+    void* map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, src->fd, 0);
+    if (map == MAP_FAILED) {
+        perror("Replay: failed to map");
+        return -1;
+    }
+    src->map = map;
+    src->map_length = (size_t)st.st_size;
+    src->map_bytes = (size_t)st.st_size / REPLAY_BYTES_PER_SAMPLE * REPLAY_BYTES_PER_SAMPLE;
+
+    const double ns_per_sample = 1e9 / src->config.sample_rate;
+    src->slots_per_loop = (src->map_bytes + src->config.slot_bytes - 1) / src->config.slot_bytes;
+    src->loop_samples = src->map_bytes / REPLAY_BYTES_PER_SAMPLE;
+    src->slot_ns = (uint64_t)((double)(src->config.slot_bytes / REPLAY_BYTES_PER_SAMPLE) * ns_per_sample);
+    src->loop_ns = (uint64_t)((double)src->loop_samples * ns_per_sample);
+    const size_t first_bytes = src->map_bytes < src->config.slot_bytes ? src->map_bytes : src->config.slot_bytes;
+    src->first_ns = (uint64_t)((double)(first_bytes / REPLAY_BYTES_PER_SAMPLE - 1) * ns_per_sample);
+
+    madvise(map, (size_t)st.st_size, MADV_SEQUENTIAL);
+    if (src->config.preload) preload(src->map, src->map_bytes);
+    return 0;
+}
+
+
+// --- Public API ---
+
+void replay_config_default(ReplayConfig* config) {
+    config->pacing = REPLAY_AS_FAST_AS_POSSIBLE;
+    config->speed = 1.0;
+    config->sample_rate = 50e6;
+    config->slot_bytes = CAPTURE_DEFAULT_PACKET_BYTES;
+    config->loops = 1;
+    config->preload = 1;
+}
+
+int replay_open(ReplaySource* src, const char* path, const ReplayConfig* config) {
+    char index_path[CAPTURE_FILE_PATH_LEN + 8];
+
+    memset(src, 0, sizeof(*src));
+    src->fd = -1;
+    if (config->loops == 0 || !(config->speed > 0.0) || !(config->sample_rate > 0.0) ||
+        config->slot_bytes == 0 || config->slot_bytes % REPLAY_BYTES_PER_SAMPLE != 0) {
+        fprintf(stderr, "Replay: loops, speed, sample rate and slot size must be positive (slots whole samples)\n");
+        return -1;
+    }
+    src->config = *config;
+
+    snprintf(index_path, sizeof(index_path), "%s.idx", path);
+    int rc = access(index_path, R_OK) == 0 ? open_indexed(src, path) : open_raw(src, path);
+    if (rc != 0) {
+        replay_close(src);
+        return -1;
+    }
+    return 0;
+}
+
+int replay_next_slot(ReplaySource* src, CaptureSlot* slot) {
+    if (src->delivered >= src->slots_per_loop * src->config.loops) return 0;
+    const uint64_t loop = src->delivered / src->slots_per_loop;
+    const uint64_t index = src->delivered % src->slots_per_loop;
+
+    memset(slot, 0, sizeof(*slot));
+    uint64_t stamp;
+    if (src->indexed) {
+        const CaptureChunkRecord* r = &src->reader.records[index];
+        const uint8_t* data = capture_reader_chunk_data(&src->reader, index);
+        if (!data) {
+            fprintf(stderr, "Replay: chunk %llu lies outside the data file\n", (unsigned long long)index);
+            return -1;
+        }
+        slot->data = (uint8_t*)data;
+        slot->length = r->bytes;
+        slot->stream_offset = (r->first_sample + loop * src->loop_samples) * src->reader.header->bytes_per_sample;
+        stamp = r->timestamp_ns;
+        // The recorded CRC goes along, so sinks downstream check the data against the original capture.
+        if (r->flags & CAPTURE_CHUNK_CRC) {
+            slot->crc32c = r->crc32c;
+            slot->flags |= CAPTURE_SLOT_CRC;
+        }
+    } else {
+        const size_t offset = (size_t)index * src->config.slot_bytes;
+        const size_t remaining = src->map_bytes - offset;
+        slot->data = (uint8_t*)src->map + offset;
+        slot->length = remaining < src->config.slot_bytes ? remaining : src->config.slot_bytes;
+        slot->stream_offset = loop * src->loop_samples * REPLAY_BYTES_PER_SAMPLE + offset;
+        stamp = (uint64_t)((double)((offset + slot->length) / REPLAY_BYTES_PER_SAMPLE - 1) * 1e9 /
+                           src->config.sample_rate);
+    }
+    slot->timestamp_ns = stamp + loop * src->loop_ns;
+    slot->sequence = (uint32_t)src->delivered;
+    slot->ring_index = 0; // No ring behind a replay
+
+    if (src->delivered == 0) clock_gettime(CLOCK_MONOTONIC, &src->start);
+    if (src->config.pacing == REPLAY_REALTIME) {
+        struct timespec due = src->start, now;
+        add_ns(&due, (uint64_t)((double)(slot->timestamp_ns - src->first_ns) / src->config.speed));
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        double lateness = seconds_between(&due, &now);
+        if (lateness > 0.0) {
+            if (lateness > src->max_lateness) src->max_lateness = lateness;
+            if (lateness * 1e9 > (double)src->slot_ns / src->config.speed) src->late_slots++;
+        } else {
+            while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &due, NULL) == EINTR) {}
+        }
+    }
+    src->delivered++;
+    return 1;
+}
+
+int replay_release_slot(ReplaySource* src, const CaptureSlot* slot) {
+    if (slot->sequence != (uint32_t)src->released) {
+        fprintf(stderr, "Replay: slot %u released out of order (expected %u).\n", slot->sequence, (uint32_t)src->released);
+        return -1;
+    }
+    src->released++;
+    return 0;
+}
+
+int replay_run(ReplaySource* src, ReplayStageFn stage, void* user, ReplayStats* stats) {
+    CaptureSlot slot;
+    struct timespec start, end, begin, done;
+    int rc;
+
+    memset(stats, 0, sizeof(*stats));
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    while ((rc = replay_next_slot(src, &slot)) == 1) {
+        clock_gettime(CLOCK_MONOTONIC, &begin);
+        stage(&slot, user);
+        clock_gettime(CLOCK_MONOTONIC, &done);
+        stats->busy_seconds += seconds_between(&begin, &done);
+        stats->slots++;
+        stats->bytes += slot.length;
+        if (replay_release_slot(src, &slot) != 0) {
+            rc = -1;
+            break;
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    const double samples = (double)stats->bytes / REPLAY_BYTES_PER_SAMPLE;
+    stats->elapsed_seconds = seconds_between(&start, &end);
+    stats->input_rate = stats->elapsed_seconds > 0.0 ? samples / stats->elapsed_seconds : 0.0;
+    stats->max_rate = stats->busy_seconds > 0.0 ? samples / stats->busy_seconds : 0.0;
+    stats->late_slots = src->late_slots;
+    stats->max_lateness = src->max_lateness;
+    return rc;
+}
+
+void replay_close(ReplaySource* src) {
+    if (src->indexed) capture_reader_close(&src->reader);
+    if (src->map) munmap((void*)src->map, src->map_length);
+    if (src->fd >= 0) close(src->fd);
+    memset(src, 0, sizeof(*src));
+    src->fd = -1;
+}
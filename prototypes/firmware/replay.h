@@ -0,0 +1,118 @@
+// =================================================================================================
+// File: replay.h
+// Description: Replays recorded captures through the same slot interface the DMA ring produces,
+//              so processing stages can be benchmarked and regression-tested without hardware.
+//
+// Two kinds of recording are accepted: an indexed capture (capture_file.h), replayed chunk by chunk
+// with its recorded sample indices and timestamps, and a raw sample file such as the "Record
+// Capture to File" output, cut into slots of `slot_bytes` with timestamps made up from the sample
+// rate. Slots point straight into a read-only mapping of the file, so no data is copied; stages
+// must not write to them (the DMA ring gives the same guarantee the other way round). Indexed
+// chunks keep their recorded CRC32C, so sinks fed from a replay check against the original capture.
+//
+// Slots are handed out either as fast as the consumer takes them, which measures the highest input
+// rate a pipeline sustains, or paced to the recorded timing, which shows whether it keeps up at the
+// real rate: a slot the consumer asks for later than one slot period after it was due would have
+// been waiting in the ring, and enough of those in a row overrun it.
+// =================================================================================================
+
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+#include "capture_session.h"
+#include "capture_file.h"
+
+// --- Configuration ---
+
+#define REPLAY_BYTES_PER_SAMPLE 4 // Raw files: complex int16 (I low, Q high)
+
+typedef enum {
+    REPLAY_AS_FAST_AS_POSSIBLE,
+    REPLAY_REALTIME
+} ReplayPacing;
+
+typedef struct {
+    ReplayPacing pacing;
+    double       speed;       // REPLAY_REALTIME: multiple of the recorded rate
+    double       sample_rate; // Raw files: samples per second for pacing and timestamps
+    size_t       slot_bytes;  // Raw files: bytes per slot
+    unsigned     loops;       // Times the recording is played; the stream continues across loops
+    int          preload;     // Read the whole file into the page cache before the first slot
+} ReplayConfig;
+
+typedef struct {
+    uint64_t slots;
+    uint64_t bytes;
+    double   elapsed_seconds;
+    double   busy_seconds;     // Time spent inside the stage
+    double   input_rate;       // Samples per second delivered
+    double   max_rate;         // Samples per second the stage could take: samples / busy_seconds
+    uint64_t late_slots;       // REPLAY_REALTIME: slots taken more than one slot period after due
+    double   max_lateness;     // Seconds
+} ReplayStats;
+
+typedef struct {
+    ReplayConfig      config;
+    int               indexed;
+    CaptureFileReader reader;         // Indexed recordings
+    int               fd;             // Raw recordings
+    const uint8_t*    map;
+    size_t            map_length;     // Bytes mapped (the file size), for munmap()
+    size_t            map_bytes;      // Whole samples in the mapping
+
+    uint64_t          slots_per_loop;
+    uint64_t          loop_samples;   // Stream samples one loop advances
+    uint64_t          loop_ns;        // Recorded time one loop advances
+    uint64_t          first_ns;       // Timestamp of the first slot's end
+    uint64_t          slot_ns;        // Nominal time between slots
+    uint64_t          delivered;
+    uint64_t          released;
+    struct timespec   start;
+    uint64_t          late_slots;
+    double            max_lateness;
+} ReplaySource;
+
+typedef void (*ReplayStageFn)(const CaptureSlot* slot, void* user);
+
+
+// --- Function Prototypes ---
+
+/**
+ * @brief Fills in a configuration: as fast as possible, once, preloaded, 4MB slots at 50 MS/s.
+ */
+void replay_config_default(ReplayConfig* config);
+
+/**
+ * @brief Maps a recording for replay; <path>.idx selects the indexed format.
+ * @return 0 on success, -1 on failure.
+ */
+int replay_open(ReplaySource* src, const char* path, const ReplayConfig* config);
+
+/**
+ * @brief Returns the next slot, waiting for its due time when pacing in real time.
+ * @return 1 if a slot was returned, 0 once the replay is complete, -1 on error.
+ */
+int replay_next_slot(ReplaySource* src, CaptureSlot* slot);
+
+/**
+ * @brief Hands a slot back. Slots must be released in the order they were received, as with
+ *        capture_session_release_slot().
+ * @return 0 on success, -1 if the slot is not the oldest outstanding one.
+ */
+int replay_release_slot(ReplaySource* src, const CaptureSlot* slot);
+
+/**
+ * @brief Plays the whole recording through one stage, releasing each slot when the stage returns.
+ * @return 0 on success, -1 on error.
+ */
+int replay_run(ReplaySource* src, ReplayStageFn stage, void* user, ReplayStats* stats);
+
+/**
+ * @brief Unmaps the recording.
+ */
+void replay_close(ReplaySource* src);
+
+#endif // REPLAY_H
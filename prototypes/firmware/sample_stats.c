@@ -0,0 +1,196 @@
+// =================================================================================================
+// File: sample_stats.c
+// Description: Implementation of the per-slot sample statistics kernels.
+// =================================================================================================
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "sample_stats.h"
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+// --- Kernels ---
+
+static void lanes_init(SampleStatsLanes* lanes) {
+    memset(lanes, 0, sizeof(*lanes));
+    lanes->min[0] = lanes->min[1] = INT16_MAX;
+    lanes->max[0] = lanes->max[1] = INT16_MIN;
+}
+
+static inline void lane_add(SampleStatsLanes* lanes, int lane, int16_t v, int16_t clip_level) {
+    if (v < lanes->min[lane]) lanes->min[lane] = v;
+    if (v > lanes->max[lane]) lanes->max[lane] = v;
+    lanes->sum[lane] += v;
+    lanes->sum_squares[lane] += (uint64_t)((int32_t)v * v);
+    lanes->clipped[lane] += (v >= clip_level || v <= -clip_level);
+}
+
+static void stats_scalar(const int16_t* x, size_t pairs, int16_t clip_level, SampleStatsLanes* lanes) {
+    for (size_t n = 0; n < pairs; ++n) {
+        lane_add(lanes, 0, x[2 * n], clip_level);
+        lane_add(lanes, 1, x[2 * n + 1], clip_level);
+    }
+}
+
+#if defined(__x86_64__)
+
+// 16-bit lane counters and 32-bit sums are flushed before they can overflow.
+#define AVX2_FLUSH_VECTORS 16384
+
+__attribute__((target("avx2")))
+static void stats_avx2(const int16_t* x, size_t pairs, int16_t clip_level, SampleStatsLanes* lanes) {
+    const __m256i even_ones = _mm256_set1_epi32(1);               // (1, 0) in every 16-bit pair
+    const __m256i even_mask = _mm256_set1_epi32(0x0000FFFF);
+    const __m256i clip_hi = _mm256_set1_epi16((int16_t)(clip_level - 1));
+    const __m256i clip_lo = _mm256_set1_epi16((int16_t)(-clip_level + 1));
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i vmin = _mm256_set1_epi16(INT16_MAX);
+    __m256i vmax = _mm256_set1_epi16(INT16_MIN);
+    size_t n = 0;
+
+    while (n + 8 <= pairs) {
+        size_t vectors = (pairs - n) / 8;
+        if (vectors > AVX2_FLUSH_VECTORS) vectors = AVX2_FLUSH_VECTORS;
+
+        __m256i sum_all = zero, sum_even = zero, clip = zero;
+        __m256i sq_all_lo = zero, sq_all_hi = zero, sq_even_lo = zero, sq_even_hi = zero;
+        for (size_t v = 0; v < vectors; ++v, n += 8) {
+            __m256i s = _mm256_loadu_si256((const __m256i*)(x + 2 * n));
+            vmin = _mm256_min_epi16(vmin, s);
+            vmax = _mm256_max_epi16(vmax, s);
+
+            // madd against (1,1) and (1,0) gives per-pair sums of both lanes and of the even lane.
+            sum_all = _mm256_add_epi32(sum_all, _mm256_madd_epi16(s, _mm256_set1_epi16(1)));
+            sum_even = _mm256_add_epi32(sum_even, _mm256_madd_epi16(s, even_ones));
+
+            // Squares fit in 32 bits per pair but not summed over many vectors: widen to 64 bits.
+            __m256i sq_all = _mm256_madd_epi16(s, s);
+            __m256i sq_even = _mm256_madd_epi16(s, _mm256_and_si256(s, even_mask));
+            sq_all_lo = _mm256_add_epi64(sq_all_lo, _mm256_unpacklo_epi32(sq_all, zero));
+            sq_all_hi = _mm256_add_epi64(sq_all_hi, _mm256_unpackhi_epi32(sq_all, zero));
+            sq_even_lo = _mm256_add_epi64(sq_even_lo, _mm256_unpacklo_epi32(sq_even, zero));
+            sq_even_hi = _mm256_add_epi64(sq_even_hi, _mm256_unpackhi_epi32(sq_even, zero));
+
+            __m256i clipped = _mm256_or_si256(_mm256_cmpgt_epi16(s, clip_hi), _mm256_cmpgt_epi16(clip_lo, s));
+            clip = _mm256_sub_epi16(clip, clipped);
+        }
+
+        int32_t s32_all[8], s32_even[8];
+        int16_t c16[16];
+        uint64_t q_all[8], q_even[8];
+        _mm256_storeu_si256((__m256i*)s32_all, sum_all);
+        _mm256_storeu_si256((__m256i*)s32_even, sum_even);
+        _mm256_storeu_si256((__m256i*)c16, clip);
+        _mm256_storeu_si256((__m256i*)q_all, sq_all_lo);
+        _mm256_storeu_si256((__m256i*)(q_all + 4), sq_all_hi);
+        _mm256_storeu_si256((__m256i*)q_even, sq_even_lo);
+        _mm256_storeu_si256((__m256i*)(q_even + 4), sq_even_hi);
+        for (int i = 0; i < 8; ++i) {
+            lanes->sum[0] += s32_even[i];
+            lanes->sum[1] += (int64_t)s32_all[i] - s32_even[i];
+            lanes->sum_squares[0] += q_even[i];
+            lanes->sum_squares[1] += q_all[i] - q_even[i];
+        }
+        for (int i = 0; i < 16; ++i) lanes->clipped[i & 1] += (uint16_t)c16[i];
+    }
+
+    int16_t m16[16], x16[16];
+    _mm256_storeu_si256((__m256i*)m16, vmin);
+    _mm256_storeu_si256((__m256i*)x16, vmax);
+    for (int i = 0; i < 16; ++i) {
+        if (m16[i] < lanes->min[i & 1]) lanes->min[i & 1] = m16[i];
+        if (x16[i] > lanes->max[i & 1]) lanes->max[i & 1] = x16[i];
+    }
+
+    stats_scalar(x + 2 * n, pairs - n, clip_level, lanes);
+}
+
+#endif // __x86_64__
+
+
+// --- Public API Functions ---
+
+void sample_stats_config_default(SampleStatsConfig* config) {
+    config->channels = 2;
+    config->clip_level = SAMPLE_STATS_CLIP_12BIT;
+    config->impl = SAMPLE_IMPL_AUTO;
+}
+
+int sample_stats_init(SampleStats* stats, const SampleStatsConfig* config) {
+    if (config->channels < 1 || config->channels > SAMPLE_STATS_MAX_CHANNELS || config->clip_level <= 0) {
+        printf("ERROR: Invalid sample statistics configuration (%u channels).\n", config->channels);
+        return -1;
+    }
+    stats->config = *config;
+
+    SampleImpl impl = config->impl;
+#if defined(__x86_64__)
+    if (impl == SAMPLE_IMPL_AUTO) impl = __builtin_cpu_supports("avx2") ? SAMPLE_IMPL_AVX2 : SAMPLE_IMPL_SCALAR;
+    if (impl == SAMPLE_IMPL_AVX2 && __builtin_cpu_supports("avx2")) {
+        stats->kernel = stats_avx2;
+        stats->config.impl = impl;
+        return 0;
+    }
+#else
+    // Min/max have no useful SWAR form on the U54; the scalar loop is the fast path there.
+    if (impl == SAMPLE_IMPL_AUTO) impl = SAMPLE_IMPL_SCALAR;
+#endif
+    if (impl != SAMPLE_IMPL_SCALAR) {
+        printf("ERROR: Statistics kernel '%s' is not available.\n", sample_impl_name(impl));
+        return -1;
+    }
+    stats->kernel = stats_scalar;
+    stats->config.impl = impl;
+    return 0;
+}
+
+void sample_stats_compute(const SampleStats* stats, const void* samples, size_t bytes, SampleStatsRecord* record) {
+    const int16_t* x = samples;
+    const size_t count = bytes / sizeof(int16_t);
+    const int16_t clip_level = stats->config.clip_level;
+    SampleStatsLanes lanes;
+
+    lanes_init(&lanes);
+    stats->kernel(x, count / 2, clip_level, &lanes);
+    if (count & 1) lane_add(&lanes, 0, x[count - 1], clip_level);
+
+    memset(record, 0, sizeof(*record));
+    if (stats->config.channels == 1) {
+        // Real samples: both lanes belong to the one channel.
+        lanes.min[0] = lanes.min[0] < lanes.min[1] ? lanes.min[0] : lanes.min[1];
+        lanes.max[0] = lanes.max[0] > lanes.max[1] ? lanes.max[0] : lanes.max[1];
+        lanes.sum[0] += lanes.sum[1];
+        lanes.sum_squares[0] += lanes.sum_squares[1];
+        lanes.clipped[0] += lanes.clipped[1];
+        record->samples = (uint32_t)count;
+    } else {
+        record->samples = (uint32_t)(count / 2);
+    }
+    if (record->samples == 0) return;
+
+    for (unsigned c = 0; c < stats->config.channels; ++c) {
+        record->min[c] = lanes.min[c];
+        record->max[c] = lanes.max[c];
+        record->mean[c] = (float)((double)lanes.sum[c] / record->samples);
+        record->rms[c] = (float)sqrt((double)lanes.sum_squares[c] / record->samples);
+        record->clipped[c] = (uint32_t)lanes.clipped[c];
+    }
+}
+
+void sample_stats_compute_slot(const SampleStats* stats, const CaptureSlot* slot, SampleStatsRecord* record) {
+    sample_stats_compute(stats, slot->data, slot->length, record);
+    record->sequence = slot->sequence;
+    record->stream_offset = slot->stream_offset;
+}
+
+void sample_stats_print(const SampleStatsRecord* record, unsigned channels) {
+    printf("  Slot %u (%u samples):", record->sequence, record->samples);
+    for (unsigned c = 0; c < channels; ++c) {
+        printf(" %s[min %d max %d mean %.1f rms %.1f clip %u]", channels == 2 ? (c == 0 ? "I" : "Q") : "",
+               record->min[c], record->max[c], record->mean[c], record->rms[c], record->clipped[c]);
+    }
+    printf("\n");
+}
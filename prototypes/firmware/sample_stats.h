@@ -0,0 +1,86 @@
+// =================================================================================================
+// File: sample_stats.h
+// Description: Single-pass ADC health statistics for each DMA slot: min/max, mean (DC offset),
+//              RMS and full-scale clipping count, published as a compact fixed-size record.
+// =================================================================================================
+
+#ifndef SAMPLE_STATS_H
+#define SAMPLE_STATS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "capture_session.h"
+#include "sample_unpack.h"
+
+// --- Configuration ---
+
+#define SAMPLE_STATS_MAX_CHANNELS 2
+#define SAMPLE_STATS_CLIP_12BIT   0x7FF0 // MSB-aligned full scale of a 12-bit ADC
+
+typedef struct {
+    unsigned channels;   // 1 for real samples, 2 for interleaved I/Q
+    int16_t  clip_level; // Samples with |x| >= clip_level count as clipped
+    SampleImpl impl;     // SAMPLE_IMPL_AUTO, SCALAR or AVX2
+} SampleStatsConfig;
+
+/**
+ * @brief Statistics of one slot (48 bytes, little-endian). Unused channel entries are zero.
+ */
+typedef struct __attribute__((packed)) {
+    uint32_t sequence;                             // Capture slot sequence number
+    uint32_t samples;                              // Samples per channel
+    uint64_t stream_offset;                        // Byte offset of the slot in the capture stream
+    int16_t  min[SAMPLE_STATS_MAX_CHANNELS];
+    int16_t  max[SAMPLE_STATS_MAX_CHANNELS];
+    float    mean[SAMPLE_STATS_MAX_CHANNELS];      // DC offset in int16 LSBs
+    float    rms[SAMPLE_STATS_MAX_CHANNELS];       // RMS in int16 LSBs (DC included)
+    uint32_t clipped[SAMPLE_STATS_MAX_CHANNELS];
+} SampleStatsRecord;
+
+/**
+ * @brief Raw per-lane accumulators filled by a kernel. Lane 0 holds even int16 positions
+ *        (I, or every other real sample), lane 1 the odd positions.
+ */
+typedef struct {
+    int16_t  min[2];
+    int16_t  max[2];
+    int64_t  sum[2];
+    uint64_t sum_squares[2];
+    uint64_t clipped[2];
+} SampleStatsLanes;
+
+typedef struct {
+    SampleStatsConfig config;
+    void (*kernel)(const int16_t* x, size_t pairs, int16_t clip_level, SampleStatsLanes* lanes);
+} SampleStats;
+
+
+// --- Function Prototypes ---
+
+/**
+ * @brief Fills in a configuration for I/Q data with 12-bit ADC clipping and automatic kernel choice.
+ */
+void sample_stats_config_default(SampleStatsConfig* config);
+
+/**
+ * @brief Selects the statistics kernel.
+ * @return 0 on success, -1 if the configuration or requested kernel is not supported.
+ */
+int sample_stats_init(SampleStats* stats, const SampleStatsConfig* config);
+
+/**
+ * @brief Computes the statistics of `bytes` of int16 samples in one pass.
+ */
+void sample_stats_compute(const SampleStats* stats, const void* samples, size_t bytes, SampleStatsRecord* record);
+
+/**
+ * @brief Computes the statistics of a filled capture slot and stamps the record with its position.
+ */
+void sample_stats_compute_slot(const SampleStats* stats, const CaptureSlot* slot, SampleStatsRecord* record);
+
+/**
+ * @brief Prints a record on one line.
+ */
+void sample_stats_print(const SampleStatsRecord* record, unsigned channels);
+
+#endif // SAMPLE_STATS_H
@@ -0,0 +1,237 @@
+// =================================================================================================
+// File: sample_unpack.c
+// Description: Implementation of the scalar, SWAR and AVX2 sample conversion kernels.
+// =================================================================================================
+
+#include <stdio.h>
+#include <string.h>
+#include "sample_unpack.h"
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+// --- Scalar Kernels ---
+
+// Unpacks samples [first, last) of a B-bit packed stream, touching only bytes that hold them.
+static void unpack_scalar_range(const uint8_t* in, int16_t* out, size_t first, size_t last, unsigned bits) {
+    const uint32_t mask = (1U << bits) - 1;
+    for (size_t k = first; k < last; ++k) {
+        size_t bit = k * bits;
+        size_t b = bit >> 3;
+        unsigned r = bit & 7;
+        uint32_t v = in[b] | ((uint32_t)in[b + 1] << 8);
+        if (r + bits > 16) v |= (uint32_t)in[b + 2] << 16;
+        out[k] = (int16_t)(uint16_t)(((v >> r) & mask) << (16 - bits));
+    }
+}
+
+static void unpack12_scalar(const uint8_t* in, int16_t* out, size_t samples) {
+    unpack_scalar_range(in, out, 0, samples, 12);
+}
+
+static void unpack14_scalar(const uint8_t* in, int16_t* out, size_t samples) {
+    unpack_scalar_range(in, out, 0, samples, 14);
+}
+
+static void to_float_scalar(const int16_t* in, float* out, size_t samples) {
+    for (size_t i = 0; i < samples; ++i) out[i] = (float)in[i] * (1.0f / 32768.0f);
+}
+
+static void deinterleave_scalar(const int16_t* iq, int16_t* i_out, int16_t* q_out, size_t pairs) {
+    for (size_t n = 0; n < pairs; ++n) {
+        i_out[n] = iq[2 * n];
+        q_out[n] = iq[2 * n + 1];
+    }
+}
+
+
+// --- SWAR Kernels (64-bit words, little-endian) ---
+
+static inline uint64_t load64(const void* p) {
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline void store64(void* p, uint64_t v) {
+    memcpy(p, &v, sizeof(v));
+}
+
+// Four 12-bit samples sit in the low 48 bits of a word; each moves to the top of its 16-bit lane.
+static void unpack12_swar(const uint8_t* in, int16_t* out, size_t samples) {
+    const size_t total_bytes = sample_packed_bytes(12, samples);
+    size_t k = 0;
+    for (; k + 4 <= samples && (k / 4) * 6 + 8 <= total_bytes; k += 4) {
+        uint64_t w = load64(in + (k / 4) * 6);
+        store64(out + k, ((w << 4) & 0x000000000000FFF0ULL) | ((w << 8) & 0x00000000FFF00000ULL) |
+                         ((w << 12) & 0x0000FFF000000000ULL) | ((w << 16) & 0xFFF0000000000000ULL));
+    }
+    unpack_scalar_range(in, out, k, samples, 12);
+}
+
+// Four 14-bit samples sit in the low 56 bits of a word.
+static void unpack14_swar(const uint8_t* in, int16_t* out, size_t samples) {
+    const size_t total_bytes = sample_packed_bytes(14, samples);
+    size_t k = 0;
+    for (; k + 4 <= samples && (k / 4) * 7 + 8 <= total_bytes; k += 4) {
+        uint64_t w = load64(in + (k / 4) * 7);
+        store64(out + k, ((w << 2) & 0x000000000000FFFCULL) | ((w << 4) & 0x00000000FFFC0000ULL) |
+                         ((w << 6) & 0x0000FFFC00000000ULL) | ((w << 8) & 0xFFFC000000000000ULL));
+    }
+    unpack_scalar_range(in, out, k, samples, 14);
+}
+
+// Two words hold four I/Q pairs; the I and Q halves are gathered into one word each.
+static void deinterleave_swar(const int16_t* iq, int16_t* i_out, int16_t* q_out, size_t pairs) {
+    size_t n = 0;
+    for (; n + 4 <= pairs; n += 4) {
+        uint64_t w0 = load64(iq + 2 * n);
+        uint64_t w1 = load64(iq + 2 * n + 4);
+        uint64_t i01 = (w0 & 0xFFFF) | ((w0 >> 16) & 0xFFFF0000ULL);
+        uint64_t q01 = ((w0 >> 16) & 0xFFFF) | ((w0 >> 32) & 0xFFFF0000ULL);
+        uint64_t i23 = (w1 & 0xFFFF) | ((w1 >> 16) & 0xFFFF0000ULL);
+        uint64_t q23 = ((w1 >> 16) & 0xFFFF) | ((w1 >> 32) & 0xFFFF0000ULL);
+        store64(i_out + n, i01 | (i23 << 32));
+        store64(q_out + n, q01 | (q23 << 32));
+    }
+    deinterleave_scalar(iq + 2 * n, i_out + n, q_out + n, pairs - n);
+}
+
+
+// --- AVX2 Kernels ---
+
+#if defined(__x86_64__)
+
+// Unpacks 16 B-bit samples from `in`. Each 128-bit lane gathers the bytes of four samples into
+// 32-bit elements, shifts every sample to the top of its element, and the halves are packed to int16.
+__attribute__((target("avx2")))
+static inline __m256i unpack16_avx2(const uint8_t* in, unsigned bits, __m256i shuffle, __m256i shifts, __m256i mask) {
+    const size_t half = bits / 2; // Bytes per four samples
+    __m256i a = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)in)),
+                                        _mm_loadu_si128((const __m128i*)(in + half)), 1);
+    __m256i b = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)(in + 2 * half))),
+                                        _mm_loadu_si128((const __m128i*)(in + 3 * half)), 1);
+    a = _mm256_and_si256(_mm256_srli_epi32(_mm256_sllv_epi32(_mm256_shuffle_epi8(a, shuffle), shifts), 16), mask);
+    b = _mm256_and_si256(_mm256_srli_epi32(_mm256_sllv_epi32(_mm256_shuffle_epi8(b, shuffle), shifts), 16), mask);
+    return _mm256_permute4x64_epi64(_mm256_packus_epi32(a, b), 0xD8);
+}
+
+__attribute__((target("avx2")))
+static void unpack_avx2(const uint8_t* in, int16_t* out, size_t samples, unsigned bits,
+                        __m256i shuffle, __m256i shifts) {
+    const size_t total_bytes = sample_packed_bytes(bits, samples);
+    const __m256i mask = _mm256_set1_epi32((0xFFFF << (16 - bits)) & 0xFFFF);
+    size_t k = 0;
+    // The last 16-byte load of a group starts 1.5 * bits bytes in.
+    for (; k + 16 <= samples && (k / 16) * 2 * bits + 3 * bits / 2 + 16 <= total_bytes; k += 16) {
+        __m256i v = unpack16_avx2(in + (k / 16) * 2 * bits, bits, shuffle, shifts, mask);
+        _mm256_storeu_si256((__m256i*)(out + k), v);
+    }
+    unpack_scalar_range(in, out, k, samples, bits);
+}
+
+__attribute__((target("avx2")))
+static void unpack12_avx2(const uint8_t* in, int16_t* out, size_t samples) {
+    // Sample k of a lane starts at byte 12k/8 = {0, 1, 3, 4}, bit {0, 4, 0, 4}.
+    const __m256i shuffle = _mm256_setr_epi8(0, 1, 2, 3, 1, 2, 3, 4, 3, 4, 5, 6, 4, 5, 6, 7,
+                                             0, 1, 2, 3, 1, 2, 3, 4, 3, 4, 5, 6, 4, 5, 6, 7);
+    const __m256i shifts = _mm256_setr_epi32(20, 16, 20, 16, 20, 16, 20, 16);
+    unpack_avx2(in, out, samples, 12, shuffle, shifts);
+}
+
+__attribute__((target("avx2")))
+static void unpack14_avx2(const uint8_t* in, int16_t* out, size_t samples) {
+    // Sample k of a lane starts at byte 14k/8 = {0, 1, 3, 5}, bit {0, 6, 4, 2}.
+    const __m256i shuffle = _mm256_setr_epi8(0, 1, 2, 3, 1, 2, 3, 4, 3, 4, 5, 6, 5, 6, 7, 8,
+                                             0, 1, 2, 3, 1, 2, 3, 4, 3, 4, 5, 6, 5, 6, 7, 8);
+    const __m256i shifts = _mm256_setr_epi32(18, 12, 14, 16, 18, 12, 14, 16);
+    unpack_avx2(in, out, samples, 14, shuffle, shifts);
+}
+
+__attribute__((target("avx2")))
+static void to_float_avx2(const int16_t* in, float* out, size_t samples) {
+    const __m256 scale = _mm256_set1_ps(1.0f / 32768.0f);
+    size_t i = 0;
+    for (; i + 8 <= samples; i += 8) {
+        __m256i wide = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i*)(in + i)));
+        _mm256_storeu_ps(out + i, _mm256_mul_ps(_mm256_cvtepi32_ps(wide), scale));
+    }
+    to_float_scalar(in + i, out + i, samples - i);
+}
+
+__attribute__((target("avx2")))
+static void deinterleave_avx2(const int16_t* iq, int16_t* i_out, int16_t* q_out, size_t pairs) {
+    // Within each lane, gather the four I values into the low 8 bytes and the Q values above them.
+    const __m256i shuffle = _mm256_setr_epi8(0, 1, 4, 5, 8, 9, 12, 13, 2, 3, 6, 7, 10, 11, 14, 15,
+                                             0, 1, 4, 5, 8, 9, 12, 13, 2, 3, 6, 7, 10, 11, 14, 15);
+    size_t n = 0;
+    for (; n + 8 <= pairs; n += 8) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(iq + 2 * n));
+        v = _mm256_permute4x64_epi64(_mm256_shuffle_epi8(v, shuffle), 0xD8);
+        _mm_storeu_si128((__m128i*)(i_out + n), _mm256_castsi256_si128(v));
+        _mm_storeu_si128((__m128i*)(q_out + n), _mm256_extracti128_si256(v, 1));
+    }
+    deinterleave_scalar(iq + 2 * n, i_out + n, q_out + n, pairs - n);
+}
+
+#endif // __x86_64__
+
+
+// --- Public API Functions ---
+
+int sample_kernels_select(SampleKernels* kernels, SampleImpl impl) {
+    if (impl == SAMPLE_IMPL_AUTO) {
+#if defined(__x86_64__)
+        impl = __builtin_cpu_supports("avx2") ? SAMPLE_IMPL_AVX2 : SAMPLE_IMPL_SWAR;
+#else
+        impl = SAMPLE_IMPL_SWAR;
+#endif
+    }
+
+    switch (impl) {
+        case SAMPLE_IMPL_SCALAR:
+            *kernels = (SampleKernels){ impl, unpack12_scalar, unpack14_scalar, to_float_scalar, deinterleave_scalar };
+            return 0;
+        case SAMPLE_IMPL_SWAR:
+            // Float conversion has no useful SWAR form; it stays scalar.
+            *kernels = (SampleKernels){ impl, unpack12_swar, unpack14_swar, to_float_scalar, deinterleave_swar };
+            return 0;
+        case SAMPLE_IMPL_AVX2:
+#if defined(__x86_64__)
+            if (__builtin_cpu_supports("avx2")) {
+                *kernels = (SampleKernels){ impl, unpack12_avx2, unpack14_avx2, to_float_avx2, deinterleave_avx2 };
+                return 0;
+            }
+#endif
+            return -1;
+        default:
+            return -1;
+    }
+}
+
+const char* sample_impl_name(SampleImpl impl) {
+    switch (impl) {
+        case SAMPLE_IMPL_AUTO:   return "auto";
+        case SAMPLE_IMPL_SCALAR: return "scalar";
+        case SAMPLE_IMPL_SWAR:   return "swar";
+        case SAMPLE_IMPL_AVX2:   return "avx2";
+    }
+    return "unknown";
+}
+
+size_t sample_packed_bytes(unsigned bits, size_t samples) {
+    return (samples * bits + 7) / 8;
+}
+
+int sample_unpack(const SampleKernels* kernels, unsigned bits, const void* in, int16_t* out, size_t samples) {
+    if (bits == 12) {
+        kernels->unpack12(in, out, samples);
+    } else if (bits == 14) {
+        kernels->unpack14(in, out, samples);
+    } else {
+        printf("ERROR: Unsupported packed sample width %u.\n", bits);
+        return -1;
+    }
+    return 0;
+}
@@ -0,0 +1,67 @@
+// =================================================================================================
+// File: sample_unpack.h
+// Description: Conversion kernels for ADC pod data: packed 12/14-bit samples to int16, int16 to
+//              float, and I/Q deinterleaving.
+//
+// Packed samples form a little-endian bit stream: sample k occupies bits [k*B, k*B + B) of the
+// stream, counting from bit 0 of the first byte (the same layout whether the AXI stream carries it
+// in 32- or 64-bit words). Unpacked samples are two's complement and MSB-aligned, i.e. the ADC code
+// shifted left by 16 - B, so every ADC width shares int16 full scale.
+//
+// Each kernel has a portable scalar version, a SWAR version that works on 64-bit words (the U54
+// has no vector unit), and an AVX2 version for x86 hosts. The best available set is selected at
+// run time.
+// =================================================================================================
+
+#ifndef SAMPLE_UNPACK_H
+#define SAMPLE_UNPACK_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// --- Configuration ---
+
+typedef enum {
+    SAMPLE_IMPL_AUTO,   // Best implementation the CPU supports
+    SAMPLE_IMPL_SCALAR,
+    SAMPLE_IMPL_SWAR,
+    SAMPLE_IMPL_AVX2
+} SampleImpl;
+
+/**
+ * @brief One implementation of every conversion kernel.
+ */
+typedef struct {
+    SampleImpl impl;
+    void (*unpack12)(const uint8_t* in, int16_t* out, size_t samples);
+    void (*unpack14)(const uint8_t* in, int16_t* out, size_t samples);
+    void (*to_float)(const int16_t* in, float* out, size_t samples);       // Scaled to [-1, 1)
+    void (*deinterleave)(const int16_t* iq, int16_t* i, int16_t* q, size_t pairs);
+} SampleKernels;
+
+
+// --- Function Prototypes ---
+
+/**
+ * @brief Fills in the kernel table for `impl` (SAMPLE_IMPL_AUTO picks the fastest supported).
+ * @return 0 on success, -1 if the CPU or build does not support `impl`.
+ */
+int sample_kernels_select(SampleKernels* kernels, SampleImpl impl);
+
+/**
+ * @brief Returns a printable name for an implementation.
+ */
+const char* sample_impl_name(SampleImpl impl);
+
+/**
+ * @brief Number of bytes holding `samples` packed samples of `bits` bits each.
+ */
+size_t sample_packed_bytes(unsigned bits, size_t samples);
+
+/**
+ * @brief Unpacks `samples` packed samples of 12 or 14 bits into MSB-aligned int16.
+ * @return 0 on success, -1 for an unsupported sample width.
+ */
+int sample_unpack(const SampleKernels* kernels, unsigned bits, const void* in, int16_t* out, size_t samples);
+
+#endif // SAMPLE_UNPACK_H
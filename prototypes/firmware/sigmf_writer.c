@@ -0,0 +1,189 @@
+// =================================================================================================
+// File: sigmf_writer.c
+// Description: Implementation of the streaming SigMF writer.
+// =================================================================================================
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "sigmf_writer.h"
+
+// --- Internal Helpers ---
+
+static void write_json_string(FILE* fp, const char* str) {
+    fputc('"', fp);
+    for (const char* p = str; *p; ++p) {
+        switch (*p) {
+            case '"':  fputs("\\\"", fp); break;
+            case '\\': fputs("\\\\", fp); break;
+            case '\n': fputs("\\n", fp);  break;
+            case '\r': fputs("\\r", fp);  break;
+            case '\t': fputs("\\t", fp);  break;
+            default:
+                if ((unsigned char)*p < 0x20) fprintf(fp, "\\u%04x", *p);
+                else fputc(*p, fp);
+        }
+    }
+    fputc('"', fp);
+}
+
+// Formats the current UTC time as an ISO-8601 string with microseconds, as SigMF expects.
+static void format_datetime(char* buf, size_t len) {
+    struct timespec now;
+    struct tm utc;
+    clock_gettime(CLOCK_REALTIME, &now);
+    gmtime_r(&now.tv_sec, &utc);
+    size_t n = strftime(buf, len, "%Y-%m-%dT%H:%M:%S", &utc);
+    snprintf(buf + n, len - n, ".%06ldZ", now.tv_nsec / 1000);
+}
+
+
+// --- Public API ---
+
+void sigmf_config_default(SigmfConfig* config, double sample_rate, double center_frequency) {
+    config->datatype = "ri16_le";
+    config->sample_rate = sample_rate;
+    config->center_frequency = center_frequency;
+    config->description = NULL;
+    config->hw = "BeagleV-Fire + RadioHound FPGA stream capture";
+    config->annotate_slots = 1;
+    config->backend = RECORDER_BACKEND_IO_URING;
+}
+
+size_t sigmf_sample_bytes(const char* datatype) {
+    // Format is [c|r][f|i|u]<bits>[_le|_be], e.g. "ci16_le".
+    if (!datatype || (datatype[0] != 'c' && datatype[0] != 'r')) return 0;
+    if (datatype[1] != 'f' && datatype[1] != 'i' && datatype[1] != 'u') return 0;
+    long bits = strtol(datatype + 2, NULL, 10);
+    if (bits != 8 && bits != 16 && bits != 32 && bits != 64) return 0;
+    return (size_t)(bits / 8) * (datatype[0] == 'c' ? 2 : 1);
+}
+
+int sigmf_writer_open(SigmfWriter* writer, const char* base_path, const SigmfConfig* config) {
+    char data_path[SIGMF_PATH_LEN];
+    char datetime[40];
+    RecorderConfig rec_config;
+
+    memset(writer, 0, sizeof(*writer));
+    writer->sample_bytes = sigmf_sample_bytes(config->datatype);
+    writer->annotate_slots = config->annotate_slots;
+    if (writer->sample_bytes == 0) {
+        fprintf(stderr, "SigMF: unsupported datatype '%s'\n", config->datatype ? config->datatype : "(null)");
+        return -1;
+    }
+
+    if (snprintf(data_path, sizeof(data_path), "%s.sigmf-data", base_path) >= (int)sizeof(data_path) ||
+        snprintf(writer->meta_path, sizeof(writer->meta_path), "%s.sigmf-meta", base_path) >= (int)sizeof(writer->meta_path)) {
+        fprintf(stderr, "SigMF: path too long\n");
+        return -1;
+    }
+
+    recorder_config_default(&rec_config, config->backend);
+    if (recorder_open(&writer->data, data_path, &rec_config) != 0) return -1;
+
+    writer->meta = fopen(writer->meta_path, "w");
+    if (!writer->meta) {
+        perror("SigMF: failed to open metadata file");
+        recorder_close(&writer->data, NULL);
+        return -1;
+    }
+
+    format_datetime(datetime, sizeof(datetime));
+    FILE* fp = writer->meta;
+    fprintf(fp, "{\n  \"global\": {\n");
+    fprintf(fp, "    \"core:datatype\": ");
+    write_json_string(fp, config->datatype);
+    fprintf(fp, ",\n    \"core:sample_rate\": %.17g,\n", config->sample_rate);
+    fprintf(fp, "    \"core:version\": \"1.0.0\",\n");
+    fprintf(fp, "    \"core:recorder\": \"radiohound dma_test_app\"");
+    if (config->description) {
+        fprintf(fp, ",\n    \"core:description\": ");
+        write_json_string(fp, config->description);
+    }
+    if (config->hw) {
+        fprintf(fp, ",\n    \"core:hw\": ");
+        write_json_string(fp, config->hw);
+    }
+    fprintf(fp, "\n  },\n  \"captures\": [\n    {\n");
+    fprintf(fp, "      \"core:sample_start\": 0,\n");
+    fprintf(fp, "      \"core:frequency\": %.17g,\n", config->center_frequency);
+    fprintf(fp, "      \"core:datetime\": \"%s\"\n", datetime);
+    fprintf(fp, "    }\n  ],\n  \"annotations\": [");
+    fflush(fp);
+
+    return 0;
+}
+
+int sigmf_writer_write(SigmfWriter* writer, const void* data, size_t len) {
+    if (recorder_write(&writer->data, data, len) != 0) {
+        writer->error = 1;
+        return -1;
+    }
+    writer->samples_written += len / writer->sample_bytes;
+    return 0;
+}
+
+int sigmf_writer_write_slot(SigmfWriter* writer, const CaptureSlot* slot) {
+    uint64_t sample_start = writer->samples_written;
+    // Through the slot path so the recorder checks the completion CRC32C.
+    if (recorder_write_slot(&writer->data, slot) != 0) {
+        writer->error = 1;
+        return -1;
+    }
+    writer->samples_written += slot->length / writer->sample_bytes;
+
+    if (writer->annotate_slots) {
+        char comment[128];
+        int n = snprintf(comment, sizeof(comment), "stream packet %u, completed at %llu ns", slot->sequence,
+                         (unsigned long long)slot->timestamp_ns);
+        // Lets a reader check each segment of the data file against the CRC taken at completion.
+        if (slot->flags & CAPTURE_SLOT_CRC) {
+            snprintf(comment + n, sizeof(comment) - (size_t)n, ", crc32c 0x%08x", slot->crc32c);
+        }
+        return sigmf_writer_annotate(writer, sample_start, slot->length / writer->sample_bytes, "segment", comment);
+    }
+    return 0;
+}
+
+int sigmf_writer_annotate(SigmfWriter* writer, uint64_t sample_start, uint64_t sample_count,
+                          const char* label, const char* comment) {
+    FILE* fp = writer->meta;
+
+    fprintf(fp, "%s\n    {\n", writer->annotations == 0 ? "" : ",");
+    fprintf(fp, "      \"core:sample_start\": %llu,\n", (unsigned long long)sample_start);
+    fprintf(fp, "      \"core:sample_count\": %llu", (unsigned long long)sample_count);
+    if (label) {
+        fprintf(fp, ",\n      \"core:label\": ");
+        write_json_string(fp, label);
+    }
+    if (comment) {
+        fprintf(fp, ",\n      \"core:comment\": ");
+        write_json_string(fp, comment);
+    }
+    fprintf(fp, "\n    }");
+    writer->annotations++;
+
+    if (ferror(fp)) {
+        writer->error = 1;
+        return -1;
+    }
+    return 0;
+}
+
+uint64_t sigmf_writer_retired(const SigmfWriter* writer) {
+    return recorder_retired(&writer->data);
+}
+
+int sigmf_writer_close(SigmfWriter* writer, RecorderStats* stats) {
+    int rc = writer->error ? -1 : 0;
+
+    if (recorder_close(&writer->data, stats) != 0) rc = -1;
+
+    if (writer->meta) {
+        fprintf(writer->meta, "%s]\n}\n", writer->annotations == 0 ? "" : "\n  ");
+        if (fclose(writer->meta) != 0) rc = -1;
+        writer->meta = NULL;
+    }
+    return rc;
+}
@@ -0,0 +1,95 @@
+// =================================================================================================
+// File: sigmf_writer.h
+// Description: Streaming writer for SigMF recordings (.sigmf-data + .sigmf-meta).
+//
+// Sample data goes through the recorder straight from the DMA slots. The metadata file is written
+// as the recording progresses: the global and capture objects are emitted at open, annotations are
+// appended one by one, and the closing brackets are added at close. Nothing is held in memory or
+// rewritten, so a multi-GB recording costs the same few KB of state as a short one.
+// =================================================================================================
+
+#ifndef SIGMF_WRITER_H
+#define SIGMF_WRITER_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include "capture_session.h"
+#include "recorder.h"
+
+// --- Configuration ---
+
+#define SIGMF_PATH_LEN     256
+
+typedef struct {
+    const char* datatype;          // SigMF core:datatype, e.g. "ri16_le" or "ci16_le"
+    double      sample_rate;       // Samples per second
+    double      center_frequency;  // Hz, recorded in the capture segment
+    const char* description;       // Optional free text (may be NULL)
+    const char* hw;                // Optional hardware description (may be NULL)
+    int         annotate_slots;    // Append one annotation per written slot
+    RecorderBackend backend;       // Backend used for the data file
+} SigmfConfig;
+
+typedef struct {
+    Recorder  data;
+    FILE*     meta;
+    char      meta_path[SIGMF_PATH_LEN];
+    size_t    sample_bytes;        // Bytes per sample (both components for complex types)
+    uint64_t  samples_written;
+    uint64_t  annotations;
+    int       annotate_slots;
+    int       error;
+} SigmfWriter;
+
+
+// --- Function Prototypes ---
+
+/**
+ * @brief Fills in a configuration with RadioHound defaults (real int16, io_uring data path).
+ */
+void sigmf_config_default(SigmfConfig* config, double sample_rate, double center_frequency);
+
+/**
+ * @brief Returns the size of one sample in bytes for a SigMF datatype string, or 0 if unknown.
+ */
+size_t sigmf_sample_bytes(const char* datatype);
+
+/**
+ * @brief Creates <base>.sigmf-data and <base>.sigmf-meta and writes the global and capture metadata.
+ * The capture start time is taken from CLOCK_REALTIME at this call.
+ * @return 0 on success, -1 on failure.
+ */
+int sigmf_writer_open(SigmfWriter* writer, const char* base_path, const SigmfConfig* config);
+
+/**
+ * @brief Queues raw sample data. See recorder_write() for the alignment rules.
+ */
+int sigmf_writer_write(SigmfWriter* writer, const void* data, size_t len);
+
+/**
+ * @brief Queues a filled capture slot, appending a per-segment annotation if configured. The slot
+ *        is checked against its completion CRC32C (see recorder_write_slot()), and the annotation
+ *        records that CRC so the segment can be verified after transfer.
+ */
+int sigmf_writer_write_slot(SigmfWriter* writer, const CaptureSlot* slot);
+
+/**
+ * @brief Appends an annotation covering [sample_start, sample_start + sample_count).
+ * @param label Short core:label (may be NULL).
+ * @param comment Free-text core:comment (may be NULL).
+ */
+int sigmf_writer_annotate(SigmfWriter* writer, uint64_t sample_start, uint64_t sample_count,
+                          const char* label, const char* comment);
+
+/**
+ * @brief Number of data writes completed in submission order (see recorder_retired()).
+ */
+uint64_t sigmf_writer_retired(const SigmfWriter* writer);
+
+/**
+ * @brief Finishes the data file, closes the annotation list and the metadata object.
+ * @return 0 on success, -1 if anything failed.
+ */
+int sigmf_writer_close(SigmfWriter* writer, RecorderStats* stats);
+
+#endif // SIGMF_WRITER_H
@@ -7,18 +7,58 @@
 #define TEST_SUITE_H
 
 #include "hw_platform.h"
+#include "radiohound_dma_api.h"
 
 // --- Function Prototypes ---
 
 void run_axi_stream_source_test(
-    Dma_Regs_t* dma_regs,
+    RhDma* dma,
     AxiStreamSource_Regs_t* stream_src_regs,
-    int dma_uio_fd,
     uintptr_t dma_phys_base,
     uint8_t* dma_virt_base
 );
 
-void run_diagnostics(Dma_Regs_t* dma_regs, AxiStreamSource_Regs_t* stream_src_regs);
+void run_segmented_capture_test(
+    RhDma* dma,
+    AxiStreamSource_Regs_t* stream_src_regs,
+    uintptr_t dma_phys_base,
+    uint8_t* dma_virt_base,
+    size_t dma_buffer_size,
+    uint64_t capture_bytes
+);
+
+void run_capture_recording_test(
+    RhDma* dma,
+    AxiStreamSource_Regs_t* stream_src_regs,
+    uintptr_t dma_phys_base,
+    uint8_t* dma_virt_base,
+    size_t dma_buffer_size,
+    uint64_t capture_bytes,
+    const char* path
+);
+
+void run_triggered_capture_test(
+    RhDma* dma,
+    AxiStreamSource_Regs_t* stream_src_regs,
+    uintptr_t dma_phys_base,
+    uint8_t* dma_virt_base,
+    size_t dma_buffer_size,
+    uint64_t capture_bytes,
+    int16_t level,
+    const char* path
+);
+
+void run_capture_file_test(
+    RhDma* dma,
+    AxiStreamSource_Regs_t* stream_src_regs,
+    uintptr_t dma_phys_base,
+    uint8_t* dma_virt_base,
+    size_t dma_buffer_size,
+    uint64_t capture_bytes,
+    const char* path
+);
+
+void run_diagnostics(RhDma* dma, AxiStreamSource_Regs_t* stream_src_regs);
 
 void run_axi_lite_reg_test(AxiStreamSource_Regs_t* stream_src_regs);
 
@@ -0,0 +1,99 @@
+// =================================================================================================
+// File: time_model.c
+// Description: Implementation of the sample index to capture clock time model.
+// =================================================================================================
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "time_model.h"
+
+// --- Internal Helpers ---
+
+// Time offset from the origin predicted for a sample offset from the origin.
+static double predict(const TimeModel* m, double x) {
+    return m->mean_y + m->ns_per_sample * (x - m->mean_x);
+}
+
+
+// --- Public API Functions ---
+
+void time_model_config_default(TimeModelConfig* config, double nominal_rate_hz) {
+    config->nominal_rate_hz = nominal_rate_hz;
+    config->forget = 1.0;
+    config->reject_ns = 50000.0;
+}
+
+int time_model_init(TimeModel* model, const TimeModelConfig* config) {
+    memset(model, 0, sizeof(*model));
+    if (!(config->nominal_rate_hz > 0.0)) {
+        printf("ERROR: Time model needs a positive nominal sample rate\n");
+        return -1;
+    }
+    if (!(config->forget > 0.0 && config->forget <= 1.0)) {
+        printf("ERROR: Time model forgetting factor must be in (0, 1]\n");
+        return -1;
+    }
+    if (config->reject_ns < 0.0) {
+        printf("ERROR: Time model rejection threshold must not be negative\n");
+        return -1;
+    }
+    model->config = *config;
+    model->ns_per_sample = 1e9 / config->nominal_rate_hz;
+    return 0;
+}
+
+int time_model_add_point(TimeModel* model, uint64_t sample, uint64_t time_ns) {
+    if (model->points == 0) {
+        model->origin_sample = sample;
+        model->origin_ns = time_ns;
+        model->weight = 1.0;
+        model->points = 1;
+        return 1;
+    }
+
+    // Signed offsets from the origin stay exact in a double for any realistic capture.
+    const double x = (double)(int64_t)(sample - model->origin_sample);
+    const double y = (double)(int64_t)(time_ns - model->origin_ns);
+    const double residual = y - predict(model, x);
+    if (model->config.reject_ns > 0.0 && model->points >= TIME_MODEL_WARMUP_POINTS &&
+        residual > model->config.reject_ns && model->late_run < TIME_MODEL_MAX_LATE_RUN) {
+        model->rejected++;
+        model->late_run++;
+        return 0;
+    }
+    model->late_run = 0;
+    model->residual_sq += residual * residual;
+
+    // Weighted running means and co-moments (West's update), decayed by the forgetting factor.
+    const double lambda = model->config.forget;
+    model->weight = lambda * model->weight + 1.0;
+    const double dx = x - model->mean_x;
+    const double dy = y - model->mean_y;
+    model->mean_x += dx / model->weight;
+    model->mean_y += dy / model->weight;
+    model->cxx = lambda * model->cxx + dx * (x - model->mean_x);
+    model->cxy = lambda * model->cxy + dx * (y - model->mean_y);
+    if (model->cxx > 0.0) model->ns_per_sample = model->cxy / model->cxx;
+    model->points++;
+    return 1;
+}
+
+int time_model_add_slot(TimeModel* model, const CaptureSlot* slot) {
+    const uint64_t last = (slot->stream_offset + slot->length) / TIME_MODEL_BYTES_PER_SAMPLE - 1;
+    return time_model_add_point(model, last, slot->timestamp_ns);
+}
+
+uint64_t time_model_sample_time_ns(const TimeModel* model, uint64_t sample) {
+    if (model->points == 0) return 0;
+    const double x = (double)(int64_t)(sample - model->origin_sample);
+    return model->origin_ns + (uint64_t)llround(predict(model, x));
+}
+
+double time_model_rate_hz(const TimeModel* model) {
+    return 1e9 / model->ns_per_sample;
+}
+
+double time_model_residual_rms_ns(const TimeModel* model) {
+    return model->points > 1 ? sqrt(model->residual_sq / (double)(model->points - 1)) : 0.0;
+}
@@ -0,0 +1,94 @@
+// =================================================================================================
+// File: time_model.h
+// Description: Linear model mapping stream sample indices to capture clock time, fitted from the
+//              per-slot completion timestamps.
+//
+// Every slot carries the capture_clock_ns() reading taken when its completion was seen, which
+// belongs to the slot's last sample. Each stamp is late by the interrupt and scheduling latency,
+// and the latency varies, so a single stamp is only good to a few microseconds. A straight-line
+// fit through many (end sample, stamp) pairs averages that jitter away and also measures the true
+// sample rate, so any sample's time comes from one multiply-add with no per-sample cost. Stamps
+// far later than the fit (the consumer fell behind and picked the completion up late) are left
+// out; a forgetting factor below 1 lets the fit follow slow drift between the sample clock and
+// the capture clock over long captures.
+//
+// The model assumes the samples are clocked continuously. With the test pattern source, which
+// idles between packets, the gaps show up as residuals and the fitted rate is the average rate.
+// =================================================================================================
+
+#ifndef TIME_MODEL_H
+#define TIME_MODEL_H
+
+#include <stdint.h>
+#include "capture_session.h"
+
+// --- Configuration ---
+
+#define TIME_MODEL_BYTES_PER_SAMPLE 4 // Complex int16 (I low, Q high)
+#define TIME_MODEL_WARMUP_POINTS    4 // Stamps accepted before late ones are rejected
+#define TIME_MODEL_MAX_LATE_RUN     8 // Consecutive late stamps after which the next is used anyway
+
+typedef struct {
+    double nominal_rate_hz; // Used until two stamps are in
+    double forget;          // Weight kept by older stamps for every new one (1 = plain least squares)
+    double reject_ns;       // Stamps later than the fit by more than this are ignored (0 = keep all)
+} TimeModelConfig;
+
+typedef struct {
+    TimeModelConfig config;
+    uint64_t        origin_sample;  // First stamp; coordinates are kept relative to it
+    uint64_t        origin_ns;
+    double          weight;         // Sum of the (decayed) weights
+    double          mean_x;         // Weighted means of sample offset and time offset
+    double          mean_y;
+    double          cxx;            // Weighted co-moments about the means
+    double          cxy;
+    double          ns_per_sample;  // Current slope
+    uint64_t        points;         // Stamps used
+    uint64_t        rejected;       // Stamps left out as late
+    unsigned        late_run;       // Consecutive rejections
+    double          residual_sq;    // Sum of squared residuals of used stamps against the prior fit
+} TimeModel;
+
+
+// --- Function Prototypes ---
+
+/**
+ * @brief Fills in a configuration: plain least squares, stamps more than 50 us late rejected.
+ */
+void time_model_config_default(TimeModelConfig* config, double nominal_rate_hz);
+
+/**
+ * @brief Validates the configuration and clears the model.
+ * @return 0 on success, -1 on an invalid configuration.
+ */
+int time_model_init(TimeModel* model, const TimeModelConfig* config);
+
+/**
+ * @brief Adds one (sample index, capture clock time) pair.
+ * @return 1 if the stamp was used, 0 if it was rejected as late.
+ */
+int time_model_add_point(TimeModel* model, uint64_t sample, uint64_t time_ns);
+
+/**
+ * @brief Adds a filled slot's completion timestamp, which belongs to its last sample.
+ */
+int time_model_add_slot(TimeModel* model, const CaptureSlot* slot);
+
+/**
+ * @brief Capture clock time of a stream sample index under the current fit, in nanoseconds.
+ * Returns 0 until the first stamp has been added.
+ */
+uint64_t time_model_sample_time_ns(const TimeModel* model, uint64_t sample);
+
+/**
+ * @brief Sample rate measured against the capture clock.
+ */
+double time_model_rate_hz(const TimeModel* model);
+
+/**
+ * @brief RMS distance of the used stamps from the fit before each was added, in nanoseconds.
+ */
+double time_model_residual_rms_ns(const TimeModel* model);
+
+#endif // TIME_MODEL_H
@@ -0,0 +1,311 @@
+// =================================================================================================
+// File: trigger.c
+// Description: Implementation of the pre-trigger history and snippet extraction stage.
+// =================================================================================================
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "trigger.h"
+
+#define NO_TRIGGER      UINT64_MAX
+#define LEVEL_BLOCK     64 // Samples tested together before locating the exact one
+
+// --- Internal Helpers ---
+
+static double seconds_between(const struct timespec* start, const struct timespec* end) {
+    return (double)(end->tv_sec - start->tv_sec) + (double)(end->tv_nsec - start->tv_nsec) / 1e9;
+}
+
+static uint64_t slot_first(const CaptureSlot* slot) {
+    return slot->stream_offset / TRIGGER_BYTES_PER_SAMPLE;
+}
+
+static uint64_t slot_end(const CaptureSlot* slot) {
+    return (slot->stream_offset + slot->length) / TRIGGER_BYTES_PER_SAMPLE;
+}
+
+static const CaptureSlot* held_at(const TriggerStage* s, unsigned i) {
+    return &s->held[(s->held_head + i) % TRIGGER_MAX_HELD_SLOTS];
+}
+
+static void release_oldest(TriggerStage* s) {
+    const CaptureSlot slot = s->held[s->held_head];
+    s->held_head = (s->held_head + 1) % TRIGGER_MAX_HELD_SLOTS;
+    s->held_count--;
+    if (s->on_release) s->on_release(&slot, s->user);
+}
+
+static void reset_energy(TriggerStage* s) {
+    s->energy_sum = 0.0;
+    s->energy_count = 0;
+}
+
+// First sample in [from, to) where |I| or |Q| reaches the level. Whole blocks are tested with a
+// fixed-length branch-free loop, which the compiler vectorizes, before locating the exact sample.
+static uint64_t scan_level(const int16_t* iq, uint64_t first, uint64_t from, uint64_t to, int16_t level) {
+    const int16_t neg = (int16_t)-level;
+    uint64_t pos = from;
+    for (; pos + LEVEL_BLOCK <= to; pos += LEVEL_BLOCK) {
+        const int16_t* p = iq + 2 * (pos - first);
+        int hit = 0;
+        for (unsigned k = 0; k < 2 * LEVEL_BLOCK; ++k) hit |= (p[k] >= level) | (p[k] <= neg);
+        if (hit) break;
+    }
+    for (; pos < to; ++pos) {
+        const int16_t* p = iq + 2 * (pos - first);
+        if (p[0] >= level || p[0] <= neg || p[1] >= level || p[1] <= neg) return pos;
+    }
+    return NO_TRIGGER;
+}
+
+// Accumulates consecutive energy windows from `from` on, carrying a partial window across slots.
+// Returns the first sample of the first window over the threshold.
+static uint64_t scan_energy(TriggerStage* s, const int16_t* iq, uint64_t first, uint64_t from, uint64_t to) {
+    const unsigned window = s->config.energy_window;
+    uint64_t pos = from;
+    while (pos < to) {
+        if (s->energy_count == 0) s->energy_start = pos;
+        const uint64_t remaining = to - pos;
+        const unsigned n = remaining < window - s->energy_count ? (unsigned)remaining : window - s->energy_count;
+        const int16_t* p = iq + 2 * (pos - first);
+        int64_t sum = 0;
+        for (unsigned k = 0; k < 2 * n; ++k) sum += (int32_t)p[k] * p[k];
+        s->energy_sum += (double)sum;
+        s->energy_count += n;
+        pos += n;
+        if (s->energy_count == window) {
+            const int fired = s->energy_sum >= s->energy_threshold;
+            const uint64_t start = s->energy_start;
+            reset_energy(s);
+            if (fired) return start;
+        }
+    }
+    return NO_TRIGGER;
+}
+
+// An external trigger is served as long as its sample is still held and after the last snippet,
+// so one reported after its slot was pushed (the usual case for a GPIO timestamp) is not lost.
+static uint64_t external_floor(const TriggerStage* s) {
+    const uint64_t oldest = slot_first(held_at(s, 0));
+    return s->snippet_end > oldest ? s->snippet_end : oldest;
+}
+
+// Earliest trigger before `to`: the detector's in [from, to) of the newest slot, or a queued
+// external one anywhere in the held history.
+static uint64_t find_trigger(TriggerStage* s, const CaptureSlot* slot, uint64_t from, uint64_t to) {
+    const uint64_t floor = external_floor(s);
+    while (s->external_count > 0 && s->external[0] < floor) {
+        memmove(s->external, s->external + 1, (s->external_count - 1) * sizeof(s->external[0]));
+        s->external_count--;
+        s->stats.external_dropped++;
+    }
+    const uint64_t external = s->external_count > 0 && s->external[0] < to ? s->external[0] : NO_TRIGGER;
+    if (external != NO_TRIGGER) to = external; // The detector only has to beat it
+
+    const int16_t* iq = (const int16_t*)slot->data;
+    uint64_t found = NO_TRIGGER;
+    if (s->config.mode == TRIGGER_LEVEL) {
+        found = scan_level(iq, slot_first(slot), from, to, s->config.level);
+    } else if (s->config.mode == TRIGGER_ENERGY) {
+        found = scan_energy(s, iq, slot_first(slot), from, to);
+    }
+    if (found != NO_TRIGGER) return found;
+    if (external != NO_TRIGGER) {
+        memmove(s->external, s->external + 1, (s->external_count - 1) * sizeof(s->external[0]));
+        s->external_count--;
+    }
+    return external;
+}
+
+// Hands [from, to) of the held slots to the sink.
+static void emit_range(TriggerStage* s, uint64_t from, uint64_t to, int last) {
+    TriggerChunk chunk = {
+        .snippet = s->stats.snippets - 1,
+        .trigger_sample = s->trigger_sample,
+    };
+    int emitted = 0;
+    for (unsigned i = 0; i < s->held_count; ++i) {
+        const CaptureSlot* slot = held_at(s, i);
+        const uint64_t first = slot_first(slot);
+        const uint64_t a = from > first ? from : first;
+        const uint64_t b = to < slot_end(slot) ? to : slot_end(slot);
+        if (a >= b) continue;
+        chunk.first_sample = a;
+        chunk.data = (const uint8_t*)slot->data + (a - first) * TRIGGER_BYTES_PER_SAMPLE;
+        chunk.bytes = (size_t)(b - a) * TRIGGER_BYTES_PER_SAMPLE;
+        chunk.first = s->first_pending;
+        chunk.last = last && b == to;
+        s->first_pending = 0;
+        s->stats.bytes_out += chunk.bytes;
+        s->on_chunk(&chunk, s->user);
+        emitted = 1;
+    }
+    if (last && !emitted) {
+        // Capture ended before the next sample arrived
+        chunk.first_sample = to;
+        chunk.data = NULL;
+        chunk.bytes = 0;
+        chunk.first = s->first_pending;
+        chunk.last = 1;
+        s->first_pending = 0;
+        s->on_chunk(&chunk, s->user);
+    }
+    s->emit_pos = to;
+}
+
+static void record_latency(double value, double* mean, double* max, uint64_t count) {
+    *mean += (value - *mean) / (double)count;
+    if (value > *max) *max = value;
+}
+
+static void finish_snippet(TriggerStage* s, const struct timespec* arrival) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    const uint64_t n = s->stats.snippets;
+    record_latency(seconds_between(arrival, &now), &s->stats.save_latency_mean, &s->stats.save_latency_max, n);
+    record_latency(seconds_between(&s->trigger_arrival, &now), &s->stats.trigger_latency_mean,
+                   &s->stats.trigger_latency_max, n);
+    s->active = 0;
+    if (s->scan_from < s->snippet_end) s->scan_from = s->snippet_end; // A late external trigger may end behind it
+    reset_energy(s);
+}
+
+static void start_snippet(TriggerStage* s, uint64_t trigger, const struct timespec* arrival) {
+    const uint64_t wanted = trigger > s->config.pre_samples ? trigger - s->config.pre_samples : 0;
+    const uint64_t oldest = slot_first(held_at(s, 0));
+    s->stats.snippets++;
+    if (wanted < oldest) s->stats.truncated++;
+    s->trigger_sample = trigger;
+    s->emit_pos = wanted > oldest ? wanted : oldest;
+    s->snippet_end = trigger + s->config.post_samples;
+    s->first_pending = 1;
+    s->trigger_arrival = *arrival;
+    s->active = 1;
+}
+
+
+// --- Public API Functions ---
+
+void trigger_config_default(TriggerConfig* config, TriggerMode mode, uint64_t pre_samples, uint64_t post_samples) {
+    config->mode = mode;
+    config->level = 16384;
+    config->energy_db = -20.0;
+    config->energy_window = 256;
+    config->pre_samples = pre_samples;
+    config->post_samples = post_samples;
+    config->max_held_slots = 4;
+}
+
+int trigger_init(TriggerStage* stage, const TriggerConfig* config, TriggerChunkCallback on_chunk,
+                 TriggerReleaseCallback on_release, void* user) {
+    memset(stage, 0, sizeof(*stage));
+    if (config->mode != TRIGGER_LEVEL && config->mode != TRIGGER_ENERGY && config->mode != TRIGGER_EXTERNAL) {
+        printf("ERROR: Unknown trigger mode %d\n", (int)config->mode);
+        return -1;
+    }
+    if (config->mode == TRIGGER_LEVEL && config->level <= 0) {
+        printf("ERROR: Trigger level must be positive\n");
+        return -1;
+    }
+    if (config->mode == TRIGGER_ENERGY && (config->energy_window == 0 || config->energy_window > (1U << 20))) {
+        printf("ERROR: Energy window must be 1..%u samples\n", 1U << 20);
+        return -1;
+    }
+    if (config->post_samples == 0) {
+        printf("ERROR: Snippets need at least one post-trigger sample\n");
+        return -1;
+    }
+    if (config->max_held_slots == 0 || config->max_held_slots > TRIGGER_MAX_HELD_SLOTS) {
+        printf("ERROR: Held slots must be 1..%d\n", TRIGGER_MAX_HELD_SLOTS);
+        return -1;
+    }
+    if (!on_chunk) {
+        printf("ERROR: Trigger stage needs a chunk callback\n");
+        return -1;
+    }
+
+    stage->config = *config;
+    // 0 dBFS is a full-scale complex tone, |x|^2 = 32768^2 per sample
+    stage->energy_threshold = pow(10.0, config->energy_db / 10.0) * 32768.0 * 32768.0 * config->energy_window;
+    stage->on_chunk = on_chunk;
+    stage->on_release = on_release;
+    stage->user = user;
+    return 0;
+}
+
+int trigger_fire(TriggerStage* stage, uint64_t sample) {
+    if (stage->external_count == TRIGGER_MAX_EXTERNAL) return -1;
+    unsigned i = stage->external_count;
+    while (i > 0 && stage->external[i - 1] > sample) {
+        stage->external[i] = stage->external[i - 1];
+        --i;
+    }
+    stage->external[i] = sample;
+    stage->external_count++;
+    return 0;
+}
+
+void trigger_push_slot(TriggerStage* stage, const CaptureSlot* slot) {
+    struct timespec arrival;
+    clock_gettime(CLOCK_MONOTONIC, &arrival);
+
+    if (stage->held_count == stage->config.max_held_slots) {
+        release_oldest(stage);
+        stage->stats.forced_releases++;
+    }
+    stage->held[(stage->held_head + stage->held_count) % TRIGGER_MAX_HELD_SLOTS] = *slot;
+    stage->held_count++;
+    stage->stats.slots++;
+    stage->stats.bytes_in += slot->length;
+
+    const uint64_t first = slot_first(slot);
+    const uint64_t end = slot_end(slot);
+    for (;;) {
+        if (stage->active) {
+            const uint64_t to = stage->snippet_end < end ? stage->snippet_end : end;
+            const int last = to == stage->snippet_end;
+            emit_range(stage, stage->emit_pos, to, last);
+            if (!last) break;
+            finish_snippet(stage, &arrival);
+        }
+        const uint64_t from = stage->scan_from > first ? stage->scan_from : first;
+        if (from >= end) break;
+        const uint64_t trigger = find_trigger(stage, slot, from, end);
+        if (trigger == NO_TRIGGER) {
+            stage->scan_from = end;
+            break;
+        }
+        start_snippet(stage, trigger, &arrival);
+    }
+
+    // Keep the pre-trigger history for a trigger in the next slot, and anything not yet delivered
+    uint64_t needed = end > stage->config.pre_samples ? end - stage->config.pre_samples : 0;
+    if (stage->active && stage->emit_pos < needed) needed = stage->emit_pos;
+    while (stage->held_count > 0 && slot_end(held_at(stage, 0)) <= needed) release_oldest(stage);
+}
+
+void trigger_flush(TriggerStage* stage) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    uint64_t end = stage->emit_pos;
+    if (stage->held_count > 0) {
+        const CaptureSlot* newest = held_at(stage, stage->held_count - 1);
+        end = slot_end(newest);
+        // An external trigger reported after the last slot was pushed
+        if (!stage->active) {
+            const uint64_t trigger = find_trigger(stage, newest, end, end);
+            if (trigger != NO_TRIGGER) start_snippet(stage, trigger, &now);
+        }
+    }
+    if (stage->active) {
+        emit_range(stage, stage->emit_pos, stage->snippet_end < end ? stage->snippet_end : end, 1);
+        finish_snippet(stage, &now);
+    }
+    while (stage->held_count > 0) release_oldest(stage);
+}
+
+void trigger_get_stats(const TriggerStage* stage, TriggerStats* stats) {
+    *stats = stage->stats;
+    stats->discarded = stats->bytes_in ? 1.0 - (double)stats->bytes_out / (double)stats->bytes_in : 0.0;
+}
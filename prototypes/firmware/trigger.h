@@ -0,0 +1,145 @@
+// =================================================================================================
+// File: trigger.h
+// Description: Triggered capture on top of the DMA slot ring: keeps a pre-trigger history, watches
+//              every slot for a level, energy or external trigger, and passes only the samples
+//              around each trigger on to the sinks.
+//
+// The history costs no copies: the stage holds on to the most recent slots instead of releasing
+// them, and hands each slot back through a release callback (in order) once it can no longer be
+// part of a snippet. A snippet is the `pre_samples` before the trigger and the `post_samples` from
+// it on; it is delivered as chunks pointing straight into the slots, possibly spanning several of
+// them, so a sink sees the pre-trigger part as soon as the trigger is found and the rest as it
+// arrives. Triggers during a snippet are ignored; the next one is searched for after it ends.
+//
+// Holding slots takes them away from the DMA, so `max_held_slots` must leave enough of the ring
+// free for the source to keep streaming (see capture_session.h); if the history would need more,
+// the oldest slot is released anyway and snippets that reach back into it start late.
+// =================================================================================================
+
+#ifndef TRIGGER_H
+#define TRIGGER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+#include "capture_session.h"
+
+// --- Configuration ---
+
+#define TRIGGER_MAX_HELD_SLOTS  64
+#define TRIGGER_MAX_EXTERNAL    16  // Pending external triggers
+#define TRIGGER_BYTES_PER_SAMPLE 4  // Complex int16 (I low, Q high)
+
+typedef enum {
+    TRIGGER_LEVEL,    // |I| or |Q| reaches `level`
+    TRIGGER_ENERGY,   // Mean power over an `energy_window` reaches `energy_db`
+    TRIGGER_EXTERNAL  // Only trigger_fire(); also honoured in the other modes
+} TriggerMode;
+
+typedef struct {
+    TriggerMode mode;
+    int16_t     level;          // TRIGGER_LEVEL threshold, int16 counts
+    double      energy_db;      // TRIGGER_ENERGY threshold, dB relative to full scale
+    unsigned    energy_window;  // Samples per energy measurement
+    uint64_t    pre_samples;    // History kept before the trigger
+    uint64_t    post_samples;   // Samples kept from the trigger on
+    unsigned    max_held_slots; // Upper bound on slots held back from the ring
+} TriggerConfig;
+
+/**
+ * @brief A piece of a snippet. `data` points into a held slot and is valid only during the callback.
+ */
+typedef struct {
+    uint64_t    snippet;        // Snippet sequence number
+    uint64_t    trigger_sample; // Stream sample index of the trigger
+    uint64_t    first_sample;   // Stream sample index of data[0]
+    const void* data;
+    size_t      bytes;
+    int         first;          // First chunk of the snippet
+    int         last;           // Last chunk of the snippet (may be empty at the end of a capture)
+} TriggerChunk;
+
+typedef void (*TriggerChunkCallback)(const TriggerChunk* chunk, void* user);
+typedef void (*TriggerReleaseCallback)(const CaptureSlot* slot, void* user);
+
+typedef struct {
+    uint64_t slots;
+    uint64_t bytes_in;
+    uint64_t bytes_out;          // Snippet bytes handed to the sink
+    uint64_t snippets;
+    uint64_t truncated;          // Snippets whose history had already been released
+    uint64_t external_dropped;   // External triggers inside a snippet or older than the held history
+    uint64_t forced_releases;    // Slots released early because max_held_slots was reached
+    double   save_latency_mean;  // Slot holding a snippet's end handed in -> snippet delivered, s
+    double   save_latency_max;
+    double   trigger_latency_mean; // Slot holding the trigger handed in -> snippet delivered, s
+    double   trigger_latency_max;
+    double   discarded;          // Fraction of the input not passed on (filled in by trigger_get_stats)
+} TriggerStats;
+
+typedef struct {
+    TriggerConfig          config;
+    double                 energy_threshold; // Sum of I^2 + Q^2 over a window
+    CaptureSlot            held[TRIGGER_MAX_HELD_SLOTS];
+    unsigned               held_head;        // Oldest held slot
+    unsigned               held_count;
+    uint64_t               scan_from;        // First sample that may trigger
+    double                 energy_sum;       // Partial energy window carried across slots
+    unsigned               energy_count;
+    uint64_t               energy_start;
+    uint64_t               external[TRIGGER_MAX_EXTERNAL];
+    unsigned               external_count;
+    int                    active;           // A snippet is being delivered
+    uint64_t               trigger_sample;
+    uint64_t               emit_pos;         // Next snippet sample to deliver
+    uint64_t               snippet_end;
+    int                    first_pending;    // The next chunk is the snippet's first
+    struct timespec        trigger_arrival;
+    TriggerStats           stats;
+    TriggerChunkCallback   on_chunk;
+    TriggerReleaseCallback on_release;
+    void*                  user;
+} TriggerStage;
+
+
+// --- Function Prototypes ---
+
+/**
+ * @brief Fills in a configuration: level trigger at half scale, -20 dBFS energy over 256 samples,
+ *        `pre_samples` and `post_samples` as given, and at most 4 held slots.
+ */
+void trigger_config_default(TriggerConfig* config, TriggerMode mode, uint64_t pre_samples, uint64_t post_samples);
+
+/**
+ * @brief Validates the configuration and sets up an idle stage.
+ * @return 0 on success, -1 on an invalid configuration.
+ */
+int trigger_init(TriggerStage* stage, const TriggerConfig* config, TriggerChunkCallback on_chunk,
+                 TriggerReleaseCallback on_release, void* user);
+
+/**
+ * @brief Queues an external trigger at a stream sample index (e.g. from a GPIO timestamp). It
+ *        may be fired after the slot holding that sample was pushed, as long as the slot is still
+ *        held; it is acted on at the next trigger_push_slot() or trigger_flush().
+ * @return 0 on success, -1 if the queue is full.
+ */
+int trigger_fire(TriggerStage* stage, uint64_t sample);
+
+/**
+ * @brief Takes ownership of a filled slot: evaluates the trigger, delivers any snippet data it
+ *        completes, and releases slots that are no longer needed.
+ */
+void trigger_push_slot(TriggerStage* stage, const CaptureSlot* slot);
+
+/**
+ * @brief Ends the capture: closes a snippet in progress with the data available and releases
+ *        every held slot.
+ */
+void trigger_flush(TriggerStage* stage);
+
+/**
+ * @brief Returns the counters and latency figures so far.
+ */
+void trigger_get_stats(const TriggerStage* stage, TriggerStats* stats);
+
+#endif // TRIGGER_H
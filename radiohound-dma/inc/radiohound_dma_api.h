@@ -0,0 +1,188 @@
+// =================================================================================================
+// File: radiohound_dma_api.h
+// Description: Asynchronous submit/complete interface to the CoreAXI4DMAController, shared by the
+//              mem-mem and mem-stream test programs and the capture firmware.
+//
+// Transfers are submitted in batches and rh_dma_submit() returns as soon as they are queued: the
+// library hands each one to the controller the moment a channel is free (an internal descriptor
+// for memory-to-memory copies, the TDEST's stream descriptor for stream-to-memory packets), so a
+// whole batch starts with one START_OPERATION_REG write. Finished transfers are collected from a
+// completion queue with rh_dma_reap(), which drains the controller's interrupt queue and waits on
+// the UIO device only when nothing has finished yet. Each completion carries the submitter's
+// `user_data` back.
+//
+// Everything lives in the RhDma structure: the submission and completion queues are fixed arrays
+// of RH_DMA_QUEUE_DEPTH entries, so neither call allocates. At most RH_DMA_QUEUE_DEPTH transfers
+// may be outstanding (submitted and not yet reaped); rh_dma_submit() accepts fewer than asked once
+// the queue is full, which is the caller's cue to reap.
+//
+// Memory-to-memory transfers run on independent descriptors and the controller arbitrates between
+// them, so they may complete out of order. Stream transfers on one TDEST complete in submission
+// order. The software backend performs transfers with memcpy() inside a window of ordinary memory
+// (stream packets get the stream source's counting pattern), for running and benchmarking the
+// callers without the FPGA.
+// =================================================================================================
+
+#ifndef RADIOHOUND_DMA_API_H
+#define RADIOHOUND_DMA_API_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "radiohound_dma_regs.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// --- Configuration ---
+
+#define RH_DMA_QUEUE_DEPTH          64 // Outstanding transfers; a power of two
+#define RH_DMA_DEFAULT_DESCRIPTORS  4  // Internal descriptors in the Libero design
+#define RH_DMA_DEFAULT_UIO_NAME     "dma-controller@60010000"
+#define RH_DMA_STREAM_DESC_STRIDE   64 // Bytes between stream descriptors (keeps each bus-aligned)
+
+typedef enum {
+    RH_DMA_BACKEND_UIO,      // The controller, through its UIO device
+    RH_DMA_BACKEND_SOFTWARE  // memcpy() in a memory window; no hardware needed
+} RhDmaBackend;
+
+typedef enum {
+    RH_DMA_MEM_TO_MEM,
+    RH_DMA_STREAM_TO_MEM
+} RhDmaKind;
+
+typedef struct {
+    RhDmaBackend backend;
+    const char*  uio_name;      // UIO: device tree name looked up in /sys/class/uio...
+    const char*  uio_path;      // ...or an explicit /dev/uioN, used when set
+    unsigned     descriptors;   // UIO: internal descriptors used for memory-to-memory transfers
+    uint64_t     desc_phys;     // UIO: RH_DMA_STREAMS stream descriptors are written here...
+    void*        desc_virt;     // ...through this (non-cached) mapping; unused without streams
+    uint64_t     mem_phys;      // Software: physical window that transfer addresses refer to...
+    uint8_t*     mem_virt;      // ...and where it lives in this process
+    size_t       mem_bytes;
+} RhDmaConfig;
+
+typedef struct {
+    RhDmaKind kind;
+    uint32_t  stream;           // STREAM_TO_MEM: TDEST the packet arrives on
+    uint64_t  src_phys;         // MEM_TO_MEM only
+    uint64_t  dst_phys;
+    uint32_t  bytes;
+    uint64_t  user_data;        // Returned untouched in the completion
+} RhDmaTransfer;
+
+#define RH_DMA_STATUS_OK       0
+#define RH_DMA_STATUS_ERROR   -1 // AXI read/write error or invalid descriptor
+#define RH_DMA_STATUS_TIMEOUT -2 // Deadline passed first; only reported by radiohound_dma_async.hpp
+
+typedef struct {
+    uint64_t  user_data;
+    uint32_t  bytes;
+    int32_t   status;           // RH_DMA_STATUS_*
+    uint32_t  irq_status;       // UIO: the INTR_0_STAT_REG event that finished the transfer
+    RhDmaKind kind;             // Copied from the transfer, so a reaper can route stream packets...
+    uint32_t  stream;           // ...by TDEST without knowing their user_data
+} RhDmaCompletion;
+
+typedef struct {
+    uint64_t submitted;
+    uint64_t completed;
+    uint64_t errors;
+    uint64_t batches;           // rh_dma_submit() calls that accepted at least one transfer
+    uint64_t starts;            // START_OPERATION_REG writes
+    uint64_t waits;             // Times rh_dma_reap() slept on the UIO device
+    uint64_t events;            // Interrupt queue entries drained
+    uint64_t stray_events;      // Entries that matched no transfer in flight
+} RhDmaStats;
+
+typedef struct {
+    RhDmaTransfer xfer[RH_DMA_QUEUE_DEPTH];
+    uint32_t      head;
+    uint32_t      tail;
+} RhDmaQueue;
+
+typedef struct {
+    RhDmaConfig                   config;
+    int                           uio_fd;
+    CoreAXI4DMAController_Regs_t* regs;
+
+    RhDmaQueue                    mem_pending;                 // Waiting for a free descriptor
+    RhDmaQueue                    stream_pending[RH_DMA_STREAMS]; // Waiting for the TDEST's descriptor
+    RhDmaTransfer                 mem_active[RH_DMA_MAX_DESCRIPTORS];
+    uint32_t                      mem_busy;                    // Bit n: descriptor n is in flight
+    RhDmaTransfer                 stream_active[RH_DMA_STREAMS];
+    uint32_t                      stream_busy;                 // Bit n: TDEST n is in flight
+
+    RhDmaCompletion               cq[RH_DMA_QUEUE_DEPTH];
+    uint32_t                      cq_head;
+    uint32_t                      cq_tail;
+    uint32_t                      outstanding;                 // Submitted and not yet reaped
+    RhDmaStats                    stats;
+} RhDma;
+
+
+// --- Function Prototypes ---
+
+/**
+ * @brief Fills in a configuration for the UIO backend: the device tree name of the Libero design
+ *        and its four internal descriptors. Stream users must still set desc_phys/desc_virt.
+ */
+void rh_dma_config_default(RhDmaConfig* config);
+
+/**
+ * @brief Opens the backend, maps the controller and leaves it idle with completion interrupts
+ *        unmasked and the interrupt queue empty.
+ * @return 0 on success, -1 on failure.
+ */
+int rh_dma_open(RhDma* dma, const RhDmaConfig* config);
+
+/**
+ * @brief Queues a batch of transfers and starts as many as the controller has room for.
+ *        Returns without waiting for any of them.
+ * @return Number of transfers accepted (fewer than `count` once RH_DMA_QUEUE_DEPTH are
+ *         outstanding), or -1 if any transfer in the batch is invalid, in which case none are queued.
+ */
+int rh_dma_submit(RhDma* dma, const RhDmaTransfer* xfers, unsigned count);
+
+/**
+ * @brief Collects finished transfers, waiting for the first one if none has finished yet.
+ * @param timeout_ms -1 waits as long as transfers are in flight, 0 only polls.
+ * @return Number of completions written to `out` (0 on timeout or with nothing in flight), -1 on error.
+ */
+int rh_dma_reap(RhDma* dma, RhDmaCompletion* out, unsigned max, int timeout_ms);
+
+/**
+ * @brief Number of transfers submitted and not yet reaped.
+ */
+unsigned rh_dma_outstanding(const RhDma* dma);
+
+/**
+ * @brief The UIO file descriptor, which becomes readable when the controller interrupts
+ *        (-1 for the software backend). Poll it, then call rh_dma_reap() with timeout 0.
+ *        rh_dma_reap() re-arms the interrupt itself.
+ */
+int rh_dma_fd(const RhDma* dma);
+
+/**
+ * @brief The mapped controller registers, for diagnostics (NULL for the software backend).
+ */
+CoreAXI4DMAController_Regs_t* rh_dma_regs(const RhDma* dma);
+
+/**
+ * @brief Invalidates every descriptor and empties the interrupt queue, then forgets every transfer
+ *        still queued or in flight and every completion not yet reaped.
+ * @return Number of outstanding transfers dropped.
+ */
+unsigned rh_dma_reset(RhDma* dma);
+
+/**
+ * @brief Resets the controller and unmaps it.
+ */
+void rh_dma_close(RhDma* dma);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // RADIOHOUND_DMA_API_H
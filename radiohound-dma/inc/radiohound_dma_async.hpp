@@ -0,0 +1,342 @@
+// =================================================================================================
+// File: radiohound_dma_async.hpp
+// Description: C++20 coroutine layer over the asynchronous DMA interface.
+//
+// Code written as coroutines `co_await` a transfer, a sleep, or (through a router registered for
+// some TDEST channels, see capture_async.hpp in the firmware) a stream slot. One EventLoop drives
+// them all on the calling thread. Each turn of the loop submits every transfer the coroutines
+// asked for since the last turn as one batch, collects finished transfers without waiting, fires
+// expired timers and resumes whoever was waiting. Only when nothing is runnable does it sleep,
+// in poll() on the UIO interrupt fd and a timerfd armed for the earliest deadline.
+//
+// A suspended coroutine costs its frame and, while it waits, one pooled operation record; there
+// are no threads and no per-transfer allocation once the pool has grown. Transfers beyond the
+// library's RH_DMA_QUEUE_DEPTH wait in the loop's backlog, so thousands may be awaited at once.
+//
+// A transfer given a timeout resumes its coroutine with RH_DMA_STATUS_TIMEOUT when the deadline
+// passes first. The controller cannot abandon a single transfer, so its destination may still be
+// written afterwards; the loop keeps the record until the late completion arrives.
+// =================================================================================================
+
+#ifndef RADIOHOUND_DMA_ASYNC_HPP
+#define RADIOHOUND_DMA_ASYNC_HPP
+
+#include <cassert>
+#include <chrono>
+#include <coroutine>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <optional>
+#include <queue>
+#include <utility>
+#include <vector>
+#include "radiohound_dma_api.h"
+
+namespace rhdma {
+
+template <typename T = void>
+class Task;
+
+class EventLoop;
+
+namespace detail {
+
+// --- Coroutine Promises ---
+
+struct PromiseBase {
+    std::coroutine_handle<> continuation = std::noop_coroutine();
+    std::exception_ptr      error;
+
+    struct FinalAwaiter {
+        bool await_ready() const noexcept { return false; }
+        template <typename P>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<P> done) noexcept {
+            return done.promise().continuation; // Symmetric transfer back to the awaiting coroutine
+        }
+        void await_resume() const noexcept {}
+    };
+
+    std::suspend_always initial_suspend() const noexcept { return {}; }
+    FinalAwaiter final_suspend() const noexcept { return {}; }
+    void unhandled_exception() noexcept { error = std::current_exception(); }
+};
+
+template <typename T>
+struct Promise : PromiseBase {
+    std::optional<T> value;
+
+    Task<T> get_return_object() noexcept;
+    template <typename U>
+    void return_value(U&& result) { value.emplace(std::forward<U>(result)); }
+    T take() {
+        if (error) std::rethrow_exception(error);
+        return std::move(*value);
+    }
+};
+
+template <>
+struct Promise<void> : PromiseBase {
+    Task<void> get_return_object() noexcept;
+    void return_void() const noexcept {}
+    void take() {
+        if (error) std::rethrow_exception(error);
+    }
+};
+
+// A transfer or sleep some coroutine is waiting on. Records live in a pool owned by the loop;
+// a submitted transfer carries its record's address as user_data.
+struct Operation {
+    enum class State : uint8_t { Free, Backlog, Submitted, Sleeping, Done, Orphaned };
+
+    State                   state = State::Free;
+    uint32_t                generation = 0;      // Bumped on reuse; stale timers compare it
+    std::coroutine_handle<> waiter;
+    RhDmaTransfer           xfer{};
+    uint64_t                user_data = 0;       // The caller's, restored in the result
+    RhDmaCompletion         result{};
+    Operation*              next = nullptr;      // Backlog or free list
+};
+
+struct Timer {
+    uint64_t   deadline_ns;
+    Operation* op;
+    uint32_t   generation;
+    bool operator>(const Timer& other) const { return deadline_ns > other.deadline_ns; }
+};
+
+// Owns a task spawned onto the loop; the frame frees itself when the task finishes.
+struct Detached {
+    struct promise_type {
+        EventLoop*    loop = nullptr;
+        promise_type* prev = nullptr;
+        promise_type* next = nullptr;
+
+        Detached get_return_object() noexcept {
+            return Detached{ std::coroutine_handle<promise_type>::from_promise(*this) };
+        }
+        std::suspend_always initial_suspend() const noexcept { return {}; }
+        std::suspend_never final_suspend() const noexcept { return {}; }
+        void return_void() const noexcept {}
+        void unhandled_exception() const noexcept { std::terminate(); }
+        ~promise_type();
+    };
+    std::coroutine_handle<promise_type> handle;
+};
+
+} // namespace detail
+
+
+// --- Task ---
+
+/**
+ * @brief A lazily started coroutine returning T. Awaiting it runs it to completion and yields its
+ *        result (or rethrows its exception). Top-level tasks are handed to EventLoop::spawn().
+ */
+template <typename T>
+class [[nodiscard]] Task {
+public:
+    using promise_type = detail::Promise<T>;
+    using Handle = std::coroutine_handle<promise_type>;
+
+    Task() = default;
+    explicit Task(Handle handle) noexcept : handle_(handle) {}
+    Task(Task&& other) noexcept : handle_(std::exchange(other.handle_, {})) {}
+    Task& operator=(Task&& other) noexcept {
+        if (this != &other) {
+            if (handle_) handle_.destroy();
+            handle_ = std::exchange(other.handle_, {});
+        }
+        return *this;
+    }
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+    ~Task() {
+        if (handle_) handle_.destroy();
+    }
+
+    bool await_ready() const noexcept {
+        assert(handle_ && "awaiting a Task with no coroutine");
+        return handle_.done();
+    }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+        handle_.promise().continuation = awaiting;
+        return handle_;
+    }
+    T await_resume() { return handle_.promise().take(); }
+
+private:
+    Handle handle_;
+};
+
+namespace detail {
+template <typename T>
+Task<T> Promise<T>::get_return_object() noexcept {
+    return Task<T>{ std::coroutine_handle<Promise<T>>::from_promise(*this) };
+}
+inline Task<void> Promise<void>::get_return_object() noexcept {
+    return Task<void>{ std::coroutine_handle<Promise<void>>::from_promise(*this) };
+}
+} // namespace detail
+
+
+// --- Event Loop ---
+
+/**
+ * @brief Called for every completion on a routed TDEST channel, from inside EventLoop::run().
+ */
+using StreamRouter = void (*)(void* context, const RhDmaCompletion& done);
+
+class EventLoop {
+public:
+    /**
+     * @brief Awaitable returned by transfer(); resumes with the transfer's completion.
+     */
+    class TransferAwaiter {
+    public:
+        TransferAwaiter(EventLoop& loop, const RhDmaTransfer& xfer, int64_t timeout_ns)
+            : loop_(loop), xfer_(xfer), timeout_ns_(timeout_ns) {}
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> waiter) { op_ = loop_.queue_transfer(xfer_, timeout_ns_, waiter); }
+        RhDmaCompletion await_resume() noexcept { return loop_.finish(op_); }
+
+    private:
+        EventLoop&          loop_;
+        RhDmaTransfer       xfer_;
+        int64_t             timeout_ns_;
+        detail::Operation*  op_ = nullptr;
+    };
+
+    /**
+     * @brief Awaitable returned by sleep().
+     */
+    class SleepAwaiter {
+    public:
+        SleepAwaiter(EventLoop& loop, int64_t duration_ns) : loop_(loop), duration_ns_(duration_ns) {}
+        bool await_ready() const noexcept { return duration_ns_ <= 0; }
+        void await_suspend(std::coroutine_handle<> waiter) { op_ = loop_.queue_sleep(duration_ns_, waiter); }
+        void await_resume() noexcept {
+            if (op_) loop_.finish(op_);
+        }
+
+    private:
+        EventLoop&          loop_;
+        int64_t             duration_ns_;
+        detail::Operation*  op_ = nullptr;
+    };
+
+    /**
+     * @brief Drives coroutines over an open DMA handle. The loop does not own the handle, but it
+     *        must be the only caller of rh_dma_submit()/rh_dma_reap() while it exists.
+     */
+    explicit EventLoop(RhDma* dma);
+
+    /**
+     * @brief Destroys every task that has not finished. Transfers still in flight are dropped with
+     *        rh_dma_reset() first, so no completion can name a destroyed coroutine.
+     */
+    ~EventLoop();
+
+    EventLoop(const EventLoop&) = delete;
+    EventLoop& operator=(const EventLoop&) = delete;
+
+    /**
+     * @brief Submits a transfer and suspends until it completes. The completion's user_data is the
+     *        transfer's own. A negative timeout waits for as long as it takes.
+     */
+    TransferAwaiter transfer(const RhDmaTransfer& xfer, std::chrono::nanoseconds timeout = std::chrono::nanoseconds(-1)) {
+        return TransferAwaiter(*this, xfer, timeout.count());
+    }
+
+    /**
+     * @brief Suspends for at least `duration`.
+     */
+    SleepAwaiter sleep(std::chrono::nanoseconds duration) { return SleepAwaiter(*this, duration.count()); }
+
+    /**
+     * @brief Hands a top-level task to the loop. It starts on the next turn of run().
+     */
+    void spawn(Task<void> task);
+
+    /**
+     * @brief Makes a suspended coroutine runnable on the next turn, e.g. from a StreamRouter.
+     */
+    void schedule(std::coroutine_handle<> coroutine) { ready_.push_back(coroutine); }
+
+    /**
+     * @brief Delivers completions of stream transfers on the channels in `channel_mask` (bit n for
+     *        TDEST n) to `router` instead of to an awaiting transfer(). Stream transfers on those
+     *        channels can then no longer be awaited through transfer(). A null router removes the route.
+     */
+    void route_streams(uint32_t channel_mask, StreamRouter router, void* context);
+
+    /**
+     * @brief Runs until every spawned task has finished or stop() is called.
+     * @return 0 on success, -1 if waiting failed, a task threw, or tasks remain that nothing can wake.
+     */
+    int run();
+
+    /**
+     * @brief Makes run() return after the current turn; unfinished tasks stay suspended.
+     */
+    void stop() { stopped_ = true; }
+
+    /**
+     * @brief Transfers submitted to the library or waiting in the backlog.
+     */
+    unsigned pending_transfers() const { return pending_transfers_; }
+
+    /**
+     * @brief Highest pending_transfers() seen, and the number of operation records pooled.
+     */
+    unsigned peak_pending_transfers() const { return peak_pending_transfers_; }
+    size_t pooled_operations() const { return pool_.size(); }
+
+    RhDma* dma() const { return dma_; }
+
+private:
+    friend struct detail::Detached::promise_type;
+
+    detail::Operation* allocate();
+    void release(detail::Operation* op);
+    detail::Operation* queue_transfer(const RhDmaTransfer& xfer, int64_t timeout_ns, std::coroutine_handle<> waiter);
+    detail::Operation* queue_sleep(int64_t duration_ns, std::coroutine_handle<> waiter);
+    RhDmaCompletion finish(detail::Operation* op);
+    void complete(detail::Operation* op, const RhDmaCompletion& done);
+    void fail(detail::Operation* op, int32_t status);
+    void add_timer(detail::Operation* op, int64_t duration_ns);
+
+    void flush_backlog();
+    int drain_completions();
+    void fire_timers();
+    int wait();
+    void resume_ready();
+    static detail::Detached drive(EventLoop* loop, Task<void> task);
+
+    RhDma*                              dma_;
+    int                                 timer_fd_ = -1;
+    uint64_t                            timer_armed_ns_ = 0;   // Deadline the timerfd is set for, 0 if disarmed
+
+    std::deque<detail::Operation>       pool_;                 // Stable addresses; grows, never shrinks
+    detail::Operation*                  free_ = nullptr;
+    detail::Operation*                  backlog_head_ = nullptr;
+    detail::Operation*                  backlog_tail_ = nullptr;
+    unsigned                            pending_transfers_ = 0;
+    unsigned                            peak_pending_transfers_ = 0;
+    std::priority_queue<detail::Timer, std::vector<detail::Timer>, std::greater<detail::Timer>> timers_;
+
+    uint32_t                            routed_mask_ = 0;
+    StreamRouter                        router_ = nullptr;
+    void*                               router_context_ = nullptr;
+
+    std::vector<std::coroutine_handle<>> ready_;
+    std::vector<std::coroutine_handle<>> running_;
+    detail::Detached::promise_type*     tasks_ = nullptr;      // Unfinished spawned tasks
+    unsigned                            live_tasks_ = 0;
+    unsigned                            task_errors_ = 0;
+    bool                                stopped_ = false;
+};
+
+} // namespace rhdma
+
+#endif // RADIOHOUND_DMA_ASYNC_HPP
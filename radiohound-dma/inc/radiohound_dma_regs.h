@@ -0,0 +1,99 @@
+// =================================================================================================
+// File: radiohound_dma_regs.h
+// Description: Register map and descriptor formats of the CoreAXI4DMAController, as laid out in
+//              the handbook (ref/CoreAXI4DMAController_HB.pdf, chapter 4).
+//
+// Only radiohound_dma_api.c writes these registers. Applications include this header to print
+// diagnostics through rh_dma_regs().
+// =================================================================================================
+
+#ifndef RADIOHOUND_DMA_REGS_H
+#define RADIOHOUND_DMA_REGS_H
+
+#include <stdint.h>
+
+#define RH_DMA_MAX_DESCRIPTORS 32 // Internal descriptors the core can be built with (4-32)
+#define RH_DMA_STREAMS         4  // TDEST values with a stream descriptor address register
+#define RH_DMA_INTERRUPTS      4
+
+/*
+ * A single internal descriptor block. Each descriptor is 32 bytes.
+ */
+typedef struct {
+    volatile uint32_t CONFIG_REG;         // Offset +0x00
+    volatile uint32_t BYTE_COUNT_REG;     // Offset +0x04
+    volatile uint32_t SOURCE_ADDR_REG;    // Offset +0x08
+    volatile uint32_t DEST_ADDR_REG;      // Offset +0x0C
+    volatile uint32_t NEXT_DESC_ADDR_REG; // Offset +0x10
+    uint8_t           _RESERVED[0x20 - 0x14];
+} DmaDescriptorBlock_t;
+
+/*
+ * The register block for a single interrupt output. STAT_REG shows the event at the head of the
+ * output's queue; clearing every bit it shows pops that event.
+ */
+typedef struct {
+    volatile const uint32_t STAT_REG;
+    volatile uint32_t       MASK_REG;
+    volatile uint32_t       CLEAR_REG;
+    volatile const uint32_t EXT_ADDR_REG;
+} DmaInterruptBlock_t;
+
+/*
+ * A stream descriptor in DMA-visible memory. The hardware reads 12 bytes; the configuration word
+ * must be aligned to the AXI bus width.
+ */
+#define STREAM_DESC_SIZE 16
+typedef struct {
+    volatile uint32_t CONFIG_REG;         // Offset +0x00
+    volatile uint32_t BYTE_COUNT_REG;     // Offset +0x04
+    volatile uint32_t DEST_ADDR_REG;      // Offset +0x08
+    uint8_t           _RESERVED[STREAM_DESC_SIZE - 12];
+} StreamDescriptor_t;
+
+/*
+ * The register layout of the CoreAXI4DMAController.
+ */
+typedef struct {
+    volatile const uint32_t VERSION_REG;                                // Offset +0x00
+    volatile uint32_t       START_OPERATION_REG;                        // Offset +0x04
+    uint8_t                 _RESERVED1[0x10 - 0x08];
+    DmaInterruptBlock_t     INTERRUPT[RH_DMA_INTERRUPTS];               // Offset +0x10
+    uint8_t                 _RESERVED2[0x60 - 0x50];
+    DmaDescriptorBlock_t    DESCRIPTOR[RH_DMA_MAX_DESCRIPTORS];         // Offset +0x60
+    volatile uint32_t       STREAM_DESC_ADDR_REG[RH_DMA_STREAMS];       // Offset +0x460
+} CoreAXI4DMAController_Regs_t;
+
+// Internal descriptor CONFIG_REG bits
+#define OP_INCR                  (0b01)    // Source [1:0] / destination [3:2] operation: increment
+#define FLAG_CHAIN               (1U << 10)
+#define FLAG_EXT_DESC_NEXT       (1U << 11)
+#define FLAG_IRQ_ON_PROCESS      (1U << 12)
+#define FLAG_SRC_RDY             (1U << 13)
+#define FLAG_DEST_RDY            (1U << 14)
+#define FLAG_VALID               (1U << 15)
+
+// Base configuration for an incrementing transfer (without the VALID bit)
+#define BASE_CONF                ((OP_INCR << 2) | OP_INCR | FLAG_SRC_RDY | FLAG_DEST_RDY)
+
+// Stream descriptor CONFIG_REG bits
+#define STREAM_FLAG_DEST_OP_INCR (0b01)
+#define STREAM_FLAG_DEST_RDY     (1U << 2)
+#define STREAM_FLAG_VALID        (1U << 3)
+
+// INTERRUPT[n].STAT_REG / MASK_REG / CLEAR_REG bits
+#define FDMA_IRQ_OPS_COMPL       (1U << 0)
+#define FDMA_IRQ_WR_ERR          (1U << 1)
+#define FDMA_IRQ_RD_ERR          (1U << 2)
+#define FDMA_IRQ_INVALID_DESC    (1U << 3)
+#define FDMA_IRQ_ALL             0xFU
+#define FDMA_IRQ_ERRORS          (FDMA_IRQ_WR_ERR | FDMA_IRQ_RD_ERR | FDMA_IRQ_INVALID_DESC)
+
+// INTERRUPT[n].STAT_REG descriptor number field
+#define FDMA_STAT_DESC_NUM(stat) (((stat) >> 4) & 0x3F)
+#define FDMA_DESC_NUM_EXTERNAL   32        // EXT_ADDR_REG holds the external descriptor's address
+#define FDMA_DESC_NUM_STREAM     33        // EXT_ADDR_REG holds the stream descriptor's address
+
+#define FDMA_MAX_STREAM_BYTES    (8UL * 1024 * 1024) // Largest single stream transaction
+
+#endif // RADIOHOUND_DMA_REGS_H
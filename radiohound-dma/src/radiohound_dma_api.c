@@ -0,0 +1,441 @@
+// =================================================================================================
+// File: radiohound_dma_api.c
+// Description: Implementation of the asynchronous DMA interface.
+// =================================================================================================
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include "radiohound_dma_api.h"
+
+// --- Internal Helpers ---
+
+#define QUEUE_MASK   (RH_DMA_QUEUE_DEPTH - 1)
+#define REGS_MAP_SIZE 4096UL
+#define SYSFS_PATH_LEN 128
+#define ID_STR_LEN 32
+#define NUM_UIO_DEVICES 32
+
+_Static_assert((RH_DMA_QUEUE_DEPTH & QUEUE_MASK) == 0, "RH_DMA_QUEUE_DEPTH must be a power of two");
+_Static_assert(offsetof(CoreAXI4DMAController_Regs_t, STREAM_DESC_ADDR_REG) == 0x460, "register map");
+
+// Finds the UIO device number (the X in /dev/uioX) for a device tree name.
+static int get_uio_device_number(const char* id) {
+    char file_id[ID_STR_LEN];
+    char sysfs_path[SYSFS_PATH_LEN];
+
+    for (int i = 0; i < NUM_UIO_DEVICES; i++) {
+        snprintf(sysfs_path, SYSFS_PATH_LEN, "/sys/class/uio/uio%d/name", i);
+        FILE* fp = fopen(sysfs_path, "r");
+        if (fp == NULL) break;
+        int found = fscanf(fp, "%31s", file_id) == 1 && strncmp(file_id, id, strlen(id)) == 0;
+        fclose(fp);
+        if (found) return i;
+    }
+    return -1;
+}
+
+static int queue_empty(const RhDmaQueue* q) {
+    return q->head == q->tail;
+}
+
+// Cannot overflow: every queue holds at most the outstanding transfers, which submit caps.
+static void queue_push(RhDmaQueue* q, const RhDmaTransfer* xfer) {
+    q->xfer[q->tail++ & QUEUE_MASK] = *xfer;
+}
+
+static RhDmaTransfer* queue_pop(RhDmaQueue* q) {
+    return &q->xfer[q->head++ & QUEUE_MASK];
+}
+
+static void post(RhDma* dma, const RhDmaTransfer* xfer, int32_t status, uint32_t irq_status) {
+    RhDmaCompletion* c = &dma->cq[dma->cq_tail++ & QUEUE_MASK];
+    c->user_data = xfer->user_data;
+    c->bytes = xfer->bytes;
+    c->status = status;
+    c->irq_status = irq_status;
+    c->kind = xfer->kind;
+    c->stream = xfer->stream;
+    dma->stats.completed++;
+    if (status == RH_DMA_STATUS_ERROR) dma->stats.errors++;
+}
+
+static StreamDescriptor_t* stream_desc(const RhDma* dma, unsigned stream) {
+    return (StreamDescriptor_t*)((uint8_t*)dma->config.desc_virt + stream * RH_DMA_STREAM_DESC_STRIDE);
+}
+
+static uint32_t stream_desc_phys(const RhDma* dma, unsigned stream) {
+    return (uint32_t)(dma->config.desc_phys + stream * RH_DMA_STREAM_DESC_STRIDE);
+}
+
+static int transfer_valid(const RhDma* dma, const RhDmaTransfer* x) {
+    const int sw = dma->config.backend == RH_DMA_BACKEND_SOFTWARE;
+    const uint64_t limit = sw ? dma->config.mem_phys + dma->config.mem_bytes : (1ULL << 32);
+    const uint64_t base = sw ? dma->config.mem_phys : 0;
+
+    if (x->bytes == 0 || x->dst_phys < base || x->dst_phys + x->bytes > limit) {
+        fprintf(stderr, "RH DMA: destination 0x%llx + %u is outside the addressable range\n",
+                (unsigned long long)x->dst_phys, x->bytes);
+        return 0;
+    }
+    if (x->kind == RH_DMA_MEM_TO_MEM) {
+        if (x->src_phys < base || x->src_phys + x->bytes > limit) {
+            fprintf(stderr, "RH DMA: source 0x%llx + %u is outside the addressable range\n",
+                    (unsigned long long)x->src_phys, x->bytes);
+            return 0;
+        }
+        return 1;
+    }
+    if (x->kind == RH_DMA_STREAM_TO_MEM) {
+        if (x->stream >= RH_DMA_STREAMS || x->bytes > FDMA_MAX_STREAM_BYTES) {
+            fprintf(stderr, "RH DMA: stream transfer needs TDEST < %d and at most %lu bytes\n",
+                    RH_DMA_STREAMS, (unsigned long)FDMA_MAX_STREAM_BYTES);
+            return 0;
+        }
+        if (!sw && !dma->config.desc_virt) {
+            fprintf(stderr, "RH DMA: stream transfers need a stream descriptor area\n");
+            return 0;
+        }
+        return 1;
+    }
+    fprintf(stderr, "RH DMA: unknown transfer kind %d\n", (int)x->kind);
+    return 0;
+}
+
+// The software backend finishes every transfer as soon as it is handed over. Stream packets get
+// the stream source's pattern: one incrementing 32-bit word per beat.
+static void dispatch_software(RhDma* dma) {
+    uint8_t* mem = dma->config.mem_virt;
+    const uint64_t base = dma->config.mem_phys;
+
+    while (!queue_empty(&dma->mem_pending)) {
+        const RhDmaTransfer* x = queue_pop(&dma->mem_pending);
+        memmove(mem + (x->dst_phys - base), mem + (x->src_phys - base), x->bytes);
+        post(dma, x, RH_DMA_STATUS_OK, FDMA_IRQ_OPS_COMPL);
+    }
+    for (unsigned ch = 0; ch < RH_DMA_STREAMS; ++ch) {
+        while (!queue_empty(&dma->stream_pending[ch])) {
+            const RhDmaTransfer* x = queue_pop(&dma->stream_pending[ch]);
+            uint8_t* dst = mem + (x->dst_phys - base);
+            for (uint32_t i = 0; i + 4 <= x->bytes; i += 4) {
+                const uint32_t word = i / 4;
+                memcpy(dst + i, &word, sizeof(word));
+            }
+            post(dma, x, RH_DMA_STATUS_OK, FDMA_IRQ_OPS_COMPL);
+        }
+    }
+}
+
+// Hands queued transfers to free channels. Memory-to-memory transfers go to idle internal
+// descriptors and are kicked off together by one START_OPERATION_REG write; a stream transfer is
+// armed as soon as the previous packet on its TDEST has landed.
+static void dispatch(RhDma* dma) {
+    if (dma->config.backend == RH_DMA_BACKEND_SOFTWARE) {
+        dispatch_software(dma);
+        dma->stats.starts++;
+        return;
+    }
+
+    CoreAXI4DMAController_Regs_t* regs = dma->regs;
+    uint32_t start = 0;
+    for (unsigned d = 0; d < dma->config.descriptors && !queue_empty(&dma->mem_pending); ++d) {
+        if (dma->mem_busy & (1U << d)) continue;
+        const RhDmaTransfer* x = queue_pop(&dma->mem_pending);
+        DmaDescriptorBlock_t* desc = &regs->DESCRIPTOR[d];
+
+        // Two-step write: configure, then arm.
+        desc->SOURCE_ADDR_REG = (uint32_t)x->src_phys;
+        desc->DEST_ADDR_REG = (uint32_t)x->dst_phys;
+        desc->BYTE_COUNT_REG = x->bytes;
+        desc->NEXT_DESC_ADDR_REG = 0;
+        desc->CONFIG_REG = BASE_CONF | FLAG_IRQ_ON_PROCESS;
+        desc->CONFIG_REG = BASE_CONF | FLAG_IRQ_ON_PROCESS | FLAG_VALID;
+
+        dma->mem_active[d] = *x;
+        dma->mem_busy |= 1U << d;
+        start |= 1U << d;
+    }
+    if (start) {
+        __sync_synchronize();
+        regs->START_OPERATION_REG = start;
+        dma->stats.starts++;
+    }
+
+    for (unsigned ch = 0; ch < RH_DMA_STREAMS; ++ch) {
+        if ((dma->stream_busy & (1U << ch)) || queue_empty(&dma->stream_pending[ch])) continue;
+        const RhDmaTransfer* x = queue_pop(&dma->stream_pending[ch]);
+        StreamDescriptor_t* desc = stream_desc(dma, ch);
+
+        desc->DEST_ADDR_REG = (uint32_t)x->dst_phys;
+        desc->BYTE_COUNT_REG = x->bytes;
+        desc->CONFIG_REG = STREAM_FLAG_DEST_OP_INCR | STREAM_FLAG_DEST_RDY;
+        __sync_synchronize();
+        desc->CONFIG_REG |= STREAM_FLAG_VALID;
+        __sync_synchronize();
+        regs->STREAM_DESC_ADDR_REG[ch] = stream_desc_phys(dma, ch);
+        __sync_synchronize();
+
+        dma->stream_active[ch] = *x;
+        dma->stream_busy |= 1U << ch;
+    }
+}
+
+// Pops every event off the Interrupt 0 queue and completes the transfer each one names: an
+// internal descriptor number, or for stream packets the stream descriptor's address.
+static void handle_events(RhDma* dma) {
+    DmaInterruptBlock_t* irq = &dma->regs->INTERRUPT[0];
+
+    for (int guard = 0; guard < RH_DMA_QUEUE_DEPTH + RH_DMA_MAX_DESCRIPTORS; ++guard) {
+        const uint32_t stat = irq->STAT_REG;
+        if (!(stat & FDMA_IRQ_ALL)) break;
+        const uint32_t num = FDMA_STAT_DESC_NUM(stat);
+        const uint32_t ext = irq->EXT_ADDR_REG;
+        irq->CLEAR_REG = stat & FDMA_IRQ_ALL;
+        __sync_synchronize();
+        dma->stats.events++;
+
+        const int32_t status = (stat & FDMA_IRQ_ERRORS) ? RH_DMA_STATUS_ERROR : RH_DMA_STATUS_OK;
+        if (num < RH_DMA_MAX_DESCRIPTORS && (dma->mem_busy & (1U << num))) {
+            dma->mem_busy &= ~(1U << num);
+            post(dma, &dma->mem_active[num], status, stat);
+            continue;
+        }
+        int matched = 0;
+        for (unsigned ch = 0; num == FDMA_DESC_NUM_STREAM && ch < RH_DMA_STREAMS; ++ch) {
+            if ((dma->stream_busy & (1U << ch)) && ext == stream_desc_phys(dma, ch)) {
+                dma->stream_busy &= ~(1U << ch);
+                post(dma, &dma->stream_active[ch], status, stat);
+                matched = 1;
+                break;
+            }
+        }
+        if (!matched) dma->stats.stray_events++;
+    }
+}
+
+static int in_flight(const RhDma* dma) {
+    return dma->mem_busy != 0 || dma->stream_busy != 0;
+}
+
+// Consumes the UIO interrupt if it has fired (waiting up to timeout_ms for it), drains the
+// controller and re-arms the line, which the generic UIO driver masks after every interrupt.
+// Returns 1 if the interrupt had fired, 0 if not, -1 on error.
+static int service(RhDma* dma, int timeout_ms) {
+    struct pollfd pfd = { .fd = dma->uio_fd, .events = POLLIN };
+    int rc = poll(&pfd, 1, timeout_ms);
+    if (rc < 0) {
+        if (errno == EINTR) return 0;
+        perror("RH DMA: poll on the UIO device failed");
+        return -1;
+    }
+    if (rc > 0) {
+        uint32_t irq_count;
+        if (read(dma->uio_fd, &irq_count, sizeof(irq_count)) != sizeof(irq_count)) {
+            perror("RH DMA: failed to read the UIO interrupt count");
+            return -1;
+        }
+    }
+
+    handle_events(dma);
+
+    if (rc > 0) {
+        uint32_t irq_enable = 1;
+        if (write(dma->uio_fd, &irq_enable, sizeof(irq_enable)) != sizeof(irq_enable)) {
+            perror("RH DMA: failed to re-enable the UIO interrupt");
+            return -1;
+        }
+    }
+    return rc > 0;
+}
+
+static int ms_until(const struct timespec* deadline) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    long long ms = (long long)(deadline->tv_sec - now.tv_sec) * 1000 + (deadline->tv_nsec - now.tv_nsec) / 1000000;
+    return ms > 0 ? (int)ms : 0;
+}
+
+
+// --- Public API ---
+
+void rh_dma_config_default(RhDmaConfig* config) {
+    memset(config, 0, sizeof(*config));
+    config->backend = RH_DMA_BACKEND_UIO;
+    config->uio_name = RH_DMA_DEFAULT_UIO_NAME;
+    config->descriptors = RH_DMA_DEFAULT_DESCRIPTORS;
+}
+
+int rh_dma_open(RhDma* dma, const RhDmaConfig* config) {
+    char uio_dev_path[32];
+
+    memset(dma, 0, sizeof(*dma));
+    dma->uio_fd = -1;
+    dma->config = *config;
+
+    if (config->backend == RH_DMA_BACKEND_SOFTWARE) {
+        if (!config->mem_virt || config->mem_bytes == 0) {
+            fprintf(stderr, "RH DMA: the software backend needs a memory window\n");
+            return -1;
+        }
+        return 0;
+    }
+
+    if (config->descriptors == 0 || config->descriptors > RH_DMA_MAX_DESCRIPTORS) {
+        fprintf(stderr, "RH DMA: %u internal descriptors requested, the core has 1 to %d\n",
+                config->descriptors, RH_DMA_MAX_DESCRIPTORS);
+        return -1;
+    }
+    if (config->desc_virt && (config->desc_phys % RH_DMA_STREAM_DESC_STRIDE) != 0) {
+        fprintf(stderr, "RH DMA: stream descriptor area 0x%llx is not %d-byte aligned\n",
+                (unsigned long long)config->desc_phys, RH_DMA_STREAM_DESC_STRIDE);
+        return -1;
+    }
+
+    const char* path = config->uio_path;
+    if (!path) {
+        int uio_num = get_uio_device_number(config->uio_name);
+        if (uio_num < 0) {
+            fprintf(stderr, "RH DMA: no UIO device named %s\n", config->uio_name);
+            return -1;
+        }
+        snprintf(uio_dev_path, sizeof(uio_dev_path), "/dev/uio%d", uio_num);
+        path = uio_dev_path;
+    }
+    dma->uio_fd = open(path, O_RDWR);
+    if (dma->uio_fd < 0) {
+        perror("RH DMA: failed to open the UIO device");
+        return -1;
+    }
+    void* map = mmap(NULL, REGS_MAP_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, dma->uio_fd, 0);
+    if (map == MAP_FAILED) {
+        perror("RH DMA: failed to map the controller registers");
+        rh_dma_close(dma);
+        return -1;
+    }
+    dma->regs = map;
+
+    // Start from a clean controller: nothing armed, nothing queued, completions and errors unmasked.
+    dma->regs->INTERRUPT[0].MASK_REG = 0;
+    rh_dma_reset(dma);
+    memset(&dma->stats, 0, sizeof(dma->stats));
+    dma->regs->INTERRUPT[0].MASK_REG = FDMA_IRQ_ALL;
+    __sync_synchronize();
+
+    // The line may have been left masked by a previous user; writing 1 enables it.
+    uint32_t irq_enable = 1;
+    if (write(dma->uio_fd, &irq_enable, sizeof(irq_enable)) != sizeof(irq_enable)) {
+        perror("RH DMA: failed to enable the UIO interrupt");
+        rh_dma_close(dma);
+        return -1;
+    }
+    return 0;
+}
+
+int rh_dma_submit(RhDma* dma, const RhDmaTransfer* xfers, unsigned count) {
+    for (unsigned i = 0; i < count; ++i) {
+        if (!transfer_valid(dma, &xfers[i])) return -1;
+    }
+
+    const unsigned room = RH_DMA_QUEUE_DEPTH - dma->outstanding;
+    const unsigned n = count < room ? count : room;
+    for (unsigned i = 0; i < n; ++i) {
+        const RhDmaTransfer* x = &xfers[i];
+        queue_push(x->kind == RH_DMA_MEM_TO_MEM ? &dma->mem_pending : &dma->stream_pending[x->stream], x);
+    }
+    if (n == 0) return 0;
+
+    dma->outstanding += n;
+    dma->stats.submitted += n;
+    dma->stats.batches++;
+    dispatch(dma);
+    return (int)n;
+}
+
+int rh_dma_reap(RhDma* dma, RhDmaCompletion* out, unsigned max, int timeout_ms) {
+    if (dma->config.backend == RH_DMA_BACKEND_UIO && in_flight(dma)) {
+        // Collect and re-arm whatever has finished since the last call, even if earlier
+        // completions are still queued, so the channels keep running while the caller drains.
+        if (service(dma, 0) < 0) return -1;
+
+        if (dma->cq_head == dma->cq_tail && timeout_ms != 0) {
+            struct timespec deadline;
+            if (timeout_ms > 0) {
+                clock_gettime(CLOCK_MONOTONIC, &deadline);
+                deadline.tv_sec += timeout_ms / 1000;
+                deadline.tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+                if (deadline.tv_nsec >= 1000000000L) {
+                    deadline.tv_sec++;
+                    deadline.tv_nsec -= 1000000000L;
+                }
+            }
+            while (dma->cq_head == dma->cq_tail && in_flight(dma)) {
+                const int wait_ms = timeout_ms < 0 ? -1 : ms_until(&deadline);
+                const int rc = service(dma, wait_ms);
+                if (rc < 0) return -1;
+                if (rc > 0) dma->stats.waits++;
+                if (timeout_ms > 0 && wait_ms == 0) break;
+            }
+        }
+        dispatch(dma);
+    }
+
+    unsigned n = 0;
+    while (n < max && dma->cq_head != dma->cq_tail) {
+        out[n++] = dma->cq[dma->cq_head++ & QUEUE_MASK];
+    }
+    dma->outstanding -= n;
+    return (int)n;
+}
+
+unsigned rh_dma_outstanding(const RhDma* dma) {
+    return dma->outstanding;
+}
+
+int rh_dma_fd(const RhDma* dma) {
+    return dma->uio_fd;
+}
+
+CoreAXI4DMAController_Regs_t* rh_dma_regs(const RhDma* dma) {
+    return dma->regs;
+}
+
+unsigned rh_dma_reset(RhDma* dma) {
+    const unsigned dropped = dma->outstanding;
+
+    if (dma->config.backend == RH_DMA_BACKEND_UIO && dma->regs) {
+        CoreAXI4DMAController_Regs_t* regs = dma->regs;
+        for (unsigned d = 0; d < dma->config.descriptors; ++d) regs->DESCRIPTOR[d].CONFIG_REG = 0;
+        for (unsigned ch = 0; ch < RH_DMA_STREAMS; ++ch) {
+            if (dma->config.desc_virt) stream_desc(dma, ch)->CONFIG_REG = 0;
+            regs->STREAM_DESC_ADDR_REG[ch] = 0;
+        }
+        __sync_synchronize();
+        service(dma, 0); // Empties the interrupt queue and re-arms the line
+    }
+
+    dma->mem_pending.head = dma->mem_pending.tail = 0;
+    for (unsigned ch = 0; ch < RH_DMA_STREAMS; ++ch) {
+        dma->stream_pending[ch].head = dma->stream_pending[ch].tail = 0;
+    }
+    dma->mem_busy = 0;
+    dma->stream_busy = 0;
+    dma->cq_head = dma->cq_tail = 0;
+    dma->outstanding = 0;
+    return dropped;
+}
+
+void rh_dma_close(RhDma* dma) {
+    if (dma->regs) {
+        rh_dma_reset(dma);
+        dma->regs->INTERRUPT[0].MASK_REG = 0;
+        munmap((void*)dma->regs, REGS_MAP_SIZE);
+    }
+    if (dma->uio_fd >= 0) close(dma->uio_fd);
+    dma->regs = NULL;
+    dma->uio_fd = -1;
+}
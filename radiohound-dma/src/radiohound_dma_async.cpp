@@ -0,0 +1,321 @@
+// =================================================================================================
+// File: radiohound_dma_async.cpp
+// Description: Implementation of the coroutine event loop.
+// =================================================================================================
+
+#include <cerrno>
+#include <cstdio>
+#include <ctime>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/timerfd.h>
+#include "radiohound_dma_async.hpp"
+
+namespace rhdma {
+
+// --- Internal Helpers ---
+
+using detail::Operation;
+
+static uint64_t now_ns() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+}
+
+detail::Detached::promise_type::~promise_type() {
+    if (!loop) return;
+    if (prev) prev->next = next;
+    else loop->tasks_ = next;
+    if (next) next->prev = prev;
+    loop->live_tasks_--;
+}
+
+Operation* EventLoop::allocate() {
+    Operation* op = free_;
+    if (op) {
+        free_ = op->next;
+    } else {
+        op = &pool_.emplace_back();
+    }
+    op->next = nullptr;
+    return op;
+}
+
+void EventLoop::release(Operation* op) {
+    op->state = Operation::State::Free;
+    op->generation++;
+    op->waiter = {};
+    op->next = free_;
+    free_ = op;
+}
+
+void EventLoop::add_timer(Operation* op, int64_t duration_ns) {
+    timers_.push({ now_ns() + (uint64_t)duration_ns, op, op->generation });
+}
+
+// Resumes the waiter with a result the hardware never produced (invalid transfer, timeout).
+void EventLoop::fail(Operation* op, int32_t status) {
+    op->result = RhDmaCompletion{};
+    op->result.user_data = op->user_data;
+    op->result.bytes = op->xfer.bytes;
+    op->result.status = status;
+    op->result.kind = op->xfer.kind;
+    op->result.stream = op->xfer.stream;
+    schedule(op->waiter);
+}
+
+Operation* EventLoop::queue_transfer(const RhDmaTransfer& xfer, int64_t timeout_ns, std::coroutine_handle<> waiter) {
+    Operation* op = allocate();
+    op->waiter = waiter;
+    op->xfer = xfer;
+    op->user_data = xfer.user_data;
+    op->xfer.user_data = (uint64_t)(uintptr_t)op;
+
+    if (xfer.kind == RH_DMA_STREAM_TO_MEM && xfer.stream < 32 && (routed_mask_ & (1U << xfer.stream))) {
+        fprintf(stderr, "RH DMA: TDEST %u is routed; its transfers cannot be awaited\n", xfer.stream);
+        op->state = Operation::State::Done;
+        fail(op, RH_DMA_STATUS_ERROR);
+        return op;
+    }
+
+    op->state = Operation::State::Backlog;
+    if (backlog_tail_) backlog_tail_->next = op;
+    else backlog_head_ = op;
+    backlog_tail_ = op;
+    if (++pending_transfers_ > peak_pending_transfers_) peak_pending_transfers_ = pending_transfers_;
+    if (timeout_ns >= 0) add_timer(op, timeout_ns);
+    return op;
+}
+
+Operation* EventLoop::queue_sleep(int64_t duration_ns, std::coroutine_handle<> waiter) {
+    Operation* op = allocate();
+    op->waiter = waiter;
+    op->state = Operation::State::Sleeping;
+    add_timer(op, duration_ns);
+    return op;
+}
+
+RhDmaCompletion EventLoop::finish(Operation* op) {
+    RhDmaCompletion result = op->result;
+    // A timed-out transfer keeps its record until the controller is done with it.
+    if (op->state == Operation::State::Done) release(op);
+    return result;
+}
+
+void EventLoop::complete(Operation* op, const RhDmaCompletion& done) {
+    pending_transfers_--;
+    if (op->state == Operation::State::Orphaned) {
+        release(op);
+        return;
+    }
+    op->state = Operation::State::Done;
+    op->result = done;
+    op->result.user_data = op->user_data;
+    schedule(op->waiter);
+}
+
+// Submits the backlog in batches as large as the library has room for; a batch the library
+// rejects is retried one transfer at a time so only the invalid ones fail.
+void EventLoop::flush_backlog() {
+    RhDmaTransfer batch[RH_DMA_QUEUE_DEPTH];
+    Operation* ops[RH_DMA_QUEUE_DEPTH];
+
+    while (backlog_head_) {
+        const unsigned room = RH_DMA_QUEUE_DEPTH - rh_dma_outstanding(dma_);
+        if (room == 0) return;
+
+        unsigned n = 0;
+        while (backlog_head_ && n < room) {
+            Operation* op = backlog_head_;
+            backlog_head_ = op->next;
+            if (!backlog_head_) backlog_tail_ = nullptr;
+            op->next = nullptr;
+            if (op->state == Operation::State::Orphaned) { // Timed out before it was submitted
+                pending_transfers_--;
+                release(op);
+                continue;
+            }
+            ops[n] = op;
+            batch[n++] = op->xfer;
+        }
+        if (n == 0) continue;
+
+        if (rh_dma_submit(dma_, batch, n) == (int)n) {
+            for (unsigned i = 0; i < n; ++i) ops[i]->state = Operation::State::Submitted;
+            continue;
+        }
+        for (unsigned i = 0; i < n; ++i) {
+            if (rh_dma_submit(dma_, &batch[i], 1) == 1) {
+                ops[i]->state = Operation::State::Submitted;
+            } else {
+                pending_transfers_--;
+                ops[i]->state = Operation::State::Done;
+                fail(ops[i], RH_DMA_STATUS_ERROR);
+            }
+        }
+    }
+}
+
+// Collects every finished transfer without waiting. Returns -1 if the library failed.
+int EventLoop::drain_completions() {
+    RhDmaCompletion done[RH_DMA_QUEUE_DEPTH];
+
+    while (rh_dma_outstanding(dma_) > 0) {
+        const int got = rh_dma_reap(dma_, done, RH_DMA_QUEUE_DEPTH, 0);
+        if (got < 0) return -1;
+        if (got == 0) break;
+        for (int i = 0; i < got; ++i) {
+            const RhDmaCompletion& c = done[i];
+            if (c.kind == RH_DMA_STREAM_TO_MEM && c.stream < 32 && (routed_mask_ & (1U << c.stream))) {
+                router_(router_context_, c);
+            } else {
+                complete((Operation*)(uintptr_t)c.user_data, c);
+            }
+        }
+    }
+    return 0;
+}
+
+void EventLoop::fire_timers() {
+    const uint64_t now = now_ns();
+    while (!timers_.empty() && timers_.top().deadline_ns <= now) {
+        const detail::Timer timer = timers_.top();
+        timers_.pop();
+        Operation* op = timer.op;
+        if (op->generation != timer.generation) continue; // Finished and reused since
+
+        switch (op->state) {
+        case Operation::State::Sleeping:
+            op->state = Operation::State::Done;
+            schedule(op->waiter);
+            break;
+        case Operation::State::Backlog:
+        case Operation::State::Submitted:
+            op->state = Operation::State::Orphaned;
+            fail(op, RH_DMA_STATUS_TIMEOUT);
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+// Sleeps until the controller interrupts or the earliest deadline passes.
+int EventLoop::wait() {
+    while (!timers_.empty()) {
+        const detail::Timer& top = timers_.top();
+        const Operation::State state = top.op->state;
+        const bool live = top.op->generation == top.generation &&
+                          (state == Operation::State::Sleeping || state == Operation::State::Backlog ||
+                           state == Operation::State::Submitted);
+        if (live) break;
+        timers_.pop();
+    }
+
+    const uint64_t deadline = timers_.empty() ? 0 : timers_.top().deadline_ns;
+    if (deadline != timer_armed_ns_ && timer_fd_ >= 0) {
+        struct itimerspec spec = {};
+        spec.it_value.tv_sec = (time_t)(deadline / 1000000000ULL);
+        spec.it_value.tv_nsec = (long)(deadline % 1000000000ULL);
+        if (timerfd_settime(timer_fd_, TFD_TIMER_ABSTIME, &spec, nullptr) != 0) {
+            perror("RH DMA: failed to arm the loop timer");
+            return -1;
+        }
+        timer_armed_ns_ = deadline;
+    }
+
+    struct pollfd fds[2];
+    nfds_t count = 0;
+    if (rh_dma_outstanding(dma_) > 0 && rh_dma_fd(dma_) >= 0) fds[count++] = { rh_dma_fd(dma_), POLLIN, 0 };
+    if (deadline != 0 && timer_fd_ >= 0) fds[count++] = { timer_fd_, POLLIN, 0 };
+    if (count == 0) {
+        fprintf(stderr, "RH DMA: %u tasks are waiting on nothing that can wake them\n", live_tasks_);
+        return -1;
+    }
+
+    if (poll(fds, count, -1) < 0) {
+        if (errno == EINTR) return 0;
+        perror("RH DMA: poll in the event loop failed");
+        return -1;
+    }
+    for (nfds_t i = 0; i < count; ++i) {
+        if (fds[i].fd == timer_fd_ && (fds[i].revents & POLLIN)) {
+            uint64_t expirations;
+            if (read(timer_fd_, &expirations, sizeof(expirations)) == sizeof(expirations)) timer_armed_ns_ = 0;
+        }
+    }
+    // The UIO interrupt is consumed and re-armed by rh_dma_reap() on the next turn.
+    return 0;
+}
+
+void EventLoop::resume_ready() {
+    running_.swap(ready_);
+    for (std::coroutine_handle<> coroutine : running_) coroutine.resume();
+    running_.clear();
+}
+
+detail::Detached EventLoop::drive(EventLoop* loop, Task<void> task) {
+    try {
+        co_await task;
+    } catch (const std::exception& e) {
+        fprintf(stderr, "RH DMA: task failed: %s\n", e.what());
+        loop->task_errors_++;
+    } catch (...) {
+        fprintf(stderr, "RH DMA: task failed with an unknown exception\n");
+        loop->task_errors_++;
+    }
+}
+
+
+// --- Public API ---
+
+EventLoop::EventLoop(RhDma* dma) : dma_(dma) {
+    timer_fd_ = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (timer_fd_ < 0) perror("RH DMA: failed to create the loop timer; sleeps and timeouts will fail");
+}
+
+EventLoop::~EventLoop() {
+    if (pending_transfers_ > 0) rh_dma_reset(dma_);
+    while (tasks_) {
+        std::coroutine_handle<detail::Detached::promise_type>::from_promise(*tasks_).destroy();
+    }
+    if (timer_fd_ >= 0) close(timer_fd_);
+}
+
+void EventLoop::spawn(Task<void> task) {
+    detail::Detached driver = drive(this, std::move(task));
+    detail::Detached::promise_type& promise = driver.handle.promise();
+    promise.loop = this;
+    promise.next = tasks_;
+    if (tasks_) tasks_->prev = &promise;
+    tasks_ = &promise;
+    live_tasks_++;
+    schedule(driver.handle);
+}
+
+void EventLoop::route_streams(uint32_t channel_mask, StreamRouter router, void* context) {
+    routed_mask_ = router ? channel_mask : 0;
+    router_ = router;
+    router_context_ = context;
+}
+
+int EventLoop::run() {
+    stopped_ = false;
+    task_errors_ = 0;
+
+    while (live_tasks_ > 0 && !stopped_) {
+        flush_backlog();
+        if (drain_completions() < 0) return -1;
+        fire_timers();
+        if (!ready_.empty()) {
+            resume_ready();
+            continue;
+        }
+        if (backlog_head_ && rh_dma_outstanding(dma_) < RH_DMA_QUEUE_DEPTH) continue; // Room opened up
+        if (wait() < 0) return -1;
+    }
+    return task_errors_ ? -1 : 0;
+}
+
+} // namespace rhdma